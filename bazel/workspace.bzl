@@ -1,9 +1,11 @@
 load("//third_party/absl:workspace.bzl", absl = "repo")
 load("//third_party/bazel_skylib:workspace.bzl", bazel_skylib = "repo")
+load("//third_party/benchmark:workspace.bzl", benchmark = "repo")
 load("//third_party/glog:workspace.bzl", glog = "repo")
 load("//third_party/googletest:workspace.bzl", googletest = "repo")
 load("//third_party/hedron_compile_commands:workspace.bzl", hedron_compile_commands = "repo")
 load("//third_party/libjpeg:workspace.bzl", libjpeg = "repo")
+load("//third_party/lz4:workspace.bzl", lz4 = "repo")
 load("//third_party/platforms:workspace.bzl", platforms = "repo")
 load("//third_party/rules_boost:workspace.bzl", rules_boost = "repo")
 load("//third_party/rules_cc:workspace.bzl", rules_cc = "repo")
@@ -28,12 +30,14 @@ def third_party_repos():
     absl()
     glog(with_gflags = 0)
     googletest()
+    benchmark()
     rules_boost()
 
     rules_fuzzing()
     tcmalloc()
 
     libjpeg()
+    lz4()
 
 def galaxy_repositories():
     rules_bazel_repos()
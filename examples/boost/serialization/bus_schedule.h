@@ -30,6 +30,10 @@ class GpsPosition {
 
   bool operator!=(const GpsPosition& rhs) const { return *this == rhs; }
 
+  int degrees() const { return degrees_; }
+  int minutes() const { return minutes_; }
+  float seconds() const { return seconds_; }
+
  private:
   int degrees_;
   int minutes_;
@@ -49,6 +53,9 @@ class BusStop {
   BusStop() = default;
   virtual ~BusStop() = default;
 
+  const GpsPosition& latitude() const { return latitude_; }
+  const GpsPosition& longitude() const { return longitude_; }
+
  protected:
   BusStop(const GpsPosition& lat, const GpsPosition& lon)
       : latitude_(lat), longitude_(lon) {}
@@ -91,6 +98,9 @@ class BusStopCorner : public BusStop {
   virtual std::string Description() const {
     return absl::StrCat(street1_, " and ", street2_);
   }
+
+  const std::string& street1() const { return street1_; }
+  const std::string& street2() const { return street2_; }
 };
 
 class BusStopDestination : public BusStop {
@@ -108,6 +118,8 @@ class BusStopDestination : public BusStop {
                      const std::string& name)
       : BusStop(lat, lon), name_(name) {}
   virtual std::string Description() const { return name_; }
+
+  const std::string& name() const { return name_; }
 };
 
 class BusRoute {
@@ -115,6 +127,9 @@ class BusRoute {
   BusRoute() = default;
   void Append(BusStop* bs) { stops_.push_back(bs); }
 
+  const std::list<BusStop*>& stops() const { return stops_; }
+  std::list<BusStop*>* mutable_stops() { return &stops_; }
+
  private:
   friend class boost::serialization::access;
   friend std::ostream& operator<<(std::ostream& os, const BusRoute& br);
@@ -142,7 +157,7 @@ class BusRoute {
 // versions of the same class.
 
 class BusSchedule {
- private:
+ public:
   // note: this structure was made public. because the friend declarations
   // didn't seem to work as expected.
   struct TripInfo {
@@ -173,6 +188,9 @@ class BusSchedule {
     schedule_.emplace_back(std::make_pair(TripInfo(h, m, d), br));
   }
 
+  using Trip = std::pair<TripInfo, BusRoute*>;
+  const std::list<Trip>& trips() const { return schedule_; }
+
  private:
   friend class boost::serialization::access;
   friend std::ostream& operator<<(std::ostream& os, const BusSchedule& bs);
@@ -180,7 +198,7 @@ class BusSchedule {
                                   const BusSchedule::TripInfo& ti);
 
  private:
-  std::list<std::pair<TripInfo, BusRoute*> > schedule_;
+  std::list<Trip> schedule_;
   template <class Archive>
   void serialize(Archive& ar, const unsigned int version) {
     ar& schedule_;
@@ -0,0 +1,260 @@
+#include "examples/boost/serialization/bus_schedule_archive.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <ios>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "boost/archive/binary_iarchive.hpp"
+#include "boost/archive/binary_oarchive.hpp"
+#include "boost/archive/text_iarchive.hpp"
+#include "boost/archive/text_oarchive.hpp"
+#include "boost/iostreams/concepts.hpp"
+#include "boost/iostreams/filter/zstd.hpp"
+#include "boost/iostreams/filtering_stream.hpp"
+#include "boost/iostreams/operations.hpp"
+#include "examples/boost/serialization/portable_binary_archive.h"
+#include "lz4frame.h"
+
+namespace {
+
+// Input is handed to LZ4F in pieces of at most this size, which bounds the
+// output buffer.
+constexpr size_t kLz4ChunkBytes = 64 << 10;
+
+void CheckLz4(size_t code) {
+  if (LZ4F_isError(code)) {
+    throw std::ios_base::failure(
+        absl::StrCat("lz4: ", LZ4F_getErrorName(code)));
+  }
+}
+
+// A Boost.Iostreams output filter writing LZ4 frames. Filters are copied
+// into the chain, so the state lives behind a shared pointer.
+class Lz4Compressor : public boost::iostreams::multichar_output_filter {
+ public:
+  explicit Lz4Compressor(int level) : state_(std::make_shared<State>()) {
+    CheckLz4(LZ4F_createCompressionContext(&state_->ctx, LZ4F_VERSION));
+    state_->prefs.compressionLevel = level;
+    state_->out.resize(LZ4F_compressBound(kLz4ChunkBytes, &state_->prefs));
+  }
+
+  template <typename Sink>
+  std::streamsize write(Sink& sink, const char* s, std::streamsize n) {
+    State& st = *state_;
+    if (!st.started) {
+      st.started = true;
+      Emit(sink, LZ4F_compressBegin(st.ctx, st.out.data(), st.out.size(),
+                                    &st.prefs));
+    }
+    for (std::streamsize done = 0; done < n;) {
+      const size_t chunk =
+          std::min(static_cast<size_t>(n - done), kLz4ChunkBytes);
+      Emit(sink, LZ4F_compressUpdate(st.ctx, st.out.data(), st.out.size(),
+                                     s + done, chunk, nullptr));
+      done += static_cast<std::streamsize>(chunk);
+    }
+    return n;
+  }
+
+  template <typename Sink>
+  void close(Sink& sink) {
+    State& st = *state_;
+    if (st.started) {
+      st.started = false;
+      Emit(sink,
+           LZ4F_compressEnd(st.ctx, st.out.data(), st.out.size(), nullptr));
+    }
+  }
+
+ private:
+  struct State {
+    ~State() { LZ4F_freeCompressionContext(ctx); }
+
+    LZ4F_cctx* ctx = nullptr;
+    LZ4F_preferences_t prefs = LZ4F_INIT_PREFERENCES;
+    bool started = false;
+    std::vector<char> out;
+  };
+
+  template <typename Sink>
+  void Emit(Sink& sink, size_t size) {
+    CheckLz4(size);
+    boost::iostreams::write(sink, state_->out.data(),
+                            static_cast<std::streamsize>(size));
+  }
+
+  std::shared_ptr<State> state_;
+};
+
+// Reads what Lz4Compressor wrote. A stream which ends inside a frame fails.
+class Lz4Decompressor : public boost::iostreams::multichar_input_filter {
+ public:
+  Lz4Decompressor() : state_(std::make_shared<State>()) {
+    CheckLz4(LZ4F_createDecompressionContext(&state_->ctx, LZ4F_VERSION));
+    state_->in.resize(kLz4ChunkBytes);
+  }
+
+  template <typename Source>
+  std::streamsize read(Source& source, char* s, std::streamsize n) {
+    State& st = *state_;
+    std::streamsize produced = 0;
+    while (produced < n) {
+      if (st.in_pos == st.in_size) {
+        const std::streamsize got = boost::iostreams::read(
+            source, st.in.data(), static_cast<std::streamsize>(st.in.size()));
+        if (got <= 0) {
+          if (st.hint != 0) {
+            throw std::ios_base::failure("lz4: truncated frame");
+          }
+          break;
+        }
+        st.in_pos = 0;
+        st.in_size = static_cast<size_t>(got);
+      }
+      size_t out_size = static_cast<size_t>(n - produced);
+      size_t in_size = st.in_size - st.in_pos;
+      st.hint = LZ4F_decompress(st.ctx, s + produced, &out_size,
+                                st.in.data() + st.in_pos, &in_size, nullptr);
+      CheckLz4(st.hint);
+      st.in_pos += in_size;
+      produced += static_cast<std::streamsize>(out_size);
+    }
+    return produced > 0 ? produced : -1;
+  }
+
+ private:
+  struct State {
+    ~State() { LZ4F_freeDecompressionContext(ctx); }
+
+    LZ4F_dctx* ctx = nullptr;
+    std::vector<char> in;
+    size_t in_pos = 0;
+    size_t in_size = 0;
+    // LZ4F_decompress()'s last return value; 0 once a frame is complete.
+    size_t hint = 1;
+  };
+
+  std::shared_ptr<State> state_;
+};
+
+boost::iostreams::zstd_params ZstdParams(int level) {
+  return boost::iostreams::zstd_params(
+      level > 0 ? static_cast<uint32_t>(level)
+                : boost::iostreams::zstd::default_compression);
+}
+
+template <class Archive>
+void WriteArchive(const BusSchedule& s, std::ostream& os) {
+  Archive oa(os);
+  oa << s;
+}
+
+template <class Archive>
+void ReadArchive(std::istream& is, BusSchedule* s) {
+  Archive ia(is);
+  ia >> *s;
+}
+
+}  // namespace
+
+absl::Status SaveSchedule(const BusSchedule& s, std::string_view filename,
+                          const ArchiveOptions& options) {
+  std::ofstream ofs(std::string(filename), std::ios::binary);
+  if (!ofs) {
+    return absl::UnavailableError(
+        absl::StrCat("Failed to open ", filename, " for write."));
+  }
+  boost::iostreams::filtering_ostream filtered;
+  std::ostream* os = &ofs;
+  switch (options.compression) {
+    case ArchiveCompression::kNone:
+      break;
+    case ArchiveCompression::kLz4:
+      filtered.push(Lz4Compressor(options.level));
+      break;
+    case ArchiveCompression::kZstd:
+      filtered.push(
+          boost::iostreams::zstd_compressor(ZstdParams(options.level)));
+      break;
+  }
+  if (options.compression != ArchiveCompression::kNone) {
+    filtered.push(ofs);
+    os = &filtered;
+  }
+
+  try {
+    switch (options.format) {
+      case ArchiveFormat::kText:
+        WriteArchive<boost::archive::text_oarchive>(s, *os);
+        break;
+      case ArchiveFormat::kBinary:
+        WriteArchive<boost::archive::binary_oarchive>(s, *os);
+        break;
+      case ArchiveFormat::kPortableBinary:
+        WriteArchive<PortableBinaryOArchive>(s, *os);
+        break;
+    }
+    // Flushes the compressor's last frame into `ofs`.
+    filtered.reset();
+  } catch (const std::exception& e) {
+    return absl::InternalError(
+        absl::StrCat("Failed to save ", filename, ": ", e.what()));
+  }
+  ofs.close();
+  if (!ofs) {
+    return absl::UnavailableError(absl::StrCat("Failed to write ", filename));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<BusSchedule> RestoreSchedule(std::string_view filename,
+                                            const ArchiveOptions& options) {
+  std::ifstream ifs(std::string(filename), std::ios::binary);
+  if (!ifs) {
+    return absl::NotFoundError(absl::StrCat("Failed to open ", filename));
+  }
+  boost::iostreams::filtering_istream filtered;
+  std::istream* is = &ifs;
+  switch (options.compression) {
+    case ArchiveCompression::kNone:
+      break;
+    case ArchiveCompression::kLz4:
+      filtered.push(Lz4Decompressor());
+      break;
+    case ArchiveCompression::kZstd:
+      filtered.push(boost::iostreams::zstd_decompressor());
+      break;
+  }
+  if (options.compression != ArchiveCompression::kNone) {
+    filtered.push(ifs);
+    // Report decompression errors instead of just ending the archive.
+    filtered.exceptions(std::ios::badbit);
+    is = &filtered;
+  }
+
+  BusSchedule s;
+  try {
+    switch (options.format) {
+      case ArchiveFormat::kText:
+        ReadArchive<boost::archive::text_iarchive>(*is, &s);
+        break;
+      case ArchiveFormat::kBinary:
+        ReadArchive<boost::archive::binary_iarchive>(*is, &s);
+        break;
+      case ArchiveFormat::kPortableBinary:
+        ReadArchive<PortableBinaryIArchive>(*is, &s);
+        break;
+    }
+  } catch (const std::exception& e) {
+    // archive_exception and decompression errors, but also length_error or
+    // bad_alloc for a size read from a damaged binary archive.
+    return absl::DataLossError(
+        absl::StrCat("Failed to restore ", filename, ": ", e.what()));
+  }
+  return s;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "examples/boost/serialization/bus_schedule.h"
+
+// SaveSchedule()/RestoreSchedule() with a choice of archive format and a
+// streaming compression filter between the archive and the file. The
+// archive is compressed as it is written, so neither side holds the whole
+// archive in memory.
+//
+// Class versions are stored and checked as in the text archives, so
+// BusSchedule::TripInfo's version still decides what is read back.
+
+enum class ArchiveFormat {
+  kText,            // boost::archive::text_oarchive, as SaveSchedule()
+  kBinary,          // boost::archive::binary_oarchive, native byte order
+  kPortableBinary,  // PortableBinaryOArchive, readable on any platform
+};
+
+enum class ArchiveCompression {
+  kNone,
+  kLz4,   // LZ4 frames: fast, a smaller ratio
+  kZstd,  // Zstandard: slower, a larger ratio
+};
+
+struct ArchiveOptions {
+  ArchiveFormat format = ArchiveFormat::kBinary;
+  ArchiveCompression compression = ArchiveCompression::kNone;
+  // Compression level, 0 for the codec's default. For LZ4, levels from 3 on
+  // select its high compression mode and negative ones trade ratio for
+  // speed; Zstandard levels go from 1 to 22. Not needed for restoring.
+  int level = 0;
+};
+
+absl::Status SaveSchedule(const BusSchedule& s, std::string_view filename,
+                          const ArchiveOptions& options);
+// `options` must name the format and compression the file was saved with.
+// Fails with DataLoss if the file does not decompress or parse.
+absl::StatusOr<BusSchedule> RestoreSchedule(std::string_view filename,
+                                            const ArchiveOptions& options);
@@ -0,0 +1,117 @@
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "examples/boost/serialization/bus_schedule.h"
+#include "examples/boost/serialization/bus_schedule_archive.h"
+#include "examples/boost/serialization/synthetic_schedule.h"
+
+// How to run:
+// bazel run -c opt //examples/boost/serialization:bus_schedule_archive_benchmark
+namespace {
+
+constexpr size_t kNumTrips = 1 << 20;
+
+const SyntheticSchedule& Schedule() { return SyntheticScheduleFor(kNumTrips); }
+
+ArchiveOptions OptionsFor(const benchmark::State& state) {
+  ArchiveOptions options;
+  options.format = static_cast<ArchiveFormat>(state.range(0));
+  options.compression = static_cast<ArchiveCompression>(state.range(1));
+  options.level = static_cast<int>(state.range(2));
+  return options;
+}
+
+std::string FileFor(const ArchiveOptions& options) {
+  return (std::filesystem::temp_directory_path() /
+          absl::StrCat("bus_schedule_archive_",
+                       static_cast<int>(options.format), "_",
+                       static_cast<int>(options.compression), "_",
+                       options.level))
+      .string();
+}
+
+// Size of the uncompressed archive in `format`, which throughput is
+// measured against so that compressed and plain modes compare directly.
+uint64_t ArchiveBytes(ArchiveFormat format) {
+  static auto* sizes = new std::map<ArchiveFormat, uint64_t>();
+  auto it = sizes->find(format);
+  if (it != sizes->end()) {
+    return it->second;
+  }
+  ArchiveOptions options;
+  options.format = format;
+  const std::string file = FileFor(options);
+  if (!SaveSchedule(Schedule().schedule, file, options).ok()) {
+    std::abort();
+  }
+  return sizes->emplace(format, std::filesystem::file_size(file))
+      .first->second;
+}
+
+void SetCounters(benchmark::State& state, const ArchiveOptions& options) {
+  const uint64_t raw = ArchiveBytes(options.format);
+  const auto file = std::filesystem::file_size(FileFor(options));
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * raw));
+  state.counters["file_MB"] = static_cast<double>(file) / (1 << 20);
+  state.counters["ratio"] = static_cast<double>(raw) / file;
+}
+
+void BM_Save(benchmark::State& state) {
+  const ArchiveOptions options = OptionsFor(state);
+  const std::string file = FileFor(options);
+  for (auto _ : state) {
+    if (!SaveSchedule(Schedule().schedule, file, options).ok()) {
+      std::abort();
+    }
+  }
+  SetCounters(state, options);
+}
+
+void BM_Restore(benchmark::State& state) {
+  const ArchiveOptions options = OptionsFor(state);
+  const std::string file = FileFor(options);
+  if (!SaveSchedule(Schedule().schedule, file, options).ok()) {
+    std::abort();
+  }
+  for (auto _ : state) {
+    auto restored = RestoreSchedule(file, options);
+    if (!restored.ok()) {
+      std::abort();
+    }
+    benchmark::DoNotOptimize(restored);
+  }
+  SetCounters(state, options);
+}
+
+// format, compression, level
+void AllModes(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"format", "compression", "level"});
+  for (const auto format :
+       {ArchiveFormat::kText, ArchiveFormat::kBinary,
+        ArchiveFormat::kPortableBinary}) {
+    const auto f = static_cast<int64_t>(format);
+    b->Args({f, static_cast<int64_t>(ArchiveCompression::kNone), 0});
+    for (const int level : {0, 9}) {
+      b->Args({f, static_cast<int64_t>(ArchiveCompression::kLz4), level});
+    }
+    for (const int level : {1, 3, 9}) {
+      b->Args({f, static_cast<int64_t>(ArchiveCompression::kZstd), level});
+    }
+  }
+}
+
+BENCHMARK(BM_Save)
+    ->Apply(AllModes)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_Restore)
+    ->Apply(AllModes)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
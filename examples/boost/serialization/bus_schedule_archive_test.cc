@@ -0,0 +1,145 @@
+#include "examples/boost/serialization/bus_schedule_archive.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <tuple>
+
+#include "absl/strings/str_cat.h"
+#include "examples/boost/serialization/synthetic_schedule.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+std::string TempPath(const std::string& name) {
+  return ::testing::TempDir() + name;
+}
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream ifs(path, std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(ifs)),
+                     std::istreambuf_iterator<char>());
+}
+
+class ArchiveRoundTripTest
+    : public ::testing::TestWithParam<
+          std::tuple<ArchiveFormat, ArchiveCompression>> {};
+
+TEST_P(ArchiveRoundTripTest, RestoresTripsAndSharedStops) {
+  const auto [format, compression] = GetParam();
+  const SyntheticSchedule s = MakeSyntheticSchedule(3000, 8, 6);
+  ArchiveOptions options;
+  options.format = format;
+  options.compression = compression;
+  const std::string file = TempPath(absl::StrCat(
+      "archive_", static_cast<int>(format), "_",
+      static_cast<int>(compression)));
+  ASSERT_TRUE(SaveSchedule(s.schedule, file, options).ok());
+
+  auto restored = RestoreSchedule(file, options);
+  ASSERT_TRUE(restored.ok()) << restored.status();
+  ASSERT_EQ(restored->trips().size(), s.schedule.trips().size());
+  std::set<const BusRoute*> routes;
+  std::set<const BusStop*> stops;
+  auto it = s.schedule.trips().begin();
+  for (const auto& [info, route] : restored->trips()) {
+    // The driver is only read for TripInfo version 2 and later.
+    EXPECT_EQ(info.driver, it->first.driver);
+    EXPECT_EQ(info.hour, it->first.hour);
+    EXPECT_EQ(info.minute, it->first.minute);
+    ASSERT_EQ(route->stops().size(), it->second->stops().size());
+    auto jt = it->second->stops().begin();
+    for (const BusStop* stop : route->stops()) {
+      EXPECT_EQ(stop->latitude(), (*jt)->latitude());
+      EXPECT_EQ(stop->longitude(), (*jt)->longitude());
+      stops.insert(stop);
+      ++jt;
+    }
+    routes.insert(route);
+    ++it;
+  }
+  // Object tracking still shares routes and stops between trips.
+  EXPECT_LE(routes.size(), 8);
+  EXPECT_LE(stops.size(), 8 * 6 / 2 + 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllModes, ArchiveRoundTripTest,
+    ::testing::Combine(::testing::Values(ArchiveFormat::kText,
+                                         ArchiveFormat::kBinary,
+                                         ArchiveFormat::kPortableBinary),
+                       ::testing::Values(ArchiveCompression::kNone,
+                                         ArchiveCompression::kLz4,
+                                         ArchiveCompression::kZstd)));
+
+TEST(ArchiveTest, CompressionShrinksArchives) {
+  const SyntheticSchedule s = MakeSyntheticSchedule(20000);
+  const std::string file = TempPath("archive_sizes");
+  auto size_of = [&](ArchiveFormat format, ArchiveCompression compression,
+                     int level) {
+    ArchiveOptions options{format, compression, level};
+    EXPECT_TRUE(SaveSchedule(s.schedule, file, options).ok());
+    return std::filesystem::file_size(file);
+  };
+  const auto text = size_of(ArchiveFormat::kText, ArchiveCompression::kNone, 0);
+  const auto binary =
+      size_of(ArchiveFormat::kBinary, ArchiveCompression::kNone, 0);
+  const auto portable =
+      size_of(ArchiveFormat::kPortableBinary, ArchiveCompression::kNone, 0);
+  const auto lz4 =
+      size_of(ArchiveFormat::kPortableBinary, ArchiveCompression::kLz4, 0);
+  const auto zstd =
+      size_of(ArchiveFormat::kPortableBinary, ArchiveCompression::kZstd, 19);
+  EXPECT_LT(portable, binary);
+  EXPECT_LT(portable, text);
+  EXPECT_LT(lz4, portable);
+  EXPECT_LT(zstd, lz4);
+}
+
+TEST(ArchiveTest, MismatchedOptionsAreDataLoss) {
+  const SyntheticSchedule s = MakeSyntheticSchedule(100);
+  const std::string file = TempPath("archive_mismatch");
+  ArchiveOptions options;
+  options.format = ArchiveFormat::kPortableBinary;
+  options.compression = ArchiveCompression::kZstd;
+  ASSERT_TRUE(SaveSchedule(s.schedule, file, options).ok());
+
+  ArchiveOptions binary = options;
+  binary.format = ArchiveFormat::kBinary;
+  EXPECT_EQ(RestoreSchedule(file, binary).status().code(),
+            absl::StatusCode::kDataLoss);
+  ArchiveOptions lz4 = options;
+  lz4.compression = ArchiveCompression::kLz4;
+  EXPECT_EQ(RestoreSchedule(file, lz4).status().code(),
+            absl::StatusCode::kDataLoss);
+}
+
+TEST(ArchiveTest, TruncatedArchiveIsDataLoss) {
+  const SyntheticSchedule s = MakeSyntheticSchedule(1000);
+  const std::string file = TempPath("archive_truncated");
+  for (const ArchiveCompression compression :
+       {ArchiveCompression::kNone, ArchiveCompression::kLz4,
+        ArchiveCompression::kZstd}) {
+    ArchiveOptions options;
+    options.format = ArchiveFormat::kPortableBinary;
+    options.compression = compression;
+    ASSERT_TRUE(SaveSchedule(s.schedule, file, options).ok());
+    const std::string data = ReadFile(file);
+    std::ofstream(file, std::ios::binary | std::ios::trunc)
+        << data.substr(0, data.size() / 2);
+    EXPECT_EQ(RestoreSchedule(file, options).status().code(),
+              absl::StatusCode::kDataLoss)
+        << static_cast<int>(compression);
+  }
+}
+
+TEST(ArchiveTest, MissingFileIsNotFound) {
+  EXPECT_EQ(RestoreSchedule(TempPath("archive_missing"), ArchiveOptions())
+                .status()
+                .code(),
+            absl::StatusCode::kNotFound);
+}
+
+}  // namespace
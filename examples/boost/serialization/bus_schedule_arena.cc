@@ -0,0 +1,337 @@
+#include "examples/boost/serialization/bus_schedule_arena.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "boost/archive/archive_exception.hpp"
+#include "boost/archive/text_iarchive.hpp"
+#include "boost/archive/text_oarchive.hpp"
+
+StringPool::StringPool(StringPool&& other) noexcept {
+  *this = std::move(other);
+}
+
+StringPool& StringPool::operator=(StringPool&& other) noexcept {
+  if (this != &other) {
+    // `other` must not keep writing into the block it no longer owns.
+    blocks_ = std::move(other.blocks_);
+    current_block_ = std::exchange(other.current_block_, nullptr);
+    block_used_ = std::exchange(other.block_used_, kBlockBytes);
+    strings_ = std::move(other.strings_);
+    index_ = std::move(other.index_);
+    other.blocks_.clear();
+    other.strings_.clear();
+    other.index_.clear();
+  }
+  return *this;
+}
+
+StringId StringPool::Intern(std::string_view s) {
+  auto it = index_.find(s);
+  if (it != index_.end()) {
+    return it->second;
+  }
+  const std::string_view stored = Store(s);
+  const auto id = static_cast<StringId>(strings_.size());
+  strings_.push_back(stored);
+  index_.emplace(stored, id);
+  return id;
+}
+
+std::optional<StringId> StringPool::Find(std::string_view s) const {
+  auto it = index_.find(s);
+  if (it == index_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+std::string_view StringPool::Store(std::string_view s) {
+  if (s.size() > kBlockBytes / 4) {
+    // Large strings get a block of their own so they do not waste the tail
+    // of the current one.
+    blocks_.push_back(std::make_unique<char[]>(s.size()));
+    std::memcpy(blocks_.back().get(), s.data(), s.size());
+    return std::string_view(blocks_.back().get(), s.size());
+  }
+  if (kBlockBytes - block_used_ < s.size()) {
+    blocks_.push_back(std::make_unique<char[]>(kBlockBytes));
+    block_used_ = 0;
+    current_block_ = blocks_.back().get();
+  }
+  char* p = current_block_ + block_used_;
+  std::memcpy(p, s.data(), s.size());
+  block_used_ += s.size();
+  return std::string_view(p, s.size());
+}
+
+absl::StatusOr<ArenaSchedule> ArenaSchedule::FromSchedule(
+    const BusSchedule& s) {
+  ArenaSchedule arena;
+  std::unordered_map<const BusStop*, StopId> stop_ids;
+  std::unordered_map<const BusRoute*, RouteId> route_ids;
+  std::vector<StopId> stops;
+  arena.Reserve(s.trips().size());
+  for (const auto& [info, br] : s.trips()) {
+    auto route = route_ids.find(br);
+    if (route == route_ids.end()) {
+      stops.clear();
+      for (const BusStop* bs : br->stops()) {
+        auto stop = stop_ids.find(bs);
+        if (stop == stop_ids.end()) {
+          StopId id;
+          if (const auto* corner = dynamic_cast<const BusStopCorner*>(bs)) {
+            id = arena.AddCorner(bs->latitude(), bs->longitude(),
+                                 corner->street1(), corner->street2());
+          } else if (const auto* dest =
+                         dynamic_cast<const BusStopDestination*>(bs)) {
+            id = arena.AddDestination(bs->latitude(), bs->longitude(),
+                                      dest->name());
+          } else {
+            return absl::InvalidArgumentError("Unknown BusStop subclass.");
+          }
+          stop = stop_ids.emplace(bs, id).first;
+        }
+        stops.push_back(stop->second);
+      }
+      route = route_ids.emplace(br, arena.AddRoute(stops)).first;
+    }
+    arena.Append(info.driver, info.hour, info.minute, route->second);
+  }
+  return arena;
+}
+
+OwnedBusSchedule ArenaSchedule::ToSchedule() const {
+  OwnedBusSchedule owned;
+  owned.stops.reserve(stops_.size());
+  for (const ArenaStop& stop : stops_) {
+    if (const auto* corner = std::get_if<CornerStop>(&stop.place)) {
+      owned.stops.push_back(std::make_unique<BusStopCorner>(
+          stop.latitude, stop.longitude, std::string(string(corner->street1)),
+          std::string(string(corner->street2))));
+    } else {
+      owned.stops.push_back(std::make_unique<BusStopDestination>(
+          stop.latitude, stop.longitude,
+          std::string(string(std::get<DestinationStop>(stop.place).name))));
+    }
+  }
+  owned.routes.reserve(routes_.size());
+  for (const ArenaRoute& route : routes_) {
+    auto br = std::make_unique<BusRoute>();
+    for (size_t i = 0; i < route.num_stops; ++i) {
+      br->Append(owned.stops[route_stop(route, i)].get());
+    }
+    owned.routes.push_back(std::move(br));
+  }
+  for (const ArenaTrip& trip : trips_) {
+    owned.schedule.Append(std::string(driver(trip)), trip.hour, trip.minute,
+                          owned.routes[trip.route].get());
+  }
+  return owned;
+}
+
+StopId ArenaSchedule::AddCorner(const GpsPosition& lat,
+                                const GpsPosition& lon,
+                                std::string_view street1,
+                                std::string_view street2) {
+  const CornerStop corner{strings_.Intern(street1), strings_.Intern(street2)};
+  stops_.push_back(ArenaStop{lat, lon, corner});
+  return static_cast<StopId>(stops_.size() - 1);
+}
+
+StopId ArenaSchedule::AddDestination(const GpsPosition& lat,
+                                     const GpsPosition& lon,
+                                     std::string_view name) {
+  stops_.push_back(
+      ArenaStop{lat, lon, DestinationStop{strings_.Intern(name)}});
+  return static_cast<StopId>(stops_.size() - 1);
+}
+
+RouteId ArenaSchedule::AddRoute(const std::vector<StopId>& stops) {
+  routes_.push_back(ArenaRoute{static_cast<uint32_t>(route_stops_.size()),
+                               static_cast<uint32_t>(stops.size())});
+  route_stops_.insert(route_stops_.end(), stops.begin(), stops.end());
+  return static_cast<RouteId>(routes_.size() - 1);
+}
+
+void ArenaSchedule::Append(std::string_view driver, int hour, int minute,
+                           RouteId route) {
+  trips_.push_back(ArenaTrip{hour, minute, strings_.Intern(driver), route});
+}
+
+std::string ArenaSchedule::Description(const ArenaStop& stop) const {
+  if (const auto* corner = std::get_if<CornerStop>(&stop.place)) {
+    return absl::StrCat(string(corner->street1), " and ",
+                        string(corner->street2));
+  }
+  return std::string(string(std::get<DestinationStop>(stop.place).name));
+}
+
+absl::Status ArenaSchedule::Verify() const {
+  const size_t num_strings = strings_.size();
+  for (size_t i = 0; i < stops_.size(); ++i) {
+    const auto& place = stops_[i].place;
+    const bool ok =
+        std::holds_alternative<CornerStop>(place)
+            ? std::get<CornerStop>(place).street1 < num_strings &&
+                  std::get<CornerStop>(place).street2 < num_strings
+            : std::get<DestinationStop>(place).name < num_strings;
+    if (!ok) {
+      return absl::DataLossError(absl::StrCat("Corrupted stop ", i));
+    }
+  }
+  for (size_t i = 0; i < routes_.size(); ++i) {
+    const ArenaRoute& route = routes_[i];
+    if (route.first_stop > route_stops_.size() ||
+        route.num_stops > route_stops_.size() - route.first_stop) {
+      return absl::DataLossError(absl::StrCat("Corrupted route ", i));
+    }
+  }
+  for (size_t i = 0; i < route_stops_.size(); ++i) {
+    if (route_stops_[i] >= stops_.size()) {
+      return absl::DataLossError(absl::StrCat("Corrupted route stop ", i));
+    }
+  }
+  for (size_t i = 0; i < trips_.size(); ++i) {
+    if (trips_[i].route >= routes_.size() ||
+        trips_[i].driver >= num_strings) {
+      return absl::DataLossError(absl::StrCat("Corrupted trip ", i));
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Every section is a count followed by the fields of each record. Records
+// are written field by field rather than as serializable classes, so the
+// archive carries no per-object class or tracking information.
+template <class Archive>
+void ArenaSchedule::save(Archive& ar, const unsigned int /* version */) const {
+  uint64_t n = strings_.size();
+  ar& n;
+  for (size_t i = 0; i < strings_.size(); ++i) {
+    const std::string s(strings_.Get(i));
+    ar& s;
+  }
+  n = stops_.size();
+  ar& n;
+  for (const ArenaStop& stop : stops_) {
+    ar& stop.latitude& stop.longitude;
+    uint32_t kind = static_cast<uint32_t>(stop.place.index());
+    StringId text[2] = {0, 0};
+    if (const auto* corner = std::get_if<CornerStop>(&stop.place)) {
+      text[0] = corner->street1;
+      text[1] = corner->street2;
+    } else {
+      text[0] = std::get<DestinationStop>(stop.place).name;
+    }
+    ar& kind& text[0]& text[1];
+  }
+  n = routes_.size();
+  ar& n;
+  for (const ArenaRoute& route : routes_) {
+    ar& route.first_stop& route.num_stops;
+  }
+  n = route_stops_.size();
+  ar& n;
+  for (const StopId id : route_stops_) {
+    ar& id;
+  }
+  n = trips_.size();
+  ar& n;
+  for (const ArenaTrip& trip : trips_) {
+    ar& trip.hour& trip.minute& trip.driver& trip.route;
+  }
+}
+
+template <class Archive>
+void ArenaSchedule::load(Archive& ar, const unsigned int /* version */) {
+  // Counts come from the file, so grow the vectors as records arrive rather
+  // than trusting them for reserve().
+  constexpr uint64_t kMaxReserve = 1 << 20;
+  *this = ArenaSchedule();
+  uint64_t n = 0;
+  ar& n;
+  std::string s;
+  for (uint64_t i = 0; i < n; ++i) {
+    ar& s;
+    strings_.Intern(s);
+  }
+  ar& n;
+  stops_.reserve(std::min(n, kMaxReserve));
+  for (uint64_t i = 0; i < n; ++i) {
+    ArenaStop stop;
+    uint32_t kind = 0;
+    StringId text[2];
+    ar& stop.latitude& stop.longitude& kind& text[0]& text[1];
+    if (kind == 0) {
+      stop.place = CornerStop{text[0], text[1]};
+    } else if (kind == 1) {
+      stop.place = DestinationStop{text[0]};
+    } else {
+      throw boost::archive::archive_exception(
+          boost::archive::archive_exception::input_stream_error);
+    }
+    stops_.push_back(stop);
+  }
+  ar& n;
+  routes_.reserve(std::min(n, kMaxReserve));
+  for (uint64_t i = 0; i < n; ++i) {
+    ArenaRoute route;
+    ar& route.first_stop& route.num_stops;
+    routes_.push_back(route);
+  }
+  ar& n;
+  route_stops_.reserve(std::min(n, kMaxReserve));
+  for (uint64_t i = 0; i < n; ++i) {
+    StopId id;
+    ar& id;
+    route_stops_.push_back(id);
+  }
+  ar& n;
+  trips_.reserve(std::min(n, kMaxReserve));
+  for (uint64_t i = 0; i < n; ++i) {
+    ArenaTrip trip;
+    ar& trip.hour& trip.minute& trip.driver& trip.route;
+    trips_.push_back(trip);
+  }
+}
+
+absl::Status SaveArenaSchedule(const ArenaSchedule& s,
+                               std::string_view filename) {
+  std::ofstream ofs(filename.data());
+  if (!ofs) {
+    return absl::UnavailableError(
+        absl::StrCat("Failed to open ", filename, " for write."));
+  }
+  boost::archive::text_oarchive oa(ofs);
+  oa << s;
+  ofs.close();
+  if (!ofs) {
+    return absl::DataLossError(absl::StrCat("Failed to write ", filename));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<ArenaSchedule> RestoreArenaSchedule(
+    std::string_view filename) {
+  std::ifstream ifs(filename.data());
+  if (!ifs) {
+    return absl::NotFoundError(absl::StrCat("Failed to open ", filename));
+  }
+  ArenaSchedule s;
+  try {
+    boost::archive::text_iarchive ia(ifs);
+    ia >> s;
+  } catch (const boost::archive::archive_exception& e) {
+    return absl::DataLossError(
+        absl::StrCat(filename, " is corrupted: ", e.what()));
+  }
+  if (auto status = s.Verify(); !status.ok()) {
+    return status;
+  }
+  return s;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "boost/serialization/split_member.hpp"
+#include "examples/boost/serialization/bus_schedule.h"
+
+// In-memory BusSchedule in which stops, routes and trips live in contiguous
+// vectors and refer to each other by index instead of by pointer. Strings
+// are interned into large blocks, so a trip is 16 bytes and iterating a
+// schedule walks arrays rather than list nodes spread over the heap.
+//
+// Converts to and from the pointer-based BusSchedule, and has its own Boost
+// serialization (SaveArenaSchedule/RestoreArenaSchedule) which does not
+// track objects.
+
+using StringId = uint32_t;
+using StopId = uint32_t;
+using RouteId = uint32_t;
+
+// Interns strings into blocks which never move, so views stay valid for the
+// lifetime of the pool, including across moves of the pool itself. A
+// moved-from pool is empty.
+class StringPool {
+ public:
+  StringPool() = default;
+  StringPool(StringPool&& other) noexcept;
+  StringPool& operator=(StringPool&& other) noexcept;
+  StringPool(const StringPool&) = delete;
+  StringPool& operator=(const StringPool&) = delete;
+
+  StringId Intern(std::string_view s);
+  // Id of `s` if it has been interned.
+  std::optional<StringId> Find(std::string_view s) const;
+  std::string_view Get(StringId id) const { return strings_[id]; }
+  size_t size() const { return strings_.size(); }
+
+ private:
+  static constexpr size_t kBlockBytes = 64 << 10;
+
+  std::string_view Store(std::string_view s);
+
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char* current_block_ = nullptr;
+  size_t block_used_ = kBlockBytes;
+  std::vector<std::string_view> strings_;
+  std::unordered_map<std::string_view, StringId> index_;
+};
+
+// The BusStopCorner and BusStopDestination alternatives of a stop.
+struct CornerStop {
+  StringId street1;
+  StringId street2;
+};
+
+struct DestinationStop {
+  StringId name;
+};
+
+struct ArenaStop {
+  GpsPosition latitude;
+  GpsPosition longitude;
+  std::variant<CornerStop, DestinationStop> place;
+};
+
+struct ArenaRoute {
+  uint32_t first_stop;  // index into the route stop array
+  uint32_t num_stops;
+};
+
+struct ArenaTrip {
+  int32_t hour;
+  int32_t minute;
+  StringId driver;
+  RouteId route;
+};
+
+// A BusSchedule together with the stops and routes it points to.
+struct OwnedBusSchedule {
+  std::vector<std::unique_ptr<BusStop>> stops;
+  std::vector<std::unique_ptr<BusRoute>> routes;
+  BusSchedule schedule;
+};
+
+class ArenaSchedule {
+ public:
+  ArenaSchedule() = default;
+  ArenaSchedule(ArenaSchedule&&) = default;
+  ArenaSchedule& operator=(ArenaSchedule&&) = default;
+
+  // Stops and routes which a BusSchedule shares between trips are stored
+  // once.
+  static absl::StatusOr<ArenaSchedule> FromSchedule(const BusSchedule& s);
+  OwnedBusSchedule ToSchedule() const;
+
+  StopId AddCorner(const GpsPosition& lat, const GpsPosition& lon,
+                   std::string_view street1, std::string_view street2);
+  StopId AddDestination(const GpsPosition& lat, const GpsPosition& lon,
+                        std::string_view name);
+  // `stops` must have been returned by this schedule.
+  RouteId AddRoute(const std::vector<StopId>& stops);
+  // `route` must have been returned by this schedule.
+  void Append(std::string_view driver, int hour, int minute, RouteId route);
+  void Reserve(size_t num_trips) { trips_.reserve(num_trips); }
+
+  size_t num_stops() const { return stops_.size(); }
+  size_t num_routes() const { return routes_.size(); }
+  size_t num_trips() const { return trips_.size(); }
+
+  const ArenaStop& stop(StopId id) const { return stops_[id]; }
+  const ArenaRoute& route(RouteId id) const { return routes_[id]; }
+  const ArenaTrip& trip(size_t i) const { return trips_[i]; }
+  const std::vector<ArenaTrip>& trips() const { return trips_; }
+
+  // Stop `i` of `route`.
+  StopId route_stop(const ArenaRoute& route, size_t i) const {
+    return route_stops_[route.first_stop + i];
+  }
+  std::string_view string(StringId id) const { return strings_.Get(id); }
+  std::optional<StringId> FindString(std::string_view s) const {
+    return strings_.Find(s);
+  }
+  std::string_view driver(const ArenaTrip& trip) const {
+    return strings_.Get(trip.driver);
+  }
+  // Same text as BusStop::Description().
+  std::string Description(const ArenaStop& stop) const;
+
+  // O(n) check of all stop, route and string references.
+  absl::Status Verify() const;
+
+ private:
+  friend class boost::serialization::access;
+
+  template <class Archive>
+  void save(Archive& ar, const unsigned int /* version */) const;
+  template <class Archive>
+  void load(Archive& ar, const unsigned int /* version */);
+  BOOST_SERIALIZATION_SPLIT_MEMBER()
+
+  StringPool strings_;
+  std::vector<ArenaStop> stops_;
+  std::vector<ArenaRoute> routes_;
+  std::vector<StopId> route_stops_;
+  std::vector<ArenaTrip> trips_;
+};
+
+absl::Status SaveArenaSchedule(const ArenaSchedule& s,
+                               std::string_view filename);
+absl::StatusOr<ArenaSchedule> RestoreArenaSchedule(std::string_view filename);
@@ -0,0 +1,192 @@
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "examples/boost/serialization/bus_schedule.h"
+#include "examples/boost/serialization/bus_schedule_arena.h"
+#include "examples/boost/serialization/synthetic_schedule.h"
+
+// How to run:
+// bazel run -c opt //examples/boost/serialization:bus_schedule_arena_benchmark
+namespace {
+
+constexpr size_t kNumRoutes = 64;
+
+struct Schedules {
+  ArenaSchedule arena;
+  std::string list_file;
+  std::string arena_file;
+};
+
+// SyntheticScheduleFor(num_trips) as an ArenaSchedule, and both saved, once
+// per size.
+const Schedules& SchedulesFor(size_t num_trips) {
+  static auto* cache = new std::map<size_t, std::unique_ptr<Schedules>>();
+  auto it = cache->find(num_trips);
+  if (it != cache->end()) {
+    return *it->second;
+  }
+  const SyntheticSchedule& list = SyntheticScheduleFor(num_trips);
+  auto s = std::make_unique<Schedules>();
+  auto arena = ArenaSchedule::FromSchedule(list.schedule);
+  if (!arena.ok()) {
+    std::abort();
+  }
+  s->arena = *std::move(arena);
+  const auto dir = std::filesystem::temp_directory_path();
+  const std::string tag = std::to_string(num_trips);
+  s->list_file = (dir / ("bus_schedule_list_" + tag + ".txt")).string();
+  s->arena_file = (dir / ("bus_schedule_arena_" + tag + ".txt")).string();
+  if (!SaveSchedule(list.schedule, s->list_file).ok() ||
+      !SaveArenaSchedule(s->arena, s->arena_file).ok()) {
+    std::abort();
+  }
+  return *cache->emplace(num_trips, std::move(s)).first->second;
+}
+
+std::vector<std::string> Drivers() {
+  std::vector<std::string> drivers;
+  for (int d = 0; d < 256; ++d) {
+    drivers.push_back(absl::StrCat("driver", d));
+  }
+  return drivers;
+}
+
+// Appending trips to a schedule whose stops and routes already exist.
+void BM_ListBuild(benchmark::State& state) {
+  const SyntheticSchedule& list = SyntheticScheduleFor(1 << 10);
+  const std::vector<std::string> drivers = Drivers();
+  for (auto _ : state) {
+    std::mt19937 rng(42);
+    BusSchedule schedule;
+    for (int64_t t = 0; t < state.range(0); ++t) {
+      schedule.Append(drivers[rng() % drivers.size()],
+                      static_cast<int>(rng() % 24),
+                      static_cast<int>(rng() % 60),
+                      list.routes[rng() % list.routes.size()].get());
+    }
+    benchmark::DoNotOptimize(schedule);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ArenaBuild(benchmark::State& state) {
+  const std::vector<std::string> drivers = Drivers();
+  for (auto _ : state) {
+    std::mt19937 rng(42);
+    ArenaSchedule schedule;
+    std::vector<StopId> stops;
+    for (size_t r = 0; r < kNumRoutes; ++r) {
+      stops.push_back(schedule.AddCorner(GpsPosition(1, 2, 3.0f),
+                                         GpsPosition(4, 5, 6.0f), "Main",
+                                         absl::StrCat(r, "th Avenue")));
+      schedule.AddRoute(stops);
+    }
+    for (int64_t t = 0; t < state.range(0); ++t) {
+      schedule.Append(drivers[rng() % drivers.size()],
+                      static_cast<int>(rng() % 24),
+                      static_cast<int>(rng() % 60),
+                      static_cast<RouteId>(rng() % kNumRoutes));
+    }
+    benchmark::DoNotOptimize(schedule);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// A full scan touching every trip, its driver and the latitude of every
+// stop on its route.
+void BM_ListIterate(benchmark::State& state) {
+  const SyntheticSchedule& list = SyntheticScheduleFor(state.range(0));
+  for (auto _ : state) {
+    int64_t sum = 0;
+    for (const auto& [info, route] : list.schedule.trips()) {
+      sum += info.hour * 60 + info.minute + info.driver.size();
+      for (const BusStop* stop : route->stops()) {
+        sum += stop->latitude().degrees();
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ArenaIterate(benchmark::State& state) {
+  const Schedules& s = SchedulesFor(state.range(0));
+  const ArenaSchedule& arena = s.arena;
+  for (auto _ : state) {
+    int64_t sum = 0;
+    for (const ArenaTrip& trip : arena.trips()) {
+      sum += trip.hour * 60 + trip.minute + arena.driver(trip).size();
+      const ArenaRoute& route = arena.route(trip.route);
+      for (uint32_t i = 0; i < route.num_stops; ++i) {
+        sum += arena.stop(arena.route_stop(route, i)).latitude.degrees();
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ListRestore(benchmark::State& state) {
+  const Schedules& s = SchedulesFor(state.range(0));
+  for (auto _ : state) {
+    auto restored = RestoreSchedule(s.list_file);
+    benchmark::DoNotOptimize(restored);
+  }
+  state.counters["file_MB"] =
+      static_cast<double>(std::filesystem::file_size(s.list_file)) / (1 << 20);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ArenaRestore(benchmark::State& state) {
+  const Schedules& s = SchedulesFor(state.range(0));
+  for (auto _ : state) {
+    auto restored = RestoreArenaSchedule(s.arena_file);
+    benchmark::DoNotOptimize(restored);
+  }
+  state.counters["file_MB"] =
+      static_cast<double>(std::filesystem::file_size(s.arena_file)) /
+      (1 << 20);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ListBuild)
+    ->Arg(1 << 20)
+    ->Arg(10'000'000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_ArenaBuild)
+    ->Arg(1 << 20)
+    ->Arg(10'000'000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_ListIterate)
+    ->Arg(1 << 20)
+    ->Arg(10'000'000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_ArenaIterate)
+    ->Arg(1 << 20)
+    ->Arg(10'000'000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_ListRestore)
+    ->Arg(1 << 20)
+    ->Arg(10'000'000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_ArenaRestore)
+    ->Arg(1 << 20)
+    ->Arg(10'000'000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,200 @@
+#include "examples/boost/serialization/bus_schedule_arena.h"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "examples/boost/serialization/synthetic_schedule.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+std::string TempPath(const std::string& name) {
+  return ::testing::TempDir() + name;
+}
+
+// Checks that `arena` holds the same trips, routes and stops as `s`.
+void ExpectSameSchedule(const ArenaSchedule& arena, const BusSchedule& s) {
+  ASSERT_EQ(arena.num_trips(), s.trips().size());
+  size_t i = 0;
+  for (const auto& [info, br] : s.trips()) {
+    const ArenaTrip& trip = arena.trip(i++);
+    EXPECT_EQ(trip.hour, info.hour);
+    EXPECT_EQ(trip.minute, info.minute);
+    EXPECT_EQ(arena.driver(trip), info.driver);
+    const ArenaRoute& route = arena.route(trip.route);
+    ASSERT_EQ(route.num_stops, br->stops().size());
+    size_t k = 0;
+    for (const BusStop* bs : br->stops()) {
+      const ArenaStop& stop = arena.stop(arena.route_stop(route, k++));
+      EXPECT_EQ(stop.latitude, bs->latitude());
+      EXPECT_EQ(stop.longitude, bs->longitude());
+      if (const auto* corner = dynamic_cast<const BusStopCorner*>(bs)) {
+        ASSERT_TRUE(std::holds_alternative<CornerStop>(stop.place));
+        EXPECT_EQ(arena.Description(stop), corner->Description());
+      } else {
+        ASSERT_TRUE(std::holds_alternative<DestinationStop>(stop.place));
+        EXPECT_EQ(arena.string(std::get<DestinationStop>(stop.place).name),
+                  dynamic_cast<const BusStopDestination*>(bs)->name());
+      }
+    }
+  }
+}
+
+TEST(StringPoolTest, InternsAndKeepsViewsStable) {
+  StringPool pool;
+  const StringId a = pool.Intern("alice");
+  const std::string_view view = pool.Get(a);
+  // Enough strings to fill several blocks, plus one larger than a block.
+  for (int i = 0; i < 20000; ++i) {
+    pool.Intern(absl::StrCat("driver", i));
+  }
+  pool.Intern(std::string(200 << 10, 'x'));
+  EXPECT_EQ(pool.Intern("alice"), a);
+  EXPECT_EQ(pool.Get(a).data(), view.data());
+  EXPECT_EQ(pool.Get(pool.Intern("driver123")), "driver123");
+  EXPECT_EQ(pool.Get(pool.Intern("")), "");
+  EXPECT_EQ(pool.size(), 20003);
+
+  StringPool moved = std::move(pool);
+  EXPECT_EQ(moved.Get(a).data(), view.data());
+  EXPECT_EQ(moved.Intern("alice"), a);
+}
+
+TEST(StringPoolTest, MovedFromPoolStartsOver) {
+  StringPool pool;
+  const StringId a = pool.Intern("alice");
+  StringPool moved;
+  moved = std::move(pool);
+  EXPECT_EQ(pool.size(), 0);
+  EXPECT_FALSE(pool.Find("alice").has_value());
+
+  // Interning into the moved-from pool must not write into the block now
+  // owned by `moved`.
+  EXPECT_EQ(pool.Get(pool.Intern("bobby")), "bobby");
+  EXPECT_EQ(moved.Get(a), "alice");
+  EXPECT_FALSE(moved.Find("bobby").has_value());
+
+  StringPool constructed(std::move(moved));
+  EXPECT_EQ(constructed.Get(a), "alice");
+  EXPECT_EQ(moved.size(), 0);
+  EXPECT_EQ(moved.Get(moved.Intern("carol")), "carol");
+  EXPECT_EQ(constructed.Get(a), "alice");
+}
+
+TEST(ArenaScheduleTest, FromScheduleSharesStopsAndRoutes) {
+  BusStopCorner bs0(GpsPosition(34, 135, 52.560f),
+                    GpsPosition(134, 22, 78.30f), "24th Street",
+                    "10th Avenue");
+  BusStopDestination bs1(GpsPosition(35, 136, 15.456f),
+                         GpsPosition(133, 32, 15.300f), "White House");
+  BusRoute route0;
+  route0.Append(&bs0);
+  route0.Append(&bs1);
+  BusRoute route1;
+  route1.Append(&bs1);
+
+  BusSchedule schedule;
+  schedule.Append("bob", 6, 24, &route0);
+  schedule.Append("alice", 11, 2, &route1);
+  schedule.Append("bob", 9, 57, &route0);
+
+  auto arena = ArenaSchedule::FromSchedule(schedule);
+  ASSERT_TRUE(arena.ok()) << arena.status();
+  ASSERT_TRUE(arena->Verify().ok());
+  EXPECT_EQ(arena->num_stops(), 2);
+  EXPECT_EQ(arena->num_routes(), 2);
+  EXPECT_EQ(arena->trip(0).route, arena->trip(2).route);
+  EXPECT_EQ(arena->trip(0).driver, arena->trip(2).driver);
+  ExpectSameSchedule(*arena, schedule);
+}
+
+TEST(ArenaScheduleTest, BuildsDirectly) {
+  ArenaSchedule arena;
+  const StopId a = arena.AddCorner(GpsPosition(1, 2, 3.0f),
+                                   GpsPosition(4, 5, 6.0f), "Main", "First");
+  const StopId b =
+      arena.AddDestination(GpsPosition(7, 8, 9.0f), GpsPosition(1, 1, 1.0f),
+                           "Depot");
+  const RouteId r = arena.AddRoute({a, b, a});
+  arena.Append("carol", 23, 59, r);
+  ASSERT_TRUE(arena.Verify().ok());
+  ASSERT_EQ(arena.route(r).num_stops, 3);
+  EXPECT_EQ(arena.route_stop(arena.route(r), 2), a);
+  EXPECT_EQ(arena.Description(arena.stop(a)), "Main and First");
+  EXPECT_EQ(arena.Description(arena.stop(b)), "Depot");
+
+  // Back to the pointer representation, with a shared stop shared again.
+  const OwnedBusSchedule owned = arena.ToSchedule();
+  ASSERT_EQ(owned.schedule.trips().size(), 1);
+  const BusRoute* route = owned.schedule.trips().front().second;
+  ASSERT_EQ(route->stops().size(), 3);
+  EXPECT_EQ(route->stops().front(), route->stops().back());
+  ExpectSameSchedule(arena, owned.schedule);
+}
+
+// The existing Boost archive keeps working for arena schedules: arena ->
+// BusSchedule -> SaveSchedule -> RestoreSchedule -> arena.
+TEST(ArenaScheduleTest, BusScheduleArchiveRoundTrip) {
+  const SyntheticSchedule s = MakeSyntheticSchedule(2000);
+  auto arena = ArenaSchedule::FromSchedule(s.schedule);
+  ASSERT_TRUE(arena.ok());
+
+  const OwnedBusSchedule owned = arena->ToSchedule();
+  const std::string path = TempPath("arena_bus_schedule.txt");
+  ASSERT_TRUE(SaveSchedule(owned.schedule, path).ok());
+  auto restored = RestoreSchedule(path);
+  ASSERT_TRUE(restored.ok()) << restored.status();
+  auto again = ArenaSchedule::FromSchedule(*restored);
+  ASSERT_TRUE(again.ok());
+  EXPECT_EQ(again->num_stops(), arena->num_stops());
+  EXPECT_EQ(again->num_routes(), arena->num_routes());
+  ExpectSameSchedule(*again, s.schedule);
+}
+
+TEST(ArenaScheduleTest, ArenaArchiveRoundTrip) {
+  const SyntheticSchedule s = MakeSyntheticSchedule(5000);
+  auto arena = ArenaSchedule::FromSchedule(s.schedule);
+  ASSERT_TRUE(arena.ok());
+  const std::string path = TempPath("arena_schedule.txt");
+  ASSERT_TRUE(SaveArenaSchedule(*arena, path).ok());
+
+  auto restored = RestoreArenaSchedule(path);
+  ASSERT_TRUE(restored.ok()) << restored.status();
+  EXPECT_EQ(restored->num_stops(), arena->num_stops());
+  EXPECT_EQ(restored->num_routes(), arena->num_routes());
+  ExpectSameSchedule(*restored, s.schedule);
+}
+
+TEST(ArenaScheduleTest, RejectsBadArchives) {
+  EXPECT_EQ(RestoreArenaSchedule(TempPath("arena_missing.txt")).status().code(),
+            absl::StatusCode::kNotFound);
+
+  const SyntheticSchedule s = MakeSyntheticSchedule(100);
+  auto arena = ArenaSchedule::FromSchedule(s.schedule);
+  ASSERT_TRUE(arena.ok());
+  const std::string path = TempPath("arena_truncated.txt");
+  ASSERT_TRUE(SaveArenaSchedule(*arena, path).ok());
+  std::string text;
+  {
+    std::ifstream ifs(path);
+    text.assign(std::istreambuf_iterator<char>(ifs),
+                std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream ofs(path, std::ios::trunc);
+    ofs << text.substr(0, text.size() / 2);
+  }
+  EXPECT_EQ(RestoreArenaSchedule(path).status().code(),
+            absl::StatusCode::kDataLoss);
+
+  // A trip whose route does not exist.
+  ArenaSchedule bad;
+  bad.Append("dave", 1, 2, 7);
+  EXPECT_FALSE(bad.Verify().ok());
+  ASSERT_TRUE(SaveArenaSchedule(bad, path).ok());
+  EXPECT_EQ(RestoreArenaSchedule(path).status().code(),
+            absl::StatusCode::kDataLoss);
+}
+
+}  // namespace
@@ -0,0 +1,354 @@
+#include "examples/boost/serialization/bus_schedule_flat.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+
+namespace {
+
+constexpr uint64_t kSectionAlignment = 8;
+
+uint64_t AlignUp(uint64_t n) {
+  return (n + kSectionAlignment - 1) & ~(kSectionAlignment - 1);
+}
+
+FlatGps ToFlat(const GpsPosition& g) {
+  return FlatGps{g.degrees(), g.minutes(), g.seconds()};
+}
+
+class FlatScheduleBuilder {
+ public:
+  absl::Status Add(const BusSchedule& s) {
+    trips_.reserve(s.trips().size());
+    for (const auto& [info, route] : s.trips()) {
+      auto route_index = InternRoute(route);
+      if (!route_index.ok()) {
+        return route_index.status();
+      }
+      FlatTrip trip{};
+      trip.hour = info.hour;
+      trip.minute = info.minute;
+      trip.driver = InternString(info.driver);
+      trip.route = *route_index;
+      trips_.push_back(trip);
+    }
+    if (strings_.size() > std::numeric_limits<uint32_t>::max()) {
+      return absl::OutOfRangeError("String table exceeds 4 GiB.");
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Write(std::string_view filename) const {
+    FlatScheduleHeader header{};
+    std::memcpy(header.magic, kFlatScheduleMagic, sizeof(header.magic));
+    header.version = kFlatScheduleVersion;
+    header.endian_tag = kFlatScheduleEndianTag;
+    header.num_stops = stops_.size();
+    header.num_routes = routes_.size();
+    header.num_route_stops = route_stops_.size();
+    header.num_trips = trips_.size();
+    header.string_bytes = strings_.size();
+
+    uint64_t offset = AlignUp(sizeof(header));
+    header.stops_offset = offset;
+    offset = AlignUp(offset + Bytes(stops_));
+    header.routes_offset = offset;
+    offset = AlignUp(offset + Bytes(routes_));
+    header.route_stops_offset = offset;
+    offset = AlignUp(offset + Bytes(route_stops_));
+    header.trips_offset = offset;
+    offset = AlignUp(offset + Bytes(trips_));
+    header.strings_offset = offset;
+    header.file_size = offset + strings_.size();
+
+    std::ofstream ofs(filename.data(), std::ios::binary | std::ios::trunc);
+    if (!ofs) {
+      return absl::UnavailableError(
+          absl::StrCat("Failed to open ", filename, " for write."));
+    }
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    WriteSection(ofs, header.stops_offset, stops_);
+    WriteSection(ofs, header.routes_offset, routes_);
+    WriteSection(ofs, header.route_stops_offset, route_stops_);
+    WriteSection(ofs, header.trips_offset, trips_);
+    WriteSection(ofs, header.strings_offset, strings_);
+    ofs.close();
+    if (!ofs) {
+      return absl::DataLossError(absl::StrCat("Failed to write ", filename));
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  template <typename T>
+  static uint64_t Bytes(const std::vector<T>& v) {
+    return v.size() * sizeof(T);
+  }
+
+  template <typename T>
+  static void WriteSection(std::ofstream& ofs, uint64_t offset,
+                           const std::vector<T>& v) {
+    static const char kZeros[kSectionAlignment] = {};
+    const auto pos = static_cast<uint64_t>(ofs.tellp());
+    ofs.write(kZeros, offset - pos);
+    ofs.write(reinterpret_cast<const char*>(v.data()), Bytes(v));
+  }
+
+  FlatString InternString(const std::string& s) {
+    auto it = string_index_.find(s);
+    if (it != string_index_.end()) {
+      return it->second;
+    }
+    FlatString fs{static_cast<uint32_t>(strings_.size()),
+                  static_cast<uint32_t>(s.size())};
+    strings_.insert(strings_.end(), s.begin(), s.end());
+    string_index_.emplace(s, fs);
+    return fs;
+  }
+
+  absl::StatusOr<uint32_t> InternStop(const BusStop* bs) {
+    auto it = stop_index_.find(bs);
+    if (it != stop_index_.end()) {
+      return it->second;
+    }
+    FlatStop stop{};
+    stop.latitude = ToFlat(bs->latitude());
+    stop.longitude = ToFlat(bs->longitude());
+    if (const auto* corner = dynamic_cast<const BusStopCorner*>(bs)) {
+      stop.kind = FlatStopKind::kCorner;
+      stop.text[0] = InternString(corner->street1());
+      stop.text[1] = InternString(corner->street2());
+    } else if (const auto* dest = dynamic_cast<const BusStopDestination*>(bs)) {
+      stop.kind = FlatStopKind::kDestination;
+      stop.text[0] = InternString(dest->name());
+    } else {
+      return absl::InvalidArgumentError("Unknown BusStop subclass.");
+    }
+    const auto index = static_cast<uint32_t>(stops_.size());
+    stops_.push_back(stop);
+    stop_index_.emplace(bs, index);
+    return index;
+  }
+
+  absl::StatusOr<uint32_t> InternRoute(const BusRoute* br) {
+    auto it = route_index_.find(br);
+    if (it != route_index_.end()) {
+      return it->second;
+    }
+    FlatRoute route{};
+    route.first_stop = route_stops_.size();
+    route.num_stops = static_cast<uint32_t>(br->stops().size());
+    for (const BusStop* bs : br->stops()) {
+      auto stop_index = InternStop(bs);
+      if (!stop_index.ok()) {
+        return stop_index.status();
+      }
+      route_stops_.push_back(*stop_index);
+    }
+    const auto index = static_cast<uint32_t>(routes_.size());
+    routes_.push_back(route);
+    route_index_.emplace(br, index);
+    return index;
+  }
+
+  std::vector<FlatStop> stops_;
+  std::vector<FlatRoute> routes_;
+  std::vector<uint32_t> route_stops_;
+  std::vector<FlatTrip> trips_;
+  std::vector<char> strings_;
+
+  std::unordered_map<const BusStop*, uint32_t> stop_index_;
+  std::unordered_map<const BusRoute*, uint32_t> route_index_;
+  std::unordered_map<std::string, FlatString> string_index_;
+};
+
+bool SectionFits(uint64_t offset, uint64_t count, uint64_t elem_size,
+                 uint64_t file_size) {
+  if (offset % kSectionAlignment != 0 || offset > file_size) {
+    return false;
+  }
+  return count <= (file_size - offset) / elem_size;
+}
+
+}  // namespace
+
+std::string_view FlatStopView::street1() const {
+  return schedule_->String(stop_->text[0]);
+}
+
+std::string_view FlatStopView::street2() const {
+  return schedule_->String(stop_->text[1]);
+}
+
+std::string_view FlatStopView::name() const {
+  return schedule_->String(stop_->text[0]);
+}
+
+std::string FlatStopView::Description() const {
+  if (kind() == FlatStopKind::kCorner) {
+    return absl::StrCat(street1(), " and ", street2());
+  }
+  return std::string(name());
+}
+
+uint32_t FlatRouteView::stop_index(size_t i) const {
+  return schedule_->route_stops_[route_->first_stop + i];
+}
+
+FlatStopView FlatRouteView::stop(size_t i) const {
+  return schedule_->stop(stop_index(i));
+}
+
+std::string_view FlatTripView::driver() const {
+  return schedule_->String(trip_->driver);
+}
+
+FlatRouteView FlatTripView::route() const {
+  return schedule_->route(trip_->route);
+}
+
+absl::StatusOr<FlatSchedule> FlatSchedule::Open(std::string_view filename) {
+  const std::string path(filename);
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return absl::NotFoundError(
+        absl::StrCat("Failed to open ", path, ": ", std::strerror(errno)));
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    const int err = errno;
+    ::close(fd);
+    return absl::InternalError(
+        absl::StrCat("Failed to stat ", path, ": ", std::strerror(err)));
+  }
+  const auto size = static_cast<size_t>(st.st_size);
+  if (size < sizeof(FlatScheduleHeader)) {
+    ::close(fd);
+    return absl::DataLossError(absl::StrCat(path, " is truncated."));
+  }
+  void* base = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  const int err = errno;
+  ::close(fd);
+  if (base == MAP_FAILED) {
+    return absl::InternalError(
+        absl::StrCat("Failed to mmap ", path, ": ", std::strerror(err)));
+  }
+
+  FlatSchedule s;
+  s.base_ = base;
+  s.size_ = size;
+  const auto* bytes = static_cast<const char*>(base);
+  const auto* h = reinterpret_cast<const FlatScheduleHeader*>(bytes);
+  if (std::memcmp(h->magic, kFlatScheduleMagic, sizeof(h->magic)) != 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat(path, " is not a flat schedule file."));
+  }
+  if (h->endian_tag != kFlatScheduleEndianTag) {
+    return absl::FailedPreconditionError(
+        absl::StrCat(path, " was written with a different byte order."));
+  }
+  if (h->version != kFlatScheduleVersion) {
+    return absl::FailedPreconditionError(
+        absl::StrCat(path, " has unsupported version ", h->version));
+  }
+  if (h->file_size != size ||
+      !SectionFits(h->stops_offset, h->num_stops, sizeof(FlatStop), size) ||
+      !SectionFits(h->routes_offset, h->num_routes, sizeof(FlatRoute), size) ||
+      !SectionFits(h->route_stops_offset, h->num_route_stops,
+                   sizeof(uint32_t), size) ||
+      !SectionFits(h->trips_offset, h->num_trips, sizeof(FlatTrip), size) ||
+      !SectionFits(h->strings_offset, h->string_bytes, 1, size)) {
+    return absl::DataLossError(absl::StrCat(path, " is corrupted."));
+  }
+
+  s.header_ = h;
+  s.stops_ = reinterpret_cast<const FlatStop*>(bytes + h->stops_offset);
+  s.routes_ = reinterpret_cast<const FlatRoute*>(bytes + h->routes_offset);
+  s.route_stops_ =
+      reinterpret_cast<const uint32_t*>(bytes + h->route_stops_offset);
+  s.trips_ = reinterpret_cast<const FlatTrip*>(bytes + h->trips_offset);
+  s.strings_ = bytes + h->strings_offset;
+  return s;
+}
+
+FlatSchedule::FlatSchedule(FlatSchedule&& other) noexcept {
+  *this = std::move(other);
+}
+
+FlatSchedule& FlatSchedule::operator=(FlatSchedule&& other) noexcept {
+  if (this != &other) {
+    Unmap();
+    base_ = std::exchange(other.base_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    header_ = std::exchange(other.header_, nullptr);
+    stops_ = std::exchange(other.stops_, nullptr);
+    routes_ = std::exchange(other.routes_, nullptr);
+    route_stops_ = std::exchange(other.route_stops_, nullptr);
+    trips_ = std::exchange(other.trips_, nullptr);
+    strings_ = std::exchange(other.strings_, nullptr);
+  }
+  return *this;
+}
+
+FlatSchedule::~FlatSchedule() { Unmap(); }
+
+void FlatSchedule::Unmap() {
+  if (base_ != nullptr) {
+    ::munmap(base_, size_);
+    base_ = nullptr;
+  }
+}
+
+absl::Status FlatSchedule::Verify() const {
+  const uint64_t string_bytes = header_->string_bytes;
+  auto string_ok = [string_bytes](const FlatString& fs) {
+    return fs.offset <= string_bytes && fs.size <= string_bytes - fs.offset;
+  };
+  for (size_t i = 0; i < num_stops(); ++i) {
+    const FlatStop& stop = stops_[i];
+    if ((stop.kind != FlatStopKind::kCorner &&
+         stop.kind != FlatStopKind::kDestination) ||
+        !string_ok(stop.text[0]) || !string_ok(stop.text[1])) {
+      return absl::DataLossError(absl::StrCat("Corrupted stop ", i));
+    }
+  }
+  for (size_t i = 0; i < num_routes(); ++i) {
+    const FlatRoute& route = routes_[i];
+    if (route.first_stop > header_->num_route_stops ||
+        route.num_stops > header_->num_route_stops - route.first_stop) {
+      return absl::DataLossError(absl::StrCat("Corrupted route ", i));
+    }
+  }
+  for (size_t i = 0; i < header_->num_route_stops; ++i) {
+    if (route_stops_[i] >= num_stops()) {
+      return absl::DataLossError(absl::StrCat("Corrupted route stop ", i));
+    }
+  }
+  for (size_t i = 0; i < num_trips(); ++i) {
+    const FlatTrip& trip = trips_[i];
+    if (trip.route >= num_routes() || !string_ok(trip.driver)) {
+      return absl::DataLossError(absl::StrCat("Corrupted trip ", i));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SaveFlatSchedule(const BusSchedule& s,
+                              std::string_view filename) {
+  FlatScheduleBuilder builder;
+  if (auto status = builder.Add(s); !status.ok()) {
+    return status;
+  }
+  return builder.Write(filename);
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "absl/status/statusor.h"
+#include "examples/boost/serialization/bus_schedule.h"
+
+// Flat, versioned on-disk layout of a BusSchedule which is meant to be
+// memory-mapped and queried in place. All sections are arrays of
+// trivially-copyable records addressed by index, so opening a file is
+// O(1) and nothing is allocated per stop, route or trip.
+//
+//   FlatScheduleHeader
+//   FlatStop[num_stops]
+//   FlatRoute[num_routes]
+//   uint32_t route_stops[num_route_stops]   (indices into FlatStop)
+//   FlatTrip[num_trips]
+//   char strings[string_bytes]              (interned, not NUL-terminated)
+//
+// Records are stored in host byte order; files are rejected on hosts with a
+// different endianness.
+
+inline constexpr char kFlatScheduleMagic[8] = {'B', 'U', 'S', 'S',
+                                               'C', 'H', 'E', 'D'};
+inline constexpr uint32_t kFlatScheduleVersion = 1;
+inline constexpr uint32_t kFlatScheduleEndianTag = 0x01020304;
+
+struct FlatScheduleHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t endian_tag;
+  uint64_t file_size;
+
+  uint64_t num_stops;
+  uint64_t num_routes;
+  uint64_t num_route_stops;
+  uint64_t num_trips;
+  uint64_t string_bytes;
+
+  uint64_t stops_offset;
+  uint64_t routes_offset;
+  uint64_t route_stops_offset;
+  uint64_t trips_offset;
+  uint64_t strings_offset;
+};
+
+struct FlatString {
+  uint32_t offset;
+  uint32_t size;
+};
+
+struct FlatGps {
+  int32_t degrees;
+  int32_t minutes;
+  float seconds;
+};
+
+enum class FlatStopKind : uint32_t {
+  kCorner = 0,
+  kDestination = 1,
+};
+
+struct FlatStop {
+  FlatGps latitude;
+  FlatGps longitude;
+  FlatStopKind kind;
+  // kCorner: street1, street2. kDestination: name, empty.
+  FlatString text[2];
+};
+
+struct FlatRoute {
+  uint64_t first_stop;  // index into route_stops
+  uint32_t num_stops;
+  uint32_t reserved;
+};
+
+struct FlatTrip {
+  int32_t hour;
+  int32_t minute;
+  FlatString driver;
+  uint32_t route;
+  uint32_t reserved;
+};
+
+static_assert(std::is_trivially_copyable_v<FlatScheduleHeader>);
+static_assert(sizeof(FlatScheduleHeader) == 104);
+static_assert(sizeof(FlatStop) == 44);
+static_assert(sizeof(FlatRoute) == 16);
+static_assert(sizeof(FlatTrip) == 24);
+
+class FlatSchedule;
+
+class FlatStopView {
+ public:
+  FlatStopKind kind() const { return stop_->kind; }
+  GpsPosition latitude() const { return ToGps(stop_->latitude); }
+  GpsPosition longitude() const { return ToGps(stop_->longitude); }
+  // Valid for kCorner only.
+  std::string_view street1() const;
+  std::string_view street2() const;
+  // Valid for kDestination only.
+  std::string_view name() const;
+  // Same text as BusStop::Description().
+  std::string Description() const;
+
+ private:
+  friend class FlatSchedule;
+  FlatStopView(const FlatSchedule* s, const FlatStop* stop)
+      : schedule_(s), stop_(stop) {}
+  static GpsPosition ToGps(const FlatGps& g) {
+    return GpsPosition(g.degrees, g.minutes, g.seconds);
+  }
+
+  const FlatSchedule* schedule_;
+  const FlatStop* stop_;
+};
+
+class FlatRouteView {
+ public:
+  size_t size() const { return route_->num_stops; }
+  uint32_t stop_index(size_t i) const;
+  FlatStopView stop(size_t i) const;
+
+ private:
+  friend class FlatSchedule;
+  FlatRouteView(const FlatSchedule* s, const FlatRoute* route)
+      : schedule_(s), route_(route) {}
+
+  const FlatSchedule* schedule_;
+  const FlatRoute* route_;
+};
+
+class FlatTripView {
+ public:
+  int hour() const { return trip_->hour; }
+  int minute() const { return trip_->minute; }
+  std::string_view driver() const;
+  uint32_t route_index() const { return trip_->route; }
+  FlatRouteView route() const;
+
+ private:
+  friend class FlatSchedule;
+  FlatTripView(const FlatSchedule* s, const FlatTrip* trip)
+      : schedule_(s), trip_(trip) {}
+
+  const FlatSchedule* schedule_;
+  const FlatTrip* trip_;
+};
+
+// Read-only view over a memory-mapped flat schedule file. Views handed out
+// by this class point into the mapping and must not outlive it.
+class FlatSchedule {
+ public:
+  // Maps `filename` and validates the header and section bounds. Record
+  // contents are trusted; call Verify() to check every cross reference.
+  static absl::StatusOr<FlatSchedule> Open(std::string_view filename);
+
+  FlatSchedule(FlatSchedule&& other) noexcept;
+  FlatSchedule& operator=(FlatSchedule&& other) noexcept;
+  FlatSchedule(const FlatSchedule&) = delete;
+  FlatSchedule& operator=(const FlatSchedule&) = delete;
+  ~FlatSchedule();
+
+  // O(n) check of all stop, route and string references.
+  absl::Status Verify() const;
+
+  size_t num_stops() const { return header_->num_stops; }
+  size_t num_routes() const { return header_->num_routes; }
+  size_t num_trips() const { return header_->num_trips; }
+
+  FlatStopView stop(size_t i) const { return FlatStopView(this, &stops_[i]); }
+  FlatRouteView route(size_t i) const {
+    return FlatRouteView(this, &routes_[i]);
+  }
+  FlatTripView trip(size_t i) const { return FlatTripView(this, &trips_[i]); }
+
+ private:
+  friend class FlatStopView;
+  friend class FlatRouteView;
+  friend class FlatTripView;
+
+  FlatSchedule() = default;
+  void Unmap();
+
+  std::string_view String(const FlatString& s) const {
+    return std::string_view(strings_ + s.offset, s.size);
+  }
+
+  void* base_ = nullptr;
+  size_t size_ = 0;
+  const FlatScheduleHeader* header_ = nullptr;
+  const FlatStop* stops_ = nullptr;
+  const FlatRoute* routes_ = nullptr;
+  const uint32_t* route_stops_ = nullptr;
+  const FlatTrip* trips_ = nullptr;
+  const char* strings_ = nullptr;
+};
+
+// Writes `s` in the flat layout. Stops and routes shared between trips are
+// stored once, and all strings are interned.
+absl::Status SaveFlatSchedule(const BusSchedule& s, std::string_view filename);
@@ -0,0 +1,99 @@
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "benchmark/benchmark.h"
+#include "examples/boost/serialization/bus_schedule.h"
+#include "examples/boost/serialization/bus_schedule_flat.h"
+#include "examples/boost/serialization/synthetic_schedule.h"
+
+// How to run:
+// bazel run -c opt //examples/boost/serialization:bus_schedule_flat_benchmark
+namespace {
+
+struct ArchiveFiles {
+  std::string text;
+  std::string flat;
+};
+
+// SyntheticScheduleFor(num_trips) saved in both formats, once per size.
+const ArchiveFiles& FilesFor(size_t num_trips) {
+  static auto* cache = new std::map<size_t, ArchiveFiles>();
+  auto it = cache->find(num_trips);
+  if (it != cache->end()) {
+    return it->second;
+  }
+  const auto dir = std::filesystem::temp_directory_path();
+  const std::string tag = std::to_string(num_trips);
+  ArchiveFiles files{(dir / ("bus_schedule_" + tag + ".txt")).string(),
+                     (dir / ("bus_schedule_" + tag + ".flat")).string()};
+  const SyntheticSchedule& s = SyntheticScheduleFor(num_trips);
+  if (!SaveSchedule(s.schedule, files.text).ok() ||
+      !SaveFlatSchedule(s.schedule, files.flat).ok()) {
+    std::abort();
+  }
+  return cache->emplace(num_trips, std::move(files)).first->second;
+}
+
+void SetFileCounters(benchmark::State& state, const std::string& path) {
+  const auto bytes = std::filesystem::file_size(path);
+  state.counters["file_MB"] = static_cast<double>(bytes) / (1 << 20);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_TextArchiveRestore(benchmark::State& state) {
+  const ArchiveFiles& files = FilesFor(state.range(0));
+  for (auto _ : state) {
+    auto s = RestoreSchedule(files.text);
+    benchmark::DoNotOptimize(s);
+  }
+  SetFileCounters(state, files.text);
+}
+
+void BM_FlatOpen(benchmark::State& state) {
+  const ArchiveFiles& files = FilesFor(state.range(0));
+  for (auto _ : state) {
+    auto s = FlatSchedule::Open(files.flat);
+    benchmark::DoNotOptimize(s);
+  }
+  SetFileCounters(state, files.flat);
+}
+
+// Open plus a full scan touching every trip, its driver and first stop, to
+// account for page faults which a bare Open() never pays.
+void BM_FlatOpenAndScan(benchmark::State& state) {
+  const ArchiveFiles& files = FilesFor(state.range(0));
+  for (auto _ : state) {
+    auto s = FlatSchedule::Open(files.flat);
+    int64_t sum = 0;
+    for (size_t i = 0; i < s->num_trips(); ++i) {
+      const FlatTripView trip = s->trip(i);
+      sum += trip.hour() * 60 + trip.minute() + trip.driver().size();
+      sum += trip.route().stop(0).latitude().degrees();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  SetFileCounters(state, files.flat);
+}
+
+BENCHMARK(BM_TextArchiveRestore)
+    ->Arg(1 << 20)
+    ->Arg(4 << 20)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_FlatOpen)
+    ->Arg(1 << 20)
+    ->Arg(4 << 20)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+BENCHMARK(BM_FlatOpenAndScan)
+    ->Arg(1 << 20)
+    ->Arg(4 << 20)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
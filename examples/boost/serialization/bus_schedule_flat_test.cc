@@ -0,0 +1,112 @@
+#include "examples/boost/serialization/bus_schedule_flat.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "examples/boost/serialization/synthetic_schedule.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+std::string TempPath(const std::string& name) {
+  return ::testing::TempDir() + name;
+}
+
+TEST(FlatScheduleTest, RoundTrip) {
+  BusStopCorner bs0(GpsPosition(34, 135, 52.560f),
+                    GpsPosition(134, 22, 78.30f), "24th Street",
+                    "10th Avenue");
+  BusStopDestination bs1(GpsPosition(35, 136, 15.456f),
+                         GpsPosition(133, 32, 15.300f), "White House");
+  BusRoute route0;
+  route0.Append(&bs0);
+  route0.Append(&bs1);
+  BusRoute route1;
+  route1.Append(&bs1);
+
+  BusSchedule schedule;
+  schedule.Append("bob", 6, 24, &route0);
+  schedule.Append("alice", 11, 2, &route1);
+  schedule.Append("bob", 9, 57, &route0);
+
+  const std::string path = TempPath("flat_round_trip.bin");
+  ASSERT_TRUE(SaveFlatSchedule(schedule, path).ok());
+
+  auto flat = FlatSchedule::Open(path);
+  ASSERT_TRUE(flat.ok()) << flat.status();
+  ASSERT_TRUE(flat->Verify().ok());
+  EXPECT_EQ(flat->num_trips(), 3);
+  EXPECT_EQ(flat->num_routes(), 2);
+  // bs1 is shared by both routes and must be stored once.
+  EXPECT_EQ(flat->num_stops(), 2);
+
+  const FlatTripView t0 = flat->trip(0);
+  EXPECT_EQ(t0.hour(), 6);
+  EXPECT_EQ(t0.minute(), 24);
+  EXPECT_EQ(t0.driver(), "bob");
+  ASSERT_EQ(t0.route().size(), 2);
+  EXPECT_EQ(t0.route().stop(0).kind(), FlatStopKind::kCorner);
+  EXPECT_EQ(t0.route().stop(0).Description(), bs0.Description());
+  EXPECT_EQ(t0.route().stop(0).latitude(), bs0.latitude());
+  EXPECT_EQ(t0.route().stop(1).name(), "White House");
+
+  const FlatTripView t1 = flat->trip(1);
+  EXPECT_EQ(t1.driver(), "alice");
+  ASSERT_EQ(t1.route().size(), 1);
+  EXPECT_EQ(t1.route().stop_index(0), t0.route().stop_index(1));
+  EXPECT_EQ(flat->trip(2).route_index(), t0.route_index());
+}
+
+TEST(FlatScheduleTest, MatchesSyntheticSchedule) {
+  const SyntheticSchedule s = MakeSyntheticSchedule(10000);
+  const std::string path = TempPath("flat_synthetic.bin");
+  ASSERT_TRUE(SaveFlatSchedule(s.schedule, path).ok());
+
+  auto flat = FlatSchedule::Open(path);
+  ASSERT_TRUE(flat.ok()) << flat.status();
+  ASSERT_TRUE(flat->Verify().ok());
+  ASSERT_EQ(flat->num_trips(), s.schedule.trips().size());
+
+  size_t i = 0;
+  for (const auto& [info, route] : s.schedule.trips()) {
+    const FlatTripView trip = flat->trip(i++);
+    EXPECT_EQ(trip.hour(), info.hour);
+    EXPECT_EQ(trip.minute(), info.minute);
+    EXPECT_EQ(trip.driver(), info.driver);
+    ASSERT_EQ(trip.route().size(), route->stops().size());
+    size_t k = 0;
+    for (const BusStop* bs : route->stops()) {
+      EXPECT_EQ(trip.route().stop(k++).longitude(), bs->longitude());
+    }
+  }
+}
+
+TEST(FlatScheduleTest, RejectsBadFiles) {
+  EXPECT_FALSE(FlatSchedule::Open(TempPath("does_not_exist.bin")).ok());
+
+  const std::string garbage = TempPath("flat_garbage.bin");
+  {
+    std::ofstream ofs(garbage, std::ios::binary);
+    ofs << std::string(sizeof(FlatScheduleHeader), 'x');
+  }
+  EXPECT_FALSE(FlatSchedule::Open(garbage).ok());
+
+  const SyntheticSchedule s = MakeSyntheticSchedule(100);
+  const std::string path = TempPath("flat_truncated.bin");
+  ASSERT_TRUE(SaveFlatSchedule(s.schedule, path).ok());
+  std::string bytes;
+  {
+    std::ifstream ifs(path, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(ifs),
+                 std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    ofs.write(bytes.data(), bytes.size() - 1);
+  }
+  EXPECT_FALSE(FlatSchedule::Open(path).ok());
+}
+
+}  // namespace
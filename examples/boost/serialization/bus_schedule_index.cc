@@ -0,0 +1,153 @@
+#include "examples/boost/serialization/bus_schedule_index.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace {
+
+// The unsorted tail of departures is merged once it holds more than this
+// many entries and more than 1/kTailFraction of the sorted array, which
+// bounds the linear scan a query does over it.
+constexpr size_t kMinTail = 4096;
+constexpr size_t kTailFraction = 16;
+
+}  // namespace
+
+TripIndex::TripIndex(const ArenaSchedule* schedule) : schedule_(schedule) {
+  Update();
+}
+
+void TripIndex::Update() {
+  stop_routes_.resize(schedule_->num_stops());
+  route_trips_.resize(schedule_->num_routes());
+  std::vector<StopId> stops;
+  for (; num_routes_ < schedule_->num_routes(); ++num_routes_) {
+    const ArenaRoute& route = schedule_->route(num_routes_);
+    stops.clear();
+    for (uint32_t i = 0; i < route.num_stops; ++i) {
+      stops.push_back(schedule_->route_stop(route, i));
+    }
+    // A route may pass a stop more than once.
+    std::sort(stops.begin(), stops.end());
+    stops.erase(std::unique(stops.begin(), stops.end()), stops.end());
+    for (const StopId stop : stops) {
+      stop_routes_[stop].push_back(static_cast<RouteId>(num_routes_));
+    }
+  }
+
+  const size_t num_trips = schedule_->num_trips();
+  tail_.reserve(tail_.size() + (num_trips - num_trips_));
+  for (; num_trips_ < num_trips; ++num_trips_) {
+    const ArenaTrip& trip = schedule_->trip(num_trips_);
+    const auto id = static_cast<uint32_t>(num_trips_);
+    minutes_.push_back(MinuteOfDay(trip));
+    tail_.push_back(Departure{minutes_.back(), id});
+    if (trip.driver >= driver_trips_.size()) {
+      driver_trips_.resize(trip.driver + 1);
+    }
+    driver_trips_[trip.driver].push_back(id);
+    route_trips_[trip.route].push_back(id);
+  }
+  if (tail_.size() > std::max(kMinTail, departures_.size() / kTailFraction)) {
+    MergeTail();
+  }
+}
+
+void TripIndex::MergeTail() {
+  std::sort(tail_.begin(), tail_.end());
+  const auto middle = static_cast<std::ptrdiff_t>(departures_.size());
+  departures_.insert(departures_.end(), tail_.begin(), tail_.end());
+  std::inplace_merge(departures_.begin(), departures_.begin() + middle,
+                     departures_.end());
+  tail_.clear();
+}
+
+void TripIndex::AppendDepartures(int from_minute, int to_minute,
+                                 std::vector<uint32_t>* trips) const {
+  if (from_minute >= to_minute) {
+    return;
+  }
+  const auto lo =
+      std::lower_bound(departures_.begin(), departures_.end(),
+                       Departure{from_minute, 0});
+  const auto hi = std::lower_bound(lo, departures_.end(),
+                                   Departure{to_minute, 0});
+  std::vector<Departure> recent;
+  for (const Departure& d : tail_) {
+    if (d.minute_of_day >= from_minute && d.minute_of_day < to_minute) {
+      recent.push_back(d);
+    }
+  }
+  if (recent.empty()) {
+    for (auto it = lo; it != hi; ++it) {
+      trips->push_back(it->trip);
+    }
+    return;
+  }
+  std::sort(recent.begin(), recent.end());
+  auto it = lo;
+  auto jt = recent.begin();
+  while (it != hi || jt != recent.end()) {
+    if (jt == recent.end() || (it != hi && *it < *jt)) {
+      trips->push_back((it++)->trip);
+    } else {
+      trips->push_back((jt++)->trip);
+    }
+  }
+}
+
+void TripIndex::DepartingBetween(int from_minute, int to_minute,
+                                 std::vector<uint32_t>* trips) const {
+  trips->clear();
+  if (from_minute <= to_minute) {
+    AppendDepartures(from_minute, to_minute, trips);
+    return;
+  }
+  AppendDepartures(from_minute, std::numeric_limits<int32_t>::max(), trips);
+  AppendDepartures(std::numeric_limits<int32_t>::min(), to_minute, trips);
+}
+
+absl::Span<const uint32_t> TripIndex::TripsForDriver(
+    std::string_view driver) const {
+  const std::optional<StringId> id = schedule_->FindString(driver);
+  if (!id.has_value() || *id >= driver_trips_.size()) {
+    return {};
+  }
+  return driver_trips_[*id];
+}
+
+absl::Span<const uint32_t> TripIndex::TripsForRoute(RouteId route) const {
+  if (route >= route_trips_.size()) {
+    return {};
+  }
+  return route_trips_[route];
+}
+
+void TripIndex::TripsServingStop(StopId stop,
+                                 std::vector<uint32_t>* trips) const {
+  TripsServingStopBetween(stop, std::numeric_limits<int32_t>::min(),
+                          std::numeric_limits<int32_t>::max(), trips);
+}
+
+void TripIndex::TripsServingStopBetween(StopId stop, int from_minute,
+                                        int to_minute,
+                                        std::vector<uint32_t>* trips) const {
+  trips->clear();
+  if (stop >= stop_routes_.size()) {
+    return;
+  }
+  // Each trip has one route, so the posting lists are disjoint: filter each
+  // one and merge the sorted runs.
+  for (const RouteId route : stop_routes_[stop]) {
+    const auto middle = static_cast<std::ptrdiff_t>(trips->size());
+    for (const uint32_t trip : route_trips_[route]) {
+      const int32_t m = minutes_[trip];
+      if (from_minute <= to_minute ? m >= from_minute && m < to_minute
+                                   : m >= from_minute || m < to_minute) {
+        trips->push_back(trip);
+      }
+    }
+    std::inplace_merge(trips->begin(), trips->begin() + middle, trips->end());
+  }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "examples/boost/serialization/bus_schedule_arena.h"
+
+// Secondary indexes over an ArenaSchedule answering "which trips depart
+// between 09:00 and 09:30", "which trips does this driver make" and "which
+// trips serve this stop" without scanning every trip.
+//
+// Trips are identified by their position in the schedule, which is also
+// their position in BusSchedule::trips() for a schedule converted with
+// ArenaSchedule::FromSchedule().
+//
+//  * Departure times are kept as (minute of day, trip) pairs sorted in an
+//    array searched by binary search. Newly indexed trips go to a small
+//    unsorted tail which is merged into the array once it grows past a
+//    fraction of it, so appending stays cheap.
+//  * Drivers and routes have posting lists of trip ids, in increasing order
+//    since trips are indexed in order.
+//  * Stops map to the routes serving them; the trips serving a stop are the
+//    union of those routes' posting lists. Going through routes keeps the
+//    index at one entry per trip instead of one per trip and stop.
+//
+// Not thread-safe. The schedule must outlive the index.
+class TripIndex {
+ public:
+  explicit TripIndex(const ArenaSchedule* schedule);
+
+  // Indexes the stops, routes and trips added to the schedule since the
+  // last call, or since construction.
+  void Update();
+
+  size_t num_indexed_trips() const { return num_trips_; }
+
+  // Trips departing in [from_minute, to_minute), counted in minutes since
+  // midnight (hour * 60 + minute), in departure order. A range with
+  // to_minute < from_minute wraps around midnight.
+  void DepartingBetween(int from_minute, int to_minute,
+                        std::vector<uint32_t>* trips) const;
+
+  // Trips driven by `driver`, in schedule order.
+  absl::Span<const uint32_t> TripsForDriver(std::string_view driver) const;
+
+  // Trips on `route`, in schedule order.
+  absl::Span<const uint32_t> TripsForRoute(RouteId route) const;
+
+  // Trips whose route serves `stop`, in schedule order.
+  void TripsServingStop(StopId stop, std::vector<uint32_t>* trips) const;
+  // The same, restricted to departures in [from_minute, to_minute).
+  void TripsServingStopBetween(StopId stop, int from_minute, int to_minute,
+                               std::vector<uint32_t>* trips) const;
+
+ private:
+  struct Departure {
+    int32_t minute_of_day;
+    uint32_t trip;
+
+    bool operator<(const Departure& rhs) const {
+      return minute_of_day != rhs.minute_of_day
+                 ? minute_of_day < rhs.minute_of_day
+                 : trip < rhs.trip;
+    }
+  };
+
+  static int32_t MinuteOfDay(const ArenaTrip& trip) {
+    return trip.hour * 60 + trip.minute;
+  }
+  // Appends departures in [from_minute, to_minute) to `trips`.
+  void AppendDepartures(int from_minute, int to_minute,
+                        std::vector<uint32_t>* trips) const;
+  void MergeTail();
+
+  const ArenaSchedule* const schedule_;
+  size_t num_trips_ = 0;
+  size_t num_routes_ = 0;
+
+  std::vector<int32_t> minutes_;       // minute of day by trip
+  std::vector<Departure> departures_;  // sorted
+  std::vector<Departure> tail_;        // unsorted, not yet merged
+  std::vector<std::vector<uint32_t>> driver_trips_;  // by driver StringId
+  std::vector<std::vector<uint32_t>> route_trips_;   // by RouteId
+  std::vector<std::vector<RouteId>> stop_routes_;    // by StopId
+};
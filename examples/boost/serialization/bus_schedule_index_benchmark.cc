@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "examples/boost/serialization/bus_schedule_arena.h"
+#include "examples/boost/serialization/bus_schedule_index.h"
+#include "examples/boost/serialization/synthetic_schedule.h"
+
+// How to run:
+// bazel run -c opt //examples/boost/serialization:bus_schedule_index_benchmark
+namespace {
+
+struct Indexed {
+  ArenaSchedule arena;
+  std::unique_ptr<TripIndex> index;
+};
+
+// SyntheticScheduleFor(num_trips) as an ArenaSchedule and its index, once
+// per size.
+const Indexed& IndexedFor(size_t num_trips) {
+  static auto* cache = new std::map<size_t, std::unique_ptr<Indexed>>();
+  auto it = cache->find(num_trips);
+  if (it != cache->end()) {
+    return *it->second;
+  }
+  auto s = std::make_unique<Indexed>();
+  auto arena =
+      ArenaSchedule::FromSchedule(SyntheticScheduleFor(num_trips).schedule);
+  if (!arena.ok()) {
+    std::abort();
+  }
+  s->arena = *std::move(arena);
+  s->index = std::make_unique<TripIndex>(&s->arena);
+  return *cache->emplace(num_trips, std::move(s)).first->second;
+}
+
+// Runs `query` once per iteration and reports the median and 99th
+// percentile latency next to the mean benchmark reports by itself.
+template <typename Query>
+void RunQueries(benchmark::State& state, Query query) {
+  std::mt19937 rng(1);
+  std::vector<double> latencies_us;
+  size_t results = 0;
+  for (auto _ : state) {
+    const auto start = std::chrono::steady_clock::now();
+    results += query(rng);
+    const auto end = std::chrono::steady_clock::now();
+    latencies_us.push_back(
+        std::chrono::duration<double, std::micro>(end - start).count());
+  }
+  std::sort(latencies_us.begin(), latencies_us.end());
+  state.counters["p50_us"] = latencies_us[latencies_us.size() / 2];
+  state.counters["p99_us"] = latencies_us[latencies_us.size() * 99 / 100];
+  state.counters["results"] =
+      static_cast<double>(results) / latencies_us.size();
+}
+
+// Departures in a random 30 minute window.
+void BM_DepartingBetween(benchmark::State& state) {
+  const Indexed& s = IndexedFor(state.range(0));
+  std::vector<uint32_t> trips;
+  RunQueries(state, [&](std::mt19937& rng) {
+    const int from = static_cast<int>(rng() % (24 * 60));
+    s.index->DepartingBetween(from, (from + 30) % (24 * 60), &trips);
+    return trips.size();
+  });
+}
+
+// The same question answered by walking the BusSchedule list.
+void BM_DepartingBetweenScan(benchmark::State& state) {
+  const SyntheticSchedule& list = SyntheticScheduleFor(state.range(0));
+  std::vector<const BusSchedule::TripInfo*> trips;
+  RunQueries(state, [&](std::mt19937& rng) {
+    const int from = static_cast<int>(rng() % (24 * 60 - 30));
+    trips.clear();
+    for (const auto& [info, route] : list.schedule.trips()) {
+      const int m = info.hour * 60 + info.minute;
+      if (m >= from && m < from + 30) {
+        trips.push_back(&info);
+      }
+    }
+    return trips.size();
+  });
+}
+
+void BM_TripsForDriver(benchmark::State& state) {
+  const Indexed& s = IndexedFor(state.range(0));
+  std::vector<std::string> drivers;
+  for (int d = 0; d < 256; ++d) {
+    drivers.push_back(absl::StrCat("driver", d));
+  }
+  RunQueries(state, [&](std::mt19937& rng) {
+    return s.index->TripsForDriver(drivers[rng() % drivers.size()]).size();
+  });
+}
+
+// Trips serving a random stop in a random hour.
+void BM_TripsServingStopBetween(benchmark::State& state) {
+  const Indexed& s = IndexedFor(state.range(0));
+  std::vector<uint32_t> trips;
+  RunQueries(state, [&](std::mt19937& rng) {
+    const StopId stop = static_cast<StopId>(rng() % s.arena.num_stops());
+    const int from = static_cast<int>(rng() % 24) * 60;
+    s.index->TripsServingStopBetween(stop, from, from + 60, &trips);
+    return trips.size();
+  });
+}
+
+// Appending one trip at a time and indexing it right away.
+void BM_AppendAndUpdate(benchmark::State& state) {
+  ArenaSchedule arena;
+  const StopId stop = arena.AddDestination(GpsPosition(1, 2, 3.0f),
+                                           GpsPosition(4, 5, 6.0f), "Depot");
+  const RouteId route = arena.AddRoute({stop});
+  TripIndex index(&arena);
+  std::mt19937 rng(1);
+  for (auto _ : state) {
+    arena.Append("driver", static_cast<int>(rng() % 24),
+                 static_cast<int>(rng() % 60), route);
+    index.Update();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_DepartingBetween)->Arg(1 << 20)->Arg(4 << 20);
+BENCHMARK(BM_DepartingBetweenScan)->Arg(1 << 20)->Arg(4 << 20);
+BENCHMARK(BM_TripsForDriver)->Arg(1 << 20)->Arg(4 << 20);
+BENCHMARK(BM_TripsServingStopBetween)->Arg(1 << 20)->Arg(4 << 20);
+BENCHMARK(BM_AppendAndUpdate);
+
+}  // namespace
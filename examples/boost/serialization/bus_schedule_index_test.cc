@@ -0,0 +1,130 @@
+#include "examples/boost/serialization/bus_schedule_index.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "examples/boost/serialization/synthetic_schedule.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+int MinuteOfDay(const ArenaTrip& trip) { return trip.hour * 60 + trip.minute; }
+
+// Trips departing in [from, to), wrapping around midnight, in departure
+// order, found by scanning every trip.
+std::vector<uint32_t> ScanDeparting(const ArenaSchedule& s, int from, int to) {
+  std::vector<std::pair<int, uint32_t>> found;
+  for (uint32_t i = 0; i < s.num_trips(); ++i) {
+    const int m = MinuteOfDay(s.trip(i));
+    if (from <= to ? m >= from && m < to : m >= from || m < to) {
+      // Departures after midnight come after those before it.
+      found.emplace_back(from <= to || m >= from ? m : m + 24 * 60, i);
+    }
+  }
+  std::sort(found.begin(), found.end());
+  std::vector<uint32_t> trips;
+  for (const auto& [minute, trip] : found) {
+    trips.push_back(trip);
+  }
+  return trips;
+}
+
+std::vector<uint32_t> ScanServing(const ArenaSchedule& s, StopId stop) {
+  std::vector<uint32_t> trips;
+  for (uint32_t i = 0; i < s.num_trips(); ++i) {
+    const ArenaRoute& route = s.route(s.trip(i).route);
+    for (uint32_t k = 0; k < route.num_stops; ++k) {
+      if (s.route_stop(route, k) == stop) {
+        trips.push_back(i);
+        break;
+      }
+    }
+  }
+  return trips;
+}
+
+ArenaSchedule MakeArena(size_t num_trips) {
+  const SyntheticSchedule s = MakeSyntheticSchedule(num_trips);
+  auto arena = ArenaSchedule::FromSchedule(s.schedule);
+  EXPECT_TRUE(arena.ok());
+  return *std::move(arena);
+}
+
+TEST(TripIndexTest, MatchesScans) {
+  const ArenaSchedule s = MakeArena(20000);
+  const TripIndex index(&s);
+  EXPECT_EQ(index.num_indexed_trips(), s.num_trips());
+
+  std::vector<uint32_t> trips;
+  for (const auto& [from, to] : std::vector<std::pair<int, int>>{
+           {9 * 60, 9 * 60 + 30}, {0, 1}, {0, 24 * 60}, {23 * 60, 60},
+           {600, 600}, {-5, 3}}) {
+    index.DepartingBetween(from, to, &trips);
+    EXPECT_EQ(trips, ScanDeparting(s, from, to)) << from << " " << to;
+  }
+
+  for (StopId stop = 0; stop < s.num_stops(); stop += 7) {
+    index.TripsServingStop(stop, &trips);
+    EXPECT_EQ(trips, ScanServing(s, stop)) << stop;
+
+    index.TripsServingStopBetween(stop, 22 * 60, 2 * 60, &trips);
+    std::vector<uint32_t> expected;
+    for (const uint32_t t : ScanServing(s, stop)) {
+      const int m = MinuteOfDay(s.trip(t));
+      if (m >= 22 * 60 || m < 2 * 60) {
+        expected.push_back(t);
+      }
+    }
+    EXPECT_EQ(trips, expected) << stop;
+  }
+
+  const absl::Span<const uint32_t> driver = index.TripsForDriver("driver7");
+  ASSERT_FALSE(driver.empty());
+  size_t count = 0;
+  for (uint32_t i = 0; i < s.num_trips(); ++i) {
+    if (s.driver(s.trip(i)) == "driver7") {
+      ASSERT_LT(count, driver.size());
+      EXPECT_EQ(driver[count++], i);
+    }
+  }
+  EXPECT_EQ(count, driver.size());
+  EXPECT_TRUE(index.TripsForDriver("nobody").empty());
+  EXPECT_EQ(index.TripsForRoute(s.trip(0).route).front(), 0);
+  EXPECT_TRUE(index.TripsForRoute(s.num_routes()).empty());
+  index.TripsServingStop(s.num_stops(), &trips);
+  EXPECT_TRUE(trips.empty());
+}
+
+TEST(TripIndexTest, IndexesAppendedTrips) {
+  ArenaSchedule s = MakeArena(5000);
+  TripIndex index(&s);
+  std::mt19937 rng(7);
+  std::vector<uint32_t> trips;
+  // Small batches stay in the unsorted tail; larger ones get merged. Both
+  // must answer the same as a scan, with new stops, routes and drivers.
+  for (int batch = 0; batch < 12; ++batch) {
+    const StopId stop = s.AddDestination(GpsPosition(1, 2, 3.0f),
+                                         GpsPosition(4, 5, 6.0f), "New stop");
+    const RouteId route = s.AddRoute({0, stop, stop});
+    const int n = batch % 3 == 0 ? 6000 : 10;
+    for (int i = 0; i < n; ++i) {
+      s.Append(batch % 2 ? "newcomer" : "driver3",
+               static_cast<int>(rng() % 24), static_cast<int>(rng() % 60),
+               i % 2 ? route : static_cast<RouteId>(rng() % route));
+    }
+    index.Update();
+    ASSERT_EQ(index.num_indexed_trips(), s.num_trips());
+
+    index.DepartingBetween(8 * 60, 8 * 60 + 45, &trips);
+    EXPECT_EQ(trips, ScanDeparting(s, 8 * 60, 8 * 60 + 45)) << batch;
+    index.TripsServingStop(stop, &trips);
+    EXPECT_EQ(trips, ScanServing(s, stop)) << batch;
+    index.TripsServingStop(0, &trips);
+    EXPECT_EQ(trips, ScanServing(s, 0)) << batch;
+  }
+  EXPECT_EQ(index.TripsForDriver("newcomer").size(),
+            (6000 + 10 + 10) * 2);
+}
+
+}  // namespace
@@ -0,0 +1,619 @@
+#include "examples/boost/serialization/bus_schedule_log.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <system_error>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#define BUS_SCHEDULE_LOG_X86 1
+#endif
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr char kSnapshotPrefix[] = "snapshot-";
+constexpr char kLogPrefix[] = "log-";
+constexpr char kTempSuffix[] = ".tmp";
+// crc32c, length, type
+constexpr size_t kRecordHeaderBytes = 9;
+
+// CRC-32C (Castagnoli), reflected polynomial 0x82f63b78.
+constexpr std::array<uint32_t, 256> MakeCrc32cTable() {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t c = i;
+    for (int k = 0; k < 8; ++k) {
+      c = (c & 1) ? (c >> 1) ^ 0x82f63b78u : c >> 1;
+    }
+    table[i] = c;
+  }
+  return table;
+}
+
+constexpr std::array<uint32_t, 256> kCrc32cTable = MakeCrc32cTable();
+
+uint32_t Crc32cScalar(uint32_t crc, const char* p, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    crc = kCrc32cTable[(crc ^ static_cast<uint8_t>(p[i])) & 0xff] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+#ifdef BUS_SCHEDULE_LOG_X86
+__attribute__((target("sse4.2"))) uint32_t Crc32cSse42(uint32_t crc,
+                                                       const char* p,
+                                                       size_t n) {
+  uint64_t c = crc;
+  for (; n >= 8; n -= 8, p += 8) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    c = _mm_crc32_u64(c, v);
+  }
+  crc = static_cast<uint32_t>(c);
+  for (; n > 0; --n, ++p) {
+    crc = _mm_crc32_u8(crc, static_cast<uint8_t>(*p));
+  }
+  return crc;
+}
+#endif
+
+uint32_t Crc32c(const char* p, size_t n) {
+#ifdef BUS_SCHEDULE_LOG_X86
+  static const bool sse42 = __builtin_cpu_supports("sse4.2");
+  if (sse42) {
+    return ~Crc32cSse42(~0u, p, n);
+  }
+#endif
+  return ~Crc32cScalar(~0u, p, n);
+}
+
+template <typename T>
+void Put(std::string* out, T v) {
+  out->append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+void PutString(std::string* out, std::string_view s) {
+  Put<uint32_t>(out, static_cast<uint32_t>(s.size()));
+  out->append(s.data(), s.size());
+}
+
+void PutGps(std::string* out, const GpsPosition& g) {
+  Put<int32_t>(out, g.degrees());
+  Put<int32_t>(out, g.minutes());
+  Put<float>(out, g.seconds());
+}
+
+// Bounds-checked reads from a record payload.
+class Reader {
+ public:
+  explicit Reader(std::string_view data) : data_(data) {}
+
+  template <typename T>
+  bool Get(T* v) {
+    if (data_.size() < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(v, data_.data(), sizeof(T));
+    data_.remove_prefix(sizeof(T));
+    return true;
+  }
+
+  bool GetString(std::string_view* s) {
+    uint32_t size;
+    if (!Get(&size) || data_.size() < size) {
+      return false;
+    }
+    *s = data_.substr(0, size);
+    data_.remove_prefix(size);
+    return true;
+  }
+
+  bool GetGps(GpsPosition* g) {
+    int32_t degrees, minutes;
+    float seconds;
+    if (!Get(&degrees) || !Get(&minutes) || !Get(&seconds)) {
+      return false;
+    }
+    *g = GpsPosition(degrees, minutes, seconds);
+    return true;
+  }
+
+  bool done() const { return data_.empty(); }
+
+ private:
+  std::string_view data_;
+};
+
+// Applies one record to `s`. Returns false for a malformed record or one
+// referring to ids `s` does not have.
+bool ApplyRecord(uint8_t type, std::string_view payload, ArenaSchedule* s) {
+  Reader r(payload);
+  switch (static_cast<ScheduleLogRecord>(type)) {
+    case ScheduleLogRecord::kCornerStop: {
+      GpsPosition lat, lon;
+      std::string_view street1, street2;
+      if (!r.GetGps(&lat) || !r.GetGps(&lon) || !r.GetString(&street1) ||
+          !r.GetString(&street2) || !r.done()) {
+        return false;
+      }
+      s->AddCorner(lat, lon, street1, street2);
+      return true;
+    }
+    case ScheduleLogRecord::kDestinationStop: {
+      GpsPosition lat, lon;
+      std::string_view name;
+      if (!r.GetGps(&lat) || !r.GetGps(&lon) || !r.GetString(&name) ||
+          !r.done()) {
+        return false;
+      }
+      s->AddDestination(lat, lon, name);
+      return true;
+    }
+    case ScheduleLogRecord::kRoute: {
+      uint32_t n;
+      if (!r.Get(&n) || payload.size() != sizeof(n) * (n + uint64_t{1})) {
+        return false;
+      }
+      std::vector<StopId> stops(n);
+      for (StopId& stop : stops) {
+        if (!r.Get(&stop) || stop >= s->num_stops()) {
+          return false;
+        }
+      }
+      s->AddRoute(stops);
+      return true;
+    }
+    case ScheduleLogRecord::kTrip: {
+      int32_t hour, minute;
+      RouteId route;
+      std::string_view driver;
+      if (!r.Get(&hour) || !r.Get(&minute) || !r.Get(&route) ||
+          !r.GetString(&driver) || !r.done() || route >= s->num_routes()) {
+        return false;
+      }
+      s->Append(driver, hour, minute, route);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool AllZero(std::string_view data) {
+  return std::all_of(data.begin(), data.end(), [](char c) { return c == 0; });
+}
+
+// Replays the log file at `path` onto `s`. In the newest log (`newest`) a
+// torn tail is tolerated: a final record that is cut short or fails its
+// checksum, or a run of zeros. Sets `*valid_bytes` to the length of the
+// intact prefix, which is 0 if even the header is torn.
+absl::Status ReplayLog(const std::string& path, uint64_t generation,
+                       bool newest, ArenaSchedule* s, uint64_t* valid_bytes) {
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs) {
+    return absl::NotFoundError(absl::StrCat("Failed to open ", path));
+  }
+  const std::string data((std::istreambuf_iterator<char>(ifs)),
+                         std::istreambuf_iterator<char>());
+  *valid_bytes = 0;
+  auto torn = [&](uint64_t offset) {
+    if (newest) {
+      *valid_bytes = offset;
+      return absl::OkStatus();
+    }
+    return absl::DataLossError(
+        absl::StrCat(path, " is corrupted at offset ", offset));
+  };
+
+  if (data.size() < sizeof(ScheduleLogHeader)) {
+    return torn(0);
+  }
+  ScheduleLogHeader header;
+  std::memcpy(&header, data.data(), sizeof(header));
+  if (std::memcmp(header.magic, kScheduleLogMagic, sizeof(header.magic)) !=
+          0 ||
+      header.version != kScheduleLogVersion ||
+      header.endian_tag != kScheduleLogEndianTag ||
+      header.generation != generation) {
+    return AllZero(data) ? torn(0)
+                         : absl::DataLossError(absl::StrCat(
+                               path, " is not a schedule log of generation ",
+                               generation));
+  }
+
+  size_t offset = sizeof(header);
+  while (offset < data.size()) {
+    const std::string_view rest(data.data() + offset, data.size() - offset);
+    uint32_t crc, length;
+    if (rest.size() < kRecordHeaderBytes) {
+      return torn(offset);
+    }
+    std::memcpy(&crc, rest.data(), sizeof(crc));
+    std::memcpy(&length, rest.data() + 4, sizeof(length));
+    if (length > rest.size() - kRecordHeaderBytes) {
+      return torn(offset);
+    }
+    const size_t record_bytes = kRecordHeaderBytes + length;
+    if (Crc32c(rest.data() + 4, record_bytes - 4) != crc) {
+      if (record_bytes == rest.size() || AllZero(rest)) {
+        return torn(offset);
+      }
+      return absl::DataLossError(
+          absl::StrCat(path, " has a bad checksum at offset ", offset));
+    }
+    if (!ApplyRecord(static_cast<uint8_t>(rest[8]),
+                     rest.substr(kRecordHeaderBytes, length), s)) {
+      return absl::DataLossError(
+          absl::StrCat(path, " has an invalid record at offset ", offset));
+    }
+    offset += record_bytes;
+  }
+  *valid_bytes = offset;
+  return absl::OkStatus();
+}
+
+// Generation numbers of the files in `dir` named `prefix`<G>, ascending.
+std::vector<uint64_t> ListGenerations(const std::string& dir,
+                                      std::string_view prefix) {
+  std::vector<uint64_t> generations;
+  std::error_code ec;
+  for (const auto& entry : fs::directory_iterator(dir, ec)) {
+    const std::string name = entry.path().filename().string();
+    uint64_t g;
+    if (name.compare(0, prefix.size(), prefix) == 0 &&
+        absl::SimpleAtoi(name.substr(prefix.size()), &g)) {
+      generations.push_back(g);
+    }
+  }
+  std::sort(generations.begin(), generations.end());
+  return generations;
+}
+
+std::string FilePath(const std::string& dir, std::string_view prefix,
+                     uint64_t generation) {
+  return (fs::path(dir) / absl::StrCat(prefix, generation)).string();
+}
+
+absl::Status Errno(std::string_view what, const std::string& path) {
+  return absl::InternalError(
+      absl::StrCat(what, " ", path, ": ", std::strerror(errno)));
+}
+
+absl::Status FsyncPath(const std::string& path, bool directory) {
+  const int flags = (directory ? O_DIRECTORY : 0) | O_RDONLY | O_CLOEXEC;
+  const int fd = ::open(path.c_str(), flags);
+  if (fd < 0) {
+    return Errno("Failed to open", path);
+  }
+  const int rc = ::fsync(fd);
+  ::close(fd);
+  return rc == 0 ? absl::OkStatus() : Errno("Failed to sync", path);
+}
+
+// What a log directory holds up to generation `last`.
+struct LoadedLog {
+  ArenaSchedule schedule;
+  // Newest log replayed and the length of its intact prefix, or
+  // has_log = false if there is none.
+  bool has_log = false;
+  uint64_t log_generation = 0;
+  uint64_t log_valid_bytes = 0;
+  // Generation of the snapshot the logs were replayed onto; 0 for none.
+  uint64_t snapshot_generation = 0;
+};
+
+absl::Status Load(const std::string& dir, uint64_t last, LoadedLog* out) {
+  for (const uint64_t g : ListGenerations(dir, kSnapshotPrefix)) {
+    if (g <= last) {
+      out->snapshot_generation = g;
+    }
+  }
+  if (out->snapshot_generation > 0) {
+    auto snapshot = RestoreArenaSchedule(
+        FilePath(dir, kSnapshotPrefix, out->snapshot_generation));
+    if (!snapshot.ok()) {
+      return snapshot.status();
+    }
+    out->schedule = *std::move(snapshot);
+  }
+  std::vector<uint64_t> logs;
+  for (const uint64_t g : ListGenerations(dir, kLogPrefix)) {
+    if (g >= out->snapshot_generation && g <= last) {
+      logs.push_back(g);
+    }
+  }
+  for (size_t i = 0; i < logs.size(); ++i) {
+    if (logs[i] != out->snapshot_generation + i) {
+      return absl::DataLossError(absl::StrCat(
+          dir, " is missing ", FilePath(dir, kLogPrefix,
+                                        out->snapshot_generation + i)));
+    }
+    const bool newest = i + 1 == logs.size();
+    if (auto status =
+            ReplayLog(FilePath(dir, kLogPrefix, logs[i]), logs[i], newest,
+                      &out->schedule, &out->log_valid_bytes);
+        !status.ok()) {
+      return status;
+    }
+    out->has_log = true;
+    out->log_generation = logs[i];
+  }
+  return absl::OkStatus();
+}
+
+// Writes snapshot-<last + 1> from the snapshot and logs up to `last`, then
+// deletes those. Each step leaves a directory Load() reads correctly.
+absl::Status WriteSnapshot(const std::string& dir, uint64_t last) {
+  LoadedLog loaded;
+  if (auto status = Load(dir, last, &loaded); !status.ok()) {
+    return status;
+  }
+  const std::string path = FilePath(dir, kSnapshotPrefix, last + 1);
+  const std::string temp = path + kTempSuffix;
+  if (auto status = SaveArenaSchedule(loaded.schedule, temp); !status.ok()) {
+    return status;
+  }
+  if (auto status = FsyncPath(temp, false); !status.ok()) {
+    return status;
+  }
+  if (::rename(temp.c_str(), path.c_str()) != 0) {
+    return Errno("Failed to rename", temp);
+  }
+  if (auto status = FsyncPath(dir, true); !status.ok()) {
+    return status;
+  }
+  for (const uint64_t g : ListGenerations(dir, kSnapshotPrefix)) {
+    if (g <= last) {
+      ::unlink(FilePath(dir, kSnapshotPrefix, g).c_str());
+    }
+  }
+  for (const uint64_t g : ListGenerations(dir, kLogPrefix)) {
+    if (g <= last) {
+      ::unlink(FilePath(dir, kLogPrefix, g).c_str());
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<ScheduleLog>> ScheduleLog::Open(
+    std::string_view dir, const ScheduleLogOptions& options) {
+  std::error_code ec;
+  fs::create_directories(fs::path(dir), ec);
+  if (ec) {
+    return absl::UnavailableError(
+        absl::StrCat("Failed to create ", dir, ": ", ec.message()));
+  }
+  std::unique_ptr<ScheduleLog> log(
+      new ScheduleLog(std::string(dir), options));
+  // Left over from a compaction that did not finish.
+  for (const auto& entry : fs::directory_iterator(log->dir_, ec)) {
+    if (entry.path().extension() == kTempSuffix) {
+      fs::remove(entry.path(), ec);
+    }
+  }
+
+  LoadedLog loaded;
+  if (auto status =
+          Load(log->dir_, std::numeric_limits<uint64_t>::max(), &loaded);
+      !status.ok()) {
+    return status;
+  }
+  log->schedule_ = std::move(loaded.schedule);
+  if (!loaded.has_log || loaded.log_valid_bytes == 0) {
+    log->generation_ =
+        loaded.has_log ? loaded.log_generation : loaded.snapshot_generation;
+    if (auto status = log->CreateLogFile(); !status.ok()) {
+      return status;
+    }
+    return log;
+  }
+
+  // Cut a torn tail off the newest log and append after it.
+  log->generation_ = loaded.log_generation;
+  const std::string path = FilePath(log->dir_, kLogPrefix, log->generation_);
+  log->fd_ = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+  if (log->fd_ < 0) {
+    return Errno("Failed to open", path);
+  }
+  if (::ftruncate(log->fd_, static_cast<off_t>(loaded.log_valid_bytes)) !=
+          0 ||
+      ::lseek(log->fd_, 0, SEEK_END) < 0) {
+    return Errno("Failed to truncate", path);
+  }
+  return log;
+}
+
+ScheduleLog::~ScheduleLog() {
+  Flush().IgnoreError();
+  WaitForCompaction().IgnoreError();
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+absl::Status ScheduleLog::CreateLogFile() {
+  const std::string path = FilePath(dir_, kLogPrefix, generation_);
+  fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd_ < 0) {
+    return Errno("Failed to create", path);
+  }
+  ScheduleLogHeader header{};
+  std::memcpy(header.magic, kScheduleLogMagic, sizeof(header.magic));
+  header.version = kScheduleLogVersion;
+  header.endian_tag = kScheduleLogEndianTag;
+  header.generation = generation_;
+  pending_.append(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (auto status = Flush(true); !status.ok()) {
+    return status;
+  }
+  return FsyncPath(dir_, true);
+}
+
+absl::Status ScheduleLog::AddRecord(ScheduleLogRecord type) {
+  if (!write_status_.ok()) {
+    return write_status_;
+  }
+  const size_t start = pending_.size();
+  Put<uint32_t>(&pending_, 0);
+  Put<uint32_t>(&pending_, static_cast<uint32_t>(record_.size()));
+  Put<uint8_t>(&pending_, static_cast<uint8_t>(type));
+  pending_.append(record_);
+  const uint32_t crc =
+      Crc32c(pending_.data() + start + 4, pending_.size() - start - 4);
+  std::memcpy(&pending_[start], &crc, sizeof(crc));
+  record_.clear();
+  if (pending_.size() >= options_.buffer_bytes) {
+    return WritePending();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ScheduleLog::WritePending() {
+  if (!write_status_.ok()) {
+    return write_status_;
+  }
+  size_t written = 0;
+  while (written < pending_.size()) {
+    const ssize_t n =
+        ::write(fd_, pending_.data() + written, pending_.size() - written);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      write_status_ =
+          Errno("Failed to write", FilePath(dir_, kLogPrefix, generation_));
+      return write_status_;
+    }
+    written += static_cast<size_t>(n);
+  }
+  pending_.clear();
+  return absl::OkStatus();
+}
+
+absl::StatusOr<StopId> ScheduleLog::AddCorner(const GpsPosition& lat,
+                                              const GpsPosition& lon,
+                                              std::string_view street1,
+                                              std::string_view street2) {
+  PutGps(&record_, lat);
+  PutGps(&record_, lon);
+  PutString(&record_, street1);
+  PutString(&record_, street2);
+  if (auto status = AddRecord(ScheduleLogRecord::kCornerStop); !status.ok()) {
+    return status;
+  }
+  return schedule_.AddCorner(lat, lon, street1, street2);
+}
+
+absl::StatusOr<StopId> ScheduleLog::AddDestination(const GpsPosition& lat,
+                                                   const GpsPosition& lon,
+                                                   std::string_view name) {
+  PutGps(&record_, lat);
+  PutGps(&record_, lon);
+  PutString(&record_, name);
+  if (auto status = AddRecord(ScheduleLogRecord::kDestinationStop);
+      !status.ok()) {
+    return status;
+  }
+  return schedule_.AddDestination(lat, lon, name);
+}
+
+absl::StatusOr<RouteId> ScheduleLog::AddRoute(
+    const std::vector<StopId>& stops) {
+  for (const StopId stop : stops) {
+    if (stop >= schedule_.num_stops()) {
+      return absl::InvalidArgumentError(absl::StrCat("No stop ", stop));
+    }
+  }
+  Put<uint32_t>(&record_, static_cast<uint32_t>(stops.size()));
+  for (const StopId stop : stops) {
+    Put<uint32_t>(&record_, stop);
+  }
+  if (auto status = AddRecord(ScheduleLogRecord::kRoute); !status.ok()) {
+    return status;
+  }
+  return schedule_.AddRoute(stops);
+}
+
+absl::Status ScheduleLog::Append(std::string_view driver, int hour,
+                                 int minute, RouteId route) {
+  if (route >= schedule_.num_routes()) {
+    return absl::InvalidArgumentError(absl::StrCat("No route ", route));
+  }
+  Put<int32_t>(&record_, hour);
+  Put<int32_t>(&record_, minute);
+  Put<uint32_t>(&record_, route);
+  PutString(&record_, driver);
+  if (auto status = AddRecord(ScheduleLogRecord::kTrip); !status.ok()) {
+    return status;
+  }
+  schedule_.Append(driver, hour, minute, route);
+  return absl::OkStatus();
+}
+
+absl::Status ScheduleLog::Flush(bool sync) {
+  if (auto status = WritePending(); !status.ok()) {
+    return status;
+  }
+  if ((sync || options_.sync) && ::fdatasync(fd_) != 0) {
+    write_status_ =
+        Errno("Failed to sync", FilePath(dir_, kLogPrefix, generation_));
+    return write_status_;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ScheduleLog::Compact() {
+  if (auto status = WaitForCompaction(); !status.ok()) {
+    return status;
+  }
+  if (auto status = Flush(true); !status.ok()) {
+    return status;
+  }
+  ::close(fd_);
+  fd_ = -1;
+  const uint64_t last = generation_++;
+  if (auto status = CreateLogFile(); !status.ok()) {
+    write_status_ = status;
+    return status;
+  }
+  compaction_ = std::thread([this, last] {
+    compaction_status_ = WriteSnapshot(dir_, last);
+  });
+  return absl::OkStatus();
+}
+
+absl::Status ScheduleLog::WaitForCompaction() {
+  if (compaction_.joinable()) {
+    compaction_.join();
+  }
+  return std::exchange(compaction_status_, absl::OkStatus());
+}
+
+absl::StatusOr<ArenaSchedule> RestoreScheduleLog(std::string_view dir) {
+  const std::string path(dir);
+  if (!fs::is_directory(path)) {
+    return absl::NotFoundError(absl::StrCat(path, " is not a directory."));
+  }
+  LoadedLog loaded;
+  if (auto status = Load(path, std::numeric_limits<uint64_t>::max(), &loaded);
+      !status.ok()) {
+    return status;
+  }
+  return std::move(loaded.schedule);
+}
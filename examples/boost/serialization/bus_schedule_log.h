@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "examples/boost/serialization/bus_schedule_arena.h"
+
+// Durable, incrementally written ArenaSchedule. Instead of rewriting the
+// whole archive for every change, each added stop, route and trip is
+// appended to a log as a checksummed record, and the log is periodically
+// compacted into a snapshot in the background.
+//
+// A log directory holds
+//
+//   snapshot-<G>   SaveArenaSchedule() archive of everything in logs < G
+//   log-<G>        records appended after snapshot-<G> was cut
+//
+// and the schedule is the newest snapshot followed by the logs from its
+// generation on. A log file is
+//
+//   ScheduleLogHeader
+//   record*   uint32 crc32c(length, type, payload), uint32 length,
+//             uint8 type, payload[length]
+//
+// in host byte order, like the flat schedule layout. Replay stops at a torn
+// record at the end of the newest log, which is what a crash during an
+// append leaves behind; anything else that fails its checksum is reported
+// as data loss.
+
+inline constexpr char kScheduleLogMagic[8] = {'B', 'U', 'S', 'L',
+                                              'O', 'G', '\0', '\1'};
+inline constexpr uint32_t kScheduleLogVersion = 1;
+inline constexpr uint32_t kScheduleLogEndianTag = 0x01020304;
+
+struct ScheduleLogHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t endian_tag;
+  uint64_t generation;
+};
+
+static_assert(sizeof(ScheduleLogHeader) == 24);
+
+enum class ScheduleLogRecord : uint8_t {
+  kCornerStop = 1,    // lat, lon, street1, street2
+  kDestinationStop,   // lat, lon, name
+  kRoute,             // stop count, stop ids
+  kTrip,              // hour, minute, route id, driver
+};
+
+struct ScheduleLogOptions {
+  // Appends are buffered and written once this many bytes are pending, or
+  // on Flush().
+  size_t buffer_bytes = 1 << 20;
+  // fdatasync() the log on every Flush(), not only when asked to.
+  bool sync = false;
+};
+
+class ScheduleLog {
+ public:
+  // Opens the log in `dir`, creating the directory if needed, and replays
+  // it. A torn record at the end of the newest log is cut off.
+  static absl::StatusOr<std::unique_ptr<ScheduleLog>> Open(
+      std::string_view dir, const ScheduleLogOptions& options = {});
+
+  // Flushes pending appends and waits for a running compaction.
+  ~ScheduleLog();
+  ScheduleLog(const ScheduleLog&) = delete;
+  ScheduleLog& operator=(const ScheduleLog&) = delete;
+
+  const ArenaSchedule& schedule() const { return schedule_; }
+  uint64_t generation() const { return generation_; }
+
+  // Same as the ArenaSchedule methods, plus logging. Fail if a buffered
+  // write fails, or for ids the schedule does not have.
+  absl::StatusOr<StopId> AddCorner(const GpsPosition& lat,
+                                   const GpsPosition& lon,
+                                   std::string_view street1,
+                                   std::string_view street2);
+  absl::StatusOr<StopId> AddDestination(const GpsPosition& lat,
+                                        const GpsPosition& lon,
+                                        std::string_view name);
+  absl::StatusOr<RouteId> AddRoute(const std::vector<StopId>& stops);
+  absl::Status Append(std::string_view driver, int hour, int minute,
+                      RouteId route);
+
+  // Writes pending appends to the log file, and syncs it if `sync` or
+  // ScheduleLogOptions::sync is set. Appends may be lost in a crash until
+  // they are synced.
+  absl::Status Flush(bool sync = false);
+
+  // Syncs the current log and starts a new generation, then writes a
+  // snapshot of the old generations and deletes them on a background
+  // thread. Appends go on meanwhile. Waits for a previous compaction first.
+  absl::Status Compact();
+  // Waits for the running compaction, if any, and returns its status.
+  absl::Status WaitForCompaction();
+
+ private:
+  ScheduleLog(std::string dir, const ScheduleLogOptions& options)
+      : dir_(std::move(dir)), options_(options) {}
+
+  absl::Status CreateLogFile();
+  // Frames record_ as a `type` record and queues it.
+  absl::Status AddRecord(ScheduleLogRecord type);
+  absl::Status WritePending();
+
+  const std::string dir_;
+  const ScheduleLogOptions options_;
+  ArenaSchedule schedule_;
+  uint64_t generation_ = 0;
+  int fd_ = -1;
+  // The first write error; the log takes no more appends after one.
+  absl::Status write_status_;
+  // The record being built, then the records waiting to be written.
+  std::string record_;
+  std::string pending_;
+
+  // Written by the compaction thread, read after joining it.
+  std::thread compaction_;
+  absl::Status compaction_status_;
+};
+
+// The schedule stored in the log directory `dir`, without opening it for
+// appends. Torn records at the end of the newest log are ignored.
+absl::StatusOr<ArenaSchedule> RestoreScheduleLog(std::string_view dir);
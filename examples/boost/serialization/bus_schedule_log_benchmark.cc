@@ -0,0 +1,211 @@
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "examples/boost/serialization/bus_schedule.h"
+#include "examples/boost/serialization/bus_schedule_arena.h"
+#include "examples/boost/serialization/bus_schedule_log.h"
+#include "examples/boost/serialization/synthetic_schedule.h"
+
+// How to run:
+// bazel run -c opt //examples/boost/serialization:bus_schedule_log_benchmark
+namespace {
+
+namespace fs = std::filesystem;
+
+std::string TempPath(const std::string& name) {
+  return (fs::temp_directory_path() / name).string();
+}
+
+std::unique_ptr<ScheduleLog> OpenEmptyLog(const std::string& dir,
+                                          const ScheduleLogOptions& options) {
+  fs::remove_all(dir);
+  auto log = ScheduleLog::Open(dir, options);
+  if (!log.ok()) {
+    std::abort();
+  }
+  return *std::move(log);
+}
+
+// Logs the stops and routes of `s`, and its trips in [first, last).
+void LogSchedule(const ArenaSchedule& s, size_t first, size_t last,
+                 ScheduleLog* log) {
+  for (size_t i = log->schedule().num_stops(); i < s.num_stops(); ++i) {
+    const ArenaStop& stop = s.stop(i);
+    if (const auto* c = std::get_if<CornerStop>(&stop.place)) {
+      (void)log->AddCorner(stop.latitude, stop.longitude, s.string(c->street1),
+                           s.string(c->street2));
+    } else {
+      (void)log->AddDestination(
+          stop.latitude, stop.longitude,
+          s.string(std::get<DestinationStop>(stop.place).name));
+    }
+  }
+  std::vector<StopId> stops;
+  for (size_t i = log->schedule().num_routes(); i < s.num_routes(); ++i) {
+    const ArenaRoute& route = s.route(i);
+    stops.clear();
+    for (uint32_t k = 0; k < route.num_stops; ++k) {
+      stops.push_back(s.route_stop(route, k));
+    }
+    (void)log->AddRoute(stops);
+  }
+  for (size_t i = first; i < last; ++i) {
+    const ArenaTrip& trip = s.trip(i);
+    (void)log->Append(s.driver(trip), trip.hour, trip.minute, trip.route);
+  }
+  if (!log->Flush().ok()) {
+    std::abort();
+  }
+}
+
+struct Schedules {
+  ArenaSchedule arena;
+  std::string list_file;
+  std::string arena_file;
+  // The same trips as 90% snapshot, 10% log.
+  std::string log_dir;
+};
+
+// SyntheticScheduleFor(num_trips) as an ArenaSchedule, saved both ways and
+// logged, once per size.
+const Schedules& SchedulesFor(size_t num_trips) {
+  static auto* cache = new std::map<size_t, std::unique_ptr<Schedules>>();
+  auto it = cache->find(num_trips);
+  if (it != cache->end()) {
+    return *it->second;
+  }
+  auto s = std::make_unique<Schedules>();
+  const SyntheticSchedule& list = SyntheticScheduleFor(num_trips);
+  auto arena = ArenaSchedule::FromSchedule(list.schedule);
+  if (!arena.ok()) {
+    std::abort();
+  }
+  s->arena = *std::move(arena);
+  const std::string tag = std::to_string(num_trips);
+  s->list_file = TempPath("bus_schedule_list_" + tag + ".txt");
+  s->arena_file = TempPath("bus_schedule_arena_" + tag + ".txt");
+  s->log_dir = TempPath("bus_schedule_log_" + tag);
+  if (!SaveSchedule(list.schedule, s->list_file).ok() ||
+      !SaveArenaSchedule(s->arena, s->arena_file).ok()) {
+    std::abort();
+  }
+  auto log = OpenEmptyLog(s->log_dir, {});
+  LogSchedule(s->arena, 0, num_trips * 9 / 10, log.get());
+  if (!log->Compact().ok() || !log->WaitForCompaction().ok()) {
+    std::abort();
+  }
+  LogSchedule(s->arena, num_trips * 9 / 10, num_trips, log.get());
+  return *cache->emplace(num_trips, std::move(s)).first->second;
+}
+
+// Appending trips, flushing every 1024; synced if range(0) is set.
+void BM_LogAppend(benchmark::State& state) {
+  ScheduleLogOptions options;
+  options.sync = state.range(0) != 0;
+  auto log = OpenEmptyLog(TempPath("bus_schedule_log_append"), options);
+  const StopId stop = *log->AddDestination(GpsPosition(1, 2, 3.0f),
+                                           GpsPosition(4, 5, 6.0f), "Depot");
+  const RouteId route = *log->AddRoute({stop});
+  std::mt19937 rng(42);
+  int64_t n = 0;
+  for (auto _ : state) {
+    if (!log->Append(absl::StrCat("driver", rng() % 256),
+                     static_cast<int>(rng() % 24),
+                     static_cast<int>(rng() % 60), route)
+             .ok()) {
+      std::abort();
+    }
+    if (++n % 1024 == 0 && !log->Flush().ok()) {
+      std::abort();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Making one new trip durable by rewriting the whole archive...
+void BM_AddTripRewrite(benchmark::State& state) {
+  const Schedules& s = SchedulesFor(state.range(0));
+  const std::string file = TempPath("bus_schedule_arena_rewrite.txt");
+  for (auto _ : state) {
+    if (!SaveArenaSchedule(s.arena, file).ok()) {
+      std::abort();
+    }
+  }
+}
+
+// ...versus appending it to the log and syncing.
+void BM_AddTripLog(benchmark::State& state) {
+  const Schedules& s = SchedulesFor(state.range(0));
+  auto log = OpenEmptyLog(TempPath("bus_schedule_log_one"), {});
+  LogSchedule(s.arena, 0, 0, log.get());
+  for (auto _ : state) {
+    if (!log->Append("driver1", 12, 30, 0).ok() || !log->Flush(true).ok()) {
+      std::abort();
+    }
+  }
+}
+
+void BM_RestoreText(benchmark::State& state) {
+  const Schedules& s = SchedulesFor(state.range(0));
+  for (auto _ : state) {
+    auto restored = RestoreSchedule(s.list_file);
+    benchmark::DoNotOptimize(restored);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_RestoreArena(benchmark::State& state) {
+  const Schedules& s = SchedulesFor(state.range(0));
+  for (auto _ : state) {
+    auto restored = RestoreArenaSchedule(s.arena_file);
+    benchmark::DoNotOptimize(restored);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Snapshot plus replaying the 10% tail.
+void BM_RestoreLog(benchmark::State& state) {
+  const Schedules& s = SchedulesFor(state.range(0));
+  for (auto _ : state) {
+    auto restored = RestoreScheduleLog(s.log_dir);
+    if (!restored.ok() || restored->num_trips() != s.arena.num_trips()) {
+      std::abort();
+    }
+    benchmark::DoNotOptimize(restored);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_LogAppend)->Arg(0)->Arg(1)->UseRealTime();
+BENCHMARK(BM_AddTripRewrite)
+    ->Arg(1 << 20)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_AddTripLog)
+    ->Arg(1 << 20)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+BENCHMARK(BM_RestoreText)
+    ->Arg(1 << 20)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_RestoreArena)
+    ->Arg(1 << 20)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_RestoreLog)
+    ->Arg(1 << 20)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,237 @@
+#include "examples/boost/serialization/bus_schedule_log.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// A fresh, empty directory under the test temp dir.
+std::string TempDir(const std::string& name) {
+  const std::string dir = ::testing::TempDir() + name;
+  fs::remove_all(dir);
+  return dir;
+}
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream ifs(path, std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(ifs)),
+                     std::istreambuf_iterator<char>());
+}
+
+void WriteFile(const std::string& path, const std::string& data) {
+  std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+  ofs.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+// Adds two stops, a route through both and `num_trips` trips on it.
+void Populate(ScheduleLog* log, int num_trips) {
+  auto corner = log->AddCorner(GpsPosition(34, 135, 52.560f),
+                               GpsPosition(134, 22, 78.30f), "24th Street",
+                               "10th Avenue");
+  ASSERT_TRUE(corner.ok()) << corner.status();
+  auto destination = log->AddDestination(GpsPosition(35, 136, 15.456f),
+                                         GpsPosition(133, 32, 15.300f),
+                                         "White House");
+  ASSERT_TRUE(destination.ok()) << destination.status();
+  auto route = log->AddRoute({*corner, *destination});
+  ASSERT_TRUE(route.ok()) << route.status();
+  for (int i = 0; i < num_trips; ++i) {
+    ASSERT_TRUE(
+        log->Append(absl::StrCat("driver", i % 7), i % 24, i % 60, *route)
+            .ok());
+  }
+}
+
+void ExpectSameTrips(const ArenaSchedule& a, const ArenaSchedule& b) {
+  ASSERT_EQ(a.num_stops(), b.num_stops());
+  ASSERT_EQ(a.num_routes(), b.num_routes());
+  ASSERT_EQ(a.num_trips(), b.num_trips());
+  for (size_t i = 0; i < a.num_stops(); ++i) {
+    EXPECT_EQ(a.Description(a.stop(i)), b.Description(b.stop(i)));
+    EXPECT_EQ(a.stop(i).latitude, b.stop(i).latitude);
+  }
+  for (size_t i = 0; i < a.num_trips(); ++i) {
+    EXPECT_EQ(a.trip(i).hour, b.trip(i).hour);
+    EXPECT_EQ(a.trip(i).minute, b.trip(i).minute);
+    EXPECT_EQ(a.trip(i).route, b.trip(i).route);
+    EXPECT_EQ(a.driver(a.trip(i)), b.driver(b.trip(i)));
+  }
+}
+
+TEST(ScheduleLogTest, RoundTrip) {
+  const std::string dir = TempDir("log_round_trip");
+  ArenaSchedule expected;
+  {
+    auto log = ScheduleLog::Open(dir);
+    ASSERT_TRUE(log.ok()) << log.status();
+    Populate(log->get(), 100);
+    expected = ArenaSchedule::FromSchedule(
+                   (*log)->schedule().ToSchedule().schedule)
+                   .value();
+  }
+  auto restored = RestoreScheduleLog(dir);
+  ASSERT_TRUE(restored.ok()) << restored.status();
+  ExpectSameTrips(*restored, expected);
+
+  auto reopened = ScheduleLog::Open(dir);
+  ASSERT_TRUE(reopened.ok()) << reopened.status();
+  ExpectSameTrips((*reopened)->schedule(), expected);
+}
+
+TEST(ScheduleLogTest, RejectsUnknownIds) {
+  auto log = ScheduleLog::Open(TempDir("log_unknown_ids"));
+  ASSERT_TRUE(log.ok()) << log.status();
+  EXPECT_EQ((*log)->AddRoute({0}).status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ((*log)->Append("bob", 1, 2, 0).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(ScheduleLogTest, TornTailRestoresPrefix) {
+  const std::string dir = TempDir("log_torn_tail");
+  {
+    auto log = ScheduleLog::Open(dir);
+    ASSERT_TRUE(log.ok()) << log.status();
+    Populate(log->get(), 20);
+  }
+  const std::string path = dir + "/log-0";
+  const std::string data = ReadFile(path);
+  // Every truncation point, as a crash during an append may leave it,
+  // restores a prefix of the trips; shorter files never restore more.
+  size_t last_trips = 0;
+  for (size_t n = 0; n <= data.size(); ++n) {
+    WriteFile(path, data.substr(0, n));
+    auto restored = RestoreScheduleLog(dir);
+    ASSERT_TRUE(restored.ok()) << n << ": " << restored.status();
+    EXPECT_GE(restored->num_trips(), last_trips);
+    last_trips = restored->num_trips();
+  }
+  EXPECT_EQ(last_trips, 20);
+}
+
+TEST(ScheduleLogTest, ZeroFilledTailIsIgnored) {
+  const std::string dir = TempDir("log_zero_tail");
+  {
+    auto log = ScheduleLog::Open(dir);
+    ASSERT_TRUE(log.ok()) << log.status();
+    Populate(log->get(), 5);
+  }
+  const std::string path = dir + "/log-0";
+  WriteFile(path, ReadFile(path) + std::string(4096, '\0'));
+  auto restored = RestoreScheduleLog(dir);
+  ASSERT_TRUE(restored.ok()) << restored.status();
+  EXPECT_EQ(restored->num_trips(), 5);
+}
+
+TEST(ScheduleLogTest, CorruptRecordIsDataLoss) {
+  const std::string dir = TempDir("log_corrupt");
+  {
+    auto log = ScheduleLog::Open(dir);
+    ASSERT_TRUE(log.ok()) << log.status();
+    Populate(log->get(), 20);
+  }
+  const std::string path = dir + "/log-0";
+  std::string data = ReadFile(path);
+  data[sizeof(ScheduleLogHeader) + 20] ^= 0x40;
+  WriteFile(path, data);
+  EXPECT_EQ(RestoreScheduleLog(dir).status().code(),
+            absl::StatusCode::kDataLoss);
+  EXPECT_EQ(ScheduleLog::Open(dir).status().code(),
+            absl::StatusCode::kDataLoss);
+}
+
+TEST(ScheduleLogTest, ReopenCutsTornTailAndAppends) {
+  const std::string dir = TempDir("log_reopen");
+  {
+    auto log = ScheduleLog::Open(dir);
+    ASSERT_TRUE(log.ok()) << log.status();
+    Populate(log->get(), 10);
+  }
+  const std::string path = dir + "/log-0";
+  const std::string data = ReadFile(path);
+  WriteFile(path, data.substr(0, data.size() - 3));
+  {
+    auto log = ScheduleLog::Open(dir);
+    ASSERT_TRUE(log.ok()) << log.status();
+    EXPECT_EQ((*log)->schedule().num_trips(), 9);
+    ASSERT_TRUE((*log)->Append("carol", 23, 59, 0).ok());
+  }
+  auto restored = RestoreScheduleLog(dir);
+  ASSERT_TRUE(restored.ok()) << restored.status();
+  ASSERT_EQ(restored->num_trips(), 10);
+  EXPECT_EQ(restored->driver(restored->trip(9)), "carol");
+}
+
+TEST(ScheduleLogTest, CompactWritesSnapshotAndDropsOldLogs) {
+  const std::string dir = TempDir("log_compact");
+  {
+    auto log = ScheduleLog::Open(dir);
+    ASSERT_TRUE(log.ok()) << log.status();
+    Populate(log->get(), 50);
+    ASSERT_TRUE((*log)->Compact().ok());
+    // Appends go to the new generation while the snapshot is written.
+    ASSERT_TRUE((*log)->Append("dave", 12, 0, 0).ok());
+    ASSERT_TRUE((*log)->WaitForCompaction().ok());
+    EXPECT_EQ((*log)->generation(), 1);
+    ASSERT_TRUE((*log)->Compact().ok());
+    ASSERT_TRUE((*log)->Append("erin", 13, 0, 0).ok());
+  }
+  EXPECT_TRUE(fs::exists(dir + "/snapshot-2"));
+  EXPECT_TRUE(fs::exists(dir + "/log-2"));
+  EXPECT_FALSE(fs::exists(dir + "/snapshot-1"));
+  EXPECT_FALSE(fs::exists(dir + "/log-0"));
+  EXPECT_FALSE(fs::exists(dir + "/log-1"));
+
+  auto restored = RestoreScheduleLog(dir);
+  ASSERT_TRUE(restored.ok()) << restored.status();
+  ASSERT_EQ(restored->num_trips(), 52);
+  EXPECT_EQ(restored->driver(restored->trip(50)), "dave");
+  EXPECT_EQ(restored->driver(restored->trip(51)), "erin");
+}
+
+TEST(ScheduleLogTest, RecoversFromInterruptedCompaction) {
+  const std::string dir = TempDir("log_interrupted");
+  {
+    auto log = ScheduleLog::Open(dir);
+    ASSERT_TRUE(log.ok()) << log.status();
+    Populate(log->get(), 30);
+  }
+  const std::string old_log = ReadFile(dir + "/log-0");
+  {
+    auto log = ScheduleLog::Open(dir);
+    ASSERT_TRUE(log.ok()) << log.status();
+    ASSERT_TRUE((*log)->Compact().ok());
+    ASSERT_TRUE((*log)->Append("frank", 1, 1, 0).ok());
+  }
+  // A crash after the snapshot was renamed into place but before the old
+  // log was deleted, with a half-written snapshot of the next compaction.
+  WriteFile(dir + "/log-0", old_log);
+  WriteFile(dir + "/snapshot-2.tmp", "partial");
+
+  auto log = ScheduleLog::Open(dir);
+  ASSERT_TRUE(log.ok()) << log.status();
+  EXPECT_FALSE(fs::exists(dir + "/snapshot-2.tmp"));
+  ASSERT_EQ((*log)->schedule().num_trips(), 31);
+  EXPECT_EQ((*log)->schedule().driver((*log)->schedule().trip(30)), "frank");
+}
+
+TEST(ScheduleLogTest, MissingLogIsDataLoss) {
+  const std::string dir = TempDir("log_missing");
+  {
+    auto log = ScheduleLog::Open(dir);
+    ASSERT_TRUE(log.ok()) << log.status();
+    Populate(log->get(), 3);
+  }
+  fs::copy_file(dir + "/log-0", dir + "/log-2");
+  EXPECT_EQ(RestoreScheduleLog(dir).status().code(),
+            absl::StatusCode::kDataLoss);
+}
+
+}  // namespace
@@ -0,0 +1,211 @@
+#include "examples/boost/serialization/bus_schedule_sharded.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "boost/archive/archive_exception.hpp"
+#include "boost/archive/text_iarchive.hpp"
+
+namespace {
+
+// Runs fn(0) ... fn(n - 1) on up to `num_threads` threads.
+void ParallelFor(size_t n, int num_threads,
+                 const std::function<void(size_t)>& fn) {
+  if (num_threads <= 0) {
+    num_threads = static_cast<int>(
+        std::max(1u, std::thread::hardware_concurrency()));
+  }
+  const size_t count = std::min(n, static_cast<size_t>(num_threads));
+  std::atomic<size_t> next{0};
+  std::vector<std::thread> threads;
+  threads.reserve(count);
+  for (size_t t = 0; t < count; ++t) {
+    threads.emplace_back([&] {
+      for (size_t i; (i = next.fetch_add(1)) < n;) {
+        fn(i);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+absl::Status FirstError(const std::vector<absl::Status>& statuses) {
+  for (const absl::Status& status : statuses) {
+    if (!status.ok()) {
+      return status;
+    }
+  }
+  return absl::OkStatus();
+}
+
+void AppendGps(const GpsPosition& g, std::string* key) {
+  const int degrees = g.degrees(), minutes = g.minutes();
+  const float seconds = g.seconds();
+  key->append(reinterpret_cast<const char*>(&degrees), sizeof(degrees));
+  key->append(reinterpret_cast<const char*>(&minutes), sizeof(minutes));
+  key->append(reinterpret_cast<const char*>(&seconds), sizeof(seconds));
+}
+
+void AppendName(const std::string& name, std::string* key) {
+  const auto size = static_cast<uint32_t>(name.size());
+  key->append(reinterpret_cast<const char*>(&size), sizeof(size));
+  key->append(name);
+}
+
+// Stops are equal if their kind, position and names are.
+std::string StopKey(const BusStop& stop) {
+  std::string key;
+  AppendGps(stop.latitude(), &key);
+  AppendGps(stop.longitude(), &key);
+  if (const auto* corner = dynamic_cast<const BusStopCorner*>(&stop)) {
+    key.push_back('C');
+    AppendName(corner->street1(), &key);
+    AppendName(corner->street2(), &key);
+  } else if (const auto* destination =
+                 dynamic_cast<const BusStopDestination*>(&stop)) {
+    key.push_back('D');
+    AppendName(destination->name(), &key);
+  } else {
+    // An unknown kind is never merged with another stop.
+    key.push_back('?');
+    const BusStop* p = &stop;
+    key.append(reinterpret_cast<const char*>(&p), sizeof(p));
+  }
+  return key;
+}
+
+// The stops of all shards by StopKey(), in stripes with their own locks so
+// shards restored at the same time rarely wait for each other.
+class StopTable {
+ public:
+  // Returns the stop equal to `stop`, which is `stop` itself if it is the
+  // first of its kind. Takes ownership either way.
+  BusStop* Intern(std::unique_ptr<BusStop> stop) {
+    std::string key = StopKey(*stop);
+    Stripe& stripe = stripes_[std::hash<std::string>()(key) % kNumStripes];
+    std::lock_guard<std::mutex> lock(stripe.mu);
+    return stripe.stops.try_emplace(std::move(key), std::move(stop))
+        .first->second.get();
+  }
+
+  // Moves out all interned stops. Not thread-safe.
+  void Release(std::vector<std::unique_ptr<BusStop>>* stops) {
+    for (Stripe& stripe : stripes_) {
+      for (auto& [key, stop] : stripe.stops) {
+        stops->push_back(std::move(stop));
+      }
+      stripe.stops.clear();
+    }
+  }
+
+ private:
+  static constexpr size_t kNumStripes = 64;
+
+  struct Stripe {
+    std::mutex mu;
+    std::unordered_map<std::string, std::unique_ptr<BusStop>> stops;
+  };
+  Stripe stripes_[kNumStripes];
+};
+
+absl::Status RestoreShard(const std::string& filename, StopTable* table,
+                          BusSchedule* shard,
+                          std::vector<std::unique_ptr<BusRoute>>* routes) {
+  std::ifstream ifs(filename);
+  if (!ifs) {
+    return absl::NotFoundError(absl::StrCat("Failed to open ", filename));
+  }
+  try {
+    boost::archive::text_iarchive ia(ifs);
+    ia >> *shard;
+  } catch (const boost::archive::archive_exception& e) {
+    return absl::DataLossError(
+        absl::StrCat("Failed to restore ", filename, ": ", e.what()));
+  }
+
+  // The archive allocated each of its routes and stops once; take
+  // ownership of them, replacing the stops with the interned ones.
+  std::unordered_set<BusRoute*> seen;
+  std::unordered_map<BusStop*, BusStop*> interned;
+  for (const auto& [info, route] : shard->trips()) {
+    if (route == nullptr || !seen.insert(route).second) {
+      continue;
+    }
+    routes->emplace_back(route);
+    for (BusStop*& stop : *route->mutable_stops()) {
+      auto [it, inserted] = interned.try_emplace(stop, nullptr);
+      if (inserted) {
+        it->second = table->Intern(std::unique_ptr<BusStop>(stop));
+      }
+      stop = it->second;
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+std::vector<BusSchedule> SplitSchedule(const BusSchedule& s,
+                                       size_t num_shards) {
+  std::vector<BusSchedule> shards(num_shards);
+  if (num_shards == 0) {
+    return shards;
+  }
+  const size_t num_trips = s.trips().size();
+  size_t i = 0;
+  for (const auto& [info, route] : s.trips()) {
+    shards[i++ * num_shards / num_trips].Append(info.driver, info.hour,
+                                                info.minute, route);
+  }
+  return shards;
+}
+
+std::string ShardFileName(std::string_view prefix, size_t index,
+                          size_t num_shards) {
+  return absl::StrFormat("%s-%05d-of-%05d", prefix, index, num_shards);
+}
+
+absl::Status SaveShardedSchedule(absl::Span<const BusSchedule> shards,
+                                 std::string_view prefix, int num_threads) {
+  std::vector<absl::Status> statuses(shards.size());
+  ParallelFor(shards.size(), num_threads, [&](size_t i) {
+    statuses[i] =
+        SaveSchedule(shards[i], ShardFileName(prefix, i, shards.size()));
+  });
+  return FirstError(statuses);
+}
+
+absl::StatusOr<ShardedBusSchedule> RestoreShardedSchedule(
+    std::string_view prefix, size_t num_shards, int num_threads) {
+  StopTable table;
+  ShardedBusSchedule result;
+  result.shards.resize(num_shards);
+  std::vector<std::vector<std::unique_ptr<BusRoute>>> routes(num_shards);
+  std::vector<absl::Status> statuses(num_shards);
+  ParallelFor(num_shards, num_threads, [&](size_t i) {
+    statuses[i] = RestoreShard(ShardFileName(prefix, i, num_shards), &table,
+                               &result.shards[i], &routes[i]);
+  });
+  table.Release(&result.stops);
+  if (auto status = FirstError(statuses); !status.ok()) {
+    return status;
+  }
+  for (auto& shard_routes : routes) {
+    std::move(shard_routes.begin(), shard_routes.end(),
+              std::back_inserter(result.routes));
+  }
+  return result;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "examples/boost/serialization/bus_schedule.h"
+
+// A schedule split into shards, e.g. one per region, each saved to its own
+// text archive so the shards can be written and restored in parallel.
+//
+// Object tracking shares a stop between the routes of one archive, but each
+// archive restores its own copy. Restoring interns the stops through a
+// table shared by all shards, so equal stops (same kind, position and
+// names) in different shards end up as one object. Routes stay per shard.
+
+// Splits the trips of `s` into `num_shards` consecutive runs of nearly equal
+// size. The shards point to the same routes as `s`.
+std::vector<BusSchedule> SplitSchedule(const BusSchedule& s,
+                                       size_t num_shards);
+
+// Shard `index` of `num_shards` is stored in "<prefix>-<index>-of-<count>",
+// with both numbers padded to five digits.
+std::string ShardFileName(std::string_view prefix, size_t index,
+                          size_t num_shards);
+
+// Saves each shard with SaveSchedule() on up to `num_threads` threads, or
+// one per core if 0.
+absl::Status SaveShardedSchedule(absl::Span<const BusSchedule> shards,
+                                 std::string_view prefix, int num_threads = 0);
+
+// Restored shards together with the stops and routes they point to.
+struct ShardedBusSchedule {
+  std::vector<std::unique_ptr<BusStop>> stops;  // interned
+  std::vector<std::unique_ptr<BusRoute>> routes;
+  std::vector<BusSchedule> shards;
+};
+
+// Restores `num_shards` shards saved by SaveShardedSchedule() on up to
+// `num_threads` threads, or one per core if 0. Fails with the error of the
+// first shard that fails.
+absl::StatusOr<ShardedBusSchedule> RestoreShardedSchedule(
+    std::string_view prefix, size_t num_shards, int num_threads = 0);
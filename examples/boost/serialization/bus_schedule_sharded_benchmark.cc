@@ -0,0 +1,96 @@
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "examples/boost/serialization/bus_schedule.h"
+#include "examples/boost/serialization/bus_schedule_sharded.h"
+#include "examples/boost/serialization/synthetic_schedule.h"
+
+// How to run:
+// bazel run -c opt //examples/boost/serialization:bus_schedule_sharded_benchmark
+namespace {
+
+constexpr size_t kNumTrips = 1 << 20;
+
+std::string TempPath(const std::string& name) {
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+const SyntheticSchedule& Schedule() { return SyntheticScheduleFor(kNumTrips); }
+
+// The schedule saved as one archive, and as `num_shards` shards. Saved once
+// per shard count and shared by all benchmarks.
+std::string SavedPrefix(size_t num_shards) {
+  static auto* saved = new std::map<size_t, std::string>();
+  auto it = saved->find(num_shards);
+  if (it != saved->end()) {
+    return it->second;
+  }
+  const std::string prefix =
+      TempPath("bus_schedule_sharded_" + std::to_string(num_shards));
+  if (!SaveShardedSchedule(SplitSchedule(Schedule().schedule, num_shards),
+                           prefix)
+           .ok()) {
+    std::abort();
+  }
+  return saved->emplace(num_shards, prefix).first->second;
+}
+
+// RestoreSchedule() of the whole schedule, on one thread.
+void BM_RestoreSingle(benchmark::State& state) {
+  const std::string file = ShardFileName(SavedPrefix(1), 0, 1);
+  for (auto _ : state) {
+    auto restored = RestoreSchedule(file);
+    benchmark::DoNotOptimize(restored);
+  }
+  state.SetItemsProcessed(state.iterations() * kNumTrips);
+}
+
+// range(0) shards restored on as many threads.
+void BM_RestoreSharded(benchmark::State& state) {
+  const size_t num_shards = state.range(0);
+  const std::string prefix = SavedPrefix(num_shards);
+  for (auto _ : state) {
+    auto restored = RestoreShardedSchedule(prefix, num_shards,
+                                           static_cast<int>(num_shards));
+    if (!restored.ok()) {
+      std::abort();
+    }
+    state.counters["stops"] = static_cast<double>(restored->stops.size());
+  }
+  state.SetItemsProcessed(state.iterations() * kNumTrips);
+}
+
+void BM_SaveSharded(benchmark::State& state) {
+  const size_t num_shards = state.range(0);
+  const std::vector<BusSchedule> shards =
+      SplitSchedule(Schedule().schedule, num_shards);
+  const std::string prefix = TempPath("bus_schedule_sharded_save");
+  for (auto _ : state) {
+    if (!SaveShardedSchedule(shards, prefix, static_cast<int>(num_shards))
+             .ok()) {
+      std::abort();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumTrips);
+}
+
+BENCHMARK(BM_RestoreSingle)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_RestoreSharded)
+    ->RangeMultiplier(2)
+    ->Range(1, 32)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_SaveSharded)
+    ->RangeMultiplier(2)
+    ->Range(1, 32)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,110 @@
+#include "examples/boost/serialization/bus_schedule_sharded.h"
+
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "examples/boost/serialization/synthetic_schedule.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+std::string TempPath(const std::string& name) {
+  return ::testing::TempDir() + name;
+}
+
+TEST(ShardedScheduleTest, SplitKeepsTripOrder) {
+  const SyntheticSchedule s = MakeSyntheticSchedule(10);
+  const std::vector<BusSchedule> shards = SplitSchedule(s.schedule, 3);
+  ASSERT_EQ(shards.size(), 3);
+  EXPECT_EQ(shards[0].trips().size(), 4);
+  EXPECT_EQ(shards[1].trips().size(), 3);
+  EXPECT_EQ(shards[2].trips().size(), 3);
+  auto it = s.schedule.trips().begin();
+  for (const BusSchedule& shard : shards) {
+    for (const auto& [info, route] : shard.trips()) {
+      EXPECT_EQ(info.driver, it->first.driver);
+      EXPECT_EQ(route, it->second);
+      ++it;
+    }
+  }
+}
+
+TEST(ShardedScheduleTest, ShardFileName) {
+  EXPECT_EQ(ShardFileName("/tmp/s", 3, 16), "/tmp/s-00003-of-00016");
+}
+
+TEST(ShardedScheduleTest, RoundTripSharesStopsAcrossShards) {
+  const SyntheticSchedule s = MakeSyntheticSchedule(2000, 16);
+  const std::vector<BusSchedule> shards = SplitSchedule(s.schedule, 8);
+  const std::string prefix = TempPath("sharded_round_trip");
+  ASSERT_TRUE(SaveShardedSchedule(shards, prefix, 4).ok());
+
+  auto restored = RestoreShardedSchedule(prefix, 8, 4);
+  ASSERT_TRUE(restored.ok()) << restored.status();
+  ASSERT_EQ(restored->shards.size(), 8);
+
+  // Every shard restored its trips, with stops equal to the original ones.
+  std::set<const BusStop*> used;
+  auto it = s.schedule.trips().begin();
+  for (const BusSchedule& shard : restored->shards) {
+    for (const auto& [info, route] : shard.trips()) {
+      EXPECT_EQ(info.hour, it->first.hour);
+      EXPECT_EQ(info.minute, it->first.minute);
+      EXPECT_EQ(info.driver, it->first.driver);
+      ASSERT_EQ(route->stops().size(), it->second->stops().size());
+      auto jt = it->second->stops().begin();
+      for (const BusStop* stop : route->stops()) {
+        EXPECT_EQ(stop->latitude(), (*jt)->latitude());
+        EXPECT_EQ(stop->longitude(), (*jt)->longitude());
+        used.insert(stop);
+        ++jt;
+      }
+      ++it;
+    }
+  }
+  EXPECT_EQ(it, s.schedule.trips().end());
+
+  // Each original stop maps to exactly one restored stop, shared by all
+  // shards, and the result owns exactly those.
+  std::map<const BusStop*, const BusStop*> restored_for;
+  it = s.schedule.trips().begin();
+  for (const BusSchedule& shard : restored->shards) {
+    for (const auto& [info, route] : shard.trips()) {
+      auto jt = it->second->stops().begin();
+      for (const BusStop* stop : route->stops()) {
+        auto kt = restored_for.emplace(*jt++, stop).first;
+        EXPECT_EQ(kt->second, stop);
+      }
+      ++it;
+    }
+  }
+  EXPECT_EQ(used.size(), restored_for.size());
+  EXPECT_EQ(restored->stops.size(), used.size());
+  for (const auto& stop : restored->stops) {
+    EXPECT_EQ(used.count(stop.get()), 1);
+  }
+  // Routes are per shard: each shard restores its own copy.
+  EXPECT_GT(restored->routes.size(), 16);
+}
+
+TEST(ShardedScheduleTest, MissingShardIsNotFound) {
+  const SyntheticSchedule s = MakeSyntheticSchedule(100);
+  const std::string prefix = TempPath("sharded_missing");
+  ASSERT_TRUE(SaveShardedSchedule(SplitSchedule(s.schedule, 2), prefix).ok());
+  EXPECT_EQ(RestoreShardedSchedule(prefix, 3).status().code(),
+            absl::StatusCode::kNotFound);
+}
+
+TEST(ShardedScheduleTest, CorruptShardIsDataLoss) {
+  const SyntheticSchedule s = MakeSyntheticSchedule(100);
+  const std::string prefix = TempPath("sharded_corrupt");
+  ASSERT_TRUE(SaveShardedSchedule(SplitSchedule(s.schedule, 2), prefix).ok());
+  std::ofstream(ShardFileName(prefix, 1, 2)) << "not an archive";
+  EXPECT_EQ(RestoreShardedSchedule(prefix, 2).status().code(),
+            absl::StatusCode::kDataLoss);
+}
+
+}  // namespace
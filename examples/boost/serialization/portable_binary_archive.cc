@@ -0,0 +1,141 @@
+#include "examples/boost/serialization/portable_binary_archive.h"
+
+#include "boost/archive/archive_exception.hpp"
+#include "boost/archive/impl/archive_serializer_map.ipp"
+#include "boost/archive/impl/basic_binary_iarchive.ipp"
+#include "boost/archive/impl/basic_binary_iprimitive.ipp"
+#include "boost/archive/impl/basic_binary_oarchive.ipp"
+#include "boost/archive/impl/basic_binary_oprimitive.ipp"
+#include "boost/serialization/throw_exception.hpp"
+
+namespace {
+
+// Distinguishes these archives from binary_oarchive ones, which start with
+// the same signature.
+constexpr char kPortableSignature[] = "portable_binary";
+
+}  // namespace
+
+PortableBinaryOArchive::PortableBinaryOArchive(std::ostream& os,
+                                               unsigned int flags)
+    : basic_binary_oprimitive(*os.rdbuf(),
+                              0 != (flags & boost::archive::no_codecvt)),
+      basic_binary_oarchive(flags) {
+  init(flags);
+}
+
+void PortableBinaryOArchive::init(unsigned int flags) {
+  if (0 != (flags & boost::archive::no_header)) {
+    return;
+  }
+  save(std::string(boost::archive::BOOST_ARCHIVE_SIGNATURE()));
+  save(std::string(kPortableSignature));
+  save(boost::archive::BOOST_ARCHIVE_VERSION());
+}
+
+void PortableBinaryOArchive::SaveByte(uint8_t b) {
+  save_binary(&b, 1);
+}
+
+void PortableBinaryOArchive::SaveVarint(uint64_t v) {
+  char buf[10];
+  int n = 0;
+  for (; v >= 0x80; v >>= 7) {
+    buf[n++] = static_cast<char>(v | 0x80);
+  }
+  buf[n++] = static_cast<char>(v);
+  save_binary(buf, n);
+}
+
+void PortableBinaryOArchive::SaveFixed(uint64_t v, int bytes) {
+  char buf[8];
+  for (int i = 0; i < bytes; ++i) {
+    buf[i] = static_cast<char>(v >> (8 * i));
+  }
+  save_binary(buf, bytes);
+}
+
+PortableBinaryIArchive::PortableBinaryIArchive(std::istream& is,
+                                               unsigned int flags)
+    : basic_binary_iprimitive(*is.rdbuf(),
+                              0 != (flags & boost::archive::no_codecvt)),
+      basic_binary_iarchive(flags) {
+  init(flags);
+}
+
+void PortableBinaryIArchive::ThrowInvalid() {
+  boost::serialization::throw_exception(boost::archive::archive_exception(
+      boost::archive::archive_exception::input_stream_error,
+      "invalid portable binary value"));
+}
+
+void PortableBinaryIArchive::init(unsigned int flags) {
+  if (0 != (flags & boost::archive::no_header)) {
+    return;
+  }
+  std::string signature, portable;
+  try {
+    load(signature);
+    load(portable);
+  } catch (const boost::archive::archive_exception&) {
+    // Reported as a bad signature below.
+  }
+  if (signature != boost::archive::BOOST_ARCHIVE_SIGNATURE() ||
+      portable != kPortableSignature) {
+    boost::serialization::throw_exception(boost::archive::archive_exception(
+        boost::archive::archive_exception::invalid_signature));
+  }
+  boost::serialization::library_version_type version;
+  load(version);
+  if (version > boost::archive::BOOST_ARCHIVE_VERSION()) {
+    boost::serialization::throw_exception(boost::archive::archive_exception(
+        boost::archive::archive_exception::unsupported_version));
+  }
+  set_library_version(version);
+}
+
+uint8_t PortableBinaryIArchive::LoadByte() {
+  const auto c = m_sb.sbumpc();
+  if (c == std::char_traits<char>::eof()) {
+    boost::serialization::throw_exception(boost::archive::archive_exception(
+        boost::archive::archive_exception::input_stream_error));
+  }
+  return static_cast<uint8_t>(c);
+}
+
+uint64_t PortableBinaryIArchive::LoadVarint() {
+  uint64_t v = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    const uint8_t b = LoadByte();
+    v |= static_cast<uint64_t>(b & 0x7f) << shift;
+    if ((b & 0x80) == 0) {
+      return v;
+    }
+  }
+  ThrowInvalid();
+}
+
+uint64_t PortableBinaryIArchive::LoadFixed(int bytes) {
+  char buf[8];
+  load_binary(buf, bytes);
+  uint64_t v = 0;
+  for (int i = 0; i < bytes; ++i) {
+    v |= static_cast<uint64_t>(static_cast<uint8_t>(buf[i])) << (8 * i);
+  }
+  return v;
+}
+
+// The archive templates are compiled into the serialization library only
+// for the archives it ships.
+namespace boost::archive {
+
+template class detail::archive_serializer_map<PortableBinaryOArchive>;
+template class detail::archive_serializer_map<PortableBinaryIArchive>;
+template class basic_binary_oarchive<PortableBinaryOArchive>;
+template class basic_binary_iarchive<PortableBinaryIArchive>;
+template class basic_binary_oprimitive<PortableBinaryOArchive, char,
+                                       std::char_traits<char>>;
+template class basic_binary_iprimitive<PortableBinaryIArchive, char,
+                                       std::char_traits<char>>;
+
+}  // namespace boost::archive
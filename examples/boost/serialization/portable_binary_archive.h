@@ -0,0 +1,204 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+#include "boost/archive/basic_archive.hpp"
+#include "boost/archive/basic_binary_iarchive.hpp"
+#include "boost/archive/basic_binary_iprimitive.hpp"
+#include "boost/archive/basic_binary_oarchive.hpp"
+#include "boost/archive/basic_binary_oprimitive.hpp"
+#include "boost/archive/detail/register_archive.hpp"
+#include "boost/serialization/collection_size_type.hpp"
+#include "boost/serialization/item_version_type.hpp"
+#include "boost/serialization/library_version_type.hpp"
+
+// Binary archives which, unlike boost::archive::binary_oarchive, can be read
+// on a platform with other integer sizes or byte order than the one which
+// wrote them.
+//
+// Integers, including the archive's own class ids, versions and collection
+// sizes, are written as LEB128 varints, zigzag encoded if signed, so most
+// take one or two bytes whatever their native width. Floating point values
+// are written as their IEEE 754 bits in little-endian order. The header is
+// the archive signature, a "portable_binary" tag and the library version,
+// without the native type sizes binary_oarchive records.
+
+namespace portable_binary_internal {
+
+// What the archive's wrapper types hold: an integer, or for the reference
+// types another wrapper.
+template <class T>
+struct Wrapped;
+template <>
+struct Wrapped<boost::archive::version_type> {
+  using type = uint_least32_t;
+};
+template <>
+struct Wrapped<boost::archive::class_id_type> {
+  using type = int_least16_t;
+};
+template <>
+struct Wrapped<boost::archive::class_id_reference_type> {
+  using type = boost::archive::class_id_type;
+};
+template <>
+struct Wrapped<boost::archive::object_id_type> {
+  using type = uint_least32_t;
+};
+template <>
+struct Wrapped<boost::archive::object_reference_type> {
+  using type = boost::archive::object_id_type;
+};
+template <>
+struct Wrapped<boost::serialization::collection_size_type> {
+  using type = std::size_t;
+};
+template <>
+struct Wrapped<boost::serialization::item_version_type> {
+  using type = unsigned int;
+};
+template <>
+struct Wrapped<boost::serialization::library_version_type> {
+  using type = uint_least16_t;
+};
+
+}  // namespace portable_binary_internal
+
+class PortableBinaryOArchive
+    : public boost::archive::basic_binary_oprimitive<
+          PortableBinaryOArchive, char, std::char_traits<char>>,
+      public boost::archive::basic_binary_oarchive<PortableBinaryOArchive> {
+ public:
+  explicit PortableBinaryOArchive(std::ostream& os, unsigned int flags = 0);
+
+  // Called by the serialization library.
+  template <class T>
+  void save_override(T& t) {
+    this->basic_binary_oarchive<PortableBinaryOArchive>::save_override(t);
+  }
+
+  template <class T>
+  void save(const T& t) {
+    if constexpr (std::is_same_v<T, bool>) {
+      SaveByte(t ? 1 : 0);
+    } else if constexpr (std::is_same_v<T, float>) {
+      SaveFixed(BitsOf<uint32_t>(t), sizeof(t));
+    } else if constexpr (std::is_same_v<T, double>) {
+      SaveFixed(BitsOf<uint64_t>(t), sizeof(t));
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+      const auto v = static_cast<int64_t>(t);
+      const uint64_t sign = v < 0 ? ~uint64_t{0} : 0;
+      SaveVarint((static_cast<uint64_t>(v) << 1) ^ sign);
+    } else if constexpr (std::is_integral_v<T>) {
+      SaveVarint(static_cast<uint64_t>(t));
+    } else if constexpr (std::is_same_v<T, boost::archive::tracking_type>) {
+      save(static_cast<bool>(t));
+    } else {
+      // version_type, class_id_type, collection_size_type and the other
+      // integer wrappers.
+      save(static_cast<typename portable_binary_internal::Wrapped<T>::type>(t));
+    }
+  }
+  void save(const std::string& s) {
+    basic_binary_oprimitive<PortableBinaryOArchive, char,
+                            std::char_traits<char>>::save(s);
+  }
+
+ private:
+  template <class U, class T>
+  static U BitsOf(T t) {
+    static_assert(sizeof(U) == sizeof(T));
+    U u;
+    std::memcpy(&u, &t, sizeof(u));
+    return u;
+  }
+
+  void init(unsigned int flags);
+  void SaveByte(uint8_t b);
+  void SaveVarint(uint64_t v);
+  void SaveFixed(uint64_t v, int bytes);
+};
+
+class PortableBinaryIArchive
+    : public boost::archive::basic_binary_iprimitive<
+          PortableBinaryIArchive, char, std::char_traits<char>>,
+      public boost::archive::basic_binary_iarchive<PortableBinaryIArchive> {
+ public:
+  // Throws boost::archive::archive_exception if `is` does not start with a
+  // portable binary archive header of a supported library version.
+  explicit PortableBinaryIArchive(std::istream& is, unsigned int flags = 0);
+
+  // Called by the serialization library.
+  template <class T>
+  void load_override(T& t) {
+    this->basic_binary_iarchive<PortableBinaryIArchive>::load_override(t);
+  }
+
+  template <class T>
+  void load(T& t) {
+    if constexpr (std::is_same_v<T, bool>) {
+      const uint8_t b = LoadByte();
+      if (b > 1) {
+        ThrowInvalid();
+      }
+      t = b != 0;
+    } else if constexpr (std::is_same_v<T, float>) {
+      t = FromBits<float>(static_cast<uint32_t>(LoadFixed(sizeof(t))));
+    } else if constexpr (std::is_same_v<T, double>) {
+      t = FromBits<double>(LoadFixed(sizeof(t)));
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+      const uint64_t z = LoadVarint();
+      const auto v = static_cast<int64_t>((z >> 1) ^ (~(z & 1) + 1));
+      if (v < std::numeric_limits<T>::min() ||
+          v > std::numeric_limits<T>::max()) {
+        ThrowInvalid();
+      }
+      t = static_cast<T>(v);
+    } else if constexpr (std::is_integral_v<T>) {
+      const uint64_t v = LoadVarint();
+      if (v > std::numeric_limits<T>::max()) {
+        ThrowInvalid();
+      }
+      t = static_cast<T>(v);
+    } else if constexpr (std::is_same_v<T, boost::archive::tracking_type>) {
+      bool b;
+      load(b);
+      t = b;
+    } else {
+      typename portable_binary_internal::Wrapped<T>::type v;
+      load(v);
+      t = T(v);
+    }
+  }
+  void load(std::string& s) {
+    basic_binary_iprimitive<PortableBinaryIArchive, char,
+                            std::char_traits<char>>::load(s);
+  }
+
+ private:
+  // Reads the header through m_sb, like binary_iarchive.
+  friend class boost::archive::basic_binary_iarchive<PortableBinaryIArchive>;
+
+  template <class T, class U>
+  static T FromBits(U u) {
+    static_assert(sizeof(U) == sizeof(T));
+    T t;
+    std::memcpy(&t, &u, sizeof(t));
+    return t;
+  }
+
+  [[noreturn]] static void ThrowInvalid();
+  void init(unsigned int flags);
+  uint8_t LoadByte();
+  uint64_t LoadVarint();
+  uint64_t LoadFixed(int bytes);
+};
+
+BOOST_SERIALIZATION_REGISTER_ARCHIVE(PortableBinaryOArchive)
+BOOST_SERIALIZATION_REGISTER_ARCHIVE(PortableBinaryIArchive)
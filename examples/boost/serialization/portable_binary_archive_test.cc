@@ -0,0 +1,98 @@
+#include "examples/boost/serialization/portable_binary_archive.h"
+
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "boost/archive/archive_exception.hpp"
+#include "boost/serialization/string.hpp"
+#include "boost/serialization/vector.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(PortableBinaryArchiveTest, RoundTripsExtremes) {
+  const int8_t i8 = std::numeric_limits<int8_t>::min();
+  const int32_t i32 = -1;
+  const int64_t i64 = std::numeric_limits<int64_t>::min();
+  const uint64_t u64 = std::numeric_limits<uint64_t>::max();
+  const float f = -1.5e-30f;
+  const double d = 6.02214076e23;
+  const bool b = true;
+  const std::string s = "24th Street";
+  const std::vector<int> v = {0, 1, -1, 300, -70000};
+
+  std::stringstream ss;
+  {
+    PortableBinaryOArchive oa(ss);
+    oa << i8 << i32 << i64 << u64 << f << d << b << s << v;
+  }
+  int8_t ri8;
+  int32_t ri32;
+  int64_t ri64;
+  uint64_t ru64;
+  float rf;
+  double rd;
+  bool rb;
+  std::string rs;
+  std::vector<int> rv;
+  PortableBinaryIArchive ia(ss);
+  ia >> ri8 >> ri32 >> ri64 >> ru64 >> rf >> rd >> rb >> rs >> rv;
+  EXPECT_EQ(ri8, i8);
+  EXPECT_EQ(ri32, i32);
+  EXPECT_EQ(ri64, i64);
+  EXPECT_EQ(ru64, u64);
+  EXPECT_EQ(rf, f);
+  EXPECT_EQ(rd, d);
+  EXPECT_EQ(rb, b);
+  EXPECT_EQ(rs, s);
+  EXPECT_EQ(rv, v);
+}
+
+TEST(PortableBinaryArchiveTest, EncodingDoesNotDependOnWidth) {
+  std::stringstream narrow, wide;
+  {
+    PortableBinaryOArchive oa(narrow, boost::archive::no_header);
+    const int16_t x = -300;
+    const float y = 1.0f;
+    oa << x << y;
+  }
+  {
+    PortableBinaryOArchive oa(wide, boost::archive::no_header);
+    const int64_t x = -300;
+    const float y = 1.0f;
+    oa << x << y;
+  }
+  // zigzag(-300) = 599 = 0x257 as a varint, then 1.0f little-endian.
+  const std::string expected("\xd7\x04\x00\x00\x80\x3f", 6);
+  EXPECT_EQ(narrow.str(), expected);
+  EXPECT_EQ(wide.str(), expected);
+
+  // So a value written from one width reads back into another.
+  PortableBinaryIArchive ia(wide, boost::archive::no_header);
+  int32_t x;
+  ia >> x;
+  EXPECT_EQ(x, -300);
+}
+
+TEST(PortableBinaryArchiveTest, RejectsOutOfRangeValues) {
+  std::stringstream ss;
+  {
+    PortableBinaryOArchive oa(ss);
+    const int32_t x = 70000;
+    oa << x;
+  }
+  PortableBinaryIArchive ia(ss);
+  int16_t x;
+  EXPECT_THROW(ia >> x, boost::archive::archive_exception);
+}
+
+TEST(PortableBinaryArchiveTest, RejectsOtherArchives) {
+  std::stringstream ss("22 serialization::archive 19 0 0");
+  EXPECT_THROW(PortableBinaryIArchive ia(ss),
+               boost::archive::archive_exception);
+}
+
+}  // namespace
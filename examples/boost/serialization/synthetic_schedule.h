@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "examples/boost/serialization/bus_schedule.h"
+
+// A generated BusSchedule together with the stops and routes it points to,
+// for tests and benchmarks which need schedules far larger than the demo.
+struct SyntheticSchedule {
+  std::vector<std::unique_ptr<BusStop>> stops;
+  std::vector<std::unique_ptr<BusRoute>> routes;
+  BusSchedule schedule;
+};
+
+inline SyntheticSchedule MakeSyntheticSchedule(size_t num_trips,
+                                               size_t num_routes = 64,
+                                               size_t stops_per_route = 12,
+                                               size_t num_drivers = 256,
+                                               uint32_t seed = 42) {
+  SyntheticSchedule s;
+  std::mt19937 rng(seed);
+  const size_t num_stops = num_routes * stops_per_route / 2 + 1;
+  for (size_t i = 0; i < num_stops; ++i) {
+    const GpsPosition lat(static_cast<int>(rng() % 90),
+                          static_cast<int>(rng() % 60),
+                          static_cast<float>(rng() % 6000) / 100.0f);
+    const GpsPosition lon(static_cast<int>(rng() % 180),
+                          static_cast<int>(rng() % 60),
+                          static_cast<float>(rng() % 6000) / 100.0f);
+    if (i % 4 == 0) {
+      s.stops.push_back(std::make_unique<BusStopDestination>(
+          lat, lon, absl::StrCat("Destination ", i)));
+    } else {
+      s.stops.push_back(std::make_unique<BusStopCorner>(
+          lat, lon, absl::StrCat(i, "th Street"),
+          absl::StrCat(i % 17, "th Avenue")));
+    }
+  }
+  for (size_t r = 0; r < num_routes; ++r) {
+    auto route = std::make_unique<BusRoute>();
+    for (size_t k = 0; k < stops_per_route; ++k) {
+      route->Append(s.stops[rng() % num_stops].get());
+    }
+    s.routes.push_back(std::move(route));
+  }
+  std::vector<std::string> drivers;
+  drivers.reserve(num_drivers);
+  for (size_t d = 0; d < num_drivers; ++d) {
+    drivers.push_back(absl::StrCat("driver", d));
+  }
+  for (size_t t = 0; t < num_trips; ++t) {
+    s.schedule.Append(drivers[rng() % num_drivers],
+                      static_cast<int>(rng() % 24),
+                      static_cast<int>(rng() % 60),
+                      s.routes[rng() % num_routes].get());
+  }
+  return s;
+}
+
+// MakeSyntheticSchedule(num_trips), generated on first use and kept for the
+// life of the process, so that benchmarks sharing a size generate its
+// millions of trips only once. Not thread-safe.
+inline const SyntheticSchedule& SyntheticScheduleFor(size_t num_trips) {
+  static auto* cache =
+      new std::map<size_t, std::unique_ptr<SyntheticSchedule>>();
+  std::unique_ptr<SyntheticSchedule>& s = (*cache)[num_trips];
+  if (s == nullptr) {
+    s = std::make_unique<SyntheticSchedule>(MakeSyntheticSchedule(num_trips));
+  }
+  return *s;
+}
@@ -19,6 +19,7 @@
 
 #include "cuda/include/cublas_v2.h"
 #include "cuda/include/cuda_runtime.h"
+#include "examples/cuda/batchCUBLAS/kiss_rng.h"
 
 #define SWITCH_CHAR '-'
 
@@ -72,19 +73,9 @@ static __inline__ unsigned long long doubleAsULL(double x) {
 }
 
 static __inline__ unsigned cuRand(void) {
-  /* George Marsaglia's fast inline random number generator */
-#define CUDA_ZNEW (cuda_z = 36969 * (cuda_z & 65535) + (cuda_z >> 16))
-#define CUDA_WNEW (cuda_w = 18000 * (cuda_w & 65535) + (cuda_w >> 16))
-#define CUDA_MWC ((CUDA_ZNEW << 16) + CUDA_WNEW)
-#define CUDA_SHR3                          \
-  (cuda_jsr = cuda_jsr ^ (cuda_jsr << 17), \
-   cuda_jsr = cuda_jsr ^ (cuda_jsr >> 13), \
-   cuda_jsr = cuda_jsr ^ (cuda_jsr << 5))
-#define CUDA_CONG (cuda_jcong = 69069 * cuda_jcong + 1234567)
-#define KISS ((CUDA_MWC ^ CUDA_CONG) + CUDA_SHR3)
-  static unsigned int cuda_z = 362436069, cuda_w = 521288629;
-  static unsigned int cuda_jsr = 123456789, cuda_jcong = 380116160;
-  return KISS;
+  /* George Marsaglia's KISS generator; each thread has its own state */
+  static thread_local KissRng rng;
+  return rng.Next();
 }
 
 //============================================================================================
@@ -20,10 +20,13 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <limits>
+
 /* Using updated (v2) interfaces to cublas and cusparse */
 #include "cuda/include/cublas_v2.h"
 #include "cuda/include/cuda_runtime.h"
 #include "examples/cuda/batchCUBLAS/batchCUBLAS.h"
+#include "examples/cuda/batchCUBLAS/host_gemm.h"
 #include "examples/cuda/common/cuda_helper.h"
 
 namespace {
@@ -52,6 +55,18 @@ template void fillupMatrix<float>(float* A, int lda, int rows, int cols,
 template void fillupMatrix<double>(double* A, int lda, int rows, int cols,
                                    int seed);
 
+/* Uniform (0,1] KISS draws, filled across threads */
+template <typename T_ELEM>
+void fillupMatrix(T_ELEM* A, int lda, int rows, int cols, KissRng* rng) {
+  if (lda == rows) {
+    rng->Fill(A, (size_t)rows * cols);
+    return;
+  }
+  for (int j = 0; j < cols; j++) {
+    rng->Fill(A + (size_t)lda * j, rows);
+  }
+}
+
 /* For debugging */
 void printCuType(const char* str, float A) {
   fprintf(stdout, "%s (0x%08x, %g)", str, floatAsUInt(A), A);
@@ -79,6 +94,8 @@ void printCuType(const char* str, double A) {
     if (A) free(A);                         \
     if (B) free(B);                         \
     if (C) free(C);                         \
+    if (Cref) free(Cref);                   \
+    if (Cgpu) free(Cgpu);                   \
     for (int i = 0; i < opts.N; ++i) {      \
       if (devPtrA[i]) cudaFree(devPtrA[i]); \
       if (devPtrB[i]) cudaFree(devPtrB[i]); \
@@ -102,6 +119,7 @@ struct gemmOpts {
   testMethod test_method;
   char* elem_type;
   int N;  // number of multiplications
+  unsigned long long seed;  // fill B and C from KISS draws when nonzero
 };
 
 template <typename T_ELEM>
@@ -198,6 +216,10 @@ static int processArgs(int argc, char* argv[], struct gemmOpts* opts) {
           opts->N = (int)atol(argv[0] + 2);
           break;
 
+        case 's':
+          opts->seed = strtoull(argv[0] + 2, NULL, 10);
+          break;
+
         default:
           break;
       }
@@ -262,6 +284,38 @@ static int TESTGEN(gemm)(const struct gemmOpts* opts, int matrixM, int matrixN,
   return 0;
 }
 
+//============================================================================================
+// host reference
+//============================================================================================
+
+static inline HostGemmOp hostGemmOp(cublasOperation_t op) {
+  return (op == CUBLAS_OP_N) ? kHostGemmOpN : kHostGemmOpT;
+}
+
+template <typename T_ELEM>
+static int REFFUNC(gemm)(const struct gemmTestParams<T_ELEM>* params,
+                         const T_ELEM* A, int lda, const T_ELEM* B, int ldb,
+                         T_ELEM* C, int ldc) {
+  return host_gemm(hostGemmOp(params->transa), hostGemmOp(params->transb),
+                   params->m, params->n, params->k, params->alpha, A, lda, B,
+                   ldb, params->beta, C, ldc);
+}
+
+/* max |C - Cref| / max |Cref| over the m x n matrices */
+template <typename T_ELEM>
+static double maxRelativeError(int m, int n, const T_ELEM* C,
+                               const T_ELEM* Cref, int ldc) {
+  double diff = 0.0;
+  double ref = 0.0;
+  for (int j = 0; j < n; j++) {
+    for (int i = 0; i < m; i++) {
+      diff = fmax(diff, fabs((double)C[i + ldc * j] - Cref[i + ldc * j]));
+      ref = fmax(ref, fabs((double)Cref[i + ldc * j]));
+    }
+  }
+  return (ref > 0.0) ? diff / ref : diff;
+}
+
 template <typename T_ELEM>
 void fillupMatrixDebug(T_ELEM* A, int lda, int rows, int cols) {
   for (int j = 0; j < cols; j++) {
@@ -280,6 +334,8 @@ int test_gemm_loop(struct gemmOpts& opts, float err, double max_relative_error,
   T_ELEM* A = NULL;
   T_ELEM* B = NULL;
   T_ELEM* C = NULL;
+  T_ELEM* Cref = NULL;
+  T_ELEM* Cgpu = NULL;
   T_ELEM** devPtrA = 0;
   T_ELEM** devPtrB = 0;
   T_ELEM** devPtrC = 0;
@@ -364,8 +420,10 @@ int test_gemm_loop(struct gemmOpts& opts, float err, double max_relative_error,
   A = (T_ELEM*)malloc(matrixSizeA * sizeof(A[0]));
   B = (T_ELEM*)malloc(matrixSizeB * sizeof(B[0]));
   C = (T_ELEM*)malloc(matrixSizeC * sizeof(C[0]));
+  Cref = (T_ELEM*)malloc(matrixSizeC * sizeof(C[0]));
+  Cgpu = (T_ELEM*)malloc(matrixSizeC * sizeof(C[0]));
 
-  if ((!A) || (!B) || (!C)) {
+  if ((!A) || (!B) || (!C) || (!Cref) || (!Cgpu)) {
     CLEANUP();
     fprintf(stderr, "!!!! system memory allocation error\n");
     return CUBLASTEST_FAILED;
@@ -398,10 +456,19 @@ int test_gemm_loop(struct gemmOpts& opts, float err, double max_relative_error,
     memset(A, 0xFF, matrixSizeA * sizeof(A[0]));
     fillupMatrixDebug(A, rowsA, params.m, params.k);
     memset(B, 0xFF, matrixSizeB * sizeof(B[0]));
-    fillupMatrix(B, rowsB, params.k, params.n, 121);
+    KissRng rng(opts.seed);
+    if (opts.seed) {
+      fillupMatrix(B, rowsB, params.k, params.n, &rng);
+    } else {
+      fillupMatrix(B, rowsB, params.k, params.n, 121);
+    }
 
     if (!cuEqual(params.beta, cuGet<T_ELEM>(0))) {
-      fillupMatrix(C, rowsC, params.m, params.n);
+      if (opts.seed) {
+        fillupMatrix(C, rowsC, params.m, params.n, &rng);
+      } else {
+        fillupMatrix(C, rowsC, params.m, params.n);
+      }
     } else {
       /* fill with SNaNs to make sure ZGEMM doesn't access C */
       memset(C, 0xFF, matrixSizeC * sizeof(C[0]));
@@ -481,12 +548,46 @@ int test_gemm_loop(struct gemmOpts& opts, float err, double max_relative_error,
             opts.N * (1e-9 * flopsCoef * params.m * params.n * params.k) /
                 (stop - start));
 
+    // Every product of the batch has the same inputs, so one host product
+    // is the reference for all of them.
+    memcpy(Cref, C, matrixSizeC * sizeof(C[0]));
+    start = second();
+    if (REFFUNC(gemm)(&params, A, rowsA, B, rowsB, Cref, rowsC)) {
+      CLEANUP();
+      fprintf(stderr, "!!!! host reference gemm failed\n");
+      return CUBLASTEST_FAILED;
+    }
+    stop = second();
+    fprintf(stdout, "^^^^ host reference elapsed = %10.8f sec  GFLOPS=%g\n",
+            (stop - start),
+            (1e-9 * flopsCoef * params.m * params.n * params.k) /
+                (stop - start));
+
+    const double tolerance =
+        fmax(1, params.k) * std::numeric_limits<T_ELEM>::epsilon();
+    for (int i = 0; i < opts.N; i++) {
+      status1 = cublasGetMatrix(rowsC, colsC, sizeof(C[0]), devPtrC[i], rowsC,
+                                Cgpu, rowsC);
+      if (status1 != CUBLAS_STATUS_SUCCESS) {
+        CLEANUP();
+        fprintf(stderr, "!!!! GPU access error (read)\n");
+        return CUBLASTEST_FAILED;
+      }
+      const double relErr =
+          maxRelativeError(params.m, params.n, Cgpu, Cref, rowsC);
+      if (relErr > tolerance) {
+        fprintf(stdout, "!!!! matrix %d: relative error %g > %g\n", i, relErr,
+                tolerance);
+        errors++;
+      }
+    }
+
   }  // end while (TESTGEN..
 
   CLEANUP();
   fprintf(stdout, "@@@@ %cgemm test %s\n", *opts.elem_type,
           errors ? "FAIL" : "OK");
-  return CUBLASTEST_PASSED;
+  return errors ? CUBLASTEST_FAILED : CUBLASTEST_PASSED;
 }
 
 int main(int argc, char* argv[]) {
@@ -506,7 +607,7 @@ int main(int argc, char* argv[]) {
   if (errors) {
     fprintf(stdout,
             "\n Usage: batchcublas [-mSIZE_M] [-nSIZE_N] [-kSIZE_N] "
-            "[-NSIZE_NUM_ITERATIONS] [-qatest] [-noprompt]\n");
+            "[-NSIZE_NUM_ITERATIONS] [-sSEED] [-qatest] [-noprompt]\n");
     return CUBLASTEST_FAILED;
   }
 
@@ -0,0 +1,421 @@
+#include "examples/cuda/batchCUBLAS/host_gemm.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "examples/cuda/common/parallel_helper.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HOST_GEMM_X86 1
+#endif
+
+namespace {
+
+/*
+ * Cache blocking: a kKc x kNc panel of op(B) is packed once per thread and
+ * reused by every kMc x kKc block of op(A); the microkernel then streams
+ * an mr x kKc sliver of A against a kKc x nr sliver of B held in L1.
+ * kMc is a multiple of every mr below.
+ */
+constexpr int kMc = 128;
+constexpr int kKc = 256;
+constexpr int kNc = 2048;
+
+constexpr long long kMinFlopsPerThread = 1 << 22;
+
+/*
+ * ab = a*b, where a is an mr x kc sliver packed column by column, b a
+ * kc x nr sliver packed row by row and ab an mr x nr column-major tile.
+ */
+template <typename T>
+struct MicroKernel {
+  int mr, nr;
+  void (*fn)(int kc, const T* a, const T* b, T* ab);
+};
+
+template <typename T, int MR, int NR>
+void KernelScalar(int kc, const T* a, const T* b, T* ab) {
+  T acc[NR][MR] = {};
+  for (int p = 0; p < kc; ++p, a += MR, b += NR) {
+    for (int j = 0; j < NR; ++j) {
+      for (int i = 0; i < MR; ++i) acc[j][i] += a[i] * b[j];
+    }
+  }
+  for (int j = 0; j < NR; ++j) {
+    for (int i = 0; i < MR; ++i) ab[j * MR + i] = acc[j][i];
+  }
+}
+
+#ifdef HOST_GEMM_X86
+
+/* 8x6 doubles: two 4-row vectors per entry of b, 12 accumulators. */
+__attribute__((target("avx2,fma"))) void KernelAvx2(int kc, const double* a,
+                                                     const double* b,
+                                                     double* ab) {
+  __m256d acc[6][2];
+#pragma GCC unroll 6
+  for (int j = 0; j < 6; ++j) {
+    acc[j][0] = _mm256_setzero_pd();
+    acc[j][1] = _mm256_setzero_pd();
+  }
+  for (int p = 0; p < kc; ++p, a += 8, b += 6) {
+    const __m256d a0 = _mm256_loadu_pd(a);
+    const __m256d a1 = _mm256_loadu_pd(a + 4);
+#pragma GCC unroll 6
+    for (int j = 0; j < 6; ++j) {
+      const __m256d bj = _mm256_broadcast_sd(b + j);
+      acc[j][0] = _mm256_fmadd_pd(a0, bj, acc[j][0]);
+      acc[j][1] = _mm256_fmadd_pd(a1, bj, acc[j][1]);
+    }
+  }
+#pragma GCC unroll 6
+  for (int j = 0; j < 6; ++j) {
+    _mm256_storeu_pd(ab + j * 8, acc[j][0]);
+    _mm256_storeu_pd(ab + j * 8 + 4, acc[j][1]);
+  }
+}
+
+/* 16x6 floats. */
+__attribute__((target("avx2,fma"))) void KernelAvx2(int kc, const float* a,
+                                                     const float* b,
+                                                     float* ab) {
+  __m256 acc[6][2];
+#pragma GCC unroll 6
+  for (int j = 0; j < 6; ++j) {
+    acc[j][0] = _mm256_setzero_ps();
+    acc[j][1] = _mm256_setzero_ps();
+  }
+  for (int p = 0; p < kc; ++p, a += 16, b += 6) {
+    const __m256 a0 = _mm256_loadu_ps(a);
+    const __m256 a1 = _mm256_loadu_ps(a + 8);
+#pragma GCC unroll 6
+    for (int j = 0; j < 6; ++j) {
+      const __m256 bj = _mm256_broadcast_ss(b + j);
+      acc[j][0] = _mm256_fmadd_ps(a0, bj, acc[j][0]);
+      acc[j][1] = _mm256_fmadd_ps(a1, bj, acc[j][1]);
+    }
+  }
+#pragma GCC unroll 6
+  for (int j = 0; j < 6; ++j) {
+    _mm256_storeu_ps(ab + j * 16, acc[j][0]);
+    _mm256_storeu_ps(ab + j * 16 + 8, acc[j][1]);
+  }
+}
+
+/* 16x8 doubles: 16 accumulators. */
+__attribute__((target("avx512f"))) void KernelAvx512(int kc, const double* a,
+                                                     const double* b,
+                                                     double* ab) {
+  __m512d acc[8][2];
+#pragma GCC unroll 8
+  for (int j = 0; j < 8; ++j) {
+    acc[j][0] = _mm512_setzero_pd();
+    acc[j][1] = _mm512_setzero_pd();
+  }
+  for (int p = 0; p < kc; ++p, a += 16, b += 8) {
+    const __m512d a0 = _mm512_loadu_pd(a);
+    const __m512d a1 = _mm512_loadu_pd(a + 8);
+#pragma GCC unroll 8
+    for (int j = 0; j < 8; ++j) {
+      const __m512d bj = _mm512_set1_pd(b[j]);
+      acc[j][0] = _mm512_fmadd_pd(a0, bj, acc[j][0]);
+      acc[j][1] = _mm512_fmadd_pd(a1, bj, acc[j][1]);
+    }
+  }
+#pragma GCC unroll 8
+  for (int j = 0; j < 8; ++j) {
+    _mm512_storeu_pd(ab + j * 16, acc[j][0]);
+    _mm512_storeu_pd(ab + j * 16 + 8, acc[j][1]);
+  }
+}
+
+/* 32x8 floats. */
+__attribute__((target("avx512f"))) void KernelAvx512(int kc, const float* a,
+                                                     const float* b,
+                                                     float* ab) {
+  __m512 acc[8][2];
+#pragma GCC unroll 8
+  for (int j = 0; j < 8; ++j) {
+    acc[j][0] = _mm512_setzero_ps();
+    acc[j][1] = _mm512_setzero_ps();
+  }
+  for (int p = 0; p < kc; ++p, a += 32, b += 8) {
+    const __m512 a0 = _mm512_loadu_ps(a);
+    const __m512 a1 = _mm512_loadu_ps(a + 16);
+#pragma GCC unroll 8
+    for (int j = 0; j < 8; ++j) {
+      const __m512 bj = _mm512_set1_ps(b[j]);
+      acc[j][0] = _mm512_fmadd_ps(a0, bj, acc[j][0]);
+      acc[j][1] = _mm512_fmadd_ps(a1, bj, acc[j][1]);
+    }
+  }
+#pragma GCC unroll 8
+  for (int j = 0; j < 8; ++j) {
+    _mm512_storeu_ps(ab + j * 32, acc[j][0]);
+    _mm512_storeu_ps(ab + j * 32 + 16, acc[j][1]);
+  }
+}
+
+#endif  // HOST_GEMM_X86
+
+HostGemmKernel Resolve(HostGemmKernel kernel) {
+  if (kernel != kHostGemmAuto) return kernel;
+  if (host_gemm_kernel_supported(kHostGemmAvx512)) return kHostGemmAvx512;
+  if (host_gemm_kernel_supported(kHostGemmAvx2)) return kHostGemmAvx2;
+  return kHostGemmScalar;
+}
+
+template <typename T>
+MicroKernel<T> Select(HostGemmKernel kernel) {
+  switch (Resolve(kernel)) {
+#ifdef HOST_GEMM_X86
+    case kHostGemmAvx512:
+      return {128 / static_cast<int>(sizeof(T)), 8, KernelAvx512};
+    case kHostGemmAvx2:
+      return {64 / static_cast<int>(sizeof(T)), 6, KernelAvx2};
+#endif
+    default:
+      return {4, 4, KernelScalar<T, 4, 4>};
+  }
+}
+
+struct Shape {
+  HostGemmOp transa, transb;
+  int m, n, k;
+  int lda, ldb, ldc;
+};
+
+/* Rows ic..ic+mc, columns pc..pc+kc of op(A) as mr-row slivers. */
+template <typename T>
+void PackA(const Shape& s, const T* A, int ic, int pc, int mc, int kc, int mr,
+           T* dst) {
+  for (int ir = 0; ir < mc; ir += mr, dst += mr * kc) {
+    const int rows = std::min(mr, mc - ir);
+    if (s.transa == kHostGemmOpN) {
+      for (int p = 0; p < kc; ++p) {
+        const T* src = A + (ic + ir) + static_cast<long long>(pc + p) * s.lda;
+        T* d = dst + p * mr;
+        for (int i = 0; i < rows; ++i) d[i] = src[i];
+      }
+    } else {
+      for (int i = 0; i < rows; ++i) {
+        const T* src = A + pc + static_cast<long long>(ic + ir + i) * s.lda;
+        for (int p = 0; p < kc; ++p) dst[p * mr + i] = src[p];
+      }
+    }
+    for (int p = 0; p < kc; ++p) {
+      for (int i = rows; i < mr; ++i) dst[p * mr + i] = T(0);
+    }
+  }
+}
+
+/* Rows pc..pc+kc, columns jc..jc+nc of op(B) as nr-column slivers. */
+template <typename T>
+void PackB(const Shape& s, const T* B, int pc, int jc, int kc, int nc, int nr,
+           T* dst) {
+  for (int jr = 0; jr < nc; jr += nr, dst += nr * kc) {
+    const int cols = std::min(nr, nc - jr);
+    if (s.transb == kHostGemmOpN) {
+      for (int j = 0; j < cols; ++j) {
+        const T* src = B + pc + static_cast<long long>(jc + jr + j) * s.ldb;
+        for (int p = 0; p < kc; ++p) dst[p * nr + j] = src[p];
+      }
+    } else {
+      for (int p = 0; p < kc; ++p) {
+        const T* src = B + (jc + jr) + static_cast<long long>(pc + p) * s.ldb;
+        T* d = dst + p * nr;
+        for (int j = 0; j < cols; ++j) d[j] = src[j];
+      }
+    }
+    for (int p = 0; p < kc; ++p) {
+      for (int j = cols; j < nr; ++j) dst[p * nr + j] = T(0);
+    }
+  }
+}
+
+/* C = alpha*ab + beta*C over a rows x cols tile; C is not read if beta == 0. */
+template <typename T>
+void StoreTile(const T* ab, int mr, int rows, int cols, T alpha, T beta, T* C,
+               int ldc) {
+  for (int j = 0; j < cols; ++j) {
+    T* c = C + static_cast<long long>(j) * ldc;
+    const T* t = ab + j * mr;
+    if (beta == T(0)) {
+      for (int i = 0; i < rows; ++i) c[i] = alpha * t[i];
+    } else {
+      for (int i = 0; i < rows; ++i) c[i] = alpha * t[i] + beta * c[i];
+    }
+  }
+}
+
+/* Per-thread packing buffers. */
+template <typename T>
+struct Workspace {
+  std::vector<T> a, b;
+};
+
+/* Columns j0..j1 of one product. */
+template <typename T>
+void GemmColumns(const Shape& s, const MicroKernel<T>& uk, T alpha,
+                 const T* A, const T* B, T beta, T* C, int j0, int j1,
+                 Workspace<T>& ws) {
+  if (alpha == T(0) || s.k == 0) {
+    for (int j = j0; j < j1; ++j) {
+      T* c = C + static_cast<long long>(j) * s.ldc;
+      for (int i = 0; i < s.m; ++i) {
+        c[i] = (beta == T(0)) ? T(0) : beta * c[i];
+      }
+    }
+    return;
+  }
+  const size_t kc_max = std::min(kKc, s.k);
+  const size_t mc_max = (std::min(kMc, s.m) + uk.mr - 1) / uk.mr * uk.mr;
+  const size_t nc_max = (std::min(kNc, j1 - j0) + uk.nr - 1) / uk.nr * uk.nr;
+  if (ws.a.size() < mc_max * kc_max) ws.a.resize(mc_max * kc_max);
+  if (ws.b.size() < nc_max * kc_max) ws.b.resize(nc_max * kc_max);
+  T ab[32 * 8];
+  for (int jc = j0; jc < j1; jc += kNc) {
+    const int nc = std::min(kNc, j1 - jc);
+    for (int pc = 0; pc < s.k; pc += kKc) {
+      const int kc = std::min(kKc, s.k - pc);
+      const T beta_pc = (pc == 0) ? beta : T(1);
+      PackB(s, B, pc, jc, kc, nc, uk.nr, ws.b.data());
+      for (int ic = 0; ic < s.m; ic += kMc) {
+        const int mc = std::min(kMc, s.m - ic);
+        PackA(s, A, ic, pc, mc, kc, uk.mr, ws.a.data());
+        for (int jr = 0; jr < nc; jr += uk.nr) {
+          const T* b = ws.b.data() + static_cast<long long>(jr) * kc;
+          const int cols = std::min(uk.nr, nc - jr);
+          for (int ir = 0; ir < mc; ir += uk.mr) {
+            uk.fn(kc, ws.a.data() + static_cast<long long>(ir) * kc, b, ab);
+            StoreTile(ab, uk.mr, std::min(uk.mr, mc - ir), cols, alpha,
+                      beta_pc,
+                      C + (ic + ir) + static_cast<long long>(jc + jr) * s.ldc,
+                      s.ldc);
+          }
+        }
+      }
+    }
+  }
+}
+
+bool CheckShape(const Shape& s) {
+  const int rowsA = (s.transa == kHostGemmOpN) ? s.m : s.k;
+  const int rowsB = (s.transb == kHostGemmOpN) ? s.k : s.n;
+  return s.m >= 0 && s.n >= 0 && s.k >= 0 && s.lda >= std::max(1, rowsA) &&
+         s.ldb >= std::max(1, rowsB) && s.ldc >= std::max(1, s.m);
+}
+
+template <typename T>
+int GemmBatched(const Shape& s, T alpha, const T* const Aarray[],
+                const T* const Barray[], T beta, T* const Carray[],
+                int batchCount, int num_threads, HostGemmKernel kernel) {
+  if (!CheckShape(s) || batchCount < 0 ||
+      !host_gemm_kernel_supported(kernel)) {
+    return 1;
+  }
+  if (s.m == 0 || s.n == 0 || batchCount == 0) return 0;
+  const MicroKernel<T> uk = Select<T>(kernel);
+  num_threads = host_gemm_num_threads(s.m, s.n, s.k, batchCount, num_threads);
+
+  /* With fewer products than threads, split each one by columns too. */
+  const int parts = (batchCount >= num_threads)
+                        ? 1
+                        : (num_threads + batchCount - 1) / batchCount;
+  const int width =
+      ((s.n + parts - 1) / parts + uk.nr - 1) / uk.nr * uk.nr;
+  const int chunks = (s.n + width - 1) / width;
+  const long long items = static_cast<long long>(batchCount) * chunks;
+
+  std::atomic<long long> next{0};
+  ParallelFor(static_cast<int>(std::min<long long>(num_threads, items)),
+              [&](int) {
+                Workspace<T> ws;
+                for (long long it; (it = next.fetch_add(1)) < items;) {
+                  const int b = static_cast<int>(it / chunks);
+                  const int j0 = static_cast<int>(it % chunks) * width;
+                  GemmColumns(s, uk, alpha, Aarray[b], Barray[b], beta,
+                              Carray[b], j0, std::min(s.n, j0 + width), ws);
+                }
+              });
+  return 0;
+}
+
+}  // namespace
+
+bool host_gemm_kernel_supported(HostGemmKernel kernel) {
+  switch (kernel) {
+    case kHostGemmAuto:
+    case kHostGemmScalar:
+      return true;
+#ifdef HOST_GEMM_X86
+    case kHostGemmAvx2:
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case kHostGemmAvx512:
+      return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+      return false;
+  }
+}
+
+const char* host_gemm_kernel_name(HostGemmKernel kernel) {
+  switch (Resolve(kernel)) {
+    case kHostGemmAvx2:
+      return "avx2";
+    case kHostGemmAvx512:
+      return "avx512";
+    default:
+      return "scalar";
+  }
+}
+
+int host_gemm_num_threads(int m, int n, int k, int batchCount,
+                          int num_threads) {
+  /* Clamped so that the conversion to long long cannot overflow. */
+  const double flops =
+      std::min(2.0 * m * n * std::max(k, 1) * batchCount, 1e18);
+  return ParallelThreads(static_cast<long long>(flops), num_threads,
+                         kMinFlopsPerThread);
+}
+
+template <typename T_ELEM>
+int host_gemm(HostGemmOp transa, HostGemmOp transb, int m, int n, int k,
+              T_ELEM alpha, const T_ELEM* A, int lda, const T_ELEM* B,
+              int ldb, T_ELEM beta, T_ELEM* C, int ldc, int num_threads,
+              HostGemmKernel kernel) {
+  const Shape s = {transa, transb, m, n, k, lda, ldb, ldc};
+  return GemmBatched(s, alpha, &A, &B, beta, &C, 1, num_threads, kernel);
+}
+
+template <typename T_ELEM>
+int host_gemm_batched(HostGemmOp transa, HostGemmOp transb, int m, int n,
+                      int k, T_ELEM alpha, const T_ELEM* const Aarray[],
+                      int lda, const T_ELEM* const Barray[], int ldb,
+                      T_ELEM beta, T_ELEM* const Carray[], int ldc,
+                      int batchCount, int num_threads,
+                      HostGemmKernel kernel) {
+  const Shape s = {transa, transb, m, n, k, lda, ldb, ldc};
+  return GemmBatched(s, alpha, Aarray, Barray, beta, Carray, batchCount,
+                     num_threads, kernel);
+}
+
+/* Explicit instantiation */
+template int host_gemm<float>(HostGemmOp, HostGemmOp, int, int, int, float,
+                              const float*, int, const float*, int, float,
+                              float*, int, int, HostGemmKernel);
+template int host_gemm<double>(HostGemmOp, HostGemmOp, int, int, int, double,
+                               const double*, int, const double*, int,
+                               double, double*, int, int, HostGemmKernel);
+template int host_gemm_batched<float>(HostGemmOp, HostGemmOp, int, int, int,
+                                      float, const float* const[], int,
+                                      const float* const[], int, float,
+                                      float* const[], int, int, int,
+                                      HostGemmKernel);
+template int host_gemm_batched<double>(HostGemmOp, HostGemmOp, int, int, int,
+                                       double, const double* const[], int,
+                                       const double* const[], int, double,
+                                       double* const[], int, int, int,
+                                       HostGemmKernel);
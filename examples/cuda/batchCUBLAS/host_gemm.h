@@ -0,0 +1,65 @@
+#pragma once
+
+/*
+ * Host reference for cublas<t>gemm() and cublas<t>gemmBatched(), used by
+ * batchCUBLAS_demo.cpp to check the GPU results.
+ *
+ * Matrices are column-major as in cuBLAS. The product is blocked for the
+ * caches (panels of op(A) and op(B) are packed into contiguous buffers) and
+ * computed by a register-tiled microkernel: scalar 4x4, AVX2/FMA 8x6 for
+ * double and 16x6 for float, AVX-512 16x8 for double and 32x8 for float.
+ * The summation order depends on the kernel, but not on the thread count.
+ *
+ * All functions return 0 on success and 1 on invalid sizes, leading
+ * dimensions or a kernel the CPU does not support.
+ */
+
+enum HostGemmOp {
+  kHostGemmOpN = 0,  // op(X) = X
+  kHostGemmOpT,      // op(X) = X^T
+};
+
+enum HostGemmKernel {
+  kHostGemmAuto = 0,  // widest kernel the CPU supports
+  kHostGemmScalar,
+  kHostGemmAvx2,
+  kHostGemmAvx512,
+};
+
+/* Whether the kernel can run on this CPU; kHostGemmAuto always can. */
+bool host_gemm_kernel_supported(HostGemmKernel kernel);
+
+/* Name of the kernel kHostGemmAuto resolves to, or of kernel itself. */
+const char* host_gemm_kernel_name(HostGemmKernel kernel);
+
+/*
+ * Returns the number of threads host_gemm_batched() uses for batchCount
+ * m x n x k products.
+ */
+int host_gemm_num_threads(int m, int n, int k, int batchCount,
+                          int num_threads);
+
+/*
+ * C = alpha*op(A)*op(B) + beta*C with op(A) m x k and op(B) k x n. C is
+ * not read when beta == 0, nor A and B when alpha == 0 or k == 0.
+ * num_threads <= 0 picks one thread per hardware core, capped so that
+ * small products run serially; a single product is split by columns.
+ */
+template <typename T_ELEM>
+int host_gemm(HostGemmOp transa, HostGemmOp transb, int m, int n, int k,
+              T_ELEM alpha, const T_ELEM* A, int lda, const T_ELEM* B,
+              int ldb, T_ELEM beta, T_ELEM* C, int ldc, int num_threads = 0,
+              HostGemmKernel kernel = kHostGemmAuto);
+
+/*
+ * Carray[i] = alpha*op(Aarray[i])*op(Barray[i]) + beta*Carray[i] for
+ * i < batchCount. The products are spread across the threads; when there
+ * are fewer products than threads, each one is also split by columns.
+ */
+template <typename T_ELEM>
+int host_gemm_batched(HostGemmOp transa, HostGemmOp transb, int m, int n,
+                      int k, T_ELEM alpha, const T_ELEM* const Aarray[],
+                      int lda, const T_ELEM* const Barray[], int ldb,
+                      T_ELEM beta, T_ELEM* const Carray[], int ldc,
+                      int batchCount, int num_threads = 0,
+                      HostGemmKernel kernel = kHostGemmAuto);
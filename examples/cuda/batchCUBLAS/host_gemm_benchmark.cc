@@ -0,0 +1,107 @@
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "examples/cuda/batchCUBLAS/host_gemm.h"
+
+// How to run:
+// bazel run -c opt //examples/cuda/batchCUBLAS:host_gemm_benchmark
+namespace {
+
+// A batch of square products, as batchCUBLAS_demo.cpp runs them.
+template <typename T>
+struct Batch {
+  std::vector<std::vector<T>> a, b, c;
+  std::vector<const T*> pa, pb;
+  std::vector<T*> pc;
+
+  Batch(int size, int count) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> value(-1.0, 1.0);
+    const size_t elems = static_cast<size_t>(size) * size;
+    for (int i = 0; i < count; ++i) {
+      for (auto* v : {&a, &b, &c}) {
+        v->emplace_back(elems);
+        for (T& x : v->back()) x = static_cast<T>(value(rng));
+      }
+    }
+    for (int i = 0; i < count; ++i) {
+      pa.push_back(a[i].data());
+      pb.push_back(b[i].data());
+      pc.push_back(c[i].data());
+    }
+  }
+};
+
+void SetRate(benchmark::State& state, int size, int count) {
+  state.counters["GFLOP/s"] = benchmark::Counter(
+      2.0 * size * size * size * count * 1e-9,
+      benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// The triple loop the reference check would otherwise run.
+template <typename T>
+void BM_NaiveGemmBatched(benchmark::State& state) {
+  const int size = static_cast<int>(state.range(0));
+  const int count = static_cast<int>(state.range(1));
+  Batch<T> batch(size, count);
+  for (auto _ : state) {
+    for (int i = 0; i < count; ++i) {
+      const T* A = batch.pa[i];
+      const T* B = batch.pb[i];
+      T* C = batch.pc[i];
+      for (int j = 0; j < size; ++j) {
+        for (int r = 0; r < size; ++r) {
+          T sum = 0;
+          for (int p = 0; p < size; ++p) {
+            sum += A[r + p * size] * B[p + j * size];
+          }
+          C[r + j * size] = sum;
+        }
+      }
+    }
+    benchmark::DoNotOptimize(batch.pc.data());
+  }
+  SetRate(state, size, count);
+}
+
+// Arguments: matrix size, batch size, HostGemmKernel, threads.
+template <typename T>
+void BM_HostGemmBatched(benchmark::State& state) {
+  const int size = static_cast<int>(state.range(0));
+  const int count = static_cast<int>(state.range(1));
+  const auto kernel = static_cast<HostGemmKernel>(state.range(2));
+  const int threads = static_cast<int>(state.range(3));
+  if (!host_gemm_kernel_supported(kernel)) {
+    state.SkipWithError("kernel not supported on this CPU");
+    return;
+  }
+  Batch<T> batch(size, count);
+  for (auto _ : state) {
+    host_gemm_batched(kHostGemmOpN, kHostGemmOpN, size, size, size, T(1),
+                      batch.pa.data(), size, batch.pb.data(), size, T(0),
+                      batch.pc.data(), size, count, threads, kernel);
+    benchmark::DoNotOptimize(batch.pc.data());
+  }
+  state.SetLabel(host_gemm_kernel_name(kernel));
+  SetRate(state, size, count);
+}
+
+BENCHMARK_TEMPLATE(BM_NaiveGemmBatched, float)
+    ->ArgsProduct({{32, 128}, {1, 16, 128}});
+BENCHMARK_TEMPLATE(BM_NaiveGemmBatched, double)
+    ->ArgsProduct({{32, 128}, {1, 16, 128}});
+BENCHMARK_TEMPLATE(BM_HostGemmBatched, float)
+    ->ArgsProduct({{32, 128, 512},
+                   {1, 16, 128},
+                   {kHostGemmScalar, kHostGemmAvx2, kHostGemmAvx512},
+                   {1, 4}})
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_HostGemmBatched, double)
+    ->ArgsProduct({{32, 128, 512},
+                   {1, 16, 128},
+                   {kHostGemmScalar, kHostGemmAvx2, kHostGemmAvx512},
+                   {1, 4}})
+    ->UseRealTime();
+
+}  // namespace
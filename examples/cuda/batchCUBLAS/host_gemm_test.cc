@@ -0,0 +1,181 @@
+#include "examples/cuda/batchCUBLAS/host_gemm.h"
+
+#include <math.h>
+
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<HostGemmKernel> SupportedKernels() {
+  std::vector<HostGemmKernel> kernels;
+  for (HostGemmKernel kernel :
+       {kHostGemmScalar, kHostGemmAvx2, kHostGemmAvx512}) {
+    if (host_gemm_kernel_supported(kernel)) kernels.push_back(kernel);
+  }
+  return kernels;
+}
+
+template <typename T>
+std::vector<T> Random(size_t size, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> value(-1.0, 1.0);
+  std::vector<T> x(size);
+  for (T& v : x) v = static_cast<T>(value(rng));
+  return x;
+}
+
+/* Straightforward C = alpha*op(A)*op(B) + beta*C in long double. */
+template <typename T>
+void NaiveGemm(HostGemmOp transa, HostGemmOp transb, int m, int n, int k,
+               T alpha, const T* A, int lda, const T* B, int ldb, T beta,
+               T* C, int ldc) {
+  for (int j = 0; j < n; ++j) {
+    for (int i = 0; i < m; ++i) {
+      long double sum = 0.0;
+      for (int p = 0; p < k; ++p) {
+        const T a = (transa == kHostGemmOpN) ? A[i + p * lda] : A[p + i * lda];
+        const T b = (transb == kHostGemmOpN) ? B[p + j * ldb] : B[j + p * ldb];
+        sum += static_cast<long double>(a) * b;
+      }
+      T& c = C[i + j * ldc];
+      c = static_cast<T>(alpha * sum + (beta == T(0) ? 0.0L : beta * c));
+    }
+  }
+}
+
+class HostGemmTest : public ::testing::TestWithParam<HostGemmKernel> {};
+
+template <typename T>
+void CheckShapes(HostGemmKernel kernel) {
+  const T tol = 64 * std::numeric_limits<T>::epsilon();
+  uint32_t seed = 1;
+  // Sizes straddle the microkernel tiles and the kMc/kKc cache blocks.
+  for (int m : {1, 7, 33, 130}) {
+    for (int n : {1, 9, 50}) {
+      for (int k : {1, 17, 300}) {
+        for (HostGemmOp ta : {kHostGemmOpN, kHostGemmOpT}) {
+          for (HostGemmOp tb : {kHostGemmOpN, kHostGemmOpT}) {
+            const int lda = ((ta == kHostGemmOpN) ? m : k) + 3;
+            const int ldb = ((tb == kHostGemmOpN) ? k : n) + 1;
+            const int ldc = m + 2;
+            const std::vector<T> A = Random<T>(lda * (m + k), seed++);
+            const std::vector<T> B = Random<T>(ldb * (k + n), seed++);
+            std::vector<T> C = Random<T>(ldc * n, seed++);
+            std::vector<T> expect = C;
+            const T alpha = T(1.5), beta = T(-0.5);
+            NaiveGemm(ta, tb, m, n, k, alpha, A.data(), lda, B.data(), ldb,
+                      beta, expect.data(), ldc);
+            ASSERT_EQ(host_gemm(ta, tb, m, n, k, alpha, A.data(), lda,
+                                B.data(), ldb, beta, C.data(), ldc, 1,
+                                kernel),
+                      0);
+            for (int j = 0; j < n; ++j) {
+              for (int i = 0; i < ldc; ++i) {
+                const T bound = (i < m) ? tol * k : T(0);
+                ASSERT_NEAR(C[i + j * ldc], expect[i + j * ldc], bound)
+                    << "m=" << m << " n=" << n << " k=" << k << " ta=" << ta
+                    << " tb=" << tb << " i=" << i << " j=" << j;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST_P(HostGemmTest, MatchesNaiveDouble) { CheckShapes<double>(GetParam()); }
+
+TEST_P(HostGemmTest, MatchesNaiveFloat) { CheckShapes<float>(GetParam()); }
+
+TEST_P(HostGemmTest, BetaZeroDoesNotReadC) {
+  const int m = 20, n = 13, k = 5;
+  const std::vector<double> A = Random<double>(m * k, 1);
+  const std::vector<double> B = Random<double>(k * n, 2);
+  std::vector<double> C(m * n, std::numeric_limits<double>::quiet_NaN());
+  std::vector<double> expect(m * n);
+  NaiveGemm(kHostGemmOpN, kHostGemmOpN, m, n, k, 2.0, A.data(), m, B.data(),
+            k, 0.0, expect.data(), m);
+  ASSERT_EQ(host_gemm(kHostGemmOpN, kHostGemmOpN, m, n, k, 2.0, A.data(), m,
+                      B.data(), k, 0.0, C.data(), m, 1, GetParam()),
+            0);
+  for (int e = 0; e < m * n; ++e) EXPECT_NEAR(C[e], expect[e], 1e-13);
+}
+
+TEST_P(HostGemmTest, AlphaZeroOnlyScalesC) {
+  const int m = 6, n = 4, k = 3;
+  const std::vector<double> nan(m * k,
+                                std::numeric_limits<double>::quiet_NaN());
+  std::vector<double> C(m * n, 2.0);
+  ASSERT_EQ(host_gemm(kHostGemmOpN, kHostGemmOpN, m, n, k, 0.0, nan.data(),
+                      m, nan.data(), k, 3.0, C.data(), m, 1, GetParam()),
+            0);
+  for (double c : C) EXPECT_EQ(c, 6.0);
+}
+
+TEST_P(HostGemmTest, BatchedMatchesSingleForAnyThreadCount) {
+  const int m = 45, n = 70, k = 33, batch = 5;
+  std::vector<std::vector<float>> A, B, C0;
+  for (int b = 0; b < batch; ++b) {
+    A.push_back(Random<float>(m * k, 10 + b));
+    B.push_back(Random<float>(k * n, 20 + b));
+    C0.push_back(Random<float>(m * n, 30 + b));
+  }
+  std::vector<std::vector<float>> expect = C0;
+  for (int b = 0; b < batch; ++b) {
+    ASSERT_EQ(host_gemm(kHostGemmOpT, kHostGemmOpN, m, n, k, 1.0f,
+                        A[b].data(), k, B[b].data(), k, 0.25f,
+                        expect[b].data(), m, 1, GetParam()),
+              0);
+  }
+  for (int threads : {1, 2, 3, 8, 16}) {
+    std::vector<std::vector<float>> C = C0;
+    std::vector<const float*> pa, pb;
+    std::vector<float*> pc;
+    for (int b = 0; b < batch; ++b) {
+      pa.push_back(A[b].data());
+      pb.push_back(B[b].data());
+      pc.push_back(C[b].data());
+    }
+    ASSERT_EQ(host_gemm_batched(kHostGemmOpT, kHostGemmOpN, m, n, k, 1.0f,
+                                pa.data(), k, pb.data(), k, 0.25f, pc.data(),
+                                m, batch, threads, GetParam()),
+              0);
+    // Column splitting keeps every sum in the same order.
+    EXPECT_EQ(C, expect) << threads << " threads";
+  }
+}
+
+TEST(HostGemmValidationTest, RejectsBadArguments) {
+  std::vector<double> x(16, 1.0);
+  EXPECT_NE(host_gemm(kHostGemmOpN, kHostGemmOpN, -1, 2, 2, 1.0, x.data(), 1,
+                      x.data(), 2, 0.0, x.data(), 1),
+            0);
+  // lda < m
+  EXPECT_NE(host_gemm(kHostGemmOpN, kHostGemmOpN, 4, 2, 2, 1.0, x.data(), 3,
+                      x.data(), 2, 0.0, x.data(), 4),
+            0);
+  // ldb < n for op(B) = B^T
+  EXPECT_NE(host_gemm(kHostGemmOpN, kHostGemmOpT, 2, 4, 2, 1.0, x.data(), 2,
+                      x.data(), 2, 0.0, x.data(), 2),
+            0);
+  // Nothing to do is fine.
+  EXPECT_EQ(host_gemm(kHostGemmOpN, kHostGemmOpN, 0, 0, 0, 1.0, x.data(), 1,
+                      x.data(), 1, 0.0, x.data(), 1),
+            0);
+}
+
+INSTANTIATE_TEST_SUITE_P(Kernels, HostGemmTest,
+                         ::testing::ValuesIn(SupportedKernels()),
+                         [](const ::testing::TestParamInfo<HostGemmKernel>&
+                                info) {
+                           return std::string(
+                               host_gemm_kernel_name(info.param));
+                         });
+
+}  // namespace
@@ -0,0 +1,290 @@
+#include "examples/cuda/batchCUBLAS/kiss_rng.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "examples/cuda/common/parallel_helper.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KISS_RNG_X86 1
+#endif
+
+namespace {
+
+/* Moduli of the multiply-with-carry halves, a*2^16 - 1. */
+constexpr uint64_t kModZ = 36969ull * 65536 - 1;
+constexpr uint64_t kModW = 18000ull * 65536 - 1;
+
+/* Lane l of Fill() starts l << kLaneShift draws ahead. */
+constexpr int kLaneShift = 40;
+
+constexpr long long kMinValuesPerThread = 1 << 18;
+
+uint64_t SplitMix64(uint64_t* x) {
+  uint64_t z = (*x += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+uint32_t Shr3(uint32_t jsr) {
+  jsr ^= jsr << 17;
+  jsr ^= jsr >> 13;
+  jsr ^= jsr << 5;
+  return jsr;
+}
+
+/* v times the GF(2) matrix whose column j is cols[j]. */
+uint32_t MatVec(const uint32_t* cols, uint32_t v) {
+  uint32_t r = 0;
+  for (; v != 0; v &= v - 1) r ^= cols[__builtin_ctz(v)];
+  return r;
+}
+
+/* kKissLanes generator states side by side. */
+struct Lanes {
+  uint32_t z[kKissLanes], w[kKissLanes], jsr[kKissLanes], jcong[kKissLanes];
+};
+
+inline void Convert(uint32_t r, uint32_t* x) { *x = r; }
+inline void Convert(uint32_t r, float* x) {
+  *x = static_cast<float>((r >> 8) + 1) * 0x1p-24f;
+}
+inline void Convert(uint32_t r, double* x) { *x = (r + 1.0) * 0x1p-32; }
+
+/* Writes steps rows of kKissLanes values. */
+template <typename T>
+void StepsScalar(Lanes* s, T* x, size_t steps) {
+  for (size_t t = 0; t < steps; ++t, x += kKissLanes) {
+    for (int l = 0; l < kKissLanes; ++l) {
+      s->z[l] = 36969 * (s->z[l] & 65535) + (s->z[l] >> 16);
+      s->w[l] = 18000 * (s->w[l] & 65535) + (s->w[l] >> 16);
+      s->jsr[l] = Shr3(s->jsr[l]);
+      s->jcong[l] = 69069 * s->jcong[l] + 1234567;
+      Convert((((s->z[l] << 16) + s->w[l]) ^ s->jcong[l]) + s->jsr[l], x + l);
+    }
+  }
+}
+
+#ifdef KISS_RNG_X86
+
+__attribute__((target("avx2"))) inline void StoreAvx2(__m256i r,
+                                                      uint32_t* x) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(x), r);
+}
+
+__attribute__((target("avx2"))) inline void StoreAvx2(__m256i r, float* x) {
+  const __m256i top = _mm256_add_epi32(_mm256_srli_epi32(r, 8),
+                                       _mm256_set1_epi32(1));
+  _mm256_storeu_ps(x, _mm256_mul_ps(_mm256_cvtepi32_ps(top),
+                                    _mm256_set1_ps(0x1p-24f)));
+}
+
+/* Unsigned to double through the signed conversion: (r - 2^31) + 2^31. */
+__attribute__((target("avx2"))) inline void StoreAvx2(__m256i r, double* x) {
+  const __m256i flipped =
+      _mm256_xor_si256(r, _mm256_set1_epi32(static_cast<int>(0x80000000u)));
+  const __m256d offset = _mm256_set1_pd(2147483648.0 + 1.0);
+  const __m256d scale = _mm256_set1_pd(0x1p-32);
+  const __m256d lo =
+      _mm256_add_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(flipped)),
+                    offset);
+  const __m256d hi =
+      _mm256_add_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(flipped, 1)),
+                    offset);
+  _mm256_storeu_pd(x, _mm256_mul_pd(lo, scale));
+  _mm256_storeu_pd(x + 4, _mm256_mul_pd(hi, scale));
+}
+
+template <typename T>
+__attribute__((target("avx2"))) void StepsAvx2(Lanes* s, T* x,
+                                               size_t steps) {
+  static_assert(kKissLanes == 8, "one AVX2 vector per step");
+  const __m256i lo16 = _mm256_set1_epi32(65535);
+  __m256i z = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s->z));
+  __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s->w));
+  __m256i jsr = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s->jsr));
+  __m256i jcong =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s->jcong));
+  for (size_t t = 0; t < steps; ++t, x += kKissLanes) {
+    z = _mm256_add_epi32(
+        _mm256_mullo_epi32(_mm256_and_si256(z, lo16), _mm256_set1_epi32(36969)),
+        _mm256_srli_epi32(z, 16));
+    w = _mm256_add_epi32(
+        _mm256_mullo_epi32(_mm256_and_si256(w, lo16), _mm256_set1_epi32(18000)),
+        _mm256_srli_epi32(w, 16));
+    jsr = _mm256_xor_si256(jsr, _mm256_slli_epi32(jsr, 17));
+    jsr = _mm256_xor_si256(jsr, _mm256_srli_epi32(jsr, 13));
+    jsr = _mm256_xor_si256(jsr, _mm256_slli_epi32(jsr, 5));
+    jcong = _mm256_add_epi32(
+        _mm256_mullo_epi32(jcong, _mm256_set1_epi32(69069)),
+        _mm256_set1_epi32(1234567));
+    const __m256i mwc = _mm256_add_epi32(_mm256_slli_epi32(z, 16), w);
+    StoreAvx2(_mm256_add_epi32(_mm256_xor_si256(mwc, jcong), jsr), x);
+  }
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(s->z), z);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(s->w), w);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(s->jsr), jsr);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(s->jcong), jcong);
+}
+
+#endif  // KISS_RNG_X86
+
+KissFillKernel Resolve(KissFillKernel kernel) {
+  if (kernel != kKissFillAuto) return kernel;
+  if (kiss_fill_kernel_supported(kKissFillAvx2)) return kKissFillAvx2;
+  return kKissFillScalar;
+}
+
+template <typename T>
+void Steps(KissFillKernel kernel, Lanes* s, T* x, size_t steps) {
+#ifdef KISS_RNG_X86
+  if (kernel == kKissFillAvx2) {
+    StepsAvx2(s, x, steps);
+    return;
+  }
+#endif
+  StepsScalar(s, x, steps);
+}
+
+int NumThreads(size_t n, int num_threads) {
+  num_threads = ParallelThreads(static_cast<long long>(n), num_threads,
+                                kMinValuesPerThread);
+  const size_t steps = (n + kKissLanes - 1) / kKissLanes;
+  return static_cast<int>(
+      std::max<size_t>(1, std::min<size_t>(num_threads, steps)));
+}
+
+}  // namespace
+
+/* 2^b steps of the generator, for b < 128. */
+struct KissRng::Jump {
+  uint32_t shr3[32];  // column j is SHR3^n(1 << j)
+  uint64_t mz, mw;    // a^n mod a*2^16 - 1
+  uint32_t ca, cc;    // jcong -> ca*jcong + cc
+
+  static const Jump* Table() {
+    static const std::vector<Jump>* table = [] {
+      auto* t = new std::vector<Jump>(128);
+      Jump& one = (*t)[0];
+      for (int j = 0; j < 32; ++j) one.shr3[j] = Shr3(1u << j);
+      one.mz = 36969;
+      one.mw = 18000;
+      one.ca = 69069;
+      one.cc = 1234567;
+      for (int b = 1; b < 128; ++b) (*t)[b] = (*t)[b - 1].Squared();
+      return t;
+    }();
+    return table->data();
+  }
+
+  Jump Squared() const {
+    Jump sq;
+    for (int j = 0; j < 32; ++j) sq.shr3[j] = MatVec(shr3, shr3[j]);
+    sq.mz = mz * mz % kModZ;
+    sq.mw = mw * mw % kModW;
+    sq.ca = ca * ca;
+    sq.cc = ca * cc + cc;
+    return sq;
+  }
+
+  void Apply(KissRng* rng) const {
+    rng->z_ = static_cast<uint32_t>(rng->z_ * mz % kModZ);
+    rng->w_ = static_cast<uint32_t>(rng->w_ * mw % kModW);
+    rng->jsr_ = MatVec(shr3, rng->jsr_);
+    rng->jcong_ = ca * rng->jcong_ + cc;
+  }
+};
+
+KissRng::KissRng()
+    : z_(362436069), w_(521288629), jsr_(123456789), jcong_(380116160) {}
+
+KissRng::KissRng(uint64_t seed) {
+  /* The multiply-with-carry halves must lie in [1, a*2^16 - 2] and SHR3
+   * must not be 0, or the component gets stuck. */
+  z_ = static_cast<uint32_t>(1 + SplitMix64(&seed) % (kModZ - 1));
+  w_ = static_cast<uint32_t>(1 + SplitMix64(&seed) % (kModW - 1));
+  do {
+    jsr_ = static_cast<uint32_t>(SplitMix64(&seed));
+  } while (jsr_ == 0);
+  jcong_ = static_cast<uint32_t>(SplitMix64(&seed));
+}
+
+void KissRng::Discard(uint64_t n) {
+  const Jump* table = Jump::Table();
+  for (int b = 0; n != 0; ++b, n >>= 1) {
+    if (n & 1) table[b].Apply(this);
+  }
+}
+
+KissRng KissRng::Substream(uint64_t index) const {
+  const Jump* table = Jump::Table();
+  KissRng rng = *this;
+  for (int b = 64; index != 0; ++b, index >>= 1) {
+    if (index & 1) table[b].Apply(&rng);
+  }
+  return rng;
+}
+
+template <typename T>
+int KissRng::FillImpl(T* x, size_t n, int num_threads,
+                      KissFillKernel kernel) {
+  if (!kiss_fill_kernel_supported(kernel)) return 1;
+  kernel = Resolve(kernel);
+  const size_t steps = (n + kKissLanes - 1) / kKissLanes;
+  const size_t full_steps = n / kKissLanes;
+  num_threads = NumThreads(n, num_threads);
+  ParallelFor(num_threads, [&](int t) {
+    const size_t s0 = steps * t / num_threads;
+    const size_t s1 = steps * (t + 1) / num_threads;
+    if (s0 == s1) return;
+    Lanes lanes;
+    for (int l = 0; l < kKissLanes; ++l) {
+      KissRng rng = *this;
+      rng.Discard((static_cast<uint64_t>(l) << kLaneShift) + s0);
+      lanes.z[l] = rng.z_;
+      lanes.w[l] = rng.w_;
+      lanes.jsr[l] = rng.jsr_;
+      lanes.jcong[l] = rng.jcong_;
+    }
+    const size_t end = std::min(s1, full_steps);
+    Steps(kernel, &lanes, x + s0 * kKissLanes, end - s0);
+    if (end < s1) {
+      T tail[kKissLanes];
+      Steps(kernel, &lanes, tail, 1);
+      std::copy(tail, tail + (n - end * kKissLanes), x + end * kKissLanes);
+    }
+  });
+  Discard(steps);
+  return 0;
+}
+
+int KissRng::Fill(uint32_t* x, size_t n, int num_threads,
+                  KissFillKernel kernel) {
+  return FillImpl(x, n, num_threads, kernel);
+}
+
+int KissRng::Fill(float* x, size_t n, int num_threads,
+                  KissFillKernel kernel) {
+  return FillImpl(x, n, num_threads, kernel);
+}
+
+int KissRng::Fill(double* x, size_t n, int num_threads,
+                  KissFillKernel kernel) {
+  return FillImpl(x, n, num_threads, kernel);
+}
+
+bool kiss_fill_kernel_supported(KissFillKernel kernel) {
+  switch (kernel) {
+    case kKissFillAuto:
+    case kKissFillScalar:
+      return true;
+#ifdef KISS_RNG_X86
+    case kKissFillAvx2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+/*
+ * George Marsaglia's KISS generator, as in cuRand(), with its state in an
+ * object instead of function-local statics.
+ *
+ * Every component of KISS is linear, so the generator jumps ahead n draws
+ * in O(log n): the congruential part is affine mod 2^32, SHR3 is a 32x32
+ * matrix over GF(2), and each multiply-with-carry half steps as z -> a*z
+ * mod a*2^16 - 1. Substream(i) starts i*2^64 draws further on, which gives
+ * independent per-thread or per-stream generators.
+ *
+ * Fill() runs kKissLanes copies of the generator side by side, lane l
+ * starting l*2^40 draws ahead, and writes them interleaved: element i is
+ * draw i / kKissLanes of lane i % kKissLanes. The output depends on the
+ * state only, not on the thread count or the kernel.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+constexpr int kKissLanes = 8;
+
+enum KissFillKernel {
+  kKissFillAuto = 0,  // widest kernel the CPU supports
+  kKissFillScalar,
+  kKissFillAvx2,
+};
+
+/* Whether the kernel can run on this CPU; kKissFillAuto always can. */
+bool kiss_fill_kernel_supported(KissFillKernel kernel);
+
+class KissRng {
+ public:
+  /* The state cuRand() starts from. */
+  KissRng();
+  /* A state derived from seed by SplitMix64. */
+  explicit KissRng(uint64_t seed);
+
+  uint32_t Next() {
+    z_ = 36969 * (z_ & 65535) + (z_ >> 16);
+    w_ = 18000 * (w_ & 65535) + (w_ >> 16);
+    jsr_ ^= jsr_ << 17;
+    jsr_ ^= jsr_ >> 13;
+    jsr_ ^= jsr_ << 5;
+    jcong_ = 69069 * jcong_ + 1234567;
+    return (((z_ << 16) + w_) ^ jcong_) + jsr_;
+  }
+
+  /* Skips n draws in O(log n). */
+  void Discard(uint64_t n);
+
+  /* A copy of this generator index*2^64 draws ahead. */
+  KissRng Substream(uint64_t index) const;
+
+  /*
+   * Fills x[0..n) as described above and advances this generator by
+   * ceil(n / kKissLanes) draws, so consecutive fills of multiples of
+   * kKissLanes continue one sequence. Floats and doubles are uniform on
+   * (0, 1], from the top 24 bits and all 32 bits of each draw. num_threads
+   * <= 0 picks one thread per hardware core, capped so that small fills
+   * run serially. Returns 0 on success, 1 on an unsupported kernel.
+   */
+  int Fill(uint32_t* x, size_t n, int num_threads = 0,
+           KissFillKernel kernel = kKissFillAuto);
+  int Fill(float* x, size_t n, int num_threads = 0,
+           KissFillKernel kernel = kKissFillAuto);
+  int Fill(double* x, size_t n, int num_threads = 0,
+           KissFillKernel kernel = kKissFillAuto);
+
+  bool operator==(const KissRng& other) const {
+    return z_ == other.z_ && w_ == other.w_ && jsr_ == other.jsr_ &&
+           jcong_ == other.jcong_;
+  }
+  bool operator!=(const KissRng& other) const { return !(*this == other); }
+
+ private:
+  struct Jump;  // n steps of every component
+
+  template <typename T>
+  int FillImpl(T* x, size_t n, int num_threads, KissFillKernel kernel);
+
+  uint32_t z_, w_;  // multiply-with-carry halves
+  uint32_t jsr_;    // SHR3
+  uint32_t jcong_;  // CONG
+};
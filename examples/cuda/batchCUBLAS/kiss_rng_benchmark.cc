@@ -0,0 +1,52 @@
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "examples/cuda/batchCUBLAS/kiss_rng.h"
+
+// How to run:
+// bazel run -c opt //examples/cuda/batchCUBLAS:kiss_rng_benchmark
+namespace {
+
+// One draw per call, converted the way fillupMatrix would.
+void BM_NextLoop(benchmark::State& state) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  std::vector<double> x(n);
+  KissRng rng(1);
+  for (auto _ : state) {
+    for (size_t i = 0; i < n; ++i) x[i] = (rng.Next() + 1.0) * 0x1p-32;
+    benchmark::DoNotOptimize(x.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetBytesProcessed(state.iterations() * n * sizeof(double));
+}
+
+// Arguments: values, KissFillKernel, threads.
+template <typename T>
+void BM_Fill(benchmark::State& state) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  const auto kernel = static_cast<KissFillKernel>(state.range(1));
+  const int threads = static_cast<int>(state.range(2));
+  if (!kiss_fill_kernel_supported(kernel)) {
+    state.SkipWithError("kernel not supported on this CPU");
+    return;
+  }
+  std::vector<T> x(n);
+  KissRng rng(1);
+  for (auto _ : state) {
+    rng.Fill(x.data(), n, threads, kernel);
+    benchmark::DoNotOptimize(x.data());
+  }
+  state.SetLabel(kernel == kKissFillAvx2 ? "avx2" : "scalar");
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetBytesProcessed(state.iterations() * n * sizeof(T));
+}
+
+const std::vector<std::vector<int64_t>> kArgs = {
+    {1 << 14, 1 << 24}, {kKissFillScalar, kKissFillAvx2}, {1, 4}};
+
+BENCHMARK(BM_NextLoop)->Arg(1 << 14)->Arg(1 << 24);
+BENCHMARK_TEMPLATE(BM_Fill, uint32_t)->ArgsProduct(kArgs)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Fill, float)->ArgsProduct(kArgs)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Fill, double)->ArgsProduct(kArgs)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,127 @@
+#include "examples/cuda/batchCUBLAS/kiss_rng.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+// The generator cuRand() used to inline, state and all.
+struct LegacyKiss {
+  unsigned int z = 362436069, w = 521288629;
+  unsigned int jsr = 123456789, jcong = 380116160;
+  unsigned int operator()() {
+    z = 36969 * (z & 65535) + (z >> 16);
+    w = 18000 * (w & 65535) + (w >> 16);
+    const unsigned int mwc = (z << 16) + w;
+    jsr = jsr ^ (jsr << 17);
+    jsr = jsr ^ (jsr >> 13);
+    jsr = jsr ^ (jsr << 5);
+    jcong = 69069 * jcong + 1234567;
+    return (mwc ^ jcong) + jsr;
+  }
+};
+
+std::vector<KissFillKernel> SupportedKernels() {
+  std::vector<KissFillKernel> kernels;
+  for (KissFillKernel kernel : {kKissFillScalar, kKissFillAvx2}) {
+    if (kiss_fill_kernel_supported(kernel)) kernels.push_back(kernel);
+  }
+  return kernels;
+}
+
+TEST(KissRngTest, DefaultStateMatchesCuRand) {
+  LegacyKiss legacy;
+  KissRng rng;
+  for (int i = 0; i < 100000; ++i) ASSERT_EQ(rng.Next(), legacy()) << i;
+}
+
+TEST(KissRngTest, DiscardMatchesStepping) {
+  for (uint64_t n : {0ull, 1ull, 7ull, 1000ull, 123457ull, 3000001ull}) {
+    KissRng stepped(42), jumped(42);
+    for (uint64_t i = 0; i < n; ++i) stepped.Next();
+    jumped.Discard(n);
+    EXPECT_EQ(jumped, stepped) << n;
+    EXPECT_EQ(jumped.Next(), stepped.Next()) << n;
+  }
+}
+
+TEST(KissRngTest, SeedsAndSubstreamsDiffer) {
+  const KissRng a(1), b(2);
+  EXPECT_NE(a, b);
+  EXPECT_EQ(a.Substream(0), a);
+  EXPECT_NE(a.Substream(1), a);
+  EXPECT_EQ(a.Substream(1).Substream(2), a.Substream(3));
+
+  // Jumps compose: 2^64 draws are 2^32 jumps of 2^32.
+  KissRng c = a;
+  for (int i = 0; i < 4; ++i) c.Discard(1ull << 62);
+  EXPECT_EQ(c, a.Substream(1));
+}
+
+class KissFillTest : public ::testing::TestWithParam<KissFillKernel> {};
+
+TEST_P(KissFillTest, InterleavesLanes) {
+  const size_t n = 8 * 1000 + 5;
+  KissRng rng(7);
+  std::vector<uint32_t> x(n);
+  ASSERT_EQ(rng.Fill(x.data(), n, 1, GetParam()), 0);
+
+  for (int l = 0; l < kKissLanes; ++l) {
+    KissRng lane(7);
+    lane.Discard(static_cast<uint64_t>(l) << 40);
+    for (size_t i = l; i < n; i += kKissLanes) {
+      ASSERT_EQ(x[i], lane.Next()) << "lane " << l << " i " << i;
+    }
+  }
+
+  // The generator moved on by one draw per row.
+  KissRng expect(7);
+  expect.Discard((n + kKissLanes - 1) / kKissLanes);
+  EXPECT_EQ(rng, expect);
+}
+
+TEST_P(KissFillTest, SameOutputForAnyThreadCount) {
+  const size_t n = 100003;
+  std::vector<double> serial(n);
+  KissRng rng(9);
+  ASSERT_EQ(rng.Fill(serial.data(), n, 1, GetParam()), 0);
+  for (int threads : {2, 3, 7, 16}) {
+    std::vector<double> x(n);
+    KissRng again(9);
+    ASSERT_EQ(again.Fill(x.data(), n, threads, GetParam()), 0);
+    EXPECT_EQ(x, serial) << threads << " threads";
+    EXPECT_EQ(again, rng);
+  }
+}
+
+TEST_P(KissFillTest, UnitIntervalMatchesScalar) {
+  const size_t n = 4099;
+  std::vector<uint32_t> raw(n);
+  std::vector<float> f(n);
+  std::vector<double> d(n);
+  KissRng a(11), b(11), c(11);
+  ASSERT_EQ(a.Fill(raw.data(), n, 1, kKissFillScalar), 0);
+  ASSERT_EQ(b.Fill(f.data(), n, 1, GetParam()), 0);
+  ASSERT_EQ(c.Fill(d.data(), n, 1, GetParam()), 0);
+  for (size_t i = 0; i < n; ++i) {
+    EXPECT_EQ(f[i], static_cast<float>((raw[i] >> 8) + 1) / 16777216.0f);
+    EXPECT_EQ(d[i], (raw[i] + 1.0) / 4294967296.0);
+    EXPECT_GT(f[i], 0.0f);
+    EXPECT_LE(f[i], 1.0f);
+    EXPECT_GT(d[i], 0.0);
+    EXPECT_LE(d[i], 1.0);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Kernels, KissFillTest,
+                         ::testing::ValuesIn(SupportedKernels()),
+                         [](const ::testing::TestParamInfo<KissFillKernel>&
+                                info) {
+                           return std::string(info.param == kKissFillAvx2
+                                                  ? "avx2"
+                                                  : "scalar");
+                         });
+
+}  // namespace
@@ -0,0 +1,360 @@
+#include "examples/cuda/common/compare_helper.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+#include <vector>
+
+#include "examples/cuda/common/parallel_helper.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COMPARE_HELPER_X86 1
+#endif
+
+namespace {
+
+/* As compareDataAsFloatThreshold(): epsilon 0 still allows this much. */
+constexpr float kMinEpsilonError = 1e-3f;
+
+/* Running statistics of part of a chunk. */
+struct Acc {
+  size_t error_count = 0;
+  float max_abs_error = 0.0f;
+  double sum_sq_error = 0.0;
+  double sum_sq_ref = 0.0;
+  long long first_mismatch = -1; /* relative to the start of the chunk */
+};
+
+/* Elements mismatch when !(|ref - src| < epsilon) if kStrict and when
+ * !(|ref - src| <= epsilon) otherwise, so NaNs always mismatch. The
+ * difference is computed in float, as in compareData(). */
+template <typename T, bool kStrict>
+void CompareScalar(const T* ref, const T* src, size_t n, float epsilon,
+                   size_t base, Acc* acc) {
+  for (size_t i = 0; i < n; ++i) {
+    const float r = static_cast<float>(ref[i]);
+    const float diff = fabsf(r - static_cast<float>(src[i]));
+    if (!(kStrict ? diff < epsilon : diff <= epsilon)) {
+      if (acc->first_mismatch < 0) acc->first_mismatch = base + i;
+      ++acc->error_count;
+    }
+    if (diff > acc->max_abs_error) acc->max_abs_error = diff;
+    acc->sum_sq_error += (double)diff * diff;
+    acc->sum_sq_ref += (double)r * r;
+  }
+}
+
+#ifdef COMPARE_HELPER_X86
+
+__attribute__((target("avx2"))) inline __m256 Load8(const float* x) {
+  return _mm256_loadu_ps(x);
+}
+
+/* Exact conversion of unsigned ints: both halves convert exactly and the
+ * sum rounds once. */
+__attribute__((target("avx2"))) inline __m256 Load8(const unsigned int* x) {
+  const __m256i v = _mm256_loadu_si256((const __m256i*)x);
+  const __m256 hi = _mm256_cvtepi32_ps(_mm256_srli_epi32(v, 16));
+  const __m256 lo = _mm256_cvtepi32_ps(
+      _mm256_and_si256(v, _mm256_set1_epi32(0xffff)));
+  return _mm256_add_ps(_mm256_mul_ps(hi, _mm256_set1_ps(65536.0f)), lo);
+}
+
+__attribute__((target("avx2"))) inline __m256 Load8(const unsigned char* x) {
+  return _mm256_cvtepi32_ps(
+      _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)x)));
+}
+
+__attribute__((target("avx2"))) inline __m256d SquareLow(__m256 x) {
+  const __m256d d = _mm256_cvtps_pd(_mm256_castps256_ps128(x));
+  return _mm256_mul_pd(d, d);
+}
+
+__attribute__((target("avx2"))) inline __m256d SquareHigh(__m256 x) {
+  const __m256d d = _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1));
+  return _mm256_mul_pd(d, d);
+}
+
+template <typename T, bool kStrict>
+__attribute__((target("avx2"))) void CompareAvx2(const T* ref, const T* src,
+                                                 size_t n, float epsilon,
+                                                 size_t base, Acc* acc) {
+  const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  const __m256 limit = _mm256_set1_ps(epsilon);
+  __m256 max_abs = _mm256_setzero_ps();
+  __m256d sq_error = _mm256_setzero_pd();
+  __m256d sq_ref = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256 r = Load8(ref + i);
+    const __m256 diff = _mm256_and_ps(_mm256_sub_ps(r, Load8(src + i)),
+                                      abs_mask);
+    const int bad = _mm256_movemask_ps(
+        _mm256_cmp_ps(diff, limit, kStrict ? _CMP_NLT_UQ : _CMP_NLE_UQ));
+    if (bad) {
+      if (acc->first_mismatch < 0) {
+        acc->first_mismatch = base + i + __builtin_ctz(bad);
+      }
+      acc->error_count += __builtin_popcount(bad);
+    }
+    /* max_ps returns its second operand when the first is NaN. */
+    max_abs = _mm256_max_ps(diff, max_abs);
+    sq_error = _mm256_add_pd(sq_error, SquareLow(diff));
+    sq_error = _mm256_add_pd(sq_error, SquareHigh(diff));
+    sq_ref = _mm256_add_pd(sq_ref, SquareLow(r));
+    sq_ref = _mm256_add_pd(sq_ref, SquareHigh(r));
+  }
+
+  alignas(32) float m[8];
+  alignas(32) double e[4], q[4];
+  _mm256_store_ps(m, max_abs);
+  _mm256_store_pd(e, sq_error);
+  _mm256_store_pd(q, sq_ref);
+  for (int k = 0; k < 8; ++k) {
+    acc->max_abs_error = std::max(acc->max_abs_error, m[k]);
+  }
+  acc->sum_sq_error += (e[0] + e[1]) + (e[2] + e[3]);
+  acc->sum_sq_ref += (q[0] + q[1]) + (q[2] + q[3]);
+  CompareScalar<T, kStrict>(ref + i, src + i, n - i, epsilon, base + i, acc);
+}
+
+#endif  // COMPARE_HELPER_X86
+
+CompareKernel Resolve(CompareKernel kernel) {
+  if (kernel != kCompareKernelAuto) return kernel;
+  if (compare_kernel_supported(kCompareKernelAvx2)) return kCompareKernelAvx2;
+  return kCompareKernelScalar;
+}
+
+double L2RelError(double sum_sq_error, double sum_sq_ref) {
+  if (sum_sq_ref == 0.0) return sum_sq_error == 0.0 ? 0.0 : INFINITY;
+  return sqrt(sum_sq_error) / sqrt(sum_sq_ref);
+}
+
+/* Whether a comparison of n elements with this many errors has failed. */
+bool OverBudget(size_t errors, size_t n, float threshold) {
+  if (threshold == 0.0f) return errors > 0;
+  return !((double)n * threshold > (double)errors);
+}
+
+/* Splits [0, n) into chunks handed out to threads in order; with early
+ * exit, threads stop taking chunks once the errors seen exceed the budget.
+ * compare(offset, count, acc) fills the statistics of one chunk. */
+template <typename Compare>
+bool CompareChunks(size_t n, const CompareOptions& options,
+                   CompareResult* result, Compare compare) {
+  const size_t chunk = std::max<size_t>(options.chunk_elements, 1);
+  const size_t num_chunks = (n + chunk - 1) / chunk;
+  int num_threads =
+      options.num_threads > 0 ? options.num_threads : HardwareThreads();
+  num_threads =
+      (int)std::min<size_t>(num_threads, std::max<size_t>(num_chunks, 1));
+
+  std::vector<CompareStats> stats(num_chunks);
+  std::vector<char> done(num_chunks, 0);
+  std::atomic<size_t> next(0);
+  std::atomic<size_t> errors(0);
+  std::atomic<bool> stop(false);
+  auto worker = [&]() {
+    while (!stop.load(std::memory_order_relaxed)) {
+      const size_t c = next.fetch_add(1);
+      if (c >= num_chunks) break;
+      Acc acc;
+      const size_t offset = c * chunk;
+      const size_t count = std::min(chunk, n - offset);
+      compare(offset, count, &acc);
+
+      CompareStats& s = stats[c];
+      s.offset = offset;
+      s.count = count;
+      s.error_count = acc.error_count;
+      s.max_abs_error = acc.max_abs_error;
+      s.sum_sq_error = acc.sum_sq_error;
+      s.sum_sq_ref = acc.sum_sq_ref;
+      s.l2_rel_error = L2RelError(s.sum_sq_error, s.sum_sq_ref);
+      s.first_mismatch =
+          acc.first_mismatch < 0 ? -1 : (long long)offset + acc.first_mismatch;
+      done[c] = 1;
+
+      const size_t seen = errors.fetch_add(acc.error_count) + acc.error_count;
+      if (options.early_exit && OverBudget(seen, n, options.threshold)) {
+        stop.store(true, std::memory_order_relaxed);
+      }
+    }
+  };
+  ParallelFor(num_threads, [&](int) { worker(); });
+
+  CompareStats& total = result->total;
+  total = CompareStats();
+  result->chunks.clear();
+  result->stopped_early = false;
+  for (size_t c = 0; c < num_chunks; ++c) {
+    if (!done[c]) {
+      result->stopped_early = true;
+      continue;
+    }
+    const CompareStats& s = stats[c];
+    total.count += s.count;
+    total.error_count += s.error_count;
+    total.max_abs_error = std::max(total.max_abs_error, s.max_abs_error);
+    total.sum_sq_error += s.sum_sq_error;
+    total.sum_sq_ref += s.sum_sq_ref;
+    if (total.first_mismatch < 0) total.first_mismatch = s.first_mismatch;
+    result->chunks.push_back(s);
+  }
+  total.l2_rel_error = L2RelError(total.sum_sq_error, total.sum_sq_ref);
+  result->opened = true;
+  result->passed = !OverBudget(total.error_count, n, options.threshold);
+  return result->passed;
+}
+
+template <typename T>
+bool CompareData(const T* reference, const T* data, size_t nelements,
+                 const CompareOptions& options, CompareResult* result) {
+  *result = CompareResult();
+  if (!compare_kernel_supported(options.kernel)) return false;
+  CompareRule rule = options.rule;
+  float epsilon = options.epsilon;
+  if (rule == kCompareRuleDefault) {
+    const bool is_float = std::is_same<T, float>::value;
+    rule = is_float ? kCompareRuleBelow : kCompareRuleWithin;
+    if (is_float) epsilon = std::max(epsilon, kMinEpsilonError);
+  }
+  const bool strict = rule == kCompareRuleBelow;
+  auto* kernel = strict ? &CompareScalar<T, true> : &CompareScalar<T, false>;
+#ifdef COMPARE_HELPER_X86
+  if (Resolve(options.kernel) == kCompareKernelAvx2) {
+    kernel = strict ? &CompareAvx2<T, true> : &CompareAvx2<T, false>;
+  }
+#endif
+  return CompareChunks(nelements, options, result,
+                       [&](size_t offset, size_t count, Acc* acc) {
+                         kernel(reference + offset, data + offset, count,
+                                epsilon, 0, acc);
+                       });
+}
+
+/* A read-only mapping of the first bytes of a file. */
+class MappedFile {
+ public:
+  MappedFile(const char* file, size_t bytes) {
+    fd_ = open(file, O_RDONLY);
+    if (fd_ < 0) return;
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || (size_t)st.st_size < bytes) return;
+    if (bytes == 0) {
+      ok_ = true;
+      return;
+    }
+    void* p = mmap(NULL, bytes, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (p == MAP_FAILED) return;
+    madvise(p, bytes, MADV_SEQUENTIAL);
+    data_ = p;
+    bytes_ = bytes;
+    ok_ = true;
+  }
+  ~MappedFile() {
+    if (data_) munmap(data_, bytes_);
+    if (fd_ >= 0) close(fd_);
+  }
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool ok() const { return ok_; }
+  const void* data() const { return data_; }
+
+ private:
+  int fd_ = -1;
+  void* data_ = NULL;
+  size_t bytes_ = 0;
+  bool ok_ = false;
+};
+
+template <typename T>
+bool CompareFiles(const char* src_file, const char* ref_file,
+                  size_t nelements, const CompareOptions& options,
+                  CompareResult* result) {
+  *result = CompareResult();
+  MappedFile src(src_file, nelements * sizeof(T));
+  MappedFile ref(ref_file, nelements * sizeof(T));
+  if (!src.ok()) {
+    printf("compareBin2Bin unable to map %zu elements of src_file: %s\n",
+           nelements, src_file);
+  }
+  if (!ref.ok()) {
+    printf("compareBin2Bin unable to map %zu elements of ref_file: %s\n",
+           nelements, ref_file);
+  }
+  if (!src.ok() || !ref.ok()) return false;
+  return compareDataStream(static_cast<const T*>(ref.data()),
+                           static_cast<const T*>(src.data()), nelements,
+                           options, result);
+}
+
+}  // namespace
+
+bool compare_kernel_supported(CompareKernel kernel) {
+  switch (kernel) {
+    case kCompareKernelAuto:
+    case kCompareKernelScalar:
+      return true;
+#ifdef COMPARE_HELPER_X86
+    case kCompareKernelAvx2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+const char* compare_kernel_name(CompareKernel kernel) {
+  switch (Resolve(kernel)) {
+    case kCompareKernelScalar:
+      return "scalar";
+    case kCompareKernelAvx2:
+      return "avx2";
+    default:
+      return "unknown";
+  }
+}
+
+bool compareDataStream(const float* reference, const float* data,
+                       size_t nelements, const CompareOptions& options,
+                       CompareResult* result) {
+  return CompareData(reference, data, nelements, options, result);
+}
+
+bool compareDataStream(const unsigned int* reference, const unsigned int* data,
+                       size_t nelements, const CompareOptions& options,
+                       CompareResult* result) {
+  return CompareData(reference, data, nelements, options, result);
+}
+
+bool compareDataStream(const unsigned char* reference,
+                       const unsigned char* data, size_t nelements,
+                       const CompareOptions& options, CompareResult* result) {
+  return CompareData(reference, data, nelements, options, result);
+}
+
+bool sdkCompareBin2BinFloatStream(const char* src_file, const char* ref_file,
+                                  size_t nelements,
+                                  const CompareOptions& options,
+                                  CompareResult* result) {
+  return CompareFiles<float>(src_file, ref_file, nelements, options, result);
+}
+
+bool sdkCompareBin2BinUintStream(const char* src_file, const char* ref_file,
+                                 size_t nelements,
+                                 const CompareOptions& options,
+                                 CompareResult* result) {
+  return CompareFiles<unsigned int>(src_file, ref_file, nelements, options,
+                                    result);
+}
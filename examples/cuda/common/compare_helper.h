@@ -0,0 +1,101 @@
+#pragma once
+
+/*
+ * Streaming comparison of large golden-output dumps.
+ *
+ * sdkCompareBin2BinFloat() and sdkCompareBin2BinUint() in image_helper.h
+ * read both files whole before comparing them. The functions here map the
+ * files instead and compare fixed-size chunks on several threads with
+ * SIMD kernels, so memory use does not grow with the file and a failing
+ * comparison can stop as soon as its error budget is spent.
+ *
+ * An element mismatches as in image_helper.h: floats when
+ * |ref - src| >= max(epsilon, 1e-3) (compareDataAsFloatThreshold), unsigned
+ * ints when |ref - src| > epsilon, computed in float (compareData). The
+ * comparison passes if no element mismatches (threshold 0) or fewer than
+ * threshold * nelements do.
+ *
+ * The in-memory compareDataStream() also backs compareData(),
+ * compareDataAsFloatThreshold() and sdkCompareL2fe(); its sums of squares
+ * are accumulated in double.
+ */
+
+#include <stddef.h>
+
+#include <vector>
+
+enum CompareKernel {
+  kCompareKernelAuto = 0, /* widest kernel the CPU supports */
+  kCompareKernelScalar,
+  kCompareKernelAvx2,
+};
+
+bool compare_kernel_supported(CompareKernel kernel);
+const char* compare_kernel_name(CompareKernel kernel);
+
+enum CompareRule {
+  kCompareRuleDefault = 0, /* by element type, as described above */
+  kCompareRuleWithin,      /* mismatch unless |ref - src| <= epsilon */
+  kCompareRuleBelow,       /* mismatch unless |ref - src| < epsilon */
+};
+
+struct CompareOptions {
+  float epsilon = 0.0f;
+  CompareRule rule = kCompareRuleDefault;
+  float threshold = 0.0f;
+  /* Elements per chunk; statistics are kept per chunk. */
+  size_t chunk_elements = 1 << 20;
+  /* <= 0 picks one thread per core. */
+  int num_threads = 0;
+  /* Stop once the comparison can no longer pass. */
+  bool early_exit = true;
+  CompareKernel kernel = kCompareKernelAuto;
+};
+
+/* Statistics of one chunk, and of the whole comparison. l2_rel_error is
+ * |ref - src|_2 / |ref|_2; 0 if both norms are 0 and inf if only the
+ * reference norm is. first_mismatch is an element index into the file, -1
+ * if there is none. */
+struct CompareStats {
+  size_t offset = 0;
+  size_t count = 0;
+  size_t error_count = 0;
+  double max_abs_error = 0.0;
+  double l2_rel_error = 0.0;
+  long long first_mismatch = -1;
+  /* Sums behind l2_rel_error, to combine chunks. */
+  double sum_sq_error = 0.0;
+  double sum_sq_ref = 0.0;
+};
+
+struct CompareResult {
+  bool passed = false;
+  /* False if a file could not be opened or is shorter than nelements. */
+  bool opened = false;
+  /* Chunks were skipped because the error budget was exceeded. */
+  bool stopped_early = false;
+  /* Totals over the chunks compared, which are listed in file order. */
+  CompareStats total;
+  std::vector<CompareStats> chunks;
+};
+
+/* Compares the first nelements of two files. Returns result->passed. */
+bool sdkCompareBin2BinFloatStream(const char* src_file, const char* ref_file,
+                                  size_t nelements,
+                                  const CompareOptions& options,
+                                  CompareResult* result);
+bool sdkCompareBin2BinUintStream(const char* src_file, const char* ref_file,
+                                 size_t nelements,
+                                 const CompareOptions& options,
+                                 CompareResult* result);
+
+/* The same on buffers already in memory. */
+bool compareDataStream(const float* reference, const float* data,
+                       size_t nelements, const CompareOptions& options,
+                       CompareResult* result);
+bool compareDataStream(const unsigned int* reference, const unsigned int* data,
+                       size_t nelements, const CompareOptions& options,
+                       CompareResult* result);
+bool compareDataStream(const unsigned char* reference,
+                       const unsigned char* data, size_t nelements,
+                       const CompareOptions& options, CompareResult* result);
@@ -0,0 +1,137 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "examples/cuda/common/compare_helper.h"
+
+// How to run:
+// bazel run -c opt //examples/cuda/common:compare_helper_benchmark
+namespace {
+
+std::vector<float> Values(size_t n) {
+  std::vector<float> f(n);
+  for (size_t i = 0; i < n; ++i) f[i] = (float)i * 0.37f - 1000.0f;
+  return f;
+}
+
+std::string WriteTemp(const std::string& name, const std::vector<float>& f) {
+  const char* dir = getenv("TEST_TMPDIR");
+  const std::string path = std::string(dir ? dir : "/tmp") + "/" + name;
+  FILE* fp = fopen(path.c_str(), "wb");
+  fwrite(f.data(), sizeof(float), f.size(), fp);
+  fclose(fp);
+  return path;
+}
+
+// Arguments: elements, CompareKernel, threads.
+void BM_CompareMemory(benchmark::State& state) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  CompareOptions options;
+  options.kernel = static_cast<CompareKernel>(state.range(1));
+  options.num_threads = static_cast<int>(state.range(2));
+  if (!compare_kernel_supported(options.kernel)) {
+    state.SkipWithError("kernel not supported on this CPU");
+    return;
+  }
+  const std::vector<float> ref = Values(n);
+  const std::vector<float> src = ref;
+  CompareResult result;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        compareDataStream(ref.data(), src.data(), n, options, &result));
+  }
+  state.SetLabel(compare_kernel_name(options.kernel));
+  state.SetBytesProcessed(state.iterations() * n * 2 * sizeof(float));
+}
+
+// The whole-file read of sdkCompareBin2BinFloat() before it streamed,
+// against the mapped comparison, on files in the page cache.
+// Arguments: elements, streamed.
+void BM_CompareFile(benchmark::State& state) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  const std::vector<float> values = Values(n);
+  const std::string ref_file = WriteTemp("compare_ref.bin", values);
+  const std::string src_file = WriteTemp("compare_src.bin", values);
+  CompareOptions options;
+  CompareResult result;
+  for (auto _ : state) {
+    if (state.range(1)) {
+      benchmark::DoNotOptimize(sdkCompareBin2BinFloatStream(
+          src_file.c_str(), ref_file.c_str(), n, options, &result));
+      continue;
+    }
+    std::vector<float> src(n), ref(n);
+    FILE* fp = fopen(src_file.c_str(), "rb");
+    benchmark::DoNotOptimize(fread(src.data(), sizeof(float), n, fp));
+    fclose(fp);
+    fp = fopen(ref_file.c_str(), "rb");
+    benchmark::DoNotOptimize(fread(ref.data(), sizeof(float), n, fp));
+    fclose(fp);
+    int error_count = 0;
+    for (size_t i = 0; i < n; ++i) {
+      error_count += !(fabsf(ref[i] - src[i]) < 1e-3f);
+    }
+    benchmark::DoNotOptimize(error_count);
+  }
+  state.SetLabel(state.range(1) ? "mapped" : "fread");
+  state.SetBytesProcessed(state.iterations() * n * 2 * sizeof(float));
+  remove(ref_file.c_str());
+  remove(src_file.c_str());
+}
+
+// sdkCompareL2fe() before it used compareDataStream(): one float sum.
+double L2feFloat(const float* reference, const float* data, size_t len) {
+  float error = 0;
+  float ref = 0;
+  for (size_t i = 0; i < len; ++i) {
+    float diff = reference[i] - data[i];
+    error += diff * diff;
+    ref += reference[i] * reference[i];
+  }
+  return sqrtf(error) / sqrtf(ref);
+}
+
+// |ref - src|_2 / |ref|_2 with a known value: every other element is off
+// by 2^-10, so the exact result is 2^-10 / sqrt(2) for even n. The
+// rel_error counter is the error of the computed value.
+// Arguments: elements, float sum (0) or compareDataStream() (1).
+void BM_L2RelError(benchmark::State& state) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  std::vector<float> ref(n, 1.0f), src(n, 1.0f);
+  for (size_t i = 1; i < n; i += 2) src[i] = 1.0f + 0x1p-10f;
+  CompareOptions options;
+  options.early_exit = false;
+  CompareResult result;
+  double l2 = 0.0;
+  for (auto _ : state) {
+    if (state.range(1)) {
+      compareDataStream(ref.data(), src.data(), n, options, &result);
+      l2 = result.total.l2_rel_error;
+    } else {
+      l2 = L2feFloat(ref.data(), src.data(), n);
+    }
+    benchmark::DoNotOptimize(l2);
+  }
+  const double exact = 0x1p-10 / sqrt(2.0);
+  state.SetLabel(state.range(1) ? "double, threaded" : "float");
+  state.SetItemsProcessed(state.iterations() * n);
+  state.counters["rel_error"] = fabs(l2 - exact) / exact;
+}
+
+BENCHMARK(BM_CompareMemory)
+    ->ArgsProduct({{1 << 16, 1 << 26},
+                   {kCompareKernelScalar, kCompareKernelAvx2},
+                   {1, 0}})
+    ->UseRealTime();
+BENCHMARK(BM_CompareFile)->ArgsProduct({{1 << 26}, {0, 1}})->UseRealTime();
+// 10^9 elements need 8 GB for the two inputs.
+BENCHMARK(BM_L2RelError)
+    ->ArgsProduct({{1 << 20, 1 << 26, 1000000000}, {0, 1}})
+    ->UseRealTime()
+    ->Iterations(3);
+
+}  // namespace
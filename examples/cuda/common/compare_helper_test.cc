@@ -0,0 +1,257 @@
+#include "examples/cuda/common/compare_helper.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<float> RandomFloats(size_t n, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> value(-10.0f, 10.0f);
+  std::vector<float> x(n);
+  for (float& v : x) v = value(rng);
+  return x;
+}
+
+std::string WriteTemp(const std::string& name, const void* data,
+                      size_t bytes) {
+  const std::string path = ::testing::TempDir() + name;
+  FILE* fp = fopen(path.c_str(), "wb");
+  fwrite(data, 1, bytes, fp);
+  fclose(fp);
+  return path;
+}
+
+std::vector<CompareKernel> SupportedKernels() {
+  std::vector<CompareKernel> kernels;
+  for (CompareKernel kernel : {kCompareKernelScalar, kCompareKernelAvx2}) {
+    if (compare_kernel_supported(kernel)) kernels.push_back(kernel);
+  }
+  return kernels;
+}
+
+class CompareHelperTest : public ::testing::TestWithParam<CompareKernel> {
+ protected:
+  CompareOptions Options() const {
+    CompareOptions options;
+    options.kernel = GetParam();
+    options.chunk_elements = 1000;
+    return options;
+  }
+};
+
+TEST_P(CompareHelperTest, IdenticalPasses) {
+  const std::vector<float> ref = RandomFloats(10007, 1);
+  CompareResult result;
+  EXPECT_TRUE(compareDataStream(ref.data(), ref.data(), ref.size(), Options(),
+                                &result));
+  EXPECT_TRUE(result.opened);
+  EXPECT_FALSE(result.stopped_early);
+  EXPECT_EQ(result.total.count, ref.size());
+  EXPECT_EQ(result.total.error_count, 0u);
+  EXPECT_EQ(result.total.first_mismatch, -1);
+  EXPECT_EQ(result.total.max_abs_error, 0.0);
+  EXPECT_EQ(result.total.l2_rel_error, 0.0);
+  ASSERT_EQ(result.chunks.size(), 11u);
+  EXPECT_EQ(result.chunks[10].offset, 10000u);
+  EXPECT_EQ(result.chunks[10].count, 7u);
+}
+
+TEST_P(CompareHelperTest, FloatStatistics) {
+  const std::vector<float> ref = RandomFloats(10007, 2);
+  std::vector<float> src = ref;
+  src[2345] += 0.5f;
+  src[2500] -= 0.25f;
+  src[9999] = NAN;
+  src[10003] += 1e-4f;  // below the minimum epsilon of 1e-3
+  CompareOptions options = Options();
+  options.early_exit = false;
+  CompareResult result;
+  EXPECT_FALSE(compareDataStream(ref.data(), src.data(), ref.size(), options,
+                                 &result));
+  EXPECT_EQ(result.total.error_count, 3u);
+  EXPECT_EQ(result.total.first_mismatch, 2345);
+  EXPECT_NEAR(result.total.max_abs_error, 0.5, 1e-5);
+  EXPECT_TRUE(isnan(result.total.l2_rel_error));
+
+  const CompareStats& chunk = result.chunks[2];
+  EXPECT_EQ(chunk.error_count, 2u);
+  EXPECT_EQ(chunk.first_mismatch, 2345);
+  EXPECT_NEAR(chunk.max_abs_error, 0.5, 1e-5);
+  double sum_sq_ref = 0.0;
+  for (int i = 2000; i < 3000; ++i) sum_sq_ref += (double)ref[i] * ref[i];
+  EXPECT_NEAR(chunk.l2_rel_error, sqrt(0.3125 / sum_sq_ref), 1e-6);
+  EXPECT_EQ(result.chunks[9].first_mismatch, 9999);
+  EXPECT_EQ(result.chunks[10].error_count, 0u);
+
+  // Three errors in 10007 elements pass a threshold of 0.1%.
+  options.threshold = 0.001f;
+  EXPECT_TRUE(compareDataStream(ref.data(), src.data(), ref.size(), options,
+                                &result));
+  options.epsilon = 0.3f;
+  options.threshold = 0.0f;
+  EXPECT_FALSE(compareDataStream(ref.data(), src.data(), ref.size(), options,
+                                 &result));
+  EXPECT_EQ(result.total.error_count, 2u);
+}
+
+TEST_P(CompareHelperTest, UintStatistics) {
+  std::vector<unsigned int> ref(1003), src(1003);
+  for (size_t i = 0; i < ref.size(); ++i) ref[i] = src[i] = i * 37u;
+  src[17] += 3;
+  src[500] -= 2;
+  // Equal once converted to float, as in compareData().
+  ref[900] = 0xffffffffu;
+  src[900] = 0xfffffffeu;
+  CompareOptions options = Options();
+  options.epsilon = 2.0f;
+  options.early_exit = false;
+  CompareResult result;
+  EXPECT_FALSE(compareDataStream(ref.data(), src.data(), ref.size(), options,
+                                 &result));
+  EXPECT_EQ(result.total.error_count, 1u);
+  EXPECT_EQ(result.total.first_mismatch, 17);
+  EXPECT_EQ(result.total.max_abs_error, 3.0);
+}
+
+TEST_P(CompareHelperTest, RulesAndBytes) {
+  std::vector<unsigned char> ref(1001), src(1001);
+  for (size_t i = 0; i < ref.size(); ++i) ref[i] = src[i] = i % 251;
+  src[3] += 2;
+  src[600] -= 1;
+  CompareOptions options = Options();
+  options.epsilon = 1.0f;
+  options.early_exit = false;
+  CompareResult result;
+  EXPECT_FALSE(compareDataStream(ref.data(), src.data(), ref.size(), options,
+                                 &result));
+  EXPECT_EQ(result.total.error_count, 1u);
+  EXPECT_EQ(result.total.max_abs_error, 2.0);
+  options.rule = kCompareRuleBelow;
+  compareDataStream(ref.data(), src.data(), ref.size(), options, &result);
+  EXPECT_EQ(result.total.error_count, 2u);
+  EXPECT_EQ(result.total.first_mismatch, 3);
+
+  // Explicit rules on floats do not apply the minimum epsilon.
+  std::vector<float> fref(100, 1.0f), fsrc = fref;
+  fsrc[50] = 1.0001f;
+  options.epsilon = 0.0f;
+  EXPECT_FALSE(compareDataStream(fref.data(), fsrc.data(), fref.size(),
+                                 options, &result));
+  options.rule = kCompareRuleDefault;
+  EXPECT_TRUE(compareDataStream(fref.data(), fsrc.data(), fref.size(),
+                                options, &result));
+}
+
+TEST_P(CompareHelperTest, EarlyExitStopsTakingChunks) {
+  const std::vector<float> ref = RandomFloats(100000, 3);
+  std::vector<float> src = ref;
+  for (size_t i = 0; i < src.size(); i += 10) src[i] += 1.0f;
+  CompareOptions options = Options();
+  options.num_threads = 1;
+  CompareResult result;
+  EXPECT_FALSE(compareDataStream(ref.data(), src.data(), ref.size(), options,
+                                 &result));
+  EXPECT_TRUE(result.stopped_early);
+  ASSERT_EQ(result.chunks.size(), 1u);
+  EXPECT_EQ(result.total.error_count, 100u);
+
+  // A budget of 4950 errors is spent by the 50th chunk.
+  options.threshold = 0.0495f;
+  EXPECT_FALSE(compareDataStream(ref.data(), src.data(), ref.size(), options,
+                                 &result));
+  EXPECT_EQ(result.chunks.size(), 50u);
+
+  options.early_exit = false;
+  EXPECT_FALSE(compareDataStream(ref.data(), src.data(), ref.size(), options,
+                                 &result));
+  EXPECT_FALSE(result.stopped_early);
+  EXPECT_EQ(result.chunks.size(), 100u);
+  EXPECT_EQ(result.total.error_count, 10000u);
+}
+
+TEST_P(CompareHelperTest, ThreadsDoNotChangeResults) {
+  const std::vector<float> ref = RandomFloats((1 << 20) + 5, 4);
+  std::vector<float> src = ref;
+  for (size_t i = 7; i < src.size(); i += 997) src[i] *= 1.01f;
+  CompareOptions options = Options();
+  options.early_exit = false;
+  options.chunk_elements = 1 << 16;
+  options.num_threads = 1;
+  CompareResult expect;
+  compareDataStream(ref.data(), src.data(), ref.size(), options, &expect);
+  for (int threads : {2, 3, 8}) {
+    options.num_threads = threads;
+    CompareResult result;
+    compareDataStream(ref.data(), src.data(), ref.size(), options, &result);
+    EXPECT_EQ(result.total.error_count, expect.total.error_count);
+    EXPECT_EQ(result.total.first_mismatch, expect.total.first_mismatch);
+    EXPECT_EQ(result.total.max_abs_error, expect.total.max_abs_error);
+    EXPECT_EQ(result.total.l2_rel_error, expect.total.l2_rel_error);
+  }
+}
+
+TEST_P(CompareHelperTest, KernelsAgree) {
+  const std::vector<float> ref = RandomFloats(4099, 5);
+  std::vector<float> src = RandomFloats(4099, 6);
+  CompareOptions options = Options();
+  options.epsilon = 5.0f;
+  options.early_exit = false;
+  CompareResult expect, result;
+  compareDataStream(ref.data(), src.data(), ref.size(), options, &result);
+  options.kernel = kCompareKernelScalar;
+  compareDataStream(ref.data(), src.data(), ref.size(), options, &expect);
+  ASSERT_EQ(result.chunks.size(), expect.chunks.size());
+  for (size_t c = 0; c < expect.chunks.size(); ++c) {
+    EXPECT_EQ(result.chunks[c].error_count, expect.chunks[c].error_count);
+    EXPECT_EQ(result.chunks[c].first_mismatch, expect.chunks[c].first_mismatch);
+    EXPECT_EQ(result.chunks[c].max_abs_error, expect.chunks[c].max_abs_error);
+    EXPECT_NEAR(result.chunks[c].l2_rel_error, expect.chunks[c].l2_rel_error,
+                1e-12);
+  }
+}
+
+TEST_P(CompareHelperTest, Files) {
+  const std::vector<float> ref = RandomFloats(5000, 7);
+  std::vector<float> src = ref;
+  src[4321] += 1.0f;
+  const std::string ref_file =
+      WriteTemp("ref.bin", ref.data(), ref.size() * sizeof(float));
+  const std::string src_file =
+      WriteTemp("src.bin", src.data(), src.size() * sizeof(float));
+  CompareResult result;
+  EXPECT_TRUE(sdkCompareBin2BinFloatStream(src_file.c_str(), ref_file.c_str(),
+                                           4000, Options(), &result));
+  EXPECT_TRUE(result.opened);
+  EXPECT_FALSE(sdkCompareBin2BinFloatStream(
+      src_file.c_str(), ref_file.c_str(), 5000, Options(), &result));
+  EXPECT_EQ(result.total.first_mismatch, 4321);
+  EXPECT_FALSE(sdkCompareBin2BinUintStream(src_file.c_str(), ref_file.c_str(),
+                                           5000, Options(), &result));
+  EXPECT_TRUE(result.opened);
+
+  // Too short, or missing.
+  EXPECT_FALSE(sdkCompareBin2BinFloatStream(
+      src_file.c_str(), ref_file.c_str(), 5001, Options(), &result));
+  EXPECT_FALSE(result.opened);
+  EXPECT_FALSE(sdkCompareBin2BinFloatStream(
+      "/nonexistent/src.bin", ref_file.c_str(), 1, Options(), &result));
+  EXPECT_FALSE(result.opened);
+  EXPECT_TRUE(sdkCompareBin2BinFloatStream(src_file.c_str(), ref_file.c_str(),
+                                           0, Options(), &result));
+}
+
+INSTANTIATE_TEST_SUITE_P(Kernels, CompareHelperTest,
+                         ::testing::ValuesIn(SupportedKernels()),
+                         [](const ::testing::TestParamInfo<CompareKernel>&
+                                info) {
+                           return std::string(compare_kernel_name(info.param));
+                         });
+
+}  // namespace
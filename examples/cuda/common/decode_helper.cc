@@ -0,0 +1,424 @@
+#include "examples/cuda/common/decode_helper.h"
+
+#include <fcntl.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "examples/cuda/common/parallel_helper.h"
+#include "examples/cuda/common/pnm_helper.h"
+#include "jpeglib.h"
+
+namespace {
+
+constexpr size_t kAlignment = 64;
+
+float* AllocateFloats(size_t n) {
+  const size_t bytes =
+      std::max(kAlignment, (n * sizeof(float) + kAlignment - 1) /
+                               kAlignment * kAlignment);
+  return static_cast<float*>(aligned_alloc(kAlignment, bytes));
+}
+
+/* Stores one row of 8-bit samples into out, a w x h image of channels
+ * floats per pixel in the given layout. */
+void StoreRow(const unsigned char* row, unsigned int w, unsigned int h,
+              unsigned int channels, unsigned int y, DecodeLayout layout,
+              float* out) {
+  const size_t plane = (size_t)w * h;
+  if (layout == kDecodeInterleaved || channels == 1) {
+    float* dst = out + (size_t)y * w * channels;
+    for (size_t i = 0; i < (size_t)w * channels; ++i) {
+      dst[i] = static_cast<float>(row[i]) / 255.0f;
+    }
+    return;
+  }
+  for (unsigned int c = 0; c < channels; ++c) {
+    float* dst = out + c * plane + (size_t)y * w;
+    for (unsigned int x = 0; x < w; ++x) {
+      dst[x] = static_cast<float>(row[x * channels + c]) / 255.0f;
+    }
+  }
+}
+
+bool Fail(DecodedImage* image, std::string error) {
+  image->ok = false;
+  image->error = std::move(error);
+  image->pixels.Release();
+  return false;
+}
+
+/* Acquires the output buffer and fills in the image size. */
+float* Prepare(DecodedImage* image, ImageBufferPool* pool, unsigned int w,
+               unsigned int h, unsigned int channels) {
+  image->width = w;
+  image->height = h;
+  image->channels = channels;
+  const size_t n = (size_t)w * h * channels;
+  if (pool != NULL) {
+    image->pixels = pool->Acquire(n);
+  } else {
+    image->pixels = ImageBufferPool::Allocate(n);
+  }
+  return image->pixels.data();
+}
+
+bool DecodePnm(const char* file, const DecodeOptions& options,
+               ImageBufferPool* pool, DecodedImage* image) {
+  MappedPnm pnm;
+  if (!pnm.Open(file)) return Fail(image, "cannot read PGM/PPM file");
+  const unsigned int s = options.scale;
+  const unsigned int c = pnm.channels();
+  const unsigned int w = (pnm.width() + s - 1) / s;
+  const unsigned int h = (pnm.height() + s - 1) / s;
+  float* out = Prepare(image, pool, w, h, c);
+  if (out == NULL) return Fail(image, "out of memory");
+
+  if (s == 1 && (options.layout == kDecodeInterleaved || c == 1)) {
+    pnm_normalize(pnm.pixels(), pnm.size(), out, 1);
+    return true;
+  }
+  /* Boxes are averaged to the nearest 8-bit value, like the DCT scaling of
+   * JPEGs, so both paths quantize the same way. */
+  std::vector<unsigned char> row((size_t)w * c);
+  std::vector<unsigned int> sum((size_t)w * c);
+  const size_t stride = (size_t)pnm.width() * c;
+  for (unsigned int y = 0; y < h; ++y) {
+    const unsigned int y0 = y * s;
+    const unsigned int y1 = std::min(y0 + s, pnm.height());
+    if (s == 1) {
+      std::copy(pnm.pixels() + y0 * stride, pnm.pixels() + y1 * stride,
+                row.begin());
+    } else {
+      std::fill(sum.begin(), sum.end(), 0u);
+      for (unsigned int sy = y0; sy < y1; ++sy) {
+        const unsigned char* src = pnm.pixels() + sy * stride;
+        for (unsigned int x = 0; x < pnm.width(); ++x) {
+          for (unsigned int k = 0; k < c; ++k) {
+            sum[(x / s) * c + k] += src[x * c + k];
+          }
+        }
+      }
+      for (unsigned int x = 0; x < w; ++x) {
+        const unsigned int cols = std::min(s, pnm.width() - x * s);
+        const unsigned int count = cols * (y1 - y0);
+        for (unsigned int k = 0; k < c; ++k) {
+          row[x * c + k] =
+              (unsigned char)((sum[x * c + k] + count / 2) / count);
+        }
+      }
+    }
+    StoreRow(row.data(), w, h, c, y, options.layout, out);
+  }
+  return true;
+}
+
+/* libjpeg reports fatal errors through error_exit, which must not return;
+ * jump back to the setjmp() in ReadJpegHeader() or ReadJpegPixels(). Those
+ * two only touch libjpeg state and plain pointers, so no destructors are
+ * skipped. */
+struct JpegError {
+  jpeg_error_mgr mgr;
+  jmp_buf jump;
+  char message[JMSG_LENGTH_MAX];
+};
+
+void JpegErrorExit(j_common_ptr cinfo) {
+  JpegError* error = reinterpret_cast<JpegError*>(cinfo->err);
+  (*cinfo->err->format_message)(cinfo, error->message);
+  longjmp(error->jump, 1);
+}
+
+void JpegOutputMessage(j_common_ptr) {}
+
+bool ReadJpegHeader(jpeg_decompress_struct* cinfo, JpegError* error,
+                    const unsigned char* data, size_t size,
+                    const DecodeOptions& options) {
+  if (setjmp(error->jump)) return false;
+  jpeg_mem_src(cinfo, const_cast<unsigned char*>(data), (unsigned long)size);
+  jpeg_read_header(cinfo, TRUE);
+  if (options.grayscale || cinfo->jpeg_color_space == JCS_GRAYSCALE) {
+    cinfo->out_color_space = JCS_GRAYSCALE;
+  } else if (cinfo->jpeg_color_space == JCS_CMYK ||
+             cinfo->jpeg_color_space == JCS_YCCK) {
+    snprintf(error->message, sizeof(error->message),
+             "CMYK JPEGs are not supported");
+    return false;
+  } else {
+    cinfo->out_color_space = JCS_RGB;
+  }
+  cinfo->scale_num = 1;
+  cinfo->scale_denom = options.scale;
+  jpeg_calc_output_dimensions(cinfo);
+  return true;
+}
+
+bool ReadJpegPixels(jpeg_decompress_struct* cinfo, JpegError* error,
+                    DecodeLayout layout, float* out) {
+  if (setjmp(error->jump)) return false;
+  jpeg_start_decompress(cinfo);
+  const unsigned int w = cinfo->output_width;
+  const unsigned int h = cinfo->output_height;
+  const unsigned int c = cinfo->output_components;
+  /* Freed with the decompressor. */
+  JSAMPARRAY rows = (*cinfo->mem->alloc_sarray)(
+      reinterpret_cast<j_common_ptr>(cinfo), JPOOL_IMAGE, w * c,
+      cinfo->rec_outbuf_height);
+  while (cinfo->output_scanline < h) {
+    const unsigned int y = cinfo->output_scanline;
+    const unsigned int n =
+        jpeg_read_scanlines(cinfo, rows, cinfo->rec_outbuf_height);
+    for (unsigned int i = 0; i < n; ++i) {
+      StoreRow(rows[i], w, h, c, y + i, layout, out);
+    }
+  }
+  jpeg_finish_decompress(cinfo);
+  return true;
+}
+
+bool DecodeJpeg(const unsigned char* data, size_t size,
+                const DecodeOptions& options, ImageBufferPool* pool,
+                DecodedImage* image) {
+  jpeg_decompress_struct cinfo;
+  JpegError error;
+  error.message[0] = '\0';
+  cinfo.err = jpeg_std_error(&error.mgr);
+  error.mgr.error_exit = JpegErrorExit;
+  error.mgr.output_message = JpegOutputMessage;
+  jpeg_create_decompress(&cinfo);
+
+  bool ok = ReadJpegHeader(&cinfo, &error, data, size, options);
+  float* out = NULL;
+  if (ok) {
+    out = Prepare(image, pool, cinfo.output_width, cinfo.output_height,
+                  cinfo.output_components);
+    if (out == NULL) {
+      snprintf(error.message, sizeof(error.message), "out of memory");
+    }
+    ok = out != NULL && ReadJpegPixels(&cinfo, &error, options.layout, out);
+  }
+  jpeg_destroy_decompress(&cinfo);
+  if (!ok) return Fail(image, error.message);
+  return true;
+}
+
+}  // namespace
+
+PooledBuffer::PooledBuffer(PooledBuffer&& other) noexcept
+    : pool_(other.pool_),
+      data_(other.data_),
+      size_(other.size_),
+      capacity_(other.capacity_) {
+  other.pool_ = NULL;
+  other.data_ = NULL;
+  other.size_ = other.capacity_ = 0;
+}
+
+PooledBuffer& PooledBuffer::operator=(PooledBuffer&& other) noexcept {
+  if (this != &other) {
+    Release();
+    std::swap(pool_, other.pool_);
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(capacity_, other.capacity_);
+  }
+  return *this;
+}
+
+void PooledBuffer::Release() {
+  if (data_ != NULL) {
+    if (pool_ != NULL) {
+      pool_->Return(data_, capacity_);
+    } else {
+      free(data_);
+    }
+  }
+  pool_ = NULL;
+  data_ = NULL;
+  size_ = capacity_ = 0;
+}
+
+ImageBufferPool::ImageBufferPool(size_t max_cached_bytes)
+    : max_cached_bytes_(max_cached_bytes) {}
+
+ImageBufferPool::~ImageBufferPool() {
+  for (const Block& block : free_) free(block.data);
+}
+
+PooledBuffer ImageBufferPool::Allocate(size_t n) {
+  PooledBuffer buffer;
+  buffer.data_ = AllocateFloats(n);
+  if (buffer.data_ != NULL) buffer.size_ = buffer.capacity_ = n;
+  return buffer;
+}
+
+PooledBuffer ImageBufferPool::Acquire(size_t n) {
+  PooledBuffer buffer;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    /* Smallest cached block that fits. */
+    auto best = free_.end();
+    for (auto it = free_.begin(); it != free_.end(); ++it) {
+      if (it->capacity >= n &&
+          (best == free_.end() || it->capacity < best->capacity)) {
+        best = it;
+      }
+    }
+    if (best != free_.end()) {
+      buffer.data_ = best->data;
+      buffer.capacity_ = best->capacity;
+      cached_bytes_ -= best->capacity * sizeof(float);
+      *best = free_.back();
+      free_.pop_back();
+    } else {
+      ++allocations_;
+    }
+  }
+  if (buffer.data_ == NULL) {
+    buffer.data_ = AllocateFloats(n);
+    if (buffer.data_ == NULL) return buffer;
+    buffer.capacity_ = n;
+  }
+  buffer.pool_ = this;
+  buffer.size_ = n;
+  return buffer;
+}
+
+size_t ImageBufferPool::allocations() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return allocations_;
+}
+
+void ImageBufferPool::Return(float* data, size_t capacity) {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (cached_bytes_ + capacity * sizeof(float) <= max_cached_bytes_) {
+      cached_bytes_ += capacity * sizeof(float);
+      free_.push_back(Block{data, capacity});
+      return;
+    }
+  }
+  free(data);
+}
+
+bool decode_image(const char* file, const DecodeOptions& options,
+                  ImageBufferPool* pool, DecodedImage* image) {
+  image->file = file;
+  image->ok = false;
+  image->error.clear();
+  if (options.scale != 1 && options.scale != 2 && options.scale != 4 &&
+      options.scale != 8) {
+    return Fail(image, "scale must be 1, 2, 4 or 8");
+  }
+
+  const int fd = open(file, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return Fail(image, "cannot open file");
+  unsigned char magic[2] = {0, 0};
+  if (pread(fd, magic, 2, 0) != 2) {
+    close(fd);
+    return Fail(image, "file is too short");
+  }
+  if (magic[0] == 'P') {
+    close(fd);
+    image->ok = DecodePnm(file, options, pool, image);
+    return image->ok;
+  }
+  if (magic[0] != 0xff || magic[1] != 0xd8) {
+    close(fd);
+    return Fail(image, "not a JPEG, PGM or PPM file");
+  }
+
+  struct stat st;
+  void* map = MAP_FAILED;
+  const size_t bytes = fstat(fd, &st) == 0 ? (size_t)st.st_size : 0;
+  if (bytes > 0) {
+    map = mmap(NULL, bytes, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+  }
+  close(fd);
+  if (map == MAP_FAILED) return Fail(image, "cannot map file");
+  image->ok = DecodeJpeg(static_cast<const unsigned char*>(map), bytes,
+                         options, pool, image);
+  munmap(map, bytes);
+  return image->ok;
+}
+
+DecodePipeline::DecodePipeline(ImageBufferPool* pool,
+                               const DecodeOptions& options, int num_threads,
+                               size_t max_queued)
+    : pool_(pool),
+      options_(options),
+      max_queued_(std::max<size_t>(max_queued, 1)) {
+  if (num_threads <= 0) num_threads = HardwareThreads();
+  for (int t = 0; t < num_threads; ++t) {
+    threads_.emplace_back(&DecodePipeline::Work, this);
+  }
+}
+
+DecodePipeline::~DecodePipeline() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    stop_ = true;
+  }
+  input_.notify_all();
+  output_.notify_all();
+  for (auto& t : threads_) t.join();
+}
+
+void DecodePipeline::Submit(std::string file) {
+  std::unique_lock<std::mutex> lock(mu_);
+  input_.wait(lock, [&] { return jobs_.size() < max_queued_; });
+  jobs_.push_back(Job{std::move(file), submitted_++});
+  lock.unlock();
+  input_.notify_all();
+}
+
+void DecodePipeline::Close() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    closed_ = true;
+  }
+  input_.notify_all();
+  output_.notify_all();
+}
+
+bool DecodePipeline::Next(DecodedImage* image) {
+  std::unique_lock<std::mutex> lock(mu_);
+  output_.wait(lock, [&] {
+    return !done_.empty() || (closed_ && returned_ == submitted_);
+  });
+  if (done_.empty()) return false;
+  *image = std::move(done_.front());
+  done_.pop_front();
+  ++returned_;
+  lock.unlock();
+  output_.notify_all();
+  return true;
+}
+
+void DecodePipeline::Work() {
+  std::unique_lock<std::mutex> lock(mu_);
+  for (;;) {
+    input_.wait(lock, [&] { return stop_ || closed_ || !jobs_.empty(); });
+    if (stop_ || jobs_.empty()) return;
+    Job job = std::move(jobs_.front());
+    jobs_.pop_front();
+    lock.unlock();
+    input_.notify_all();
+
+    DecodedImage image;
+    decode_image(job.file.c_str(), options_, pool_, &image);
+    image.index = job.index;
+
+    lock.lock();
+    output_.wait(lock, [&] { return stop_ || done_.size() < max_queued_; });
+    if (stop_) return;
+    done_.push_back(std::move(image));
+    output_.notify_all();
+  }
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+/*
+ * Host-side decoding of JPEG and binary PGM/PPM images into the float
+ * layout the samples upload: every 8-bit sample v becomes v / 255.0f, as
+ * ConverterFromUByte<float> computes it, either interleaved like
+ * sdkLoadPGM() or one plane per channel.
+ *
+ * Output buffers come from an ImageBufferPool so that a stream of images of
+ * the same size reuses a handful of aligned allocations. DecodePipeline
+ * decodes a list of files on worker threads; both of its queues are
+ * bounded, so a slow consumer throttles the workers instead of letting
+ * decoded images pile up.
+ */
+
+#include <stddef.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ImageBufferPool;
+
+/* Move-only handle to a pool buffer; returns it to the pool when
+ * destroyed. */
+class PooledBuffer {
+ public:
+  PooledBuffer() = default;
+  ~PooledBuffer() { Release(); }
+  PooledBuffer(PooledBuffer&& other) noexcept;
+  PooledBuffer& operator=(PooledBuffer&& other) noexcept;
+  PooledBuffer(const PooledBuffer&) = delete;
+  PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+  float* data() const { return data_; }
+  /* in floats */
+  size_t size() const { return size_; }
+  void Release();
+
+ private:
+  friend class ImageBufferPool;
+
+  ImageBufferPool* pool_ = NULL;
+  float* data_ = NULL;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+};
+
+/*
+ * Cache of 64-byte aligned float buffers. Released buffers are kept, up to
+ * max_cached_bytes in total, and handed out again to requests they are
+ * large enough for. Thread-safe; must outlive its buffers.
+ */
+class ImageBufferPool {
+ public:
+  explicit ImageBufferPool(size_t max_cached_bytes = 256 << 20);
+  ~ImageBufferPool();
+  ImageBufferPool(const ImageBufferPool&) = delete;
+  ImageBufferPool& operator=(const ImageBufferPool&) = delete;
+
+  PooledBuffer Acquire(size_t n);
+  /* A buffer of the same alignment outside any pool, freed on release. */
+  static PooledBuffer Allocate(size_t n);
+
+  /* Acquire() calls that had to allocate. */
+  size_t allocations() const;
+
+ private:
+  friend class PooledBuffer;
+
+  struct Block {
+    float* data;
+    size_t capacity;
+  };
+
+  void Return(float* data, size_t capacity);
+
+  const size_t max_cached_bytes_;
+  mutable std::mutex mu_;
+  std::vector<Block> free_;
+  size_t cached_bytes_ = 0;
+  size_t allocations_ = 0;
+};
+
+enum DecodeLayout {
+  kDecodeInterleaved = 0, /* pixel by pixel, as sdkLoadPGM() returns */
+  kDecodePlanar,          /* all of channel 0, then channel 1, ... */
+};
+
+struct DecodeOptions {
+  DecodeLayout layout = kDecodePlanar;
+  /* 1, 2, 4 or 8. JPEGs are shrunk by the DCT (only the low frequency
+   * coefficients are decoded), PGM/PPM images by averaging scale x scale
+   * boxes; either way the result is ceil(w / scale) x ceil(h / scale). */
+  unsigned int scale = 1;
+  /* Decode JPEGs to one gray channel instead of RGB. */
+  bool grayscale = false;
+};
+
+struct DecodedImage {
+  std::string file;
+  /* position of the file in the order it was submitted */
+  size_t index = 0;
+  bool ok = false;
+  std::string error;
+  unsigned int width = 0;
+  unsigned int height = 0;
+  /* 1 or 3 */
+  unsigned int channels = 0;
+  /* width * height * channels floats in [0, 1] */
+  PooledBuffer pixels;
+};
+
+/* Decodes file, a JPEG or a P5/P6 file with a maxval of at most 255.
+ * Without a pool the buffer is allocated on its own. Returns false and sets
+ * image->error on failure. */
+bool decode_image(const char* file, const DecodeOptions& options,
+                  ImageBufferPool* pool, DecodedImage* image);
+
+/*
+ * Decodes files on num_threads workers (one per core for <= 0). Submit()
+ * blocks while max_queued files wait to be decoded; workers block while
+ * max_queued decoded images wait for Next(). Images come out in the order
+ * they finish; DecodedImage::index gives the submission order.
+ */
+class DecodePipeline {
+ public:
+  DecodePipeline(ImageBufferPool* pool, const DecodeOptions& options,
+                 int num_threads = 0, size_t max_queued = 16);
+  /* Discards whatever is still queued. */
+  ~DecodePipeline();
+  DecodePipeline(const DecodePipeline&) = delete;
+  DecodePipeline& operator=(const DecodePipeline&) = delete;
+
+  void Submit(std::string file);
+  /* No more files; Next() returns false once everything is handed out. */
+  void Close();
+  /* Waits for the next decoded image. */
+  bool Next(DecodedImage* image);
+
+ private:
+  struct Job {
+    std::string file;
+    size_t index;
+  };
+
+  void Work();
+
+  ImageBufferPool* const pool_;
+  const DecodeOptions options_;
+  const size_t max_queued_;
+  std::mutex mu_;
+  std::condition_variable input_;  /* jobs added or taken, or closing */
+  std::condition_variable output_; /* images added or taken */
+  std::deque<Job> jobs_;
+  std::deque<DecodedImage> done_;
+  size_t submitted_ = 0;
+  size_t returned_ = 0;
+  bool closed_ = false;
+  bool stop_ = false;
+  std::vector<std::thread> threads_;
+};
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "examples/cuda/common/decode_helper.h"
+#include "examples/cuda/common/pnm_helper.h"
+#include "jpeglib.h"
+
+// How to run:
+// bazel run -c opt //examples/cuda/common:decode_helper_benchmark
+namespace {
+
+constexpr int kCorpusSize = 32;
+constexpr unsigned int kWidth = 1280;
+constexpr unsigned int kHeight = 720;
+
+std::vector<unsigned char> Frame(unsigned int seed) {
+  std::vector<unsigned char> rgb((size_t)kWidth * kHeight * 3);
+  unsigned int state = seed * 2654435761u + 1;
+  for (unsigned int y = 0; y < kHeight; ++y) {
+    for (unsigned int x = 0; x < kWidth; ++x) {
+      for (unsigned int c = 0; c < 3; ++c) {
+        state = state * 1664525u + 1013904223u;
+        // A gradient with some noise, roughly like a photograph.
+        rgb[((size_t)y * kWidth + x) * 3 + c] =
+            (unsigned char)((x / 5 + y / 3 + c * 50 + seed * 13 +
+                             (state >> 28)) %
+                            256);
+      }
+    }
+  }
+  return rgb;
+}
+
+void WriteJpeg(const std::string& path, const std::vector<unsigned char>& rgb) {
+  FILE* fp = fopen(path.c_str(), "wb");
+  jpeg_compress_struct cinfo;
+  jpeg_error_mgr err;
+  cinfo.err = jpeg_std_error(&err);
+  jpeg_create_compress(&cinfo);
+  jpeg_stdio_dest(&cinfo, fp);
+  cinfo.image_width = kWidth;
+  cinfo.image_height = kHeight;
+  cinfo.input_components = 3;
+  cinfo.in_color_space = JCS_RGB;
+  jpeg_set_defaults(&cinfo);
+  jpeg_set_quality(&cinfo, 90, TRUE);
+  jpeg_start_compress(&cinfo, TRUE);
+  while (cinfo.next_scanline < kHeight) {
+    JSAMPROW row = const_cast<unsigned char*>(rgb.data()) +
+                   (size_t)cinfo.next_scanline * kWidth * 3;
+    jpeg_write_scanlines(&cinfo, &row, 1);
+  }
+  jpeg_finish_compress(&cinfo);
+  jpeg_destroy_compress(&cinfo);
+  fclose(fp);
+}
+
+// kCorpusSize 1280 x 720 frames as JPEG (jpeg = true) or PPM files, written
+// once per format.
+const std::vector<std::string>& Corpus(bool jpeg) {
+  static std::vector<std::string> corpus[2];
+  std::vector<std::string>& files = corpus[jpeg];
+  if (files.empty()) {
+    const char* dir = getenv("TEST_TMPDIR");
+    for (int i = 0; i < kCorpusSize; ++i) {
+      const std::vector<unsigned char> rgb = Frame(i);
+      files.push_back(std::string(dir ? dir : "/tmp") + "/corpus" +
+                      std::to_string(i) + (jpeg ? ".jpg" : ".ppm"));
+      if (jpeg) {
+        WriteJpeg(files.back(), rgb);
+      } else {
+        pnm_save(files.back().c_str(), rgb.data(), kWidth, kHeight, 3);
+      }
+    }
+  }
+  return files;
+}
+
+// One image after the other on the calling thread. Arguments: JPEG, pooled
+// buffers, scale.
+void BM_DecodeSerial(benchmark::State& state) {
+  const std::vector<std::string>& files = Corpus(state.range(0) != 0);
+  ImageBufferPool pool;
+  DecodeOptions options;
+  options.scale = static_cast<unsigned int>(state.range(2));
+  for (auto _ : state) {
+    for (const std::string& file : files) {
+      DecodedImage image;
+      decode_image(file.c_str(), options, state.range(1) ? &pool : NULL,
+                   &image);
+      benchmark::DoNotOptimize(image.pixels.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * files.size());
+}
+
+// The whole corpus through a DecodePipeline. Arguments: JPEG, threads,
+// scale.
+void BM_DecodePipeline(benchmark::State& state) {
+  const std::vector<std::string>& files = Corpus(state.range(0) != 0);
+  ImageBufferPool pool;
+  DecodeOptions options;
+  options.scale = static_cast<unsigned int>(state.range(2));
+  for (auto _ : state) {
+    DecodePipeline pipeline(&pool, options,
+                            static_cast<int>(state.range(1)));
+    for (const std::string& file : files) pipeline.Submit(file);
+    pipeline.Close();
+    DecodedImage image;
+    while (pipeline.Next(&image)) {
+      benchmark::DoNotOptimize(image.pixels.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * files.size());
+}
+
+BENCHMARK(BM_DecodeSerial)
+    ->ArgsProduct({{1, 0}, {0, 1}, {1}})
+    ->Args({1, 1, 8})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DecodePipeline)
+    ->ArgsProduct({{1, 0}, {1, 4, 0}, {1}})
+    ->Args({1, 4, 8})
+    ->Args({1, 0, 8})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
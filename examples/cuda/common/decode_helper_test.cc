@@ -0,0 +1,286 @@
+#include "examples/cuda/common/decode_helper.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "examples/cuda/common/pnm_helper.h"
+#include "gtest/gtest.h"
+#include "jpeglib.h"
+
+namespace {
+
+/* A smooth w x h test pattern, so that JPEG round trips stay close. */
+std::vector<unsigned char> Pattern(unsigned int w, unsigned int h,
+                                   unsigned int channels) {
+  std::vector<unsigned char> p((size_t)w * h * channels);
+  for (unsigned int y = 0; y < h; ++y) {
+    for (unsigned int x = 0; x < w; ++x) {
+      for (unsigned int c = 0; c < channels; ++c) {
+        p[((size_t)y * w + x) * channels + c] =
+            (unsigned char)((x * 2 + y + c * 60) % 256);
+      }
+    }
+  }
+  return p;
+}
+
+std::string WriteJpeg(const std::string& name,
+                      const std::vector<unsigned char>& pixels,
+                      unsigned int w, unsigned int h, unsigned int channels) {
+  jpeg_compress_struct cinfo;
+  jpeg_error_mgr err;
+  cinfo.err = jpeg_std_error(&err);
+  jpeg_create_compress(&cinfo);
+  unsigned char* buffer = NULL;
+  unsigned long size = 0;
+  jpeg_mem_dest(&cinfo, &buffer, &size);
+  cinfo.image_width = w;
+  cinfo.image_height = h;
+  cinfo.input_components = channels;
+  cinfo.in_color_space = channels == 3 ? JCS_RGB : JCS_GRAYSCALE;
+  jpeg_set_defaults(&cinfo);
+  jpeg_set_quality(&cinfo, 98, TRUE);
+  jpeg_start_compress(&cinfo, TRUE);
+  while (cinfo.next_scanline < h) {
+    JSAMPROW row = const_cast<unsigned char*>(pixels.data()) +
+                   (size_t)cinfo.next_scanline * w * channels;
+    jpeg_write_scanlines(&cinfo, &row, 1);
+  }
+  jpeg_finish_compress(&cinfo);
+  jpeg_destroy_compress(&cinfo);
+
+  const std::string path = ::testing::TempDir() + name;
+  FILE* fp = fopen(path.c_str(), "wb");
+  fwrite(buffer, 1, size, fp);
+  fclose(fp);
+  free(buffer);
+  return path;
+}
+
+std::string WriteRaw(const std::string& name, const std::string& contents) {
+  const std::string path = ::testing::TempDir() + name;
+  FILE* fp = fopen(path.c_str(), "wb");
+  fwrite(contents.data(), 1, contents.size(), fp);
+  fclose(fp);
+  return path;
+}
+
+TEST(ImageBufferPoolTest, ReusesReleasedBuffers) {
+  ImageBufferPool pool(1 << 20);
+  PooledBuffer a = pool.Acquire(1000);
+  ASSERT_NE(a.data(), nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(a.data()) % 64, 0u);
+  EXPECT_EQ(a.size(), 1000u);
+  float* p = a.data();
+  a.Release();
+  EXPECT_EQ(a.data(), nullptr);
+
+  PooledBuffer b = pool.Acquire(900);
+  EXPECT_EQ(b.data(), p);
+  EXPECT_EQ(b.size(), 900u);
+  PooledBuffer c = pool.Acquire(2000);
+  EXPECT_NE(c.data(), p);
+  EXPECT_EQ(pool.allocations(), 2u);
+
+  // Beyond the cache limit buffers are freed, not kept.
+  PooledBuffer big = pool.Acquire(1 << 20);
+  big.Release();
+  PooledBuffer again = pool.Acquire(1 << 20);
+  EXPECT_EQ(pool.allocations(), 4u);
+
+  PooledBuffer moved = std::move(b);
+  EXPECT_EQ(moved.data(), p);
+  EXPECT_EQ(b.data(), nullptr);
+}
+
+TEST(DecodeImageTest, PpmMatchesConverterFromUByte) {
+  const unsigned int w = 13, h = 7;
+  const std::vector<unsigned char> rgb = Pattern(w, h, 3);
+  const std::string path = ::testing::TempDir() + "decode.ppm";
+  ASSERT_TRUE(pnm_save(path.c_str(), rgb.data(), w, h, 3));
+
+  ImageBufferPool pool;
+  DecodeOptions options;
+  DecodedImage image;
+  ASSERT_TRUE(decode_image(path.c_str(), options, &pool, &image))
+      << image.error;
+  EXPECT_EQ(image.width, w);
+  EXPECT_EQ(image.height, h);
+  ASSERT_EQ(image.channels, 3u);
+  const size_t plane = (size_t)w * h;
+  for (size_t i = 0; i < plane; ++i) {
+    for (unsigned int c = 0; c < 3; ++c) {
+      ASSERT_EQ(image.pixels.data()[c * plane + i], rgb[3 * i + c] / 255.0f);
+    }
+  }
+
+  options.layout = kDecodeInterleaved;
+  ASSERT_TRUE(decode_image(path.c_str(), options, NULL, &image));
+  for (size_t i = 0; i < rgb.size(); ++i) {
+    ASSERT_EQ(image.pixels.data()[i], rgb[i] / 255.0f);
+  }
+
+  // 13 x 7 in 4 x 4 boxes: the last column and row average partial boxes.
+  options.scale = 4;
+  ASSERT_TRUE(decode_image(path.c_str(), options, &pool, &image));
+  EXPECT_EQ(image.width, 4u);
+  EXPECT_EQ(image.height, 2u);
+  for (unsigned int y = 0; y < 2; ++y) {
+    for (unsigned int x = 0; x < 4; ++x) {
+      for (unsigned int c = 0; c < 3; ++c) {
+        unsigned int sum = 0, count = 0;
+        for (unsigned int sy = y * 4; sy < std::min(y * 4 + 4, h); ++sy) {
+          for (unsigned int sx = x * 4; sx < std::min(x * 4 + 4, w); ++sx) {
+            sum += rgb[(sy * w + sx) * 3 + c];
+            ++count;
+          }
+        }
+        ASSERT_EQ(image.pixels.data()[(y * 4 + x) * 3 + c],
+                  (unsigned char)((sum + count / 2) / count) / 255.0f);
+      }
+    }
+  }
+}
+
+TEST(DecodeImageTest, JpegScalesWithTheDct) {
+  const unsigned int w = 64, h = 48;
+  const std::vector<unsigned char> rgb = Pattern(w, h, 3);
+  const std::string path = WriteJpeg("decode.jpg", rgb, w, h, 3);
+
+  ImageBufferPool pool;
+  DecodeOptions options;
+  options.layout = kDecodeInterleaved;
+  DecodedImage image;
+  ASSERT_TRUE(decode_image(path.c_str(), options, &pool, &image))
+      << image.error;
+  ASSERT_EQ(image.width, w);
+  ASSERT_EQ(image.height, h);
+  ASSERT_EQ(image.channels, 3u);
+  double error = 0.0;
+  for (size_t i = 0; i < rgb.size(); ++i) {
+    const float v = image.pixels.data()[i];
+    ASSERT_GE(v, 0.0f);
+    ASSERT_LE(v, 1.0f);
+    // Exactly some 8-bit sample divided by 255.
+    ASSERT_EQ(v, roundf(v * 255.0f) / 255.0f);
+    error += fabs(v * 255.0f - rgb[i]);
+  }
+  EXPECT_LT(error / rgb.size(), 3.0);
+
+  // The planar layout holds the same samples.
+  const std::vector<float> interleaved(image.pixels.data(),
+                                       image.pixels.data() + rgb.size());
+  options.layout = kDecodePlanar;
+  ASSERT_TRUE(decode_image(path.c_str(), options, &pool, &image));
+  for (size_t i = 0; i < (size_t)w * h; ++i) {
+    for (unsigned int c = 0; c < 3; ++c) {
+      ASSERT_EQ(image.pixels.data()[c * w * h + i], interleaved[3 * i + c]);
+    }
+  }
+
+  for (unsigned int scale : {2u, 8u}) {
+    options.scale = scale;
+    ASSERT_TRUE(decode_image(path.c_str(), options, &pool, &image));
+    EXPECT_EQ(image.width, w / scale);
+    EXPECT_EQ(image.height, h / scale);
+  }
+  options.scale = 1;
+  options.grayscale = true;
+  ASSERT_TRUE(decode_image(path.c_str(), options, &pool, &image));
+  EXPECT_EQ(image.channels, 1u);
+
+  const std::vector<unsigned char> gray = Pattern(w, h, 1);
+  options.grayscale = false;
+  ASSERT_TRUE(decode_image(WriteJpeg("gray.jpg", gray, w, h, 1).c_str(),
+                           options, &pool, &image));
+  EXPECT_EQ(image.channels, 1u);
+}
+
+TEST(DecodeImageTest, ReportsErrors) {
+  DecodeOptions options;
+  DecodedImage image;
+  const std::string missing = ::testing::TempDir() + "missing.jpg";
+  EXPECT_FALSE(decode_image(missing.c_str(), options, NULL, &image));
+  EXPECT_FALSE(image.ok);
+  EXPECT_FALSE(image.error.empty());
+  EXPECT_FALSE(decode_image(WriteRaw("text.jpg", "hello").c_str(), options,
+                            NULL, &image));
+  // A JPEG cut off after its markers.
+  EXPECT_FALSE(decode_image(
+      WriteRaw("cut.jpg", std::string("\xff\xd8\xff\xe0\x00\x10JFIF", 10))
+          .c_str(),
+      options, NULL, &image));
+  EXPECT_EQ(image.pixels.data(), nullptr);
+  options.scale = 3;
+  EXPECT_FALSE(decode_image(
+      WriteJpeg("scale.jpg", Pattern(8, 8, 3), 8, 8, 3).c_str(), options,
+      NULL, &image));
+}
+
+TEST(DecodePipelineTest, DecodesEverySubmittedFile) {
+  const unsigned int w = 40, h = 30;
+  std::vector<std::string> files;
+  for (int i = 0; i < 24; ++i) {
+    const unsigned int iw = w + i % 4;
+    const std::vector<unsigned char> rgb = Pattern(iw, h, 3);
+    if (i % 2 == 0) {
+      files.push_back(
+          WriteJpeg("pipe" + std::to_string(i) + ".jpg", rgb, iw, h, 3));
+    } else {
+      files.push_back(::testing::TempDir() + "pipe" + std::to_string(i) +
+                      ".ppm");
+      ASSERT_TRUE(pnm_save(files.back().c_str(), rgb.data(), iw, h, 3));
+    }
+  }
+  files.push_back(::testing::TempDir() + "missing.ppm");
+
+  ImageBufferPool pool;
+  DecodeOptions options;
+  options.scale = 2;
+  // Small queues and a consumer that holds on to a few images at a time,
+  // so both Submit() and the workers have to wait.
+  DecodePipeline pipeline(&pool, options, 3, 2);
+  std::thread producer([&] {
+    for (const std::string& file : files) pipeline.Submit(file);
+    pipeline.Close();
+  });
+  std::set<size_t> seen;
+  std::vector<DecodedImage> held;
+  DecodedImage image;
+  while (pipeline.Next(&image)) {
+    EXPECT_TRUE(seen.insert(image.index).second);
+    ASSERT_LT(image.index, files.size());
+    EXPECT_EQ(image.file, files[image.index]);
+    if (image.index == 24) {
+      EXPECT_FALSE(image.ok);
+    } else {
+      ASSERT_TRUE(image.ok) << image.error;
+      EXPECT_EQ(image.width, (w + image.index % 4 + 1) / 2);
+      EXPECT_EQ(image.height, h / 2);
+      EXPECT_EQ(image.pixels.size(), image.width * image.height * 3);
+    }
+    held.push_back(std::move(image));
+    if (held.size() == 4) held.clear();
+  }
+  producer.join();
+  EXPECT_EQ(seen.size(), files.size());
+  EXPECT_FALSE(pipeline.Next(&image));
+  held.clear();
+  // Buffers were recycled rather than allocated per image.
+  EXPECT_LT(pool.allocations(), files.size());
+}
+
+TEST(DecodePipelineTest, DestructorDropsPendingWork) {
+  const std::vector<unsigned char> rgb = Pattern(16, 16, 3);
+  const std::string path = WriteJpeg("drop.jpg", rgb, 16, 16, 3);
+  ImageBufferPool pool;
+  DecodePipeline pipeline(&pool, DecodeOptions(), 2, 4);
+  for (int i = 0; i < 4; ++i) pipeline.Submit(path);
+}
+
+}  // namespace
@@ -29,159 +29,83 @@ void sdkDumpBin(void* data, unsigned int bytes, const char* filename) {
   fclose(fp);
 }
 
-bool sdkCompareBin2BinUint(const char* src_file, const char* ref_file,
-                           unsigned int nelements, const float epsilon,
-                           const float threshold, char* exec_path) {
-  unsigned int *src_buffer, *ref_buffer;
-  FILE *src_fp = NULL, *ref_fp = NULL;
-
-  uint64_t error_count = 0;
-  size_t fsize = 0;
-
-  if (FOPEN_FAIL(FOPEN(src_fp, src_file, "rb"))) {
-    printf("compareBin2Bin <unsigned int> unable to open src_file: %s\n",
-           src_file);
-    error_count++;
-  }
+namespace {
 
-  if (FOPEN_FAIL(FOPEN(ref_fp, ref_file, "rb"))) {
-    printf(
-        "compareBin2Bin <unsigned int>"
-        " unable to open ref_file: %s\n",
-        ref_file);
-    error_count++;
+// Prints the outcome of a streamed comparison the way the in-memory
+// compareData() helpers do.
+bool ReportBin2Bin(const char* type, const char* src_file,
+                   const char* ref_file, unsigned int nelements,
+                   const float epsilon, const float threshold,
+                   const CompareResult& result) {
+  printf("> compareBin2Bin <%s> nelements=%d, epsilon=%4.2f, threshold=%4.2f\n",
+         type, nelements, epsilon, threshold);
+  if (!result.opened) {
+    printf("  FAILURE: unable to compare <%s> with <%s>\n", src_file,
+           ref_file);
+    return false;
   }
-
-  if (src_fp && ref_fp) {
-    src_buffer = (unsigned int*)malloc(nelements * sizeof(unsigned int));
-    ref_buffer = (unsigned int*)malloc(nelements * sizeof(unsigned int));
-
-    fsize = fread(src_buffer, nelements, sizeof(unsigned int), src_fp);
-    fsize = fread(ref_buffer, nelements, sizeof(unsigned int), ref_fp);
-
-    printf(
-        "> compareBin2Bin <unsigned int> nelements=%d,"
-        " epsilon=%4.2f, threshold=%4.2f\n",
-        nelements, epsilon, threshold);
-    printf("   src_file <%s>, size=%d bytes\n", src_file,
-           static_cast<int>(fsize));
-    printf("   ref_file <%s>, size=%d bytes\n", ref_file,
-           static_cast<int>(fsize));
-
-    if (!compareData<unsigned int, float>(ref_buffer, src_buffer, nelements,
-                                          epsilon, threshold)) {
-      error_count++;
-    }
-
-    fclose(src_fp);
-    fclose(ref_fp);
-
-    free(src_buffer);
-    free(ref_buffer);
-  } else {
-    if (src_fp) {
-      fclose(src_fp);
-    }
-
-    if (ref_fp) {
-      fclose(ref_fp);
-    }
+  printf("   src_file <%s>, ref_file <%s>\n", src_file, ref_file);
+  const CompareStats& total = result.total;
+  if (total.error_count) {
+    printf("%4.2f(%%) of %zu compared elements mismatched (count=%zu%s),"
+           " first at %lld, max abs error %g, L2 relative error %g\n",
+           static_cast<double>(total.error_count) * 100 / total.count,
+           total.count, total.error_count,
+           result.stopped_early ? ", stopped early" : "",
+           total.first_mismatch, total.max_abs_error, total.l2_rel_error);
   }
 
-  if (error_count == 0) {
+  if (result.passed) {
     printf("  OK\n");
   } else {
-    printf("  FAILURE: %d errors...\n", (unsigned int)error_count);
+    printf("  FAILURE: %d errors...\n", static_cast<int>(total.error_count));
   }
+  return result.passed;  // returns true if all pixels pass
+}
+
+}  // namespace
 
-  return (error_count == 0);  // returns true if all pixels pass
+bool sdkCompareBin2BinUint(const char* src_file, const char* ref_file,
+                           unsigned int nelements, const float epsilon,
+                           const float threshold, char* exec_path) {
+  CompareOptions options;
+  options.epsilon = epsilon;
+  options.threshold = threshold;
+  CompareResult result;
+  sdkCompareBin2BinUintStream(src_file, ref_file, nelements, options,
+                              &result);
+  return ReportBin2Bin("unsigned int", src_file, ref_file, nelements,
+                       epsilon, threshold, result);
 }
 
 bool sdkCompareBin2BinFloat(const char* src_file, const char* ref_file,
                             unsigned int nelements, const float epsilon,
                             const float threshold, char* exec_path) {
-  float *src_buffer = NULL, *ref_buffer = NULL;
-  FILE *src_fp = NULL, *ref_fp = NULL;
-  size_t fsize = 0;
-
-  uint64_t error_count = 0;
-
-  if (FOPEN_FAIL(FOPEN(src_fp, src_file, "rb"))) {
-    printf("compareBin2Bin <float> unable to open src_file: %s\n", src_file);
-    error_count = 1;
-  }
-
-  if (FOPEN_FAIL(FOPEN(ref_fp, ref_file, "rb"))) {
-    printf("compareBin2Bin <float> unable to open ref_file: %s\n", ref_file);
-    error_count = 1;
-  }
-
-  if (src_fp && ref_fp) {
-    src_buffer = reinterpret_cast<float*>(malloc(nelements * sizeof(float)));
-    ref_buffer = reinterpret_cast<float*>(malloc(nelements * sizeof(float)));
-
-    printf(
-        "> compareBin2Bin <float> nelements=%d, epsilon=%4.2f,"
-        " threshold=%4.2f\n",
-        nelements, epsilon, threshold);
-    fsize = fread(src_buffer, sizeof(float), nelements, src_fp);
-    printf("   src_file <%s>, size=%d bytes\n", src_file,
-           static_cast<int>(fsize * sizeof(float)));
-    fsize = fread(ref_buffer, sizeof(float), nelements, ref_fp);
-    printf("   ref_file <%s>, size=%d bytes\n", ref_file,
-           static_cast<int>(fsize * sizeof(float)));
-
-    if (!compareDataAsFloatThreshold<float, float>(
-            ref_buffer, src_buffer, nelements, epsilon, threshold)) {
-      error_count++;
-    }
-
-    fclose(src_fp);
-    fclose(ref_fp);
-
-    free(src_buffer);
-    free(ref_buffer);
-  } else {
-    if (src_fp) {
-      fclose(src_fp);
-    }
-
-    if (ref_fp) {
-      fclose(ref_fp);
-    }
-  }
-
-  if (error_count == 0) {
-    printf("  OK\n");
-  } else {
-    printf("  FAILURE: %d errors...\n", (unsigned int)error_count);
-  }
-
-  return (error_count == 0);  // returns true if all pixels pass
+  CompareOptions options;
+  options.epsilon = epsilon;
+  options.threshold = threshold;
+  CompareResult result;
+  sdkCompareBin2BinFloatStream(src_file, ref_file, nelements, options,
+                               &result);
+  return ReportBin2Bin("float", src_file, ref_file, nelements, epsilon,
+                       threshold, result);
 }
 
 bool sdkCompareL2fe(const float* reference, const float* data,
                     const unsigned int len, const float epsilon) {
   assert(epsilon >= 0);
 
-  float error = 0;
-  float ref = 0;
-
-  for (unsigned int i = 0; i < len; ++i) {
-    float diff = reference[i] - data[i];
-    error += diff * diff;
-    ref += reference[i] * reference[i];
-  }
-
-  float normRef = sqrtf(ref);
+  // The sums of squares are accumulated in double, on several threads.
+  CompareOptions options;
+  options.early_exit = false;
+  CompareResult result;
+  compareDataStream(reference, data, len, options, &result);
 
-  if (fabs(ref) < 1e-7) {
+  if (fabs(result.total.sum_sq_ref) < 1e-7) {
     return false;
   }
 
-  float normError = sqrtf(error);
-  error = normError / normRef;
-  return error < epsilon;
+  return result.total.l2_rel_error < epsilon;
 }
 
 bool sdkLoadPPMub(const char* file, unsigned char** data, unsigned int* w,
@@ -192,30 +116,7 @@ bool sdkLoadPPMub(const char* file, unsigned char** data, unsigned int* w,
 
 bool sdkLoadPPM4ub(const char* file, unsigned char** data, unsigned int* w,
                    unsigned int* h) {
-  unsigned char* idata = 0;
-  unsigned int channels;
-
-  if (__loadPPM(file, &idata, w, h, &channels)) {
-    // pad 4th component
-    int size = *w * *h;
-    // keep the original pointer
-    unsigned char* idata_orig = idata;
-    *data = (unsigned char*)malloc(sizeof(unsigned char) * size * 4);
-    unsigned char* ptr = *data;
-
-    for (int i = 0; i < size; i++) {
-      *ptr++ = *idata++;
-      *ptr++ = *idata++;
-      *ptr++ = *idata++;
-      *ptr++ = 0;
-    }
-
-    free(idata_orig);
-    return true;
-  } else {
-    free(idata);
-    return false;
-  }
+  return sdkLoadPPM4(file, data, w, h);
 }
 
 bool sdkComparePPM(const char* src_file, const char* ref_file,
@@ -36,9 +36,12 @@
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+#include "examples/cuda/common/compare_helper.h"
 #include "examples/cuda/common/cuda_helper.h"
+#include "examples/cuda/common/pnm_helper.h"
 
 // namespace unnamed (internal)
 namespace helper_image_internal {
@@ -96,6 +99,68 @@ struct ConverterToUByte<float> {
     return static_cast<unsigned char>(val * 255.0f);
   }
 };
+
+//! Count the elements where the float difference of \a reference and
+//! \a data is not within (<=), or if \a strict not below (<), \a epsilon
+//! @param stop_at_first  return as soon as one mismatch is found
+template <class T, class S>
+inline size_t countMismatches(const T* reference, const T* data,
+                              const unsigned int len, const S epsilon,
+                              bool strict, bool stop_at_first) {
+  size_t error_count = 0;
+
+  for (unsigned int i = 0; i < len; ++i) {
+    float diff =
+        fabs(static_cast<float>(reference[i]) - static_cast<float>(data[i]));
+    bool comp = strict ? (diff < epsilon) : (diff <= epsilon);
+
+    if (!comp) {
+      error_count++;
+      if (stop_at_first) break;
+    }
+  }
+
+  return error_count;
+}
+
+//! float, unsigned int and unsigned char arrays with a float epsilon are
+//! compared by the SIMD kernels of compare_helper.h, on several threads
+template <class T>
+inline size_t countMismatchesStream(const T* reference, const T* data,
+                                    const unsigned int len,
+                                    const float epsilon, bool strict,
+                                    bool stop_at_first) {
+  CompareOptions options;
+  options.epsilon = epsilon;
+  options.rule = strict ? kCompareRuleBelow : kCompareRuleWithin;
+  options.early_exit = stop_at_first;
+  CompareResult result;
+  compareDataStream(reference, data, len, options, &result);
+  return result.total.error_count;
+}
+
+inline size_t countMismatches(const float* reference, const float* data,
+                              const unsigned int len, const float epsilon,
+                              bool strict, bool stop_at_first) {
+  return countMismatchesStream(reference, data, len, epsilon, strict,
+                               stop_at_first);
+}
+
+inline size_t countMismatches(const unsigned int* reference,
+                              const unsigned int* data,
+                              const unsigned int len, const float epsilon,
+                              bool strict, bool stop_at_first) {
+  return countMismatchesStream(reference, data, len, epsilon, strict,
+                               stop_at_first);
+}
+
+inline size_t countMismatches(const unsigned char* reference,
+                              const unsigned char* data,
+                              const unsigned int len, const float epsilon,
+                              bool strict, bool stop_at_first) {
+  return countMismatchesStream(reference, data, len, epsilon, strict,
+                               stop_at_first);
+}
 }  // namespace helper_image_internal
 
 #if defined(__linux__)
@@ -114,76 +179,29 @@ struct ConverterToUByte<float> {
 
 inline bool __loadPPM(const char* file, unsigned char** data, unsigned int* w,
                       unsigned int* h, unsigned int* channels) {
-  FILE* fp = NULL;
-
-  if (FOPEN_FAIL(FOPEN(fp, file, "rb"))) {
-    std::cerr << "__LoadPPM() : Failed to open file: " << file << std::endl;
-    return false;
-  }
-
-  // check header
-  char header[helper_image_internal::PGMHeaderSize];
+  // map the file and parse the header in place
+  MappedPnm image;
 
-  if (fgets(header, helper_image_internal::PGMHeaderSize, fp) == NULL) {
-    std::cerr << "__LoadPPM() : reading PGM header returned NULL" << std::endl;
-    return false;
-  }
-
-  if (strncmp(header, "P5", 2) == 0) {
-    *channels = 1;
-  } else if (strncmp(header, "P6", 2) == 0) {
-    *channels = 3;
-  } else {
-    std::cerr << "__LoadPPM() : File is not a PPM or PGM image" << std::endl;
+  if (!image.Open(file)) {
+    std::cerr << "__LoadPPM() : Failed to load file: " << file << std::endl;
     *channels = 0;
     return false;
   }
 
-  // parse header, read maxval, width and height
-  unsigned int width = 0;
-  unsigned int height = 0;
-  unsigned int maxval = 0;
-  unsigned int i = 0;
-
-  while (i < 3) {
-    if (fgets(header, helper_image_internal::PGMHeaderSize, fp) == NULL) {
-      std::cerr << "__LoadPPM() : reading PGM header returned NULL"
-                << std::endl;
-      return false;
-    }
-
-    if (header[0] == '#') {
-      continue;
-    }
-
-    if (i == 0) {
-      i += SSCANF(header, "%u %u %u", &width, &height, &maxval);
-    } else if (i == 1) {
-      i += SSCANF(header, "%u %u", &height, &maxval);
-    } else if (i == 2) {
-      i += SSCANF(header, "%u", &maxval);
-    }
-  }
+  *channels = image.channels();
 
   // check if given handle for the data is initialized
   if (NULL != *data) {
-    if (*w != width || *h != height) {
+    if (*w != image.width() || *h != image.height()) {
       std::cerr << "__LoadPPM() : Invalid image dimensions." << std::endl;
     }
   } else {
-    *data = (unsigned char*)malloc(sizeof(unsigned char) * width * height *
-                                   *channels);
-    *w = width;
-    *h = height;
+    *data = (unsigned char*)malloc(sizeof(unsigned char) * image.size());
+    *w = image.width();
+    *h = image.height();
   }
 
-  // read and close file
-  if (fread(*data, sizeof(unsigned char), width * height * *channels, fp) ==
-      0) {
-    std::cerr << "__LoadPPM() read data returned error." << std::endl;
-  }
-
-  fclose(fp);
+  memcpy(*data, image.pixels(), image.size());
 
   return true;
 }
@@ -194,93 +212,71 @@ inline bool __savePPM(const char* file, unsigned char* data, unsigned int w,
   assert(w > 0);
   assert(h > 0);
 
-  std::fstream fh(file, std::fstream::out | std::fstream::binary);
-
-  if (fh.bad()) {
-    std::cerr << "__savePPM() : Opening file failed." << std::endl;
-    return false;
-  }
-
-  if (channels == 1) {
-    fh << "P5\n";
-  } else if (channels == 3) {
-    fh << "P6\n";
-  } else {
-    std::cerr << "__savePPM() : Invalid number of channels." << std::endl;
-    return false;
-  }
-
-  fh << w << "\n" << h << "\n" << 0xff << std::endl;
-
-  for (unsigned int i = 0; (i < (w * h * channels)) && fh.good(); ++i) {
-    fh << data[i];
-  }
-
-  fh.flush();
-
-  if (fh.bad()) {
-    std::cerr << "__savePPM() : Writing data failed." << std::endl;
-    return false;
-  }
+  // header and payload in a single write
+  return pnm_save(file, data, w, h, channels);
+}
 
-  fh.close();
+namespace helper_image_internal {
+//! Convert n samples with ConverterFromUByte<T>
+template <class T>
+inline void convertFromUByte(const unsigned char* src, size_t n, T* dst) {
+  std::transform(src, src + n, dst, ConverterFromUByte<T>());
+}
 
-  return true;
+//! the same, vectorized and threaded
+inline void convertFromUByte(const unsigned char* src, size_t n,
+                             float* dst) {
+  pnm_normalize(src, n, dst);
 }
+}  // namespace helper_image_internal
+
 template <class T>
 inline bool sdkLoadPGM(const char* file, T** data, unsigned int* w,
                        unsigned int* h) {
-  unsigned char* idata = NULL;
-  unsigned int channels;
+  // convert straight from the mapped file
+  MappedPnm image;
 
-  if (true != __loadPPM(file, &idata, w, h, &channels)) {
+  if (!image.Open(file)) {
     return false;
   }
 
-  unsigned int size = *w * *h * channels;
+  *w = image.width();
+  *h = image.height();
+  size_t size = image.size();
 
   // initialize mem if necessary
-  // the correct size is checked / set in loadPGMc()
   if (NULL == *data) {
     *data = reinterpret_cast<T*>(malloc(sizeof(T) * size));
   }
 
   // copy and cast data
-  std::transform(idata, idata + size, *data,
-                 helper_image_internal::ConverterFromUByte<T>());
-
-  free(idata);
+  helper_image_internal::convertFromUByte(image.pixels(), size, *data);
 
   return true;
 }
 
+//! Load a PPM (or PGM) file as RGBA with a zero 4th component, as unsigned
+//! char or float normalized as ConverterFromUByte<float> does
 template <class T>
 inline bool sdkLoadPPM4(const char* file, T** data, unsigned int* w,
                         unsigned int* h) {
-  unsigned char* idata = 0;
-  unsigned int channels;
-
-  if (__loadPPM(file, &idata, w, h, &channels)) {
-    // pad 4th component
-    int size = *w * *h;
-    // keep the original pointer
-    unsigned char* idata_orig = idata;
-    *data = reinterpret_cast<T*>(malloc(sizeof(T) * size * 4));
-    unsigned char* ptr = *data;
-
-    for (int i = 0; i < size; i++) {
-      *ptr++ = *idata++;
-      *ptr++ = *idata++;
-      *ptr++ = *idata++;
-      *ptr++ = 0;
-    }
+  static_assert(std::is_same<T, unsigned char>::value ||
+                    std::is_same<T, float>::value,
+                "sdkLoadPPM4 loads unsigned char or float");
+  MappedPnm image;
 
-    free(idata_orig);
-    return true;
-  } else {
-    free(idata);
+  if (!image.Open(file)) {
     return false;
   }
+
+  // pad 4th component in the same pass that reads the file
+  *w = image.width();
+  *h = image.height();
+  size_t size = (size_t)*w * *h;
+  *data = reinterpret_cast<T*>(malloc(sizeof(T) * size * 4));
+  pnm_expand_rgba(image.pixels(), image.channels(), size, *data);
+
+  return true;
 }
 
 template <class T>
@@ -481,16 +477,11 @@ inline bool compareData(const T* reference, const T* data,
                         const float threshold) {
   assert(epsilon >= 0);
 
-  bool result = true;
-  unsigned int error_count = 0;
-
-  for (unsigned int i = 0; i < len; ++i) {
-    float diff = static_cast<float>(reference[i]) - static_cast<float>(data[i]);
-    bool comp = (diff <= epsilon) && (diff >= -epsilon);
-    result &= comp;
-
-    error_count += !comp;
-  }
+  // Without a threshold only the first mismatch matters.
+  unsigned int error_count =
+      static_cast<unsigned int>(helper_image_internal::countMismatches(
+          reference, data, len, epsilon, false, threshold == 0.0f));
+  bool result = error_count == 0;
 
   if (threshold == 0.0f) {
     return (result) ? true : false;
@@ -523,17 +514,8 @@ inline bool compareDataAsFloatThreshold(const T* reference, const T* data,
   constexpr float kMinEpisilonError = 1e-3f;
   // If we set epsilon to be 0, let's set a minimum threshold
   float max_error = std::max((float)epsilon, kMinEpisilonError);
-  int error_count = 0;
-
-  for (unsigned int i = 0; i < len; ++i) {
-    float diff =
-        fabs(static_cast<float>(reference[i]) - static_cast<float>(data[i]));
-    bool comp = (diff < max_error);
-
-    if (!comp) {
-      error_count++;
-    }
-  }
+  int error_count = static_cast<int>(helper_image_internal::countMismatches(
+      reference, data, len, max_error, true, false));
 
   if (threshold == 0.0f) {
     if (error_count) {
@@ -0,0 +1,116 @@
+#include "examples/cuda/common/image_helper.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<float> RandomFloats(size_t n, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> value(-10.0f, 10.0f);
+  std::vector<float> x(n);
+  for (float& v : x) v = value(rng);
+  return x;
+}
+
+TEST(ImageHelperTest, LoadsSavedImages) {
+  const unsigned int w = 37, h = 5;
+  std::vector<unsigned char> rgb(w * h * 3);
+  for (size_t i = 0; i < rgb.size(); ++i) rgb[i] = i * 11 % 256;
+  const std::string ppm = ::testing::TempDir() + "image.ppm";
+  ASSERT_TRUE(__savePPM(ppm.c_str(), rgb.data(), w, h, 3));
+
+  unsigned char* data = NULL;
+  unsigned int lw = 0, lh = 0, channels = 0;
+  ASSERT_TRUE(__loadPPM(ppm.c_str(), &data, &lw, &lh, &channels));
+  EXPECT_EQ(lw, w);
+  EXPECT_EQ(lh, h);
+  EXPECT_EQ(channels, 3u);
+  EXPECT_EQ(std::vector<unsigned char>(data, data + rgb.size()), rgb);
+  free(data);
+
+  data = NULL;
+  ASSERT_TRUE(sdkLoadPPM4ub(ppm.c_str(), &data, &lw, &lh));
+  float* fdata = NULL;
+  ASSERT_TRUE(sdkLoadPPM4(ppm.c_str(), &fdata, &lw, &lh));
+  for (size_t i = 0; i < w * h; ++i) {
+    for (int c = 0; c < 4; ++c) {
+      const unsigned char expect = c == 3 ? 0 : rgb[3 * i + c];
+      ASSERT_EQ(data[4 * i + c], expect) << i;
+      ASSERT_EQ(fdata[4 * i + c], expect / 255.0f) << i;
+    }
+  }
+  free(data);
+  free(fdata);
+
+  const std::string pgm = ::testing::TempDir() + "image.pgm";
+  ASSERT_TRUE(sdkSavePGM(pgm.c_str(), rgb.data(), w, h));
+  fdata = NULL;
+  ASSERT_TRUE(sdkLoadPGM(pgm.c_str(), &fdata, &lw, &lh));
+  for (size_t i = 0; i < w * h; ++i) ASSERT_EQ(fdata[i], rgb[i] / 255.0f);
+  free(fdata);
+  EXPECT_TRUE(sdkComparePGM(pgm.c_str(), pgm.c_str(), 0.0f, 0.0f, false));
+  const std::string missing = ::testing::TempDir() + "missing.pgm";
+  EXPECT_FALSE(sdkLoadPGM(missing.c_str(), &fdata, &lw, &lh));
+}
+
+TEST(ImageHelperTest, CompareDataKernelsMatchScalarLoop) {
+  const std::vector<float> ref = RandomFloats(100003, 1);
+  std::vector<float> src = ref;
+  for (size_t i = 3; i < src.size(); i += 101) src[i] += 0.01f * (i % 7);
+  src[500] = NAN;
+  for (float epsilon : {0.0f, 0.01f, 0.03f}) {
+    // The float overload goes to compare_helper; a double epsilon takes the
+    // scalar template.
+    const size_t simd = helper_image_internal::countMismatches(
+        ref.data(), src.data(), ref.size(), epsilon, false, false);
+    const size_t scalar = helper_image_internal::countMismatches(
+        ref.data(), src.data(), ref.size(), static_cast<double>(epsilon),
+        false, false);
+    EXPECT_EQ(simd, scalar) << epsilon;
+    EXPECT_EQ(helper_image_internal::countMismatches(
+                  ref.data(), src.data(), ref.size(), epsilon, true, false),
+              helper_image_internal::countMismatches(
+                  ref.data(), src.data(), ref.size(),
+                  static_cast<double>(epsilon), true, false))
+        << epsilon;
+  }
+}
+
+TEST(ImageHelperTest, CompareDataThresholds) {
+  std::vector<unsigned char> ref(1000, 100), src(1000, 100);
+  src[10] = 102;
+  src[20] = 99;
+  EXPECT_FALSE(compareData(ref.data(), src.data(), 1000, 1.0f, 0.0f));
+  EXPECT_TRUE(compareData(ref.data(), src.data(), 1000, 2.0f, 0.0f));
+  EXPECT_TRUE(compareData(ref.data(), src.data(), 1000, 1.0f, 0.01f));
+  EXPECT_FALSE(compareData(ref.data(), src.data(), 1000, 0.0f, 0.002f));
+
+  std::vector<float> fref(1000, 1.0f), fsrc(1000, 1.0f);
+  fsrc[7] = 1.0005f;  // within the minimum epsilon of 1e-3
+  EXPECT_TRUE(
+      compareDataAsFloatThreshold(fref.data(), fsrc.data(), 1000, 0.0f, 0.0f));
+  fsrc[8] = 1.5f;
+  EXPECT_FALSE(
+      compareDataAsFloatThreshold(fref.data(), fsrc.data(), 1000, 0.1f, 0.0f));
+  EXPECT_TRUE(compareDataAsFloatThreshold(fref.data(), fsrc.data(), 1000,
+                                          0.1f, 0.01f));
+}
+
+TEST(ImageHelperTest, CompareL2fe) {
+  std::vector<float> ref(1 << 20, 1.0f), src = ref;
+  for (size_t i = 0; i < src.size(); i += 2) src[i] = 1.001f;
+  // |ref - src|_2 / |ref|_2 = 0.001 / sqrt(2)
+  EXPECT_TRUE(sdkCompareL2fe(ref.data(), src.data(), ref.size(), 7.1e-4f));
+  EXPECT_FALSE(sdkCompareL2fe(ref.data(), src.data(), ref.size(), 7.0e-4f));
+  std::vector<float> zero(16, 0.0f);
+  EXPECT_FALSE(sdkCompareL2fe(zero.data(), zero.data(), 16, 1.0f));
+}
+
+}  // namespace
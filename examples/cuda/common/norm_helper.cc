@@ -0,0 +1,554 @@
+#include "examples/cuda/common/norm_helper.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "examples/cuda/common/parallel_helper.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NORM_HELPER_X86 1
+#endif
+
+namespace {
+
+constexpr long long kMinElementsPerThread = 1 << 17;
+
+/* Rows per block of the |A|_inf row sums; 4 KB of accumulators. */
+constexpr int kRowBlock = 512;
+
+/* Range in which a plain sum of squares neither overflows nor loses bits to
+ * underflow. */
+constexpr double kSumSquaresMin = 1e-280;
+constexpr double kSumSquaresMax = 1e280;
+
+/* One implementation of each primitive per instruction set. */
+struct Kernels {
+  double (*abs_max)(const double* x, int n);
+  double (*abs_sum)(const double* x, int n);
+  double (*sum_squares)(const double* x, int n);
+  /* acc[i] += |x[i]| */
+  void (*add_abs)(const double* x, int n, double* acc);
+  /* max over rows [begin, end) of sum |val| */
+  double (*row_abs_max)(const double* val, const int* rowPtr, int base,
+                        int begin, int end);
+};
+
+double AbsMaxScalar(const double* x, int n) {
+  double r = 0.0;
+  for (int i = 0; i < n; ++i) {
+    const double a = fabs(x[i]);
+    r = (r > a) ? r : a;
+  }
+  return r;
+}
+
+double AbsSumScalar(const double* x, int n) {
+  double r = 0.0;
+  for (int i = 0; i < n; ++i) r += fabs(x[i]);
+  return r;
+}
+
+double SumSquaresScalar(const double* x, int n) {
+  double r = 0.0;
+  for (int i = 0; i < n; ++i) r += x[i] * x[i];
+  return r;
+}
+
+void AddAbsScalar(const double* x, int n, double* acc) {
+  for (int i = 0; i < n; ++i) acc[i] += fabs(x[i]);
+}
+
+double RowAbsMaxScalar(const double* val, const int* rowPtr, int base,
+                       int begin, int end) {
+  double r = 0.0;
+  for (int i = begin; i < end; ++i) {
+    r = fmax(r,
+             AbsSumScalar(val + rowPtr[i] - base, rowPtr[i + 1] - rowPtr[i]));
+  }
+  return r;
+}
+
+constexpr Kernels kScalarKernels = {AbsMaxScalar, AbsSumScalar,
+                                    SumSquaresScalar, AddAbsScalar,
+                                    RowAbsMaxScalar};
+
+#ifdef NORM_HELPER_X86
+
+/* SSE2: 2 lanes, two accumulators. */
+
+__attribute__((target("sse2"))) inline __m128d AbsSse2(__m128d v) {
+  return _mm_andnot_pd(_mm_set1_pd(-0.0), v);
+}
+
+__attribute__((target("sse2"))) inline double HorizontalSse2(__m128d v,
+                                                             bool max) {
+  const __m128d hi = _mm_unpackhi_pd(v, v);
+  return _mm_cvtsd_f64(max ? _mm_max_sd(v, hi) : _mm_add_sd(v, hi));
+}
+
+__attribute__((target("sse2"))) double AbsMaxSse2(const double* x, int n) {
+  __m128d m0 = _mm_setzero_pd(), m1 = _mm_setzero_pd();
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    m0 = _mm_max_pd(m0, AbsSse2(_mm_loadu_pd(x + i)));
+    m1 = _mm_max_pd(m1, AbsSse2(_mm_loadu_pd(x + i + 2)));
+  }
+  double r = HorizontalSse2(_mm_max_pd(m0, m1), true);
+  for (; i < n; ++i) r = fmax(r, fabs(x[i]));
+  return r;
+}
+
+__attribute__((target("sse2"))) double AbsSumSse2(const double* x, int n) {
+  __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    s0 = _mm_add_pd(s0, AbsSse2(_mm_loadu_pd(x + i)));
+    s1 = _mm_add_pd(s1, AbsSse2(_mm_loadu_pd(x + i + 2)));
+  }
+  double r = HorizontalSse2(_mm_add_pd(s0, s1), false);
+  for (; i < n; ++i) r += fabs(x[i]);
+  return r;
+}
+
+__attribute__((target("sse2"))) double SumSquaresSse2(const double* x,
+                                                      int n) {
+  __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128d a = _mm_loadu_pd(x + i), b = _mm_loadu_pd(x + i + 2);
+    s0 = _mm_add_pd(s0, _mm_mul_pd(a, a));
+    s1 = _mm_add_pd(s1, _mm_mul_pd(b, b));
+  }
+  double r = HorizontalSse2(_mm_add_pd(s0, s1), false);
+  for (; i < n; ++i) r += x[i] * x[i];
+  return r;
+}
+
+__attribute__((target("sse2"))) void AddAbsSse2(const double* x, int n,
+                                                double* acc) {
+  int i = 0;
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(acc + i, _mm_add_pd(_mm_loadu_pd(acc + i),
+                                      AbsSse2(_mm_loadu_pd(x + i))));
+  }
+  for (; i < n; ++i) acc[i] += fabs(x[i]);
+}
+
+__attribute__((target("sse2"))) double RowAbsMaxSse2(const double* val,
+                                                     const int* rowPtr,
+                                                     int base, int begin,
+                                                     int end) {
+  double r = 0.0;
+  for (int i = begin; i < end; ++i) {
+    r = fmax(r, AbsSumSse2(val + rowPtr[i] - base, rowPtr[i + 1] - rowPtr[i]));
+  }
+  return r;
+}
+
+/* AVX2: 4 lanes, two accumulators. */
+
+__attribute__((target("avx2"))) inline __m256d AbsAvx2(__m256d v) {
+  return _mm256_andnot_pd(_mm256_set1_pd(-0.0), v);
+}
+
+__attribute__((target("avx2"))) inline double HorizontalAvx2(__m256d v,
+                                                             bool max) {
+  const __m128d lo = _mm256_castpd256_pd128(v);
+  const __m128d hi = _mm256_extractf128_pd(v, 1);
+  const __m128d h = max ? _mm_max_pd(lo, hi) : _mm_add_pd(lo, hi);
+  const __m128d h1 = _mm_unpackhi_pd(h, h);
+  return _mm_cvtsd_f64(max ? _mm_max_sd(h, h1) : _mm_add_sd(h, h1));
+}
+
+__attribute__((target("avx2"))) double AbsMaxAvx2(const double* x, int n) {
+  __m256d m0 = _mm256_setzero_pd(), m1 = _mm256_setzero_pd();
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    m0 = _mm256_max_pd(m0, AbsAvx2(_mm256_loadu_pd(x + i)));
+    m1 = _mm256_max_pd(m1, AbsAvx2(_mm256_loadu_pd(x + i + 4)));
+  }
+  double r = HorizontalAvx2(_mm256_max_pd(m0, m1), true);
+  for (; i < n; ++i) r = fmax(r, fabs(x[i]));
+  return r;
+}
+
+__attribute__((target("avx2"))) double AbsSumAvx2(const double* x, int n) {
+  __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    s0 = _mm256_add_pd(s0, AbsAvx2(_mm256_loadu_pd(x + i)));
+    s1 = _mm256_add_pd(s1, AbsAvx2(_mm256_loadu_pd(x + i + 4)));
+  }
+  double r = HorizontalAvx2(_mm256_add_pd(s0, s1), false);
+  for (; i < n; ++i) r += fabs(x[i]);
+  return r;
+}
+
+__attribute__((target("avx2,fma"))) double SumSquaresAvx2(const double* x,
+                                                          int n) {
+  __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256d a = _mm256_loadu_pd(x + i);
+    const __m256d b = _mm256_loadu_pd(x + i + 4);
+    s0 = _mm256_fmadd_pd(a, a, s0);
+    s1 = _mm256_fmadd_pd(b, b, s1);
+  }
+  double r = HorizontalAvx2(_mm256_add_pd(s0, s1), false);
+  for (; i < n; ++i) r += x[i] * x[i];
+  return r;
+}
+
+__attribute__((target("avx2"))) void AddAbsAvx2(const double* x, int n,
+                                                double* acc) {
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(acc + i, _mm256_add_pd(_mm256_loadu_pd(acc + i),
+                                            AbsAvx2(_mm256_loadu_pd(x + i))));
+  }
+  for (; i < n; ++i) acc[i] += fabs(x[i]);
+}
+
+__attribute__((target("avx2"))) double RowAbsMaxAvx2(const double* val,
+                                                     const int* rowPtr,
+                                                     int base, int begin,
+                                                     int end) {
+  double r = 0.0;
+  for (int i = begin; i < end; ++i) {
+    r = fmax(r, AbsSumAvx2(val + rowPtr[i] - base, rowPtr[i + 1] - rowPtr[i]));
+  }
+  return r;
+}
+
+/* AVX-512: 8 lanes, masked tails. */
+
+__attribute__((target("avx512f"))) inline __mmask8 TailMask(int left) {
+  return static_cast<__mmask8>((1u << left) - 1);
+}
+
+__attribute__((target("avx512f"))) double AbsMaxAvx512(const double* x,
+                                                       int n) {
+  __m512d m0 = _mm512_setzero_pd(), m1 = _mm512_setzero_pd();
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    m0 = _mm512_max_pd(m0, _mm512_abs_pd(_mm512_loadu_pd(x + i)));
+    m1 = _mm512_max_pd(m1, _mm512_abs_pd(_mm512_loadu_pd(x + i + 8)));
+  }
+  for (; i + 8 <= n; i += 8) {
+    m0 = _mm512_max_pd(m0, _mm512_abs_pd(_mm512_loadu_pd(x + i)));
+  }
+  if (i < n) {
+    m1 = _mm512_max_pd(
+        m1, _mm512_abs_pd(_mm512_maskz_loadu_pd(TailMask(n - i), x + i)));
+  }
+  return _mm512_reduce_max_pd(_mm512_max_pd(m0, m1));
+}
+
+__attribute__((target("avx512f"))) double AbsSumAvx512(const double* x,
+                                                       int n) {
+  __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    s0 = _mm512_add_pd(s0, _mm512_abs_pd(_mm512_loadu_pd(x + i)));
+    s1 = _mm512_add_pd(s1, _mm512_abs_pd(_mm512_loadu_pd(x + i + 8)));
+  }
+  for (; i + 8 <= n; i += 8) {
+    s0 = _mm512_add_pd(s0, _mm512_abs_pd(_mm512_loadu_pd(x + i)));
+  }
+  if (i < n) {
+    s1 = _mm512_add_pd(
+        s1, _mm512_abs_pd(_mm512_maskz_loadu_pd(TailMask(n - i), x + i)));
+  }
+  return _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+}
+
+__attribute__((target("avx512f"))) double SumSquaresAvx512(const double* x,
+                                                           int n) {
+  __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m512d a = _mm512_loadu_pd(x + i);
+    const __m512d b = _mm512_loadu_pd(x + i + 8);
+    s0 = _mm512_fmadd_pd(a, a, s0);
+    s1 = _mm512_fmadd_pd(b, b, s1);
+  }
+  for (; i + 8 <= n; i += 8) {
+    const __m512d a = _mm512_loadu_pd(x + i);
+    s0 = _mm512_fmadd_pd(a, a, s0);
+  }
+  if (i < n) {
+    const __m512d a = _mm512_maskz_loadu_pd(TailMask(n - i), x + i);
+    s1 = _mm512_fmadd_pd(a, a, s1);
+  }
+  return _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+}
+
+__attribute__((target("avx512f"))) void AddAbsAvx512(const double* x, int n,
+                                                     double* acc) {
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm512_storeu_pd(acc + i,
+                     _mm512_add_pd(_mm512_loadu_pd(acc + i),
+                                   _mm512_abs_pd(_mm512_loadu_pd(x + i))));
+  }
+  if (i < n) {
+    const __mmask8 mask = TailMask(n - i);
+    _mm512_mask_storeu_pd(
+        acc + i, mask,
+        _mm512_add_pd(_mm512_maskz_loadu_pd(mask, acc + i),
+                      _mm512_abs_pd(_mm512_maskz_loadu_pd(mask, x + i))));
+  }
+}
+
+__attribute__((target("avx512f"))) double RowAbsMaxAvx512(const double* val,
+                                                          const int* rowPtr,
+                                                          int base, int begin,
+                                                          int end) {
+  double r = 0.0;
+  for (int i = begin; i < end; ++i) {
+    r = fmax(r,
+             AbsSumAvx512(val + rowPtr[i] - base, rowPtr[i + 1] - rowPtr[i]));
+  }
+  return r;
+}
+
+constexpr Kernels kSse2Kernels = {AbsMaxSse2, AbsSumSse2, SumSquaresSse2,
+                                  AddAbsSse2, RowAbsMaxSse2};
+constexpr Kernels kAvx2Kernels = {AbsMaxAvx2, AbsSumAvx2, SumSquaresAvx2,
+                                  AddAbsAvx2, RowAbsMaxAvx2};
+constexpr Kernels kAvx512Kernels = {AbsMaxAvx512, AbsSumAvx512,
+                                    SumSquaresAvx512, AddAbsAvx512,
+                                    RowAbsMaxAvx512};
+
+#endif  // NORM_HELPER_X86
+
+/* -1 until the first call detects the CPU. */
+std::atomic<int> active_isa{-1};
+
+NormIsa ActiveIsa() {
+  int isa = active_isa.load(std::memory_order_relaxed);
+  if (isa < 0) {
+    isa = kNormIsaScalar;
+    for (NormIsa candidate : {kNormIsaSse2, kNormIsaAvx2, kNormIsaAvx512}) {
+      if (norm_isa_supported(candidate)) isa = candidate;
+    }
+    active_isa.store(isa, std::memory_order_relaxed);
+  }
+  return static_cast<NormIsa>(isa);
+}
+
+const Kernels& ActiveKernels() {
+  switch (ActiveIsa()) {
+#ifdef NORM_HELPER_X86
+    case kNormIsaSse2:
+      return kSse2Kernels;
+    case kNormIsaAvx2:
+      return kAvx2Kernels;
+    case kNormIsaAvx512:
+      return kAvx512Kernels;
+#endif
+    default:
+      return kScalarKernels;
+  }
+}
+
+int NumThreads(long long work) {
+  return ParallelThreads(work, 0, kMinElementsPerThread);
+}
+
+/*
+ * Splits [0, n) into one block per thread, maps each block with
+ * fn(begin, end) and folds the partial results with combine().
+ */
+template <typename Fn, typename Combine>
+double Reduce(int n, long long work, Fn fn, Combine combine) {
+  const int num_threads = NumThreads(work);
+  if (num_threads == 1) return fn(0, n);
+  std::vector<double> partial(num_threads);
+  ParallelFor(num_threads, [&](int t) {
+    partial[t] =
+        fn(BlockBegin(n, t, num_threads), BlockBegin(n, t + 1, num_threads));
+  });
+  double r = partial[0];
+  for (int t = 1; t < num_threads; ++t) r = combine(r, partial[t]);
+  return r;
+}
+
+double Max(double a, double b) { return fmax(a, b); }
+double Sum(double a, double b) { return a + b; }
+
+/* sqrt(sum x^2) of a sum of squares ss, rescaling by max |x| when ss is
+ * outside the safe range. column(j) gives the j-th of count contiguous
+ * pieces of length len. */
+template <typename Column>
+double SafeSqrt(double ss, int count, int len, Column column) {
+  if (ss >= kSumSquaresMin && ss <= kSumSquaresMax) return sqrt(ss);
+  double scale = 0.0;
+  for (int j = 0; j < count; ++j) {
+    scale = fmax(scale, AbsMaxScalar(column(j), len));
+  }
+  if (scale == 0.0 || isinf(scale)) return scale;
+  double sum = 0.0;
+  for (int j = 0; j < count; ++j) {
+    const double* x = column(j);
+    for (int i = 0; i < len; ++i) {
+      const double v = x[i] / scale;
+      sum += v * v;
+    }
+  }
+  return scale * sqrt(sum);
+}
+
+}  // namespace
+
+bool norm_isa_supported(NormIsa isa) {
+  switch (isa) {
+    case kNormIsaScalar:
+      return true;
+#ifdef NORM_HELPER_X86
+    case kNormIsaSse2:
+      return __builtin_cpu_supports("sse2");
+    case kNormIsaAvx2:
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case kNormIsaAvx512:
+      return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+      return false;
+  }
+}
+
+NormIsa norm_isa(void) { return ActiveIsa(); }
+
+const char* norm_isa_name(NormIsa isa) {
+  switch (isa) {
+    case kNormIsaSse2:
+      return "sse2";
+    case kNormIsaAvx2:
+      return "avx2";
+    case kNormIsaAvx512:
+      return "avx512";
+    default:
+      return "scalar";
+  }
+}
+
+bool norm_set_isa(NormIsa isa) {
+  if (!norm_isa_supported(isa)) return false;
+  active_isa.store(isa, std::memory_order_relaxed);
+  return true;
+}
+
+double vec_norm1_simd(int n, const double* x) {
+  const Kernels& k = ActiveKernels();
+  return Reduce(
+      n, n,
+      [&](int begin, int end) { return k.abs_sum(x + begin, end - begin); },
+      Sum);
+}
+
+double vec_norm2_simd(int n, const double* x) {
+  const Kernels& k = ActiveKernels();
+  const double ss = Reduce(
+      n, n,
+      [&](int begin, int end) { return k.sum_squares(x + begin, end - begin); },
+      Sum);
+  return SafeSqrt(ss, 1, n, [x](int) { return x; });
+}
+
+double vec_norminf_simd(int n, const double* x) {
+  const Kernels& k = ActiveKernels();
+  return Reduce(
+      n, n,
+      [&](int begin, int end) { return k.abs_max(x + begin, end - begin); },
+      Max);
+}
+
+double mat_norm1_simd(int m, int n, const double* A, int lda) {
+  const Kernels& k = ActiveKernels();
+  return Reduce(
+      n, static_cast<long long>(m) * n,
+      [&](int begin, int end) {
+        double r = 0.0;
+        for (int j = begin; j < end; ++j) {
+          r = fmax(r, k.abs_sum(A + static_cast<long long>(j) * lda, m));
+        }
+        return r;
+      },
+      Max);
+}
+
+double mat_normfro_simd(int m, int n, const double* A, int lda) {
+  const Kernels& k = ActiveKernels();
+  const double ss = Reduce(
+      n, static_cast<long long>(m) * n,
+      [&](int begin, int end) {
+        double r = 0.0;
+        for (int j = begin; j < end; ++j) {
+          r += k.sum_squares(A + static_cast<long long>(j) * lda, m);
+        }
+        return r;
+      },
+      Sum);
+  return SafeSqrt(ss, n, m, [A, lda](int j) {
+    return A + static_cast<long long>(j) * lda;
+  });
+}
+
+double mat_norminf_simd(int m, int n, const double* A, int lda) {
+  const Kernels& k = ActiveKernels();
+  const int blocks = (m + kRowBlock - 1) / kRowBlock;
+  return Reduce(
+      blocks, static_cast<long long>(m) * n,
+      [&](int begin, int end) {
+        double rowsum[kRowBlock];
+        double r = 0.0;
+        for (int b = begin; b < end; ++b) {
+          const int i0 = b * kRowBlock;
+          const int rows = std::min(kRowBlock, m - i0);
+          std::fill(rowsum, rowsum + rows, 0.0);
+          for (int j = 0; j < n; ++j) {
+            k.add_abs(A + i0 + static_cast<long long>(j) * lda, rows, rowsum);
+          }
+          r = fmax(r, k.abs_max(rowsum, rows));
+        }
+        return r;
+      },
+      Max);
+}
+
+double csr_mat_norm1_simd(int n, int nnzA, int baseA, const double* csrValA,
+                          const int* csrColIndA) {
+  /* Column sums are a scatter, which SIMD does not help; threads each sum a
+   * slice of the entries as long as their column arrays stay small. */
+  const int num_threads =
+      std::max(1, std::min(NumThreads(nnzA), nnzA / std::max(n, 1)));
+  std::vector<double> colsum(static_cast<size_t>(num_threads) * n, 0.0);
+  ParallelFor(num_threads, [&](int t) {
+    double* sum = colsum.data() + static_cast<size_t>(t) * n;
+    const int end = BlockBegin(nnzA, t + 1, num_threads);
+    for (int p = BlockBegin(nnzA, t, num_threads); p < end; ++p) {
+      sum[csrColIndA[p] - baseA] += fabs(csrValA[p]);
+    }
+  });
+  for (int t = 1; t < num_threads; ++t) {
+    ActiveKernels().add_abs(colsum.data() + static_cast<size_t>(t) * n, n,
+                            colsum.data());
+  }
+  return ActiveKernels().abs_max(colsum.data(), n);
+}
+
+double csr_mat_norminf_simd(int m, int nnzA, int baseA, const double* csrValA,
+                            const int* csrRowPtrA) {
+  const Kernels& k = ActiveKernels();
+  return Reduce(
+      m, nnzA,
+      [&](int begin, int end) {
+        return k.row_abs_max(csrValA, csrRowPtrA, baseA, begin, end);
+      },
+      Max);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+/*
+ * Vectorized norms for the host-side checks of the cuSolver samples.
+ *
+ * cusolver_helper.h keeps the scalar vec_norminf(), mat_norminf() and
+ * csr_mat_norminf() as the reference; the functions here compute the same
+ * quantities (up to rounding of the sums) plus 1-norms and 2-norms. The
+ * kernels are picked at runtime for the widest of SSE2, AVX2 and AVX-512
+ * the CPU supports, and long inputs are reduced by several threads.
+ *
+ * Dense matrices are column-major with leading dimension lda, as in
+ * cusolver_helper.h; CSR matrices take their index base explicitly.
+ */
+
+enum NormIsa {
+  kNormIsaScalar = 0,
+  kNormIsaSse2,
+  kNormIsaAvx2,
+  kNormIsaAvx512,
+};
+
+/* Kernel set in use, and whether another one could run on this CPU. */
+NormIsa norm_isa(void);
+bool norm_isa_supported(NormIsa isa);
+const char* norm_isa_name(NormIsa isa);
+
+/* Forces a kernel set, for tests and benchmarks. Returns false, changing
+ * nothing, if the CPU does not support it. */
+bool norm_set_isa(NormIsa isa);
+
+/* sum |x_j|, sqrt(sum x_j^2) without overflow, max |x_j| */
+double vec_norm1_simd(int n, const double* x);
+double vec_norm2_simd(int n, const double* x);
+double vec_norminf_simd(int n, const double* x);
+
+/*
+ * |A|_1 = max { ones(1,m)*|A| }, |A|_F, |A|_inf = max { |A|*ones(n,1) }.
+ * The row sums of |A|_inf are accumulated over blocks of rows, so A is
+ * read column by column as it is stored.
+ */
+double mat_norm1_simd(int m, int n, const double* A, int lda);
+double mat_normfro_simd(int m, int n, const double* A, int lda);
+double mat_norminf_simd(int m, int n, const double* A, int lda);
+
+/* |A|_1 and |A|_inf of a CSR matrix with n columns, index base baseA. */
+double csr_mat_norm1_simd(int n, int nnzA, int baseA, const double* csrValA,
+                          const int* csrColIndA);
+double csr_mat_norminf_simd(int m, int nnzA, int baseA, const double* csrValA,
+                            const int* csrRowPtrA);
@@ -0,0 +1,161 @@
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "examples/cuda/common/cusolver_helper.h"
+#include "examples/cuda/common/norm_helper.h"
+
+// How to run:
+// bazel run -c opt //examples/cuda/common:norm_helper_benchmark
+namespace {
+
+std::vector<double> RandomVector(size_t n) {
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> value(-1.0, 1.0);
+  std::vector<double> x(n);
+  for (double& v : x) v = value(rng);
+  return x;
+}
+
+// 7 entries per row at pseudo-random columns, base 0.
+struct Csr {
+  std::vector<int> ptr, ind;
+  std::vector<double> val;
+};
+
+Csr RandomCsr(int m) {
+  Csr a;
+  a.val = RandomVector(7L * m);
+  a.ptr.push_back(0);
+  for (int i = 0; i < m; ++i) {
+    for (int k = 0; k < 7; ++k) a.ind.push_back((i + 977 * k) % m);
+    a.ptr.push_back(static_cast<int>(a.ind.size()));
+  }
+  return a;
+}
+
+// Selects the kernel set in state.range(1) for the *Simd benchmarks.
+bool UseIsa(benchmark::State& state) {
+  const auto isa = static_cast<NormIsa>(state.range(1));
+  if (!norm_set_isa(isa)) {
+    state.SkipWithError("instruction set not supported on this CPU");
+    return false;
+  }
+  state.SetLabel(norm_isa_name(isa));
+  return true;
+}
+
+void SetBytes(benchmark::State& state, double bytes) {
+  state.counters["GB/s"] = benchmark::Counter(
+      bytes * 1e-9, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+void BM_VecNorminfReference(benchmark::State& state) {
+  const int n = static_cast<int>(state.range(0));
+  const std::vector<double> x = RandomVector(n);
+  for (auto _ : state) benchmark::DoNotOptimize(vec_norminf(n, x.data()));
+  SetBytes(state, 8.0 * n);
+}
+
+void BM_VecNorminfSimd(benchmark::State& state) {
+  const int n = static_cast<int>(state.range(0));
+  const std::vector<double> x = RandomVector(n);
+  if (!UseIsa(state)) return;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(vec_norminf_simd(n, x.data()));
+  }
+  SetBytes(state, 8.0 * n);
+}
+
+void BM_VecNorm1Simd(benchmark::State& state) {
+  const int n = static_cast<int>(state.range(0));
+  const std::vector<double> x = RandomVector(n);
+  if (!UseIsa(state)) return;
+  for (auto _ : state) benchmark::DoNotOptimize(vec_norm1_simd(n, x.data()));
+  SetBytes(state, 8.0 * n);
+}
+
+void BM_VecNorm2Simd(benchmark::State& state) {
+  const int n = static_cast<int>(state.range(0));
+  const std::vector<double> x = RandomVector(n);
+  if (!UseIsa(state)) return;
+  for (auto _ : state) benchmark::DoNotOptimize(vec_norm2_simd(n, x.data()));
+  SetBytes(state, 8.0 * n);
+}
+
+// Square column-major matrices, lda = m.
+void BM_MatNorminfReference(benchmark::State& state) {
+  const int m = static_cast<int>(state.range(0));
+  const std::vector<double> a = RandomVector(static_cast<size_t>(m) * m);
+  for (auto _ : state) benchmark::DoNotOptimize(mat_norminf(m, m, a.data(), m));
+  SetBytes(state, 8.0 * m * m);
+}
+
+void BM_MatNorminfSimd(benchmark::State& state) {
+  const int m = static_cast<int>(state.range(0));
+  const std::vector<double> a = RandomVector(static_cast<size_t>(m) * m);
+  if (!UseIsa(state)) return;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(mat_norminf_simd(m, m, a.data(), m));
+  }
+  SetBytes(state, 8.0 * m * m);
+}
+
+void BM_MatNorm1Simd(benchmark::State& state) {
+  const int m = static_cast<int>(state.range(0));
+  const std::vector<double> a = RandomVector(static_cast<size_t>(m) * m);
+  if (!UseIsa(state)) return;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(mat_norm1_simd(m, m, a.data(), m));
+  }
+  SetBytes(state, 8.0 * m * m);
+}
+
+void BM_CsrMatNorminfReference(benchmark::State& state) {
+  const int m = static_cast<int>(state.range(0));
+  const Csr a = RandomCsr(m);
+  const int nnz = static_cast<int>(a.ind.size());
+  cusparseMatDescr_t descr = NULL;
+  cusparseCreateMatDescr(&descr);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(csr_mat_norminf(m, m, nnz, descr, a.val.data(),
+                                             a.ptr.data(), a.ind.data()));
+  }
+  cusparseDestroyMatDescr(descr);
+  SetBytes(state, 8.0 * nnz + 4.0 * m);
+}
+
+void BM_CsrMatNorminfSimd(benchmark::State& state) {
+  const int m = static_cast<int>(state.range(0));
+  const Csr a = RandomCsr(m);
+  const int nnz = static_cast<int>(a.ind.size());
+  if (!UseIsa(state)) return;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        csr_mat_norminf_simd(m, nnz, 0, a.val.data(), a.ptr.data()));
+  }
+  SetBytes(state, 8.0 * nnz + 4.0 * m);
+}
+
+const std::vector<int64_t> kIsas = {kNormIsaScalar, kNormIsaSse2,
+                                    kNormIsaAvx2, kNormIsaAvx512};
+
+BENCHMARK(BM_VecNorminfReference)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 24);
+BENCHMARK(BM_VecNorminfSimd)
+    ->ArgsProduct({{1 << 10, 1 << 16, 1 << 24}, kIsas})
+    ->UseRealTime();
+BENCHMARK(BM_VecNorm1Simd)
+    ->ArgsProduct({{1 << 16, 1 << 24}, kIsas})
+    ->UseRealTime();
+BENCHMARK(BM_VecNorm2Simd)
+    ->ArgsProduct({{1 << 16, 1 << 24}, kIsas})
+    ->UseRealTime();
+BENCHMARK(BM_MatNorminfReference)->Arg(256)->Arg(2048);
+BENCHMARK(BM_MatNorminfSimd)->ArgsProduct({{256, 2048}, kIsas})->UseRealTime();
+BENCHMARK(BM_MatNorm1Simd)->ArgsProduct({{256, 2048}, kIsas})->UseRealTime();
+BENCHMARK(BM_CsrMatNorminfReference)->Arg(1 << 20);
+BENCHMARK(BM_CsrMatNorminfSimd)
+    ->ArgsProduct({{1 << 20}, kIsas})
+    ->UseRealTime();
+
+}  // namespace
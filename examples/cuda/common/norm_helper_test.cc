@@ -0,0 +1,140 @@
+#include "examples/cuda/common/norm_helper.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<double> RandomVector(int n, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> value(-10.0, 10.0);
+  std::vector<double> x(n);
+  for (double& v : x) v = value(rng);
+  return x;
+}
+
+std::vector<NormIsa> SupportedIsas() {
+  std::vector<NormIsa> isas;
+  for (NormIsa isa :
+       {kNormIsaScalar, kNormIsaSse2, kNormIsaAvx2, kNormIsaAvx512}) {
+    if (norm_isa_supported(isa)) isas.push_back(isa);
+  }
+  return isas;
+}
+
+// Runs the test body once per kernel set, restoring the default after.
+class NormHelperTest : public ::testing::TestWithParam<NormIsa> {
+ protected:
+  void SetUp() override {
+    saved_ = norm_isa();
+    ASSERT_TRUE(norm_set_isa(GetParam()));
+  }
+  void TearDown() override { norm_set_isa(saved_); }
+
+ private:
+  NormIsa saved_ = kNormIsaScalar;
+};
+
+TEST_P(NormHelperTest, VectorNorms) {
+  // Every tail length, and one long enough to be split across threads.
+  std::vector<int> sizes;
+  for (int n = 0; n <= 40; ++n) sizes.push_back(n);
+  sizes.push_back(1000003);
+  for (int n : sizes) {
+    const std::vector<double> x = RandomVector(n, n);
+    double norm1 = 0.0, ss = 0.0, norminf = 0.0;
+    for (double v : x) {
+      norm1 += fabs(v);
+      ss += v * v;
+      norminf = std::max(norminf, fabs(v));
+    }
+    EXPECT_DOUBLE_EQ(vec_norminf_simd(n, x.data()), norminf) << n;
+    EXPECT_NEAR(vec_norm1_simd(n, x.data()), norm1, 1e-12 * norm1) << n;
+    EXPECT_NEAR(vec_norm2_simd(n, x.data()), sqrt(ss), 1e-12 * sqrt(ss))
+        << n;
+  }
+}
+
+TEST_P(NormHelperTest, Norm2AvoidsOverflowAndUnderflow) {
+  const std::vector<double> big(9, 3e200), tiny(9, 3e-200);
+  EXPECT_DOUBLE_EQ(vec_norm2_simd(9, big.data()), 9e200);
+  EXPECT_DOUBLE_EQ(vec_norm2_simd(9, tiny.data()), 9e-200);
+  const std::vector<double> zero(5, 0.0);
+  EXPECT_EQ(vec_norm2_simd(5, zero.data()), 0.0);
+  EXPECT_DOUBLE_EQ(mat_normfro_simd(3, 3, big.data(), 3), 9e200);
+}
+
+TEST_P(NormHelperTest, DenseMatrixNorms) {
+  for (int m : {1, 7, 513, 1100}) {
+    const int n = 13, lda = m + 3;
+    const std::vector<double> a = RandomVector(lda * n, m);
+    double norm1 = 0.0, ss = 0.0, norminf = 0.0;
+    for (int j = 0; j < n; ++j) {
+      double col = 0.0;
+      for (int i = 0; i < m; ++i) {
+        col += fabs(a[i + j * lda]);
+        ss += a[i + j * lda] * a[i + j * lda];
+      }
+      norm1 = std::max(norm1, col);
+    }
+    for (int i = 0; i < m; ++i) {
+      double row = 0.0;
+      for (int j = 0; j < n; ++j) row += fabs(a[i + j * lda]);
+      norminf = std::max(norminf, row);
+    }
+    EXPECT_NEAR(mat_norm1_simd(m, n, a.data(), lda), norm1, 1e-12 * norm1);
+    EXPECT_NEAR(mat_normfro_simd(m, n, a.data(), lda), sqrt(ss),
+                1e-12 * sqrt(ss));
+    EXPECT_NEAR(mat_norminf_simd(m, n, a.data(), lda), norminf,
+                1e-12 * norminf);
+  }
+}
+
+TEST_P(NormHelperTest, CsrMatrixNorms) {
+  // Rows of 0-20 entries, 1-based.
+  std::mt19937 rng(8);
+  const int m = 300, n = 50;
+  std::vector<int> ptr = {1}, ind;
+  std::vector<double> val;
+  for (int i = 0; i < m; ++i) {
+    const int len = static_cast<int>(rng() % 21);
+    for (int k = 0; k < len; ++k) {
+      ind.push_back(static_cast<int>(rng() % n) + 1);
+      val.push_back(static_cast<double>(rng() % 200) - 100.0);
+    }
+    ptr.push_back(static_cast<int>(ind.size()) + 1);
+  }
+  const int nnz = static_cast<int>(ind.size());
+  std::vector<double> col(n, 0.0);
+  double norminf = 0.0;
+  for (int i = 0; i < m; ++i) {
+    double row = 0.0;
+    for (int p = ptr[i] - 1; p < ptr[i + 1] - 1; ++p) {
+      row += fabs(val[p]);
+      col[ind[p] - 1] += fabs(val[p]);
+    }
+    norminf = std::max(norminf, row);
+  }
+  // Integer-valued entries, so the sums are exact in any order.
+  EXPECT_EQ(csr_mat_norminf_simd(m, nnz, 1, val.data(), ptr.data()), norminf);
+  EXPECT_EQ(csr_mat_norm1_simd(n, nnz, 1, val.data(), ind.data()),
+            *std::max_element(col.begin(), col.end()));
+}
+
+INSTANTIATE_TEST_SUITE_P(AllIsas, NormHelperTest,
+                         ::testing::ValuesIn(SupportedIsas()),
+                         [](const ::testing::TestParamInfo<NormIsa>& info) {
+                           return std::string(norm_isa_name(info.param));
+                         });
+
+TEST(NormIsaTest, PicksSupportedDefault) {
+  EXPECT_TRUE(norm_isa_supported(norm_isa()));
+  EXPECT_TRUE(norm_isa_supported(kNormIsaScalar));
+}
+
+}  // namespace
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+/*
+ * Fork-join helpers for the multithreaded host kernels. Every call starts
+ * its own threads, so callers only go parallel once each thread gets
+ * enough work to pay for that; see ParallelThreads().
+ */
+
+/* std::thread::hardware_concurrency(), but at least 1. Queried once, since
+ * the query costs microseconds. */
+inline int HardwareThreads() {
+  static const int threads =
+      static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  return threads;
+}
+
+/*
+ * Threads to split `work` units over: num_threads if it is positive,
+ * otherwise HardwareThreads() as long as each thread gets at least
+ * min_work_per_thread (> 0) units. Always at least 1.
+ */
+inline int ParallelThreads(long long work, int num_threads,
+                           long long min_work_per_thread) {
+  if (num_threads <= 0) {
+    num_threads = static_cast<int>(
+        std::min<long long>(HardwareThreads(), work / min_work_per_thread));
+  }
+  return std::max(num_threads, 1);
+}
+
+/* Runs fn(t) for t in [0, num_threads), fn(0) on the calling thread. */
+template <typename Fn>
+void ParallelFor(int num_threads, Fn fn) {
+  std::vector<std::thread> workers;
+  for (int t = 1; t < num_threads; ++t) workers.emplace_back(fn, t);
+  fn(0);
+  for (auto& w : workers) w.join();
+}
+
+/* Start of block t when [0, n) is split into num_threads even blocks. */
+inline int BlockBegin(int n, int t, int num_threads) {
+  return static_cast<int>(static_cast<long long>(n) * t / num_threads);
+}
+
+/*
+ * Runs fn(begin, end) over [0, n) in one chunk per thread. Chunks are
+ * multiples of 8 so that only the last one has a scalar tail. Uses
+ * num_threads threads, or HardwareThreads() if it is not positive, but
+ * never hands a thread less than min_per_thread (> 0) elements.
+ */
+template <typename Fn>
+void ParallelChunks(size_t n, int num_threads, size_t min_per_thread,
+                    Fn fn) {
+  if (num_threads <= 0) num_threads = HardwareThreads();
+  num_threads = static_cast<int>(
+      std::min<size_t>(num_threads, std::max<size_t>(1, n / min_per_thread)));
+  ParallelFor(num_threads, [&](int t) {
+    const size_t begin = n / 8 * t / num_threads * 8;
+    const size_t end =
+        t + 1 == num_threads ? n : n / 8 * (t + 1) / num_threads * 8;
+    fn(begin, end);
+  });
+}
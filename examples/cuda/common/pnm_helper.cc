@@ -0,0 +1,467 @@
+#include "examples/cuda/common/pnm_helper.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "examples/cuda/common/parallel_helper.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PNM_HELPER_X86 1
+#endif
+
+namespace {
+
+constexpr size_t kMinPerThread = 1 << 16;  /* pixels */
+
+bool IsSpace(unsigned char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' ||
+         c == '\f';
+}
+
+/* Reads the next decimal header field at *pos, skipping whitespace and
+ * '#' comments that run to the end of the line. */
+bool ParseField(const unsigned char* p, size_t size, size_t* pos,
+                unsigned int* value) {
+  size_t i = *pos;
+  while (i < size) {
+    if (p[i] == '#') {
+      while (i < size && p[i] != '\n' && p[i] != '\r') ++i;
+    } else if (IsSpace(p[i])) {
+      ++i;
+    } else {
+      break;
+    }
+  }
+  if (i == size || p[i] < '0' || p[i] > '9') return false;
+  unsigned long long v = 0;
+  for (; i < size && p[i] >= '0' && p[i] <= '9'; ++i) {
+    v = v * 10 + (p[i] - '0');
+    if (v > 0xffffffffull) return false;
+  }
+  *pos = i;
+  *value = (unsigned int)v;
+  return true;
+}
+
+float Normalize(unsigned char v) { return static_cast<float>(v) / 255.0f; }
+
+template <typename T>
+T Sample(unsigned char v);
+
+template <>
+unsigned char Sample(unsigned char v) {
+  return v;
+}
+
+template <>
+float Sample(unsigned char v) {
+  return Normalize(v);
+}
+
+template <typename T>
+void ExpandScalar(const unsigned char* src, unsigned int channels, size_t n,
+                  T* rgba) {
+  for (size_t i = 0; i < n; ++i) {
+    const unsigned char* s = src + i * channels;
+    const unsigned char g = s[0];
+    rgba[4 * i + 0] = Sample<T>(g);
+    rgba[4 * i + 1] = Sample<T>(channels == 3 ? s[1] : g);
+    rgba[4 * i + 2] = Sample<T>(channels == 3 ? s[2] : g);
+    rgba[4 * i + 3] = T(0);
+  }
+}
+
+void NormalizeScalar(const unsigned char* src, size_t n, float* dst) {
+  for (size_t i = 0; i < n; ++i) dst[i] = Normalize(src[i]);
+}
+
+#ifdef PNM_HELPER_X86
+
+/* Eight pixels as RGBA bytes, four per 128-bit lane. Reads 28 bytes of RGB
+ * or 8 bytes of gray. */
+__attribute__((target("avx2"))) inline __m256i Rgba8(const unsigned char* src,
+                                                     unsigned int channels) {
+  if (channels == 3) {
+    const __m256i rgb = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)src)),
+        _mm_loadu_si128((const __m128i*)(src + 12)), 1);
+    const __m256i shuffle = _mm256_setr_epi8(
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,  //
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    return _mm256_shuffle_epi8(rgb, shuffle);
+  }
+  const __m128i g = _mm_loadl_epi64((const __m128i*)src);
+  const __m256i gray = _mm256_inserti128_si256(_mm256_castsi128_si256(g),
+                                               _mm_srli_si128(g, 4), 1);
+  const __m256i shuffle = _mm256_setr_epi8(
+      0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1,  //
+      0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1);
+  return _mm256_shuffle_epi8(gray, shuffle);
+}
+
+/* Pixels whose eight-pixel block may be read with Rgba8(). */
+size_t VectorPixels(unsigned int channels, size_t n) {
+  if (channels == 1) return n / 8 * 8;
+  /* The last block reads 4 bytes past its 24. */
+  return n < 10 ? 0 : (n - 2) / 8 * 8;
+}
+
+__attribute__((target("avx2"))) inline void StoreFloat8(float* dst,
+                                                        __m128i bytes) {
+  const __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+  _mm256_storeu_ps(dst, _mm256_div_ps(f, _mm256_set1_ps(255.0f)));
+}
+
+__attribute__((target("avx2"))) void ExpandAvx2(const unsigned char* src,
+                                               unsigned int channels,
+                                               size_t n,
+                                               unsigned char* rgba) {
+  const size_t m = VectorPixels(channels, n);
+  for (size_t i = 0; i < m; i += 8) {
+    _mm256_storeu_si256((__m256i*)(rgba + 4 * i),
+                        Rgba8(src + i * channels, channels));
+  }
+  ExpandScalar(src + m * channels, channels, n - m, rgba + 4 * m);
+}
+
+__attribute__((target("avx2"))) void ExpandAvx2(const unsigned char* src,
+                                               unsigned int channels,
+                                               size_t n, float* rgba) {
+  const size_t m = VectorPixels(channels, n);
+  for (size_t i = 0; i < m; i += 8) {
+    const __m256i v = Rgba8(src + i * channels, channels);
+    const __m128i lo = _mm256_castsi256_si128(v);
+    const __m128i hi = _mm256_extracti128_si256(v, 1);
+    float* dst = rgba + 4 * i;
+    StoreFloat8(dst, lo);
+    StoreFloat8(dst + 8, _mm_srli_si128(lo, 8));
+    StoreFloat8(dst + 16, hi);
+    StoreFloat8(dst + 24, _mm_srli_si128(hi, 8));
+  }
+  ExpandScalar(src + m * channels, channels, n - m, rgba + 4 * m);
+}
+
+__attribute__((target("avx2"))) void NormalizeAvx2(const unsigned char* src,
+                                                  size_t n, float* dst) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    StoreFloat8(dst + i, _mm_loadl_epi64((const __m128i*)(src + i)));
+  }
+  NormalizeScalar(src + i, n - i, dst + i);
+}
+
+#endif  // PNM_HELPER_X86
+
+PnmKernel Resolve(PnmKernel kernel) {
+  if (kernel != kPnmKernelAuto) return kernel;
+  if (pnm_kernel_supported(kPnmKernelAvx2)) return kPnmKernelAvx2;
+  return kPnmKernelScalar;
+}
+
+template <typename T>
+int Expand(const unsigned char* src, unsigned int channels, size_t n,
+           T* rgba, int num_threads, PnmKernel kernel) {
+  if ((channels != 1 && channels != 3) || !pnm_kernel_supported(kernel)) {
+    return 1;
+  }
+  const bool simd = Resolve(kernel) == kPnmKernelAvx2;
+  ParallelChunks(n, num_threads, kMinPerThread, [&](size_t begin, size_t end) {
+    const unsigned char* s = src + begin * channels;
+#ifdef PNM_HELPER_X86
+    if (simd) {
+      ExpandAvx2(s, channels, end - begin, rgba + 4 * begin);
+      return;
+    }
+#endif
+    (void)simd;
+    ExpandScalar(s, channels, end - begin, rgba + 4 * begin);
+  });
+  return 0;
+}
+
+}  // namespace
+
+MappedPnm::~MappedPnm() { Close(); }
+
+MappedPnm::MappedPnm(MappedPnm&& other) noexcept { *this = std::move(other); }
+
+MappedPnm& MappedPnm::operator=(MappedPnm&& other) noexcept {
+  if (this != &other) {
+    Close();
+    map_ = other.map_;
+    map_bytes_ = other.map_bytes_;
+    pixels_ = other.pixels_;
+    width_ = other.width_;
+    height_ = other.height_;
+    channels_ = other.channels_;
+    maxval_ = other.maxval_;
+    other.map_ = NULL;
+    other.pixels_ = NULL;
+    other.Close();
+  }
+  return *this;
+}
+
+void MappedPnm::Close() {
+  if (map_) munmap(map_, map_bytes_);
+  map_ = NULL;
+  map_bytes_ = 0;
+  pixels_ = NULL;
+  width_ = height_ = channels_ = maxval_ = 0;
+}
+
+bool MappedPnm::Open(const char* file) {
+  Close();
+  const int fd = open(file, O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "MappedPnm::Open() : Failed to open file: " << file
+              << std::endl;
+    return false;
+  }
+  struct stat st;
+  void* map = MAP_FAILED;
+  const size_t bytes = fstat(fd, &st) == 0 ? (size_t)st.st_size : 0;
+  if (bytes > 0) {
+    map = mmap(NULL, bytes, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+  }
+  close(fd);
+  if (map == MAP_FAILED) {
+    std::cerr << "MappedPnm::Open() : Failed to map file: " << file
+              << std::endl;
+    return false;
+  }
+  map_ = map;
+  map_bytes_ = bytes;
+
+  const unsigned char* p = static_cast<const unsigned char*>(map);
+  unsigned int channels = 0;
+  if (bytes >= 2 && p[0] == 'P' && p[1] == '5') {
+    channels = 1;
+  } else if (bytes >= 2 && p[0] == 'P' && p[1] == '6') {
+    channels = 3;
+  } else {
+    std::cerr << "MappedPnm::Open() : File is not a PPM or PGM image: "
+              << file << std::endl;
+    Close();
+    return false;
+  }
+
+  size_t pos = 2;
+  unsigned int width = 0, height = 0, maxval = 0;
+  if (!ParseField(p, bytes, &pos, &width) ||
+      !ParseField(p, bytes, &pos, &height) ||
+      !ParseField(p, bytes, &pos, &maxval) || pos == bytes ||
+      !IsSpace(p[pos])) {
+    std::cerr << "MappedPnm::Open() : Invalid header: " << file << std::endl;
+    Close();
+    return false;
+  }
+  // A single whitespace character ends the header.
+  ++pos;
+  if (maxval == 0 || maxval > 255) {
+    std::cerr << "MappedPnm::Open() : Unsupported maxval " << maxval << ": "
+              << file << std::endl;
+    Close();
+    return false;
+  }
+  const unsigned long long samples =
+      (unsigned long long)width * height * channels;
+  if (samples > bytes - pos) {
+    std::cerr << "MappedPnm::Open() : File is truncated: " << file
+              << std::endl;
+    Close();
+    return false;
+  }
+
+  madvise(map, bytes, MADV_SEQUENTIAL);
+  pixels_ = p + pos;
+  width_ = width;
+  height_ = height;
+  channels_ = channels;
+  maxval_ = maxval;
+  return true;
+}
+
+bool pnm_kernel_supported(PnmKernel kernel) {
+  switch (kernel) {
+    case kPnmKernelAuto:
+    case kPnmKernelScalar:
+      return true;
+#ifdef PNM_HELPER_X86
+    case kPnmKernelAvx2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+const char* pnm_kernel_name(PnmKernel kernel) {
+  switch (Resolve(kernel)) {
+    case kPnmKernelScalar:
+      return "scalar";
+    case kPnmKernelAvx2:
+      return "avx2";
+    default:
+      return "unknown";
+  }
+}
+
+int pnm_expand_rgba(const unsigned char* src, unsigned int channels,
+                    size_t n, unsigned char* rgba, int num_threads,
+                    PnmKernel kernel) {
+  return Expand(src, channels, n, rgba, num_threads, kernel);
+}
+
+int pnm_expand_rgba(const unsigned char* src, unsigned int channels,
+                    size_t n, float* rgba, int num_threads, PnmKernel kernel) {
+  return Expand(src, channels, n, rgba, num_threads, kernel);
+}
+
+int pnm_normalize(const unsigned char* src, size_t n, float* dst,
+                  int num_threads, PnmKernel kernel) {
+  if (!pnm_kernel_supported(kernel)) return 1;
+  const bool simd = Resolve(kernel) == kPnmKernelAvx2;
+  ParallelChunks(n, num_threads, kMinPerThread, [&](size_t begin, size_t end) {
+#ifdef PNM_HELPER_X86
+    if (simd) {
+      NormalizeAvx2(src + begin, end - begin, dst + begin);
+      return;
+    }
+#endif
+    (void)simd;
+    NormalizeScalar(src + begin, end - begin, dst + begin);
+  });
+  return 0;
+}
+
+bool pnm_save(const char* file, const unsigned char* data, unsigned int w,
+              unsigned int h, unsigned int channels) {
+  if (channels != 1 && channels != 3) {
+    std::cerr << "pnm_save() : Invalid number of channels." << std::endl;
+    return false;
+  }
+  char header[64];
+  const int header_bytes =
+      snprintf(header, sizeof(header), "P%c\n%u\n%u\n255\n",
+               channels == 1 ? '5' : '6', w, h);
+
+  const int fd = open(file, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  if (fd < 0) {
+    std::cerr << "pnm_save() : Opening file failed: " << file << std::endl;
+    return false;
+  }
+  struct iovec iov[2];
+  iov[0].iov_base = header;
+  iov[0].iov_len = header_bytes;
+  iov[1].iov_base = const_cast<unsigned char*>(data);
+  iov[1].iov_len = (size_t)w * h * channels;
+  struct iovec* next = iov;
+  int count = 2;
+  bool ok = true;
+  while (count > 0) {
+    const ssize_t n = writev(fd, next, count);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      ok = false;
+      break;
+    }
+    // Skip what was written, for short writes.
+    size_t done = (size_t)n;
+    while (count > 0 && done >= next->iov_len) {
+      done -= next->iov_len;
+      ++next;
+      --count;
+    }
+    if (count > 0) {
+      next->iov_base = static_cast<char*>(next->iov_base) + done;
+      next->iov_len -= done;
+    }
+  }
+  if (close(fd) != 0) ok = false;
+  if (!ok) {
+    std::cerr << "pnm_save() : Writing data failed: " << file << std::endl;
+  }
+  return ok;
+}
+
+PnmWriteQueue::PnmWriteQueue(size_t max_pending_bytes, int num_threads)
+    : max_pending_bytes_(max_pending_bytes) {
+  for (int t = 0; t < std::max(num_threads, 1); ++t) {
+    threads_.emplace_back(&PnmWriteQueue::Work, this);
+  }
+}
+
+PnmWriteQueue::~PnmWriteQueue() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    stop_ = true;
+  }
+  queued_.notify_all();
+  for (auto& t : threads_) t.join();
+}
+
+void PnmWriteQueue::Save(const std::string& file, const unsigned char* data,
+                         unsigned int w, unsigned int h,
+                         unsigned int channels) {
+  Save(file, std::vector<unsigned char>(data, data + (size_t)w * h * channels),
+       w, h, channels);
+}
+
+void PnmWriteQueue::Save(std::string file, std::vector<unsigned char> data,
+                         unsigned int w, unsigned int h,
+                         unsigned int channels) {
+  const size_t bytes = data.size();
+  std::unique_lock<std::mutex> lock(mu_);
+  // A frame larger than the limit still goes through on its own.
+  written_.wait(lock, [&] {
+    return pending_bytes_ == 0 ||
+           pending_bytes_ + bytes <= max_pending_bytes_;
+  });
+  pending_bytes_ += bytes;
+  ++in_flight_;
+  frames_.push_back(Frame{std::move(file), std::move(data), w, h, channels});
+  lock.unlock();
+  queued_.notify_one();
+}
+
+size_t PnmWriteQueue::Flush() {
+  std::unique_lock<std::mutex> lock(mu_);
+  written_.wait(lock, [&] { return in_flight_ == 0; });
+  const size_t failures = failures_;
+  failures_ = 0;
+  return failures;
+}
+
+void PnmWriteQueue::Work() {
+  std::unique_lock<std::mutex> lock(mu_);
+  for (;;) {
+    queued_.wait(lock, [&] { return stop_ || !frames_.empty(); });
+    if (frames_.empty()) return;  // stopping, and nothing left to write
+    Frame frame = std::move(frames_.front());
+    frames_.pop_front();
+    lock.unlock();
+    const bool ok = frame.data.size() == (size_t)frame.w * frame.h *
+                                             frame.channels &&
+                    pnm_save(frame.file.c_str(), frame.data.data(), frame.w,
+                             frame.h, frame.channels);
+    lock.lock();
+    if (!ok) ++failures_;
+    pending_bytes_ -= frame.data.size();
+    --in_flight_;
+    written_.notify_all();
+  }
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+/*
+ * Memory-mapped loading of binary PGM (P5) and PPM (P6) images with 8-bit
+ * samples, as read by __loadPPM() in image_helper.h.
+ *
+ * MappedPnm maps the file, parses the header in place and exposes the
+ * samples without copying them. The conversions below turn those samples
+ * into the layouts the samples upload: RGBA with a zero fourth channel
+ * (sdkLoadPPM4ub()) and floats scaled to [0, 1] (ConverterFromUByte<float>),
+ * in one pass that is vectorized and split across threads.
+ *
+ * pnm_save() and PnmWriteQueue write such files: the header and the
+ * samples go out in a single writev(), from the caller or from background
+ * threads.
+ */
+
+#include <stddef.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class MappedPnm {
+ public:
+  MappedPnm() = default;
+  ~MappedPnm();
+  MappedPnm(MappedPnm&& other) noexcept;
+  MappedPnm& operator=(MappedPnm&& other) noexcept;
+  MappedPnm(const MappedPnm&) = delete;
+  MappedPnm& operator=(const MappedPnm&) = delete;
+
+  /* Maps file, closing the image open before. Returns false, printing why
+   * to std::cerr, if it is not a P5 or P6 file with a maxval of at most
+   * 255 and all its samples. */
+  bool Open(const char* file);
+  void Close();
+
+  bool is_open() const { return pixels_ != NULL; }
+  unsigned int width() const { return width_; }
+  unsigned int height() const { return height_; }
+  /* 1 for PGM, 3 for PPM */
+  unsigned int channels() const { return channels_; }
+  unsigned int maxval() const { return maxval_; }
+
+  /* width * height * channels samples, row by row; valid until the image
+   * is closed. */
+  const unsigned char* pixels() const { return pixels_; }
+  size_t size() const { return (size_t)width_ * height_ * channels_; }
+
+ private:
+  void* map_ = NULL;
+  size_t map_bytes_ = 0;
+  const unsigned char* pixels_ = NULL;
+  unsigned int width_ = 0;
+  unsigned int height_ = 0;
+  unsigned int channels_ = 0;
+  unsigned int maxval_ = 0;
+};
+
+enum PnmKernel {
+  kPnmKernelAuto = 0, /* widest kernel the CPU supports */
+  kPnmKernelScalar,
+  kPnmKernelAvx2,
+};
+
+bool pnm_kernel_supported(PnmKernel kernel);
+const char* pnm_kernel_name(PnmKernel kernel);
+
+/*
+ * Expands n pixels of channels (1 or 3) samples each to RGBA: gray is
+ * replicated to RGB, the fourth channel is 0. The float overloads divide by
+ * 255 as ConverterFromUByte<float> does. num_threads <= 0 picks one thread
+ * per core. Return 0 on success and 1 for a bad channel count or a kernel
+ * the CPU cannot run.
+ */
+int pnm_expand_rgba(const unsigned char* src, unsigned int channels,
+                    size_t n, unsigned char* rgba, int num_threads = 0,
+                    PnmKernel kernel = kPnmKernelAuto);
+int pnm_expand_rgba(const unsigned char* src, unsigned int channels,
+                    size_t n, float* rgba, int num_threads = 0,
+                    PnmKernel kernel = kPnmKernelAuto);
+
+/* Converts n samples to floats in [0, 1], keeping the layout. */
+int pnm_normalize(const unsigned char* src, size_t n, float* dst,
+                  int num_threads = 0, PnmKernel kernel = kPnmKernelAuto);
+
+/* Writes w x h pixels of channels (1 or 3) 8-bit samples as a P5 or P6
+ * file with maxval 255, byte for byte as __savePPM() did. Returns false,
+ * printing why to std::cerr, on failure. */
+bool pnm_save(const char* file, const unsigned char* data, unsigned int w,
+              unsigned int h, unsigned int channels);
+
+/*
+ * Saves frames with pnm_save() on background threads so that batch jobs
+ * can dump them without waiting for the disk. Frames are written in the
+ * order they are queued when there is one thread. Save() blocks while more
+ * than max_pending_bytes of samples are waiting, to bound memory use.
+ */
+class PnmWriteQueue {
+ public:
+  explicit PnmWriteQueue(size_t max_pending_bytes = 256 << 20,
+                         int num_threads = 1);
+  /* Writes everything still queued. */
+  ~PnmWriteQueue();
+  PnmWriteQueue(const PnmWriteQueue&) = delete;
+  PnmWriteQueue& operator=(const PnmWriteQueue&) = delete;
+
+  /* Copies the samples and returns. */
+  void Save(const std::string& file, const unsigned char* data,
+            unsigned int w, unsigned int h, unsigned int channels);
+  /* Takes the samples, w * h * channels of them, without copying. */
+  void Save(std::string file, std::vector<unsigned char> data,
+            unsigned int w, unsigned int h, unsigned int channels);
+
+  /* Waits until every frame queued so far is written. Returns the number
+   * of frames that failed since the last call. */
+  size_t Flush();
+
+ private:
+  struct Frame {
+    std::string file;
+    std::vector<unsigned char> data;
+    unsigned int w, h, channels;
+  };
+
+  void Work();
+
+  const size_t max_pending_bytes_;
+  std::mutex mu_;
+  std::condition_variable queued_;  /* frames added, or stopping */
+  std::condition_variable written_; /* frames done */
+  std::deque<Frame> frames_;
+  size_t pending_bytes_ = 0; /* queued or being written */
+  size_t in_flight_ = 0;     /* frames queued or being written */
+  size_t failures_ = 0;
+  bool stop_ = false;
+  std::vector<std::thread> threads_;
+};
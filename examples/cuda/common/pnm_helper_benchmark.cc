@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "examples/cuda/common/pnm_helper.h"
+
+// How to run:
+// bazel run -c opt //examples/cuda/common:pnm_helper_benchmark
+namespace {
+
+// A w x h PPM frame in the temporary directory.
+std::string WriteFrame(unsigned int w, unsigned int h) {
+  const char* dir = getenv("TEST_TMPDIR");
+  const std::string path = std::string(dir ? dir : "/tmp") + "/frame.ppm";
+  std::vector<unsigned char> rgb((size_t)w * h * 3);
+  for (size_t i = 0; i < rgb.size(); ++i) rgb[i] = (unsigned char)(i * 7);
+  FILE* fp = fopen(path.c_str(), "wb");
+  fprintf(fp, "P6\n%u\n%u\n255\n", w, h);
+  fwrite(rgb.data(), 1, rgb.size(), fp);
+  fclose(fp);
+  return path;
+}
+
+// sdkLoadPPM4ub() before it mapped the file: fgets/sscanf for the header,
+// fread into a new buffer, then a serial pass to pad the 4th channel.
+unsigned char* LoadPpm4Fread(const char* file, unsigned int* w,
+                             unsigned int* h) {
+  FILE* fp = fopen(file, "rb");
+  char header[0x40];
+  if (fgets(header, sizeof(header), fp) == NULL) return NULL;
+  unsigned int width = 0, height = 0, maxval = 0, i = 0;
+  while (i < 3) {
+    if (fgets(header, sizeof(header), fp) == NULL) return NULL;
+    if (header[0] == '#') continue;
+    if (i == 0) {
+      i += sscanf(header, "%u %u %u", &width, &height, &maxval);
+    } else if (i == 1) {
+      i += sscanf(header, "%u %u", &height, &maxval);
+    } else {
+      i += sscanf(header, "%u", &maxval);
+    }
+  }
+  const size_t size = (size_t)width * height;
+  unsigned char* rgb = (unsigned char*)malloc(size * 3);
+  benchmark::DoNotOptimize(fread(rgb, 1, size * 3, fp));
+  fclose(fp);
+  unsigned char* rgba = (unsigned char*)malloc(size * 4);
+  for (size_t p = 0; p < size; ++p) {
+    rgba[4 * p + 0] = rgb[3 * p + 0];
+    rgba[4 * p + 1] = rgb[3 * p + 1];
+    rgba[4 * p + 2] = rgb[3 * p + 2];
+    rgba[4 * p + 3] = 0;
+  }
+  free(rgb);
+  *w = width;
+  *h = height;
+  return rgba;
+}
+
+// Arguments: width, height.
+void BM_LoadRgbaFread(benchmark::State& state) {
+  const std::string file = WriteFrame(state.range(0), state.range(1));
+  unsigned int w, h;
+  for (auto _ : state) {
+    unsigned char* rgba = LoadPpm4Fread(file.c_str(), &w, &h);
+    benchmark::DoNotOptimize(rgba);
+    free(rgba);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) *
+                          state.range(1));
+}
+
+// Arguments: width, height, float output, threads.
+void BM_LoadRgbaMapped(benchmark::State& state) {
+  const std::string file = WriteFrame(state.range(0), state.range(1));
+  const bool to_float = state.range(2) != 0;
+  const int threads = static_cast<int>(state.range(3));
+  for (auto _ : state) {
+    MappedPnm image;
+    image.Open(file.c_str());
+    const size_t n = (size_t)image.width() * image.height();
+    if (to_float) {
+      float* rgba = (float*)malloc(n * 4 * sizeof(float));
+      pnm_expand_rgba(image.pixels(), image.channels(), n, rgba, threads);
+      benchmark::DoNotOptimize(rgba);
+      free(rgba);
+    } else {
+      unsigned char* rgba = (unsigned char*)malloc(n * 4);
+      pnm_expand_rgba(image.pixels(), image.channels(), n, rgba, threads);
+      benchmark::DoNotOptimize(rgba);
+      free(rgba);
+    }
+  }
+  state.SetLabel(to_float ? "float" : "unsigned char");
+  state.SetItemsProcessed(state.iterations() * state.range(0) *
+                          state.range(1));
+}
+
+// Opening the view alone, for callers that want the raw samples.
+void BM_OpenView(benchmark::State& state) {
+  const std::string file = WriteFrame(state.range(0), state.range(1));
+  for (auto _ : state) {
+    MappedPnm image;
+    image.Open(file.c_str());
+    benchmark::DoNotOptimize(image.pixels());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) *
+                          state.range(1));
+}
+
+std::vector<unsigned char> Frame(unsigned int w, unsigned int h) {
+  std::vector<unsigned char> rgb((size_t)w * h * 3);
+  for (size_t i = 0; i < rgb.size(); ++i) rgb[i] = (unsigned char)(i * 7);
+  return rgb;
+}
+
+std::string SavePath(int i) {
+  const char* dir = getenv("TEST_TMPDIR");
+  return std::string(dir ? dir : "/tmp") + "/saved" + std::to_string(i) +
+         ".ppm";
+}
+
+// __savePPM() before it used pnm_save(): an ofstream written one sample at a
+// time.
+bool SavePpmStream(const char* file, const unsigned char* data,
+                   unsigned int w, unsigned int h) {
+  std::fstream fh(file, std::fstream::out | std::fstream::binary);
+  if (fh.bad()) return false;
+  fh << "P6\n";
+  fh << w << "\n" << h << "\n" << 0xff << std::endl;
+  for (unsigned int i = 0; (i < (w * h * 3)) && fh.good(); ++i) {
+    fh << data[i];
+  }
+  fh.flush();
+  if (fh.bad()) return false;
+  fh.close();
+  return true;
+}
+
+// Arguments: width, height. Frames are spread over a few files so the page
+// cache, not a single inode, sees the writes.
+void BM_SaveStream(benchmark::State& state) {
+  const std::vector<unsigned char> rgb = Frame(state.range(0), state.range(1));
+  int i = 0;
+  for (auto _ : state) {
+    SavePpmStream(SavePath(i++ % 8).c_str(), rgb.data(), state.range(0),
+                  state.range(1));
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * rgb.size());
+}
+
+void BM_SaveWritev(benchmark::State& state) {
+  const std::vector<unsigned char> rgb = Frame(state.range(0), state.range(1));
+  int i = 0;
+  for (auto _ : state) {
+    pnm_save(SavePath(i++ % 8).c_str(), rgb.data(), state.range(0),
+             state.range(1), 3);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * rgb.size());
+}
+
+// Arguments: width, height, writer threads. Measures what the caller sees
+// for a batch of 16 frames, including the final Flush().
+void BM_SaveQueued(benchmark::State& state) {
+  const std::vector<unsigned char> rgb = Frame(state.range(0), state.range(1));
+  PnmWriteQueue queue(256 << 20, static_cast<int>(state.range(2)));
+  for (auto _ : state) {
+    for (int i = 0; i < 16; ++i) {
+      queue.Save(SavePath(i % 8), rgb.data(), state.range(0), state.range(1),
+                 3);
+    }
+    queue.Flush();
+  }
+  state.SetItemsProcessed(state.iterations() * 16);
+  state.SetBytesProcessed(state.iterations() * 16 * rgb.size());
+}
+
+BENCHMARK(BM_LoadRgbaFread)->Args({512, 512})->Args({1920, 1080});
+BENCHMARK(BM_LoadRgbaMapped)
+    ->ArgsProduct({{512, 1920}, {512, 1080}, {0, 1}, {1, 0}})
+    ->UseRealTime();
+BENCHMARK(BM_OpenView)->Args({512, 512})->Args({1920, 1080});
+BENCHMARK(BM_SaveStream)->Args({512, 512})->Args({1920, 1080});
+BENCHMARK(BM_SaveWritev)->Args({512, 512})->Args({1920, 1080});
+BENCHMARK(BM_SaveQueued)
+    ->Args({1920, 1080, 1})
+    ->Args({1920, 1080, 4})
+    ->UseRealTime();
+
+}  // namespace
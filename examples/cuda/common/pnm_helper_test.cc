@@ -0,0 +1,207 @@
+#include "examples/cuda/common/pnm_helper.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::string WriteTemp(const std::string& name, const std::string& contents) {
+  const std::string path = ::testing::TempDir() + name;
+  FILE* fp = fopen(path.c_str(), "wb");
+  fwrite(contents.data(), 1, contents.size(), fp);
+  fclose(fp);
+  return path;
+}
+
+std::string Samples(size_t n) {
+  std::string s(n, '\0');
+  for (size_t i = 0; i < n; ++i) s[i] = static_cast<char>(i * 7 + 3);
+  return s;
+}
+
+TEST(MappedPnmTest, ParsesHeaders) {
+  MappedPnm image;
+  const std::string ppm = Samples(4 * 2 * 3);
+  ASSERT_TRUE(image.Open(WriteTemp("a.ppm", "P6\n4\n2\n255\n" + ppm).c_str()));
+  EXPECT_EQ(image.width(), 4u);
+  EXPECT_EQ(image.height(), 2u);
+  EXPECT_EQ(image.channels(), 3u);
+  EXPECT_EQ(image.maxval(), 255u);
+  ASSERT_EQ(image.size(), ppm.size());
+  EXPECT_EQ(memcmp(image.pixels(), ppm.data(), ppm.size()), 0);
+
+  // Comments, several fields per line and CRLF; the payload may start with
+  // bytes that look like whitespace.
+  const std::string pgm = "\n\r " + Samples(9);
+  ASSERT_TRUE(image.Open(
+      WriteTemp("b.pgm", "P5 # comment\r\n# more\r\n4 3 # x\n200\n" + pgm)
+          .c_str()));
+  EXPECT_EQ(image.channels(), 1u);
+  EXPECT_EQ(image.width(), 4u);
+  EXPECT_EQ(image.height(), 3u);
+  EXPECT_EQ(image.maxval(), 200u);
+  EXPECT_EQ(memcmp(image.pixels(), pgm.data(), 12), 0);
+
+  // Moving keeps the mapping alive.
+  MappedPnm moved = std::move(image);
+  EXPECT_FALSE(image.is_open());
+  ASSERT_TRUE(moved.is_open());
+  EXPECT_EQ(moved.pixels()[3], static_cast<unsigned char>(pgm[3]));
+}
+
+TEST(MappedPnmTest, RejectsBadFiles) {
+  MappedPnm image;
+  EXPECT_FALSE(image.Open("/nonexistent.ppm"));
+  EXPECT_FALSE(image.Open(WriteTemp("empty.ppm", "").c_str()));
+  EXPECT_FALSE(image.Open(WriteTemp("p3.ppm", "P3\n1 1\n255\n1 2 3").c_str()));
+  EXPECT_FALSE(
+      image.Open(WriteTemp("short.ppm", "P6\n2 2\n255\n" + Samples(11))
+                     .c_str()));
+  EXPECT_FALSE(
+      image.Open(WriteTemp("wide.pgm", "P5\n2 2\n65535\n" + Samples(8))
+                     .c_str()));
+  EXPECT_FALSE(image.Open(WriteTemp("nohdr.pgm", "P5\n2 2").c_str()));
+  EXPECT_FALSE(image.is_open());
+}
+
+std::string ReadFile(const std::string& path) {
+  std::string s;
+  FILE* fp = fopen(path.c_str(), "rb");
+  if (fp == NULL) return s;
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) s.append(buf, n);
+  fclose(fp);
+  return s;
+}
+
+TEST(PnmSaveTest, WritesHeaderAndSamples) {
+  const std::string rgb = Samples(5 * 3 * 3);
+  const std::string path = WriteTemp("save.ppm", "old contents, longer");
+  ASSERT_TRUE(pnm_save(path.c_str(),
+                       reinterpret_cast<const unsigned char*>(rgb.data()), 5,
+                       3, 3));
+  EXPECT_EQ(ReadFile(path), "P6\n5\n3\n255\n" + rgb);
+  ASSERT_TRUE(pnm_save(path.c_str(),
+                       reinterpret_cast<const unsigned char*>(rgb.data()), 5,
+                       3, 1));
+  EXPECT_EQ(ReadFile(path), "P5\n5\n3\n255\n" + rgb.substr(0, 15));
+
+  MappedPnm image;
+  ASSERT_TRUE(image.Open(path.c_str()));
+  EXPECT_EQ(image.width(), 5u);
+
+  EXPECT_FALSE(pnm_save(path.c_str(),
+                        reinterpret_cast<const unsigned char*>(rgb.data()), 5,
+                        3, 4));
+  EXPECT_FALSE(pnm_save("/nonexistent/dir/x.ppm",
+                        reinterpret_cast<const unsigned char*>(rgb.data()), 5,
+                        3, 3));
+}
+
+TEST(PnmWriteQueueTest, WritesAllFrames) {
+  const std::string rgb = Samples(64 * 32 * 3);
+  const unsigned char* data =
+      reinterpret_cast<const unsigned char*>(rgb.data());
+  std::vector<std::string> paths;
+  for (int i = 0; i < 40; ++i) {
+    paths.push_back(WriteTemp("queued" + std::to_string(i) + ".ppm", ""));
+  }
+  {
+    // Room for about two frames, so Save() has to wait on the writers.
+    PnmWriteQueue queue(2 * rgb.size() + 1, 2);
+    for (int i = 0; i < 20; ++i) queue.Save(paths[i], data, 64, 32, 3);
+    EXPECT_EQ(queue.Flush(), 0u);
+    for (int i = 0; i < 20; ++i) {
+      EXPECT_EQ(ReadFile(paths[i]), "P6\n64\n32\n255\n" + rgb) << i;
+    }
+
+    queue.Save("/nonexistent/dir/x.ppm", data, 64, 32, 3);
+    queue.Save(paths[20], std::vector<unsigned char>(3), 64, 32, 3);
+    EXPECT_EQ(queue.Flush(), 2u);
+    EXPECT_EQ(queue.Flush(), 0u);
+
+    // A frame above the limit still goes through.
+    PnmWriteQueue small(16);
+    small.Save(paths[21], data, 64, 32, 3);
+    EXPECT_EQ(small.Flush(), 0u);
+    EXPECT_EQ(ReadFile(paths[21]).size(), rgb.size() + 13);
+
+    // Frames still queued are written by the destructor.
+    for (int i = 22; i < 40; ++i) {
+      queue.Save(paths[i], std::vector<unsigned char>(data, data + rgb.size()),
+                 64, 32, 3);
+    }
+  }
+  for (int i = 22; i < 40; ++i) {
+    EXPECT_EQ(ReadFile(paths[i]), "P6\n64\n32\n255\n" + rgb) << i;
+  }
+}
+
+std::vector<PnmKernel> SupportedKernels() {
+  std::vector<PnmKernel> kernels;
+  for (PnmKernel kernel : {kPnmKernelScalar, kPnmKernelAvx2}) {
+    if (pnm_kernel_supported(kernel)) kernels.push_back(kernel);
+  }
+  return kernels;
+}
+
+class PnmKernelTest : public ::testing::TestWithParam<PnmKernel> {};
+
+TEST_P(PnmKernelTest, ExpandsToRgba) {
+  for (unsigned int channels : {1u, 3u}) {
+    for (size_t n : {size_t(0), size_t(1), size_t(9), size_t(10),
+                     size_t(17), size_t(1000003)}) {
+      const std::string src = Samples(n * channels);
+      const unsigned char* s =
+          reinterpret_cast<const unsigned char*>(src.data());
+      std::vector<unsigned char> rgba(4 * n + 1, 0xee);
+      std::vector<float> rgbaf(4 * n + 1, -1.0f);
+      for (int threads : {1, 3}) {
+        ASSERT_EQ(pnm_expand_rgba(s, channels, n, rgba.data(), threads,
+                                  GetParam()),
+                  0);
+        ASSERT_EQ(pnm_expand_rgba(s, channels, n, rgbaf.data(), threads,
+                                  GetParam()),
+                  0);
+        for (size_t i = 0; i < n; ++i) {
+          for (unsigned int c = 0; c < 4; ++c) {
+            const unsigned char expect =
+                c == 3 ? 0 : s[i * channels + (channels == 3 ? c : 0)];
+            ASSERT_EQ(rgba[4 * i + c], expect) << channels << " " << i;
+            ASSERT_EQ(rgbaf[4 * i + c], static_cast<float>(expect) / 255.0f)
+                << channels << " " << i;
+          }
+        }
+        EXPECT_EQ(rgba[4 * n], 0xee);
+        EXPECT_EQ(rgbaf[4 * n], -1.0f);
+      }
+    }
+  }
+  EXPECT_EQ(pnm_expand_rgba(nullptr, 2, 0, (unsigned char*)nullptr, 1,
+                            GetParam()),
+            1);
+}
+
+TEST_P(PnmKernelTest, Normalizes) {
+  const std::string src = Samples(100003);
+  const unsigned char* s = reinterpret_cast<const unsigned char*>(src.data());
+  std::vector<float> f(src.size());
+  ASSERT_EQ(pnm_normalize(s, src.size(), f.data(), 2, GetParam()), 0);
+  for (size_t i = 0; i < src.size(); ++i) {
+    ASSERT_EQ(f[i], static_cast<float>(s[i]) / 255.0f) << i;
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Kernels, PnmKernelTest,
+                         ::testing::ValuesIn(SupportedKernels()),
+                         [](const ::testing::TestParamInfo<PnmKernel>& info) {
+                           return std::string(pnm_kernel_name(info.param));
+                         });
+
+}  // namespace
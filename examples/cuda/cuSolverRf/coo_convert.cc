@@ -0,0 +1,207 @@
+#include "examples/cuda/cuSolverRf/coo_convert.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <vector>
+
+#include "examples/cuda/common/parallel_helper.h"
+
+namespace {
+
+constexpr int kMinEntriesPerThread = 1 << 16;
+
+/*
+ * Stable counting sort of the entry ids `in` (identity when NULL) by
+ * keys[id] - base, which must lie in [0, buckets). Bucket boundaries are
+ * written to ptr[0..buckets] (offset by base) when ptr is not NULL.
+ * Returns false if a key is out of range.
+ */
+bool CountingSortPass(const int* in, int nnz, const int* keys, int base,
+                      int buckets, int* out, int* ptr, int num_threads) {
+  std::vector<int> counts(static_cast<size_t>(num_threads) * buckets, 0);
+  std::atomic<bool> in_range{true};
+
+  ParallelFor(num_threads, [&](int t) {
+    int* count = counts.data() + static_cast<size_t>(t) * buckets;
+    const int end = BlockBegin(nnz, t + 1, num_threads);
+    for (int k = BlockBegin(nnz, t, num_threads); k < end; ++k) {
+      const int key = keys[in ? in[k] : k] - base;
+      if (static_cast<unsigned>(key) >= static_cast<unsigned>(buckets)) {
+        in_range = false;
+        return;
+      }
+      ++count[key];
+    }
+  });
+  if (!in_range) return false;
+
+  /* Per-bucket totals over all threads, then an exclusive scan. */
+  std::vector<int> starts(buckets + 1, 0);
+  ParallelFor(num_threads, [&](int t) {
+    const int end = BlockBegin(buckets, t + 1, num_threads);
+    for (int b = BlockBegin(buckets, t, num_threads); b < end; ++b) {
+      int total = 0;
+      for (int s = 0; s < num_threads; ++s) {
+        total += counts[static_cast<size_t>(s) * buckets + b];
+      }
+      starts[b + 1] = total;
+    }
+  });
+  for (int b = 0; b < buckets; ++b) starts[b + 1] += starts[b];
+  if (ptr != nullptr) {
+    for (int b = 0; b <= buckets; ++b) ptr[b] = starts[b] + base;
+  }
+
+  /* Turn counts into per-thread write cursors; thread order keeps it stable. */
+  ParallelFor(num_threads, [&](int t) {
+    const int end = BlockBegin(buckets, t + 1, num_threads);
+    for (int b = BlockBegin(buckets, t, num_threads); b < end; ++b) {
+      int cursor = starts[b];
+      for (int s = 0; s < num_threads; ++s) {
+        int& c = counts[static_cast<size_t>(s) * buckets + b];
+        const int n = c;
+        c = cursor;
+        cursor += n;
+      }
+    }
+  });
+
+  ParallelFor(num_threads, [&](int t) {
+    int* cursor = counts.data() + static_cast<size_t>(t) * buckets;
+    const int end = BlockBegin(nnz, t + 1, num_threads);
+    for (int k = BlockBegin(nnz, t, num_threads); k < end; ++k) {
+      const int id = in ? in[k] : k;
+      out[cursor[keys[id] - base]++] = id;
+    }
+  });
+  return true;
+}
+
+void Gather(int nnz, const int* perm, const int* src, int* dst,
+            int num_threads) {
+  ParallelFor(num_threads, [&](int t) {
+    const int end = BlockBegin(nnz, t + 1, num_threads);
+    for (int k = BlockBegin(nnz, t, num_threads); k < end; ++k) {
+      dst[k] = src[perm[k]];
+    }
+  });
+}
+
+struct cooFormat {
+  int i;
+  int j;
+  int p;  // permutation
+};
+
+int cmp_cooFormat_csr(const void* a, const void* b) {
+  const cooFormat* s = static_cast<const cooFormat*>(a);
+  const cooFormat* t = static_cast<const cooFormat*>(b);
+  if (s->i < t->i) {
+    return -1;
+  } else if (s->i > t->i) {
+    return 1;
+  } else {
+    return s->j - t->j;
+  }
+}
+
+int cmp_cooFormat_csc(const void* a, const void* b) {
+  const cooFormat* s = static_cast<const cooFormat*>(a);
+  const cooFormat* t = static_cast<const cooFormat*>(b);
+  if (s->j < t->j) {
+    return -1;
+  } else if (s->j > t->j) {
+    return 1;
+  } else {
+    return s->i - t->i;
+  }
+}
+
+}  // namespace
+
+int coo_convert_num_threads(int nnz, int m, int n, int num_threads) {
+  if (num_threads <= 0) num_threads = HardwareThreads();
+  /* Keep the per-thread histograms (threads x buckets) within O(nnz). */
+  const int buckets = std::max({m, n, 1});
+  num_threads = std::min(num_threads, nnz / buckets);
+  num_threads = std::min(num_threads, nnz / kMinEntriesPerThread);
+  return std::max(num_threads, 1);
+}
+
+int coo_to_csr_csc(int m, int n, int nnz, const int* cooRowInd,
+                   const int* cooColInd, int base, int* csrRowPtr,
+                   int* csrColInd, int* csrPerm, int* cscColPtr,
+                   int* cscRowInd, int* cscPerm, int num_threads) {
+  const bool want_csr = csrRowPtr != nullptr;
+  const bool want_csc = cscColPtr != nullptr;
+  if (want_csr != (csrColInd != nullptr && csrPerm != nullptr) ||
+      want_csc != (cscRowInd != nullptr && cscPerm != nullptr)) {
+    return 1;
+  }
+  num_threads = coo_convert_num_threads(nnz, m, n, num_threads);
+
+  /* LSD order: the last pass is the major key. */
+  std::vector<int> tmp(nnz);
+  if (want_csr) {
+    if (!CountingSortPass(nullptr, nnz, cooColInd, base, n, tmp.data(),
+                          nullptr, num_threads) ||
+        !CountingSortPass(tmp.data(), nnz, cooRowInd, base, m, csrPerm,
+                          csrRowPtr, num_threads)) {
+      return 1;
+    }
+    Gather(nnz, csrPerm, cooColInd, csrColInd, num_threads);
+    if (want_csc) {
+      /* (row, col) order is already the minor key order for CSC. */
+      CountingSortPass(csrPerm, nnz, cooColInd, base, n, cscPerm, cscColPtr,
+                       num_threads);
+      Gather(nnz, cscPerm, cooRowInd, cscRowInd, num_threads);
+    }
+  } else if (want_csc) {
+    if (!CountingSortPass(nullptr, nnz, cooRowInd, base, m, tmp.data(),
+                          nullptr, num_threads) ||
+        !CountingSortPass(tmp.data(), nnz, cooColInd, base, n, cscPerm,
+                          cscColPtr, num_threads)) {
+      return 1;
+    }
+    Gather(nnz, cscPerm, cooRowInd, cscRowInd, num_threads);
+  }
+  return 0;
+}
+
+void coo_sort_qsort(int nnz, const int* cooRowInd, const int* cooColInd,
+                    bool csrFormat, int* sortedRowInd, int* sortedColInd,
+                    int* perm) {
+  cooFormat* work = (cooFormat*)malloc(sizeof(cooFormat) * nnz);
+  for (int i = 0; i < nnz; i++) {
+    work[i].i = cooRowInd[i];
+    work[i].j = cooColInd[i];
+    work[i].p = i;  // permutation is identity
+  }
+  qsort(work, nnz, sizeof(cooFormat),
+        csrFormat ? cmp_cooFormat_csr : cmp_cooFormat_csc);
+  for (int i = 0; i < nnz; i++) {
+    sortedRowInd[i] = work[i].i;
+    sortedColInd[i] = work[i].j;
+    perm[i] = work[i].p;
+  }
+  free(work);
+}
+
+void compress_index(const int* Ind, int nnz, int m, int* Ptr, int base) {
+  int i;
+
+  /* initialize everything to zero */
+  for (i = 0; i < m + 1; i++) {
+    Ptr[i] = 0;
+  }
+  /* count elements in every row */
+  Ptr[0] = base;
+  for (i = 0; i < nnz; i++) {
+    Ptr[Ind[i] + (1 - base)]++;
+  }
+  /* add all the values */
+  for (i = 0; i < m; i++) {
+    Ptr[i + 1] += Ptr[i];
+  }
+}
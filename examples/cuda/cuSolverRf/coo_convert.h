@@ -0,0 +1,40 @@
+#pragma once
+
+/*
+ * COO -> CSR/CSC conversion by counting sort.
+ *
+ * Entries are ordered with two stable counting-sort passes (by column, then
+ * by row) for CSR, and one more stable pass by column for CSC, so each pass
+ * is O(nnz + m) with no comparator calls. The permutation arrays give, for
+ * every position of the compressed format, the index of the COO entry that
+ * landed there (the `p` field of the old qsort-based path). For distinct
+ * (row, col) keys they are identical to the qsort result; duplicates keep
+ * their input order.
+ */
+
+/* Returns the number of threads coo_to_csr_csc() actually uses. */
+int coo_convert_num_threads(int nnz, int m, int n, int num_threads);
+
+/*
+ * cooRowInd/cooColInd hold nnz entries with indices in [base, m + base) and
+ * [base, n + base). Outputs follow compress_index(): Ptr[0] == base and
+ * Ind[] keeps the input (based) indices.
+ *
+ * Either output group may be skipped by passing NULL for all three of its
+ * arrays. num_threads <= 0 picks one thread per hardware core. Returns 0 on
+ * success, or 1 if an index is out of range or a group is only partly given.
+ */
+int coo_to_csr_csc(int m, int n, int nnz, const int* cooRowInd,
+                   const int* cooColInd, int base, int* csrRowPtr,
+                   int* csrColInd, int* csrPerm, int* cscColPtr,
+                   int* cscRowInd, int* cscPerm, int num_threads);
+
+/*
+ * Reference implementation: the qsort() path loadMMSparseMatrix() used
+ * before. Writes the sorted row/col indices and the permutation.
+ */
+void coo_sort_qsort(int nnz, const int* cooRowInd, const int* cooColInd,
+                    bool csrFormat, int* sortedRowInd, int* sortedColInd,
+                    int* perm);
+
+void compress_index(const int* Ind, int nnz, int m, int* Ptr, int base);
@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "examples/cuda/cuSolverRf/coo_convert.h"
+
+// How to run:
+// bazel run -c opt //examples/cuda/cuSolverRf:coo_convert_benchmark
+namespace {
+
+struct Coo {
+  int m;
+  std::vector<int> rows, cols;
+};
+
+// A banded matrix with ~16 entries per row, shuffled like an unsorted .mtx.
+const Coo& BandedCoo(int nnz) {
+  static auto* cache = new std::map<int, Coo>();
+  auto it = cache->find(nnz);
+  if (it != cache->end()) return it->second;
+  constexpr int kPerRow = 16;
+  Coo coo{nnz / kPerRow, {}, {}};
+  for (int i = 0; i < coo.m; ++i) {
+    for (int k = 0; k < kPerRow; ++k) {
+      coo.rows.push_back(i);
+      coo.cols.push_back((i + k * 37) % coo.m);
+    }
+  }
+  std::vector<int> order(coo.rows.size());
+  for (size_t k = 0; k < order.size(); ++k) order[k] = static_cast<int>(k);
+  std::shuffle(order.begin(), order.end(), std::mt19937(1));
+  Coo shuffled{coo.m, {}, {}};
+  for (int k : order) {
+    shuffled.rows.push_back(coo.rows[k]);
+    shuffled.cols.push_back(coo.cols[k]);
+  }
+  return cache->emplace(nnz, std::move(shuffled)).first->second;
+}
+
+void BM_Qsort(benchmark::State& state) {
+  const Coo& coo = BandedCoo(state.range(0));
+  const int nnz = static_cast<int>(coo.rows.size());
+  std::vector<int> rows(nnz), cols(nnz), perm(nnz), ptr(coo.m + 1);
+  for (auto _ : state) {
+    coo_sort_qsort(nnz, coo.rows.data(), coo.cols.data(), true, rows.data(),
+                   cols.data(), perm.data());
+    compress_index(rows.data(), nnz, coo.m, ptr.data(), 0);
+    benchmark::DoNotOptimize(ptr.data());
+  }
+  state.SetItemsProcessed(state.iterations() * nnz);
+}
+
+void BM_CountingSortCsr(benchmark::State& state) {
+  const Coo& coo = BandedCoo(state.range(0));
+  const int nnz = static_cast<int>(coo.rows.size());
+  const int threads = static_cast<int>(state.range(1));
+  std::vector<int> ptr(coo.m + 1), ind(nnz), perm(nnz);
+  for (auto _ : state) {
+    coo_to_csr_csc(coo.m, coo.m, nnz, coo.rows.data(), coo.cols.data(), 0,
+                   ptr.data(), ind.data(), perm.data(), nullptr, nullptr,
+                   nullptr, threads);
+    benchmark::DoNotOptimize(ptr.data());
+  }
+  state.counters["threads"] = coo_convert_num_threads(nnz, coo.m, coo.m,
+                                                      threads);
+  state.SetItemsProcessed(state.iterations() * nnz);
+}
+
+void BM_CountingSortCsrCsc(benchmark::State& state) {
+  const Coo& coo = BandedCoo(state.range(0));
+  const int nnz = static_cast<int>(coo.rows.size());
+  const int threads = static_cast<int>(state.range(1));
+  std::vector<int> csr_ptr(coo.m + 1), csr_ind(nnz), csr_perm(nnz);
+  std::vector<int> csc_ptr(coo.m + 1), csc_ind(nnz), csc_perm(nnz);
+  for (auto _ : state) {
+    coo_to_csr_csc(coo.m, coo.m, nnz, coo.rows.data(), coo.cols.data(), 0,
+                   csr_ptr.data(), csr_ind.data(), csr_perm.data(),
+                   csc_ptr.data(), csc_ind.data(), csc_perm.data(), threads);
+    benchmark::DoNotOptimize(csc_ptr.data());
+  }
+  state.counters["threads"] = coo_convert_num_threads(nnz, coo.m, coo.m,
+                                                      threads);
+  state.SetItemsProcessed(state.iterations() * nnz);
+}
+
+BENCHMARK(BM_Qsort)
+    ->ArgName("nnz")
+    ->RangeMultiplier(4)
+    ->Range(1 << 20, 1 << 24)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_CountingSortCsr)
+    ->ArgNames({"nnz", "threads"})
+    ->ArgsProduct({{1 << 20, 1 << 22, 1 << 24}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_CountingSortCsrCsc)
+    ->ArgNames({"nnz", "threads"})
+    ->ArgsProduct({{1 << 20, 1 << 22, 1 << 24}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
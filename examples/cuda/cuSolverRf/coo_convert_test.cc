@@ -0,0 +1,114 @@
+#include "examples/cuda/cuSolverRf/coo_convert.h"
+
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct Coo {
+  int m, n;
+  std::vector<int> rows, cols;
+};
+
+// Distinct (row, col) keys in random order.
+Coo RandomCoo(int m, int n, int nnz, int base, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::set<std::pair<int, int>> seen;
+  Coo coo{m, n, {}, {}};
+  while (static_cast<int>(coo.rows.size()) < nnz) {
+    const int i = static_cast<int>(rng() % m) + base;
+    const int j = static_cast<int>(rng() % n) + base;
+    if (seen.emplace(i, j).second) {
+      coo.rows.push_back(i);
+      coo.cols.push_back(j);
+    }
+  }
+  return coo;
+}
+
+void ExpectMatchesQsort(const Coo& coo, int base, int num_threads) {
+  const int nnz = static_cast<int>(coo.rows.size());
+  std::vector<int> csr_ptr(coo.m + 1), csr_ind(nnz), csr_perm(nnz);
+  std::vector<int> csc_ptr(coo.n + 1), csc_ind(nnz), csc_perm(nnz);
+  ASSERT_EQ(coo_to_csr_csc(coo.m, coo.n, nnz, coo.rows.data(),
+                           coo.cols.data(), base, csr_ptr.data(),
+                           csr_ind.data(), csr_perm.data(), csc_ptr.data(),
+                           csc_ind.data(), csc_perm.data(), num_threads),
+            0);
+
+  std::vector<int> rows(nnz), cols(nnz), perm(nnz), ptr;
+  coo_sort_qsort(nnz, coo.rows.data(), coo.cols.data(), true, rows.data(),
+                 cols.data(), perm.data());
+  EXPECT_EQ(csr_perm, perm);
+  EXPECT_EQ(csr_ind, cols);
+  ptr.resize(coo.m + 1);
+  compress_index(rows.data(), nnz, coo.m, ptr.data(), base);
+  EXPECT_EQ(csr_ptr, ptr);
+
+  coo_sort_qsort(nnz, coo.rows.data(), coo.cols.data(), false, rows.data(),
+                 cols.data(), perm.data());
+  EXPECT_EQ(csc_perm, perm);
+  EXPECT_EQ(csc_ind, rows);
+  ptr.resize(coo.n + 1);
+  compress_index(cols.data(), nnz, coo.n, ptr.data(), base);
+  EXPECT_EQ(csc_ptr, ptr);
+}
+
+TEST(CooConvertTest, MatchesQsortSmall) {
+  for (int base : {0, 1}) {
+    ExpectMatchesQsort(RandomCoo(37, 53, 500, base, 1), base, 1);
+  }
+}
+
+TEST(CooConvertTest, MatchesQsortMultithreaded) {
+  const Coo coo = RandomCoo(2000, 1500, 400000, 1, 2);
+  ASSERT_GT(coo_convert_num_threads(400000, 2000, 1500, 4), 1);
+  for (int threads : {1, 2, 4}) {
+    ExpectMatchesQsort(coo, 1, threads);
+  }
+}
+
+TEST(CooConvertTest, CscOnly) {
+  const Coo coo = RandomCoo(100, 80, 3000, 0, 3);
+  const int nnz = static_cast<int>(coo.rows.size());
+  std::vector<int> ptr(coo.n + 1), ind(nnz), perm(nnz);
+  ASSERT_EQ(coo_to_csr_csc(coo.m, coo.n, nnz, coo.rows.data(),
+                           coo.cols.data(), 0, nullptr, nullptr, nullptr,
+                           ptr.data(), ind.data(), perm.data(), 1),
+            0);
+  std::vector<int> rows(nnz), cols(nnz), expected(nnz);
+  coo_sort_qsort(nnz, coo.rows.data(), coo.cols.data(), false, rows.data(),
+                 cols.data(), expected.data());
+  EXPECT_EQ(perm, expected);
+}
+
+TEST(CooConvertTest, DuplicatesKeepInputOrder) {
+  const std::vector<int> rows = {1, 0, 1, 1, 0};
+  const std::vector<int> cols = {2, 0, 2, 0, 0};
+  std::vector<int> ptr(3), ind(5), perm(5);
+  ASSERT_EQ(coo_to_csr_csc(2, 3, 5, rows.data(), cols.data(), 0, ptr.data(),
+                           ind.data(), perm.data(), nullptr, nullptr, nullptr,
+                           1),
+            0);
+  EXPECT_EQ(perm, (std::vector<int>{1, 4, 3, 0, 2}));
+  EXPECT_EQ(ptr, (std::vector<int>{0, 2, 5}));
+}
+
+TEST(CooConvertTest, RejectsOutOfRange) {
+  const std::vector<int> rows = {0, 3};
+  const std::vector<int> cols = {0, 1};
+  std::vector<int> ptr(4), ind(2), perm(2);
+  EXPECT_EQ(coo_to_csr_csc(3, 3, 2, rows.data(), cols.data(), 0, ptr.data(),
+                           ind.data(), perm.data(), nullptr, nullptr, nullptr,
+                           1),
+            1);
+  EXPECT_EQ(coo_to_csr_csc(3, 3, 2, rows.data(), cols.data(), 0, ptr.data(),
+                           nullptr, perm.data(), nullptr, nullptr, nullptr, 1),
+            1);
+}
+
+}  // namespace
@@ -0,0 +1,222 @@
+#include "examples/cuda/cuSolverRf/csr_cache.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+constexpr uint64_t kHashPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kHashPrime2 = 0xC2B2AE3D27D4EB4FULL;
+
+inline uint64_t Rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint64_t Load64(const unsigned char* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t Round(uint64_t acc, uint64_t input) {
+  acc += input * kHashPrime2;
+  return Rotl(acc, 31) * kHashPrime1;
+}
+
+/* Four independent lanes so the loop runs at memory bandwidth. */
+uint64_t HashBytes(const unsigned char* p, size_t n) {
+  uint64_t lanes[4] = {kHashPrime1 + kHashPrime2, kHashPrime2, 0,
+                       0 - kHashPrime1};
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    lanes[0] = Round(lanes[0], Load64(p + i));
+    lanes[1] = Round(lanes[1], Load64(p + i + 8));
+    lanes[2] = Round(lanes[2], Load64(p + i + 16));
+    lanes[3] = Round(lanes[3], Load64(p + i + 24));
+  }
+  uint64_t h = Rotl(lanes[0], 1) + Rotl(lanes[1], 7) + Rotl(lanes[2], 12) +
+               Rotl(lanes[3], 18);
+  for (; i < n; ++i) {
+    h = Round(h, p[i]);
+  }
+  h ^= n;
+  h ^= h >> 33;
+  h *= kHashPrime2;
+  h ^= h >> 29;
+  return h;
+}
+
+inline uint64_t AlignUp(uint64_t n) {
+  return (n + kCsrCacheAlignment - 1) & ~(kCsrCacheAlignment - 1);
+}
+
+/* Maps a whole file read-only; returns nullptr for empty or unreadable. */
+void* MapFile(const char* fname, size_t* size) {
+  const int fd = open(fname, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return nullptr;
+  struct stat st;
+  void* base = nullptr;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    *size = static_cast<size_t>(st.st_size);
+    base = mmap(nullptr, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (base == MAP_FAILED) base = nullptr;
+  }
+  close(fd);
+  return base;
+}
+
+bool WriteAt(FILE* f, uint64_t offset, const void* data, size_t bytes) {
+  static const char kZeros[kCsrCacheAlignment] = {};
+  const long pos = ftell(f);
+  if (pos < 0 || static_cast<uint64_t>(pos) > offset) return false;
+  if (fwrite(kZeros, 1, offset - pos, f) != offset - pos) return false;
+  return bytes == 0 || fwrite(data, 1, bytes, f) == bytes;
+}
+
+}  // namespace
+
+std::string csr_cache_path(const char* mtx_fname) {
+  return std::string(mtx_fname) + ".csrcache";
+}
+
+bool csr_cache_hash_file(const char* fname, uint64_t* size, uint64_t* hash) {
+  struct stat st;
+  if (stat(fname, &st) != 0) return false;
+  *size = static_cast<uint64_t>(st.st_size);
+  if (*size == 0) {
+    *hash = HashBytes(nullptr, 0);
+    return true;
+  }
+  size_t mapped = 0;
+  void* base = MapFile(fname, &mapped);
+  if (base == nullptr) return false;
+  madvise(base, mapped, MADV_SEQUENTIAL);
+  *size = mapped;
+  *hash = HashBytes(static_cast<const unsigned char*>(base), mapped);
+  munmap(base, mapped);
+  return true;
+}
+
+CsrCacheView::CsrCacheView(CsrCacheView&& other) noexcept {
+  *this = std::move(other);
+}
+
+CsrCacheView& CsrCacheView::operator=(CsrCacheView&& other) noexcept {
+  if (this != &other) {
+    Reset();
+    base_ = std::exchange(other.base_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    header_ = std::exchange(other.header_, nullptr);
+    ptr_ = std::exchange(other.ptr_, nullptr);
+    ind_ = std::exchange(other.ind_, nullptr);
+    val_ = std::exchange(other.val_, nullptr);
+  }
+  return *this;
+}
+
+CsrCacheView::~CsrCacheView() { Reset(); }
+
+void CsrCacheView::Reset() {
+  if (base_ != nullptr) {
+    munmap(base_, size_);
+  }
+  base_ = nullptr;
+  size_ = 0;
+  header_ = nullptr;
+  ptr_ = ind_ = nullptr;
+  val_ = nullptr;
+}
+
+bool CsrCacheView::Open(const char* mtx_fname, bool csrFormat,
+                        int extendSymMatrix) {
+  Reset();
+  const std::string path = csr_cache_path(mtx_fname);
+  base_ = MapFile(path.c_str(), &size_);
+  if (base_ == nullptr || size_ < sizeof(CsrCacheHeader)) {
+    Reset();
+    return false;
+  }
+  const char* bytes = static_cast<const char*>(base_);
+  const auto* h = reinterpret_cast<const CsrCacheHeader*>(bytes);
+  const uint64_t major = static_cast<uint64_t>(csrFormat ? h->m : h->n);
+  const uint64_t nnz = static_cast<uint64_t>(h->nnz);
+  const bool valid =
+      std::memcmp(h->magic, kCsrCacheMagic, sizeof(h->magic)) == 0 &&
+      h->version == kCsrCacheVersion &&
+      h->header_size == sizeof(CsrCacheHeader) && h->file_size == size_ &&
+      h->csr_format == (csrFormat ? 1 : 0) &&
+      h->extend_sym == (extendSymMatrix ? 1 : 0) && h->m >= 0 && h->n >= 0 &&
+      h->nnz >= 0 && h->values_per_entry <= 2 &&
+      h->ptr_offset % kCsrCacheAlignment == 0 &&
+      h->ind_offset % kCsrCacheAlignment == 0 &&
+      h->val_offset % kCsrCacheAlignment == 0 &&
+      h->ptr_offset + (major + 1) * sizeof(int) <= size_ &&
+      h->ind_offset + nnz * sizeof(int) <= size_ &&
+      h->val_offset + nnz * h->values_per_entry * sizeof(double) <= size_;
+  if (!valid) {
+    Reset();
+    return false;
+  }
+
+  uint64_t source_size = 0, source_hash = 0;
+  if (!csr_cache_hash_file(mtx_fname, &source_size, &source_hash) ||
+      source_size != h->source_size || source_hash != h->source_hash) {
+    Reset();
+    return false;
+  }
+
+  header_ = h;
+  ptr_ = reinterpret_cast<const int*>(bytes + h->ptr_offset);
+  ind_ = reinterpret_cast<const int*>(bytes + h->ind_offset);
+  val_ = reinterpret_cast<const double*>(bytes + h->val_offset);
+  return true;
+}
+
+int csr_cache_store(const char* mtx_fname, bool csrFormat, int extendSymMatrix,
+                    const MM_typecode matcode, int m, int n, int nnz,
+                    int base, int values_per_entry, const int* ptr,
+                    const int* ind, const double* val) {
+  CsrCacheHeader h;
+  std::memset(&h, 0, sizeof(h));
+  std::memcpy(h.magic, kCsrCacheMagic, sizeof(h.magic));
+  h.version = kCsrCacheVersion;
+  h.header_size = sizeof(CsrCacheHeader);
+  if (!csr_cache_hash_file(mtx_fname, &h.source_size, &h.source_hash)) {
+    return 1;
+  }
+  h.m = m;
+  h.n = n;
+  h.nnz = nnz;
+  h.base = base;
+  std::memcpy(h.typecode, matcode, sizeof(h.typecode));
+  h.csr_format = csrFormat ? 1 : 0;
+  h.extend_sym = extendSymMatrix ? 1 : 0;
+  h.values_per_entry = static_cast<uint8_t>(values_per_entry);
+
+  const size_t ptr_bytes = ((csrFormat ? m : n) + 1) * sizeof(int);
+  const size_t ind_bytes = static_cast<size_t>(nnz) * sizeof(int);
+  const size_t val_bytes =
+      static_cast<size_t>(nnz) * values_per_entry * sizeof(double);
+  h.ptr_offset = AlignUp(sizeof(h));
+  h.ind_offset = AlignUp(h.ptr_offset + ptr_bytes);
+  h.val_offset = AlignUp(h.ind_offset + ind_bytes);
+  h.file_size = h.val_offset + val_bytes;
+
+  const std::string path = csr_cache_path(mtx_fname);
+  const std::string tmp = path + ".tmp." + std::to_string(getpid());
+  FILE* f = fopen(tmp.c_str(), "wb");
+  if (f == NULL) return 1;
+  const bool ok = WriteAt(f, 0, &h, sizeof(h)) &&
+                  WriteAt(f, h.ptr_offset, ptr, ptr_bytes) &&
+                  WriteAt(f, h.ind_offset, ind, ind_bytes) &&
+                  WriteAt(f, h.val_offset, val, val_bytes);
+  if (fclose(f) != 0 || !ok || rename(tmp.c_str(), path.c_str()) != 0) {
+    remove(tmp.c_str());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "examples/cuda/cuSolverRf/mmio.h"
+
+/*
+ * Binary sidecar cache of the compressed matrix loadMMSparseMatrix() builds
+ * from a .mtx file, stored as "<file>.csrcache" next to it.
+ *
+ * Layout (host byte order, every array 64-byte aligned):
+ *   CsrCacheHeader
+ *   int    ptr[major + 1]           row (CSR) or column (CSC) pointers
+ *   int    ind[nnz]                 column (CSR) or row (CSC) indices
+ *   double val[nnz * values_per_entry]
+ *
+ * The header records the size and a 64-bit content hash of the source
+ * file, so any change to the .mtx invalidates the sidecar. It also records
+ * the load options, since CSR/CSC and symmetric expansion give different
+ * arrays for the same source.
+ */
+
+constexpr char kCsrCacheMagic[8] = {'C', 'S', 'R', 'C', 'A', 'C', 'H', 'E'};
+constexpr uint32_t kCsrCacheVersion = 1;
+constexpr size_t kCsrCacheAlignment = 64;
+
+struct CsrCacheHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t header_size;
+  uint64_t file_size;
+  uint64_t source_size;
+  uint64_t source_hash;
+
+  int32_t m;
+  int32_t n;
+  int32_t nnz;
+  int32_t base;
+  char typecode[4];
+  uint8_t csr_format;
+  uint8_t extend_sym;
+  uint8_t values_per_entry;
+  uint8_t reserved0;
+
+  uint64_t ptr_offset;
+  uint64_t ind_offset;
+  uint64_t val_offset;
+  uint8_t reserved1[40];
+};
+
+static_assert(sizeof(CsrCacheHeader) == 128, "CsrCacheHeader layout");
+
+/* Sidecar path for a .mtx file. */
+std::string csr_cache_path(const char* mtx_fname);
+
+/* 64-bit content hash of a file; returns false if it cannot be read. */
+bool csr_cache_hash_file(const char* fname, uint64_t* size, uint64_t* hash);
+
+/*
+ * Read-only mapping of a sidecar which matched its source and load options.
+ * Arrays point into the mapping and are valid until the object is gone.
+ */
+class CsrCacheView {
+ public:
+  CsrCacheView() = default;
+  CsrCacheView(CsrCacheView&& other) noexcept;
+  CsrCacheView& operator=(CsrCacheView&& other) noexcept;
+  CsrCacheView(const CsrCacheView&) = delete;
+  CsrCacheView& operator=(const CsrCacheView&) = delete;
+  ~CsrCacheView();
+
+  /*
+   * Maps the sidecar of mtx_fname. Returns false, leaving the view empty,
+   * if there is none, it is corrupted, stale, or was written with other
+   * load options.
+   */
+  bool Open(const char* mtx_fname, bool csrFormat, int extendSymMatrix);
+
+  const CsrCacheHeader& header() const { return *header_; }
+  const int* ptr() const { return ptr_; }
+  const int* ind() const { return ind_; }
+  const double* val() const { return val_; }
+
+ private:
+  void Reset();
+
+  void* base_ = nullptr;
+  size_t size_ = 0;
+  const CsrCacheHeader* header_ = nullptr;
+  const int* ptr_ = nullptr;
+  const int* ind_ = nullptr;
+  const double* val_ = nullptr;
+};
+
+/*
+ * Writes the sidecar for mtx_fname. ptr has (csrFormat ? m : n) + 1
+ * entries, val has nnz * values_per_entry. The file is written under a
+ * temporary name and renamed, so readers never observe a partial sidecar.
+ * Returns 0 on success.
+ */
+int csr_cache_store(const char* mtx_fname, bool csrFormat, int extendSymMatrix,
+                    const MM_typecode matcode, int m, int n, int nnz,
+                    int base, int values_per_entry, const int* ptr,
+                    const int* ind, const double* val);
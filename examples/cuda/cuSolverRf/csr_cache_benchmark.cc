@@ -0,0 +1,110 @@
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "examples/cuda/cuSolverRf/mmio_wrapper.h"
+
+// How to run:
+// bazel run -c opt //examples/cuda/cuSolverRf:csr_cache_benchmark
+namespace {
+
+// Writes the 7-point Laplacian of an n^3 grid (lower triangle, symmetric).
+std::string MakeLaplacian3D(int n) {
+  const auto path = std::filesystem::temp_directory_path() /
+                    ("csr_cache_lap3D_7pt_n" + std::to_string(n) + ".mtx");
+  if (std::filesystem::exists(path)) {
+    return path.string();
+  }
+  FILE* f = fopen(path.c_str(), "w");
+  if (f == nullptr) std::abort();
+  const int rows = n * n * n;
+  const long nz = rows + 3L * (n - 1) * n * n;
+  fprintf(f, "%%%%MatrixMarket matrix coordinate real symmetric\n");
+  fprintf(f, "%d %d %ld\n", rows, rows, nz);
+  for (int z = 0; z < n; ++z) {
+    for (int y = 0; y < n; ++y) {
+      for (int x = 0; x < n; ++x) {
+        const int row = (z * n + y) * n + x + 1;
+        fprintf(f, "%d %d  6\n", row, row);
+        if (x + 1 < n) fprintf(f, "%d %d -1\n", row + 1, row);
+        if (y + 1 < n) fprintf(f, "%d %d -1\n", row + n, row);
+        if (z + 1 < n) fprintf(f, "%d %d -1\n", row + n * n, row);
+      }
+    }
+  }
+  fclose(f);
+  return path.string();
+}
+
+// The bundled matrices are copied to a writable directory for the sidecar.
+std::string CopyToTemp(const char* path) {
+  const auto dst =
+      std::filesystem::temp_directory_path() /
+      ("csr_cache_" + std::filesystem::path(path).filename().string());
+  std::filesystem::copy_file(
+      path, dst, std::filesystem::copy_options::overwrite_existing);
+  return dst.string();
+}
+
+const std::string& MatrixPath(int index) {
+  static const auto* paths = new std::vector<std::string>{
+      CopyToTemp("examples/cuda/cuSolverRf/data/lap2D_5pt_n100.mtx"),
+      CopyToTemp("examples/cuda/cuSolverRf/data/lap3D_7pt_n20.mtx"),
+      MakeLaplacian3D(100),
+  };
+  return (*paths)[index];
+}
+
+void RunLoad(benchmark::State& state, bool cached) {
+  std::string path = MatrixPath(state.range(0));
+  std::filesystem::remove(csr_cache_path(path.c_str()));
+  int m, n, nnz;
+  double* val = nullptr;
+  int *row = nullptr, *col = nullptr;
+  auto load = [&] {
+    free(val);
+    free(row);
+    free(col);
+    return cached ? loadMMSparseMatrixCached<double>(&path[0], 'd', true, &m,
+                                                     &n, &nnz, &val, &row,
+                                                     &col, true)
+                  : loadMMSparseMatrix<double>(&path[0], 'd', true, &m, &n,
+                                               &nnz, &val, &row, &col, true);
+  };
+  if (cached && load() != 0) {  // write the sidecar
+    state.SkipWithError("load failed");
+    return;
+  }
+  for (auto _ : state) {
+    if (load() != 0) {
+      state.SkipWithError("load failed");
+      break;
+    }
+  }
+  free(val);
+  free(row);
+  free(col);
+  state.SetLabel(std::filesystem::path(path).filename().string());
+  state.counters["nnz"] = nnz;
+}
+
+void BM_Parse(benchmark::State& state) { RunLoad(state, false); }
+
+void BM_Cached(benchmark::State& state) { RunLoad(state, true); }
+
+// Matrices: 0, 1 are bundled; 2 (~50 MB) is synthetic.
+BENCHMARK(BM_Parse)
+    ->ArgName("matrix")
+    ->DenseRange(0, 2)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_Cached)
+    ->ArgName("matrix")
+    ->DenseRange(0, 2)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,131 @@
+#include "examples/cuda/cuSolverRf/csr_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+class CsrCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    mtx_ = (std::filesystem::path(::testing::TempDir()) /
+            (std::string(::testing::UnitTest::GetInstance()
+                             ->current_test_info()
+                             ->name()) +
+             ".mtx"))
+               .string();
+    WriteSource("%%MatrixMarket matrix coordinate real general\n"
+                "3 3 4\n1 1 4.0\n2 2 5.0\n3 1 -1.0\n3 3 6.0\n");
+    std::filesystem::remove(csr_cache_path(mtx_.c_str()));
+  }
+
+  void WriteSource(const std::string& text) {
+    std::ofstream(mtx_, std::ios::binary | std::ios::trunc) << text;
+  }
+
+  int Store(bool csr, int extend) {
+    MM_typecode matcode = {'M', 'C', 'R', 'G'};
+    return csr_cache_store(mtx_.c_str(), csr, extend, matcode, 3, 3, 4, 1, 1,
+                           ptr_.data(), ind_.data(), val_.data());
+  }
+
+  std::string mtx_;
+  std::vector<int> ptr_ = {1, 2, 3, 5};
+  std::vector<int> ind_ = {1, 2, 1, 3};
+  std::vector<double> val_ = {4.0, 5.0, -1.0, 6.0};
+};
+
+TEST_F(CsrCacheTest, RoundTrip) {
+  ASSERT_EQ(Store(true, 0), 0);
+
+  CsrCacheView view;
+  ASSERT_TRUE(view.Open(mtx_.c_str(), true, 0));
+  EXPECT_EQ(view.header().m, 3);
+  EXPECT_EQ(view.header().n, 3);
+  EXPECT_EQ(view.header().nnz, 4);
+  EXPECT_EQ(view.header().base, 1);
+  EXPECT_EQ(std::memcmp(view.header().typecode, "MCRG", 4), 0);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(view.ptr()) % kCsrCacheAlignment, 0u);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(view.val()) % kCsrCacheAlignment, 0u);
+  EXPECT_EQ(std::vector<int>(view.ptr(), view.ptr() + 4), ptr_);
+  EXPECT_EQ(std::vector<int>(view.ind(), view.ind() + 4), ind_);
+  EXPECT_EQ(std::vector<double>(view.val(), view.val() + 4), val_);
+
+  CsrCacheView moved = std::move(view);
+  EXPECT_EQ(moved.ptr()[3], 5);
+}
+
+TEST_F(CsrCacheTest, MissingSidecar) {
+  CsrCacheView view;
+  EXPECT_FALSE(view.Open(mtx_.c_str(), true, 0));
+}
+
+TEST_F(CsrCacheTest, OptionMismatch) {
+  ASSERT_EQ(Store(true, 0), 0);
+  CsrCacheView view;
+  EXPECT_FALSE(view.Open(mtx_.c_str(), false, 0));
+  EXPECT_FALSE(view.Open(mtx_.c_str(), true, 1));
+  EXPECT_TRUE(view.Open(mtx_.c_str(), true, 0));
+}
+
+TEST_F(CsrCacheTest, SourceChangeInvalidates) {
+  ASSERT_EQ(Store(true, 0), 0);
+  // Same size, different content.
+  WriteSource("%%MatrixMarket matrix coordinate real general\n"
+              "3 3 4\n1 1 4.0\n2 2 5.0\n3 1 -1.0\n3 3 7.0\n");
+  CsrCacheView view;
+  EXPECT_FALSE(view.Open(mtx_.c_str(), true, 0));
+}
+
+TEST_F(CsrCacheTest, CorruptedSidecar) {
+  ASSERT_EQ(Store(true, 0), 0);
+  const std::string path = csr_cache_path(mtx_.c_str());
+  {
+    std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekp(0);
+    f.put('X');
+  }
+  CsrCacheView view;
+  EXPECT_FALSE(view.Open(mtx_.c_str(), true, 0));
+}
+
+TEST_F(CsrCacheTest, TruncatedSidecar) {
+  ASSERT_EQ(Store(true, 0), 0);
+  const std::string path = csr_cache_path(mtx_.c_str());
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+  CsrCacheView view;
+  EXPECT_FALSE(view.Open(mtx_.c_str(), true, 0));
+}
+
+TEST_F(CsrCacheTest, StoreFailsWithoutSource) {
+  std::filesystem::remove(mtx_);
+  EXPECT_NE(Store(true, 0), 0);
+  EXPECT_FALSE(std::filesystem::exists(csr_cache_path(mtx_.c_str())));
+}
+
+TEST(CsrCacheHashTest, DetectsSingleBitFlip) {
+  const std::string path =
+      (std::filesystem::path(::testing::TempDir()) / "hash.bin").string();
+  std::string data(1000, 'a');
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << data;
+  uint64_t size0, hash0;
+  ASSERT_TRUE(csr_cache_hash_file(path.c_str(), &size0, &hash0));
+  EXPECT_EQ(size0, 1000u);
+
+  for (size_t pos : {0, 31, 32, 500, 999}) {
+    std::string flipped = data;
+    flipped[pos] ^= 1;
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << flipped;
+    uint64_t size1, hash1;
+    ASSERT_TRUE(csr_cache_hash_file(path.c_str(), &size1, &hash1));
+    EXPECT_NE(hash0, hash1) << "pos " << pos;
+  }
+}
+
+}  // namespace
@@ -0,0 +1,265 @@
+#include "examples/cuda/cuSolverRf/csr_lu.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <utility>
+
+int CsrLuHost::Analyze(int n, int nnz, int base, const int* csrRowPtr,
+                       const int* csrColInd) {
+  factored_ = false;
+  rowPtr_.clear();
+  if (n < 0 || nnz < 0 || csrRowPtr[0] != base ||
+      csrRowPtr[n] - base != nnz) {
+    return 1;
+  }
+  for (int i = 0; i < n; ++i) {
+    const int start = csrRowPtr[i] - base;
+    const int end = csrRowPtr[i + 1] - base;
+    if (start > end) return 1;
+    for (int p = start; p < end; ++p) {
+      const int j = csrColInd[p] - base;
+      if (static_cast<unsigned>(j) >= static_cast<unsigned>(n)) return 1;
+      if (p > start && csrColInd[p - 1] >= csrColInd[p]) return 1;
+    }
+  }
+
+  n_ = n;
+  rowPtr_.resize(n + 1);
+  colInd_.resize(nnz);
+  for (int i = 0; i <= n; ++i) rowPtr_[i] = csrRowPtr[i] - base;
+  for (int p = 0; p < nnz; ++p) colInd_[p] = csrColInd[p] - base;
+
+  xi_.resize(n);
+  stack_.resize(n);
+  pstack_.resize(n);
+  return 0;
+}
+
+int CsrLuHost::Reach(int i) {
+  int top = n_;
+  for (int p = rowPtr_[i]; p < rowPtr_[i + 1]; ++p) {
+    const int root = colInd_[p];
+    if (mark_[root] == i) continue;
+
+    /* Iterative DFS through the rows of U; pstack_ resumes each node. */
+    int head = 0;
+    stack_[0] = root;
+    mark_[root] = i;
+    pstack_[0] = colpiv_[root] >= 0 ? Up_[colpiv_[root]] + 1 : 0;
+    while (head >= 0) {
+      const int c = stack_[head];
+      const int k = colpiv_[c];
+      bool done = true;
+      if (k >= 0) {
+        const int end = Up_[k + 1];
+        for (int q = pstack_[head]; q < end; ++q) {
+          const int next = Uj_[q];
+          if (mark_[next] == i) continue;
+          pstack_[head] = q + 1;
+          ++head;
+          stack_[head] = next;
+          mark_[next] = i;
+          pstack_[head] = colpiv_[next] >= 0 ? Up_[colpiv_[next]] + 1 : 0;
+          done = false;
+          break;
+        }
+      }
+      if (done) {
+        --head;
+        xi_[--top] = c;
+      }
+    }
+  }
+  return top;
+}
+
+int CsrLuHost::Factor(const double* csrVal, double pivot_threshold) {
+  if (rowPtr_.empty()) return 1;
+  factored_ = false;
+  const int nnz = rowPtr_[n_];
+
+  Lp_.assign(1, 0);
+  Lj_.clear();
+  Lx_.clear();
+  Up_.assign(1, 0);
+  Uj_.clear();
+  Ux_.clear();
+  Lj_.reserve(2 * nnz);
+  Lx_.reserve(2 * nnz);
+  Uj_.reserve(2 * nnz);
+  Ux_.reserve(2 * nnz);
+  pivcol_.assign(n_, -1);
+  colpiv_.assign(n_, -1);
+  mark_.assign(n_, -1);
+  x_.assign(n_, 0.0);
+
+  int next_free = 0;
+  for (int i = 0; i < n_; ++i) {
+    const int top = Reach(i);
+    for (int p = rowPtr_[i]; p < rowPtr_[i + 1]; ++p) {
+      x_[colInd_[p]] = csrVal[p];
+    }
+
+    /* x = B(i,:) / U over the pivotal columns, which become L(i,:). */
+    for (int p = top; p < n_; ++p) {
+      const int c = xi_[p];
+      const int k = colpiv_[c];
+      if (k < 0) continue;
+      const double ukk = Ux_[Up_[k]];
+      const double lik = (ukk != 0.0) ? x_[c] / ukk : 0.0;
+      Lj_.push_back(k);
+      Lx_.push_back(lik);
+      for (int q = Up_[k] + 1; q < Up_[k + 1]; ++q) {
+        x_[Uj_[q]] -= lik * Ux_[q];
+      }
+    }
+
+    /* Pivot among the remaining columns, preferring the diagonal. */
+    int pc = -1;
+    double amax = -1.0;
+    for (int p = top; p < n_; ++p) {
+      const int c = xi_[p];
+      if (colpiv_[c] >= 0) continue;
+      const double a = fabs(x_[c]);
+      if (a > amax) {
+        amax = a;
+        pc = c;
+      }
+    }
+    if (colpiv_[i] < 0 && mark_[i] == i &&
+        fabs(x_[i]) >= pivot_threshold * amax) {
+      pc = i;
+    }
+    if (pc < 0) {
+      /* Structurally singular row: pivot on an empty column. */
+      if (colpiv_[i] < 0) {
+        pc = i;
+      } else {
+        while (colpiv_[next_free] >= 0) ++next_free;
+        pc = next_free;
+      }
+    }
+
+    Uj_.push_back(pc);
+    Ux_.push_back(x_[pc]);
+    for (int p = top; p < n_; ++p) {
+      const int c = xi_[p];
+      if (colpiv_[c] < 0 && c != pc) {
+        Uj_.push_back(c);
+        Ux_.push_back(x_[c]);
+      }
+      x_[c] = 0.0;
+    }
+    colpiv_[pc] = i;
+    pivcol_[i] = pc;
+    Lp_.push_back(static_cast<int>(Lj_.size()));
+    Up_.push_back(static_cast<int>(Uj_.size()));
+  }
+  factored_ = true;
+  return 0;
+}
+
+int CsrLuHost::Refactor(const double* csrVal) {
+  if (!factored_) return 1;
+  /* Solve() leaves y in x_. */
+  std::fill(x_.begin(), x_.end(), 0.0);
+  for (int i = 0; i < n_; ++i) {
+    for (int p = rowPtr_[i]; p < rowPtr_[i + 1]; ++p) {
+      x_[colInd_[p]] = csrVal[p];
+    }
+    for (int p = Lp_[i]; p < Lp_[i + 1]; ++p) {
+      const int k = Lj_[p];
+      const int c = pivcol_[k];
+      const double ukk = Ux_[Up_[k]];
+      const double lik = (ukk != 0.0) ? x_[c] / ukk : 0.0;
+      Lx_[p] = lik;
+      x_[c] = 0.0;
+      for (int q = Up_[k] + 1; q < Up_[k + 1]; ++q) {
+        x_[Uj_[q]] -= lik * Ux_[q];
+      }
+    }
+    for (int p = Up_[i]; p < Up_[i + 1]; ++p) {
+      Ux_[p] = x_[Uj_[p]];
+      x_[Uj_[p]] = 0.0;
+    }
+  }
+  return 0;
+}
+
+int CsrLuHost::ZeroPivot(double tol, int* position) const {
+  if (!factored_) return 1;
+  *position = -1;
+  for (int i = 0; i < n_; ++i) {
+    if (fabs(Ux_[Up_[i]]) <= tol) {
+      *position = i;
+      break;
+    }
+  }
+  return 0;
+}
+
+int CsrLuHost::Solve(const double* b, double* x) {
+  if (!factored_) return 1;
+  double* y = x_.data();
+
+  /* L*y = b */
+  for (int i = 0; i < n_; ++i) {
+    double sum = b[i];
+    for (int p = Lp_[i]; p < Lp_[i + 1]; ++p) {
+      sum -= Lx_[p] * y[Lj_[p]];
+    }
+    y[i] = sum;
+  }
+  /* U*(Qlu*x) = y; U keeps original column numbers, so x is written
+   * directly. */
+  for (int i = n_ - 1; i >= 0; --i) {
+    double sum = y[i];
+    for (int p = Up_[i] + 1; p < Up_[i + 1]; ++p) {
+      sum -= Ux_[p] * x[Uj_[p]];
+    }
+    x[pivcol_[i]] = sum / Ux_[Up_[i]];
+  }
+  return 0;
+}
+
+int CsrLuHost::Nnz(int* nnzL, int* nnzU) const {
+  if (!factored_) return 1;
+  *nnzL = static_cast<int>(Lj_.size());
+  *nnzU = static_cast<int>(Uj_.size());
+  return 0;
+}
+
+int CsrLuHost::Extract(int* P, int* Q, double* csrValL, int* csrRowPtrL,
+                       int* csrColIndL, double* csrValU, int* csrRowPtrU,
+                       int* csrColIndU) const {
+  if (!factored_) return 1;
+  std::vector<std::pair<int, double>> row;
+  csrRowPtrL[0] = 0;
+  csrRowPtrU[0] = 0;
+  for (int i = 0; i < n_; ++i) {
+    P[i] = i;
+    Q[i] = pivcol_[i];
+
+    row.clear();
+    for (int p = Lp_[i]; p < Lp_[i + 1]; ++p) row.emplace_back(Lj_[p], Lx_[p]);
+    std::sort(row.begin(), row.end());
+    for (size_t q = 0; q < row.size(); ++q) {
+      csrColIndL[Lp_[i] + q] = row[q].first;
+      csrValL[Lp_[i] + q] = row[q].second;
+    }
+    csrRowPtrL[i + 1] = Lp_[i + 1];
+
+    row.clear();
+    for (int p = Up_[i]; p < Up_[i + 1]; ++p) {
+      row.emplace_back(colpiv_[Uj_[p]], Ux_[p]);
+    }
+    std::sort(row.begin(), row.end());
+    for (size_t q = 0; q < row.size(); ++q) {
+      csrColIndU[Up_[i] + q] = row[q].first;
+      csrValU[Up_[i] + q] = row[q].second;
+    }
+    csrRowPtrU[i + 1] = Up_[i + 1];
+  }
+  return 0;
+}
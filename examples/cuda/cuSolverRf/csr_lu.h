@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+
+/*
+ * Host sparse LU with threshold partial pivoting, the counterpart of the
+ * cusolverSp csrlu*Host() routines used by cuSolverRf.cpp:
+ *
+ *   cusolverSpXcsrluAnalysisHost   -> CsrLuHost::Analyze
+ *   cusolverSpDcsrluFactorHost     -> CsrLuHost::Factor
+ *   cusolverSpDcsrluZeroPivotHost  -> CsrLuHost::ZeroPivot
+ *   cusolverSpDcsrluSolveHost      -> CsrLuHost::Solve
+ *   cusolverSpXcsrluNnzHost        -> CsrLuHost::Nnz
+ *   cusolverSpDcsrluExtractHost    -> CsrLuHost::Extract
+ *
+ * The factorization is left-looking by rows (Gilbert-Peierls on B^T): row i
+ * of B is reduced by a sparse triangular solve against the rows of U found
+ * so far, whose nonzero pattern comes from a depth-first search, and the
+ * pivot is chosen among the remaining columns. This gives
+ *
+ *   Plu*B*Qlu^T = L*U,  Plu = I,
+ *
+ * with L unit lower triangular and Qlu the column pivot sequence. The work
+ * is proportional to the flop count, so a fill-reducing ordering of B
+ * (csr_reorder.h) matters as much as it does for cusolverSp.
+ *
+ * All methods return 0 on success and 1 on invalid arguments or use out of
+ * order.
+ */
+class CsrLuHost {
+ public:
+  /*
+   * Symbolic phase: checks and keeps the pattern of the n x n matrix B.
+   * Entries of a row must be sorted; base is the index base of the arrays.
+   */
+  int Analyze(int n, int nnz, int base, const int* csrRowPtr,
+              const int* csrColInd);
+
+  /*
+   * Numeric phase on values matching the analyzed pattern. A column is
+   * taken as pivot of row i if |b(i,i)| >= pivot_threshold * max |b(i,j)|
+   * over the candidate columns, otherwise the largest one is: 1.0 is plain
+   * partial pivoting, 0.0 keeps the diagonal whenever it is nonzero.
+   */
+  int Factor(const double* csrVal, double pivot_threshold);
+
+  /*
+   * Numeric phase only, for new values on the analyzed pattern: reuses the
+   * pivot sequence and the L/U pattern of the last Factor(), like
+   * cusolverRfRefactor(). No pivoting is done, so values far from those of
+   * the last Factor() can give small pivots; check ZeroPivot() and call
+   * Factor() again if needed.
+   */
+  int Refactor(const double* csrVal);
+
+  /* *position = first j with |U(j,j)| <= tol, or -1 if there is none. */
+  int ZeroPivot(double tol, int* position) const;
+
+  /* Solves B*x = b with the last factorization. x and b may not alias. */
+  int Solve(const double* b, double* x);
+
+  /* Sizes of the factors returned by Extract(). */
+  int Nnz(int* nnzL, int* nnzU) const;
+
+  /*
+   * Copies out P, Q (n entries each) and the base-0 CSR factors with sorted
+   * column indices. L has an implicit unit diagonal, which is not stored;
+   * the diagonal of U comes first in each of its rows.
+   */
+  int Extract(int* P, int* Q, double* csrValL, int* csrRowPtrL,
+              int* csrColIndL, double* csrValU, int* csrRowPtrU,
+              int* csrColIndU) const;
+
+ private:
+  /* Nonzero columns of x = B(i,:) / U, in topological order, to xi_[top..]. */
+  int Reach(int i);
+
+  int n_ = 0;
+  bool factored_ = false;
+
+  /* Pattern of B, base 0. */
+  std::vector<int> rowPtr_;
+  std::vector<int> colInd_;
+
+  /* L by rows without the unit diagonal; columns are pivot steps, kept in
+   * the topological order in which Factor() eliminated them. */
+  std::vector<int> Lp_;
+  std::vector<int> Lj_;
+  std::vector<double> Lx_;
+
+  /* U by rows in the original column numbering, pivot entry first. */
+  std::vector<int> Up_;
+  std::vector<int> Uj_;
+  std::vector<double> Ux_;
+
+  /* pivcol_[k]: column pivoted at step k (= Qlu); colpiv_[c]: its inverse,
+   * or -1 while column c is not pivotal. */
+  std::vector<int> pivcol_;
+  std::vector<int> colpiv_;
+
+  /* Workspace. */
+  std::vector<double> x_;
+  std::vector<int> xi_;
+  std::vector<int> stack_;
+  std::vector<int> pstack_;
+  std::vector<int> mark_;
+};
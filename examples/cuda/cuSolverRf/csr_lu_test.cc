@@ -0,0 +1,241 @@
+#include "examples/cuda/cuSolverRf/csr_lu.h"
+
+#include <math.h>
+
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct Csr {
+  int n = 0;
+  std::vector<int> ptr, ind;
+  std::vector<double> val;
+};
+
+Csr FromEntries(int n, const std::map<std::pair<int, int>, double>& entries) {
+  Csr a;
+  a.n = n;
+  a.ptr.assign(n + 1, 0);
+  for (const auto& e : entries) {
+    ++a.ptr[e.first.first + 1];
+    a.ind.push_back(e.first.second);
+    a.val.push_back(e.second);
+  }
+  for (int i = 0; i < n; ++i) a.ptr[i + 1] += a.ptr[i];
+  return a;
+}
+
+// Random nonsingular-in-practice matrix: a few off-diagonals per row and a
+// diagonal that is sometimes tiny or missing, so pivoting is exercised.
+Csr RandomMatrix(int n, int per_row, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> value(-1.0, 1.0);
+  std::map<std::pair<int, int>, double> entries;
+  for (int i = 0; i < n; ++i) {
+    if (rng() % 4 != 0) entries[{i, i}] = (rng() % 3 == 0) ? 1e-3 : 4.0;
+    for (int k = 0; k < per_row; ++k) {
+      entries[{i, static_cast<int>(rng() % n)}] = value(rng);
+    }
+  }
+  return FromEntries(n, entries);
+}
+
+std::vector<double> Multiply(const Csr& a, const std::vector<double>& x) {
+  std::vector<double> y(a.n, 0.0);
+  for (int i = 0; i < a.n; ++i) {
+    for (int p = a.ptr[i]; p < a.ptr[i + 1]; ++p) {
+      y[i] += a.val[p] * x[a.ind[p]];
+    }
+  }
+  return y;
+}
+
+double RelativeResidual(const Csr& a, const std::vector<double>& x,
+                        const std::vector<double>& b) {
+  const std::vector<double> ax = Multiply(a, x);
+  double r = 0.0, xn = 0.0, an = 0.0;
+  for (int i = 0; i < a.n; ++i) {
+    r = std::max(r, fabs(b[i] - ax[i]));
+    xn = std::max(xn, fabs(x[i]));
+    double row = 0.0;
+    for (int p = a.ptr[i]; p < a.ptr[i + 1]; ++p) row += fabs(a.val[p]);
+    an = std::max(an, row);
+  }
+  return r / (an * xn);
+}
+
+void ExpectFactorsReproduce(const Csr& b, CsrLuHost& lu) {
+  int nnzL, nnzU;
+  ASSERT_EQ(lu.Nnz(&nnzL, &nnzU), 0);
+  const int n = b.n;
+  std::vector<int> P(n), Q(n), Lp(n + 1), Lj(nnzL), Up(n + 1), Uj(nnzU);
+  std::vector<double> Lx(nnzL), Ux(nnzU);
+  ASSERT_EQ(lu.Extract(P.data(), Q.data(), Lx.data(), Lp.data(), Lj.data(),
+                       Ux.data(), Up.data(), Uj.data()),
+            0);
+
+  // Dense P*B*Q^T and L*U.
+  std::vector<double> pbq(n * n, 0.0), lu_dense(n * n, 0.0);
+  std::vector<int> qinv(n);
+  for (int j = 0; j < n; ++j) qinv[Q[j]] = j;
+  for (int i = 0; i < n; ++i) {
+    const int r = P[i];
+    for (int p = b.ptr[r]; p < b.ptr[r + 1]; ++p) {
+      pbq[i * n + qinv[b.ind[p]]] = b.val[p];
+    }
+  }
+  for (int i = 0; i < n; ++i) {
+    for (int p = Up[i]; p < Up[i + 1]; ++p) {
+      lu_dense[i * n + Uj[p]] += Ux[p];
+    }
+    for (int p = Lp[i]; p < Lp[i + 1]; ++p) {
+      ASSERT_LT(Lj[p], i);
+      if (p > Lp[i]) {
+        ASSERT_LT(Lj[p - 1], Lj[p]);
+      }
+      const int k = Lj[p];
+      for (int q = Up[k]; q < Up[k + 1]; ++q) {
+        lu_dense[i * n + Uj[q]] += Lx[p] * Ux[q];
+      }
+    }
+    ASSERT_EQ(Uj[Up[i]], i);
+  }
+  for (int e = 0; e < n * n; ++e) {
+    EXPECT_NEAR(pbq[e], lu_dense[e], 1e-10) << "entry " << e;
+  }
+}
+
+TEST(CsrLuHostTest, NeedsPivoting) {
+  // Zero diagonal everywhere: [[0 2 0], [3 0 1], [0 4 5]].
+  const Csr b = FromEntries(
+      3, {{{0, 1}, 2.0}, {{1, 0}, 3.0}, {{1, 2}, 1.0}, {{2, 1}, 4.0},
+          {{2, 2}, 5.0}});
+  CsrLuHost lu;
+  ASSERT_EQ(lu.Analyze(3, 5, 0, b.ptr.data(), b.ind.data()), 0);
+  ASSERT_EQ(lu.Factor(b.val.data(), 1.0), 0);
+  int singularity = 0;
+  ASSERT_EQ(lu.ZeroPivot(1e-14, &singularity), 0);
+  EXPECT_EQ(singularity, -1);
+
+  const std::vector<double> rhs = {1.0, 2.0, 3.0};
+  std::vector<double> x(3);
+  ASSERT_EQ(lu.Solve(rhs.data(), x.data()), 0);
+  EXPECT_LT(RelativeResidual(b, x, rhs), 1e-15);
+  ExpectFactorsReproduce(b, lu);
+}
+
+TEST(CsrLuHostTest, OneBasedInput) {
+  const Csr b0 = FromEntries(2, {{{0, 0}, 2.0}, {{0, 1}, 1.0}, {{1, 1}, 4.0}});
+  std::vector<int> ptr = b0.ptr, ind = b0.ind;
+  for (int& p : ptr) ++p;
+  for (int& j : ind) ++j;
+  CsrLuHost lu;
+  ASSERT_EQ(lu.Analyze(2, 3, 1, ptr.data(), ind.data()), 0);
+  ASSERT_EQ(lu.Factor(b0.val.data(), 1.0), 0);
+  const std::vector<double> rhs = {3.0, 4.0};
+  std::vector<double> x(2);
+  ASSERT_EQ(lu.Solve(rhs.data(), x.data()), 0);
+  EXPECT_DOUBLE_EQ(x[0], 1.0);
+  EXPECT_DOUBLE_EQ(x[1], 1.0);
+}
+
+TEST(CsrLuHostTest, RandomMatrices) {
+  for (double threshold : {1.0, 0.5, 0.1}) {
+    for (uint32_t seed = 1; seed <= 5; ++seed) {
+      const Csr b = RandomMatrix(60, 3, seed);
+      CsrLuHost lu;
+      ASSERT_EQ(lu.Analyze(b.n, static_cast<int>(b.ind.size()), 0,
+                           b.ptr.data(), b.ind.data()),
+                0);
+      ASSERT_EQ(lu.Factor(b.val.data(), threshold), 0);
+      int singularity = 0;
+      ASSERT_EQ(lu.ZeroPivot(1e-14, &singularity), 0);
+      if (singularity >= 0) continue;  // structurally singular draw
+
+      std::vector<double> x_true(b.n);
+      for (int i = 0; i < b.n; ++i) x_true[i] = 1.0 + i % 7;
+      const std::vector<double> rhs = Multiply(b, x_true);
+      std::vector<double> x(b.n);
+      ASSERT_EQ(lu.Solve(rhs.data(), x.data()), 0);
+      EXPECT_LT(RelativeResidual(b, x, rhs), 1e-12)
+          << "threshold " << threshold << " seed " << seed;
+      ExpectFactorsReproduce(b, lu);
+    }
+  }
+}
+
+TEST(CsrLuHostTest, RefactorReusesPivots) {
+  const Csr b = RandomMatrix(60, 3, 2);
+  CsrLuHost lu;
+  ASSERT_EQ(lu.Analyze(b.n, static_cast<int>(b.ind.size()), 0, b.ptr.data(),
+                       b.ind.data()),
+            0);
+  ASSERT_EQ(lu.Factor(b.val.data(), 1.0), 0);
+  int nnzL, nnzU;
+  ASSERT_EQ(lu.Nnz(&nnzL, &nnzU), 0);
+  std::vector<double> x(b.n);
+  ASSERT_EQ(lu.Solve(b.val.data(), x.data()), 0);  // dirties the workspace
+
+  // Same pattern, values moved by up to 10%.
+  Csr b2 = b;
+  std::mt19937 rng(9);
+  std::uniform_real_distribution<double> scale(0.9, 1.1);
+  for (double& v : b2.val) v *= scale(rng);
+  ASSERT_EQ(lu.Refactor(b2.val.data()), 0);
+  int nnzL2, nnzU2;
+  ASSERT_EQ(lu.Nnz(&nnzL2, &nnzU2), 0);
+  EXPECT_EQ(nnzL2, nnzL);
+  EXPECT_EQ(nnzU2, nnzU);
+  ExpectFactorsReproduce(b2, lu);
+
+  std::vector<double> x_true(b.n, 1.0);
+  const std::vector<double> rhs = Multiply(b2, x_true);
+  ASSERT_EQ(lu.Solve(rhs.data(), x.data()), 0);
+  EXPECT_LT(RelativeResidual(b2, x, rhs), 1e-12);
+}
+
+TEST(CsrLuHostTest, ReportsZeroPivot) {
+  // Rows 1 and 2 are equal, so the last pivot cancels to zero.
+  const Csr b = FromEntries(
+      3, {{{0, 0}, 1.0}, {{1, 1}, 2.0}, {{1, 2}, 3.0}, {{2, 1}, 2.0},
+          {{2, 2}, 3.0}});
+  CsrLuHost lu;
+  ASSERT_EQ(lu.Analyze(3, 5, 0, b.ptr.data(), b.ind.data()), 0);
+  ASSERT_EQ(lu.Factor(b.val.data(), 1.0), 0);
+  int singularity = -1;
+  ASSERT_EQ(lu.ZeroPivot(1e-14, &singularity), 0);
+  EXPECT_EQ(singularity, 2);
+}
+
+TEST(CsrLuHostTest, StructurallySingular) {
+  // Column 1 is empty.
+  const Csr b = FromEntries(2, {{{0, 0}, 1.0}, {{1, 0}, 1.0}});
+  CsrLuHost lu;
+  ASSERT_EQ(lu.Analyze(2, 2, 0, b.ptr.data(), b.ind.data()), 0);
+  ASSERT_EQ(lu.Factor(b.val.data(), 1.0), 0);
+  int singularity = -1;
+  ASSERT_EQ(lu.ZeroPivot(0.0, &singularity), 0);
+  EXPECT_EQ(singularity, 1);
+}
+
+TEST(CsrLuHostTest, RejectsBadInput) {
+  CsrLuHost lu;
+  const std::vector<int> ptr = {0, 2, 3};
+  const std::vector<int> unsorted = {1, 0, 1};
+  EXPECT_NE(lu.Analyze(2, 3, 0, ptr.data(), unsorted.data()), 0);
+  const std::vector<int> out_of_range = {0, 2, 1};
+  EXPECT_NE(lu.Analyze(2, 3, 0, ptr.data(), out_of_range.data()), 0);
+
+  const std::vector<double> val = {1.0, 1.0, 1.0};
+  EXPECT_NE(lu.Factor(val.data(), 1.0), 0);
+  EXPECT_NE(lu.Refactor(val.data()), 0);
+  std::vector<double> x(2);
+  EXPECT_NE(lu.Solve(val.data(), x.data()), 0);
+}
+
+}  // namespace
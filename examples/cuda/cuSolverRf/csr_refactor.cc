@@ -0,0 +1,60 @@
+#include "examples/cuda/cuSolverRf/csr_refactor.h"
+
+#include <numeric>
+
+#include "examples/cuda/cuSolverRf/csr_reorder.h"
+
+int CsrRefactorHost::Setup(int n, int nnzA, int baseA, const int* csrRowPtrA,
+                           const int* csrColIndA, const int* Q,
+                           const double* csrValA, double pivot_threshold) {
+  ready_ = false;
+  if (n < 0 || nnzA < 0) return 1;
+  n_ = n;
+  Q_.resize(n);
+  if (Q != nullptr) {
+    Q_.assign(Q, Q + n);
+  } else {
+    std::iota(Q_.begin(), Q_.end(), 0);
+  }
+
+  /* B = Q*A*Q^T; its values are A(mapBfromA). */
+  std::vector<int> rowPtrB(csrRowPtrA, csrRowPtrA + n + 1);
+  std::vector<int> colIndB(csrColIndA, csrColIndA + nnzA);
+  mapBfromA_.resize(nnzA);
+  std::iota(mapBfromA_.begin(), mapBfromA_.end(), 0);
+  if (csr_perm_host(n, n, nnzA, baseA, rowPtrB.data(), colIndB.data(),
+                    Q_.data(), Q_.data(), mapBfromA_.data())) {
+    return 1;
+  }
+  if (lu_.Analyze(n, nnzA, baseA, rowPtrB.data(), colIndB.data())) return 1;
+
+  valB_.resize(nnzA);
+  for (int j = 0; j < nnzA; ++j) valB_[j] = csrValA[mapBfromA_[j]];
+  if (lu_.Factor(valB_.data(), pivot_threshold)) return 1;
+
+  bhat_.resize(n);
+  xhat_.resize(n);
+  ready_ = true;
+  return 0;
+}
+
+int CsrRefactorHost::Refactor(const double* csrValA) {
+  if (!ready_) return 1;
+  const int nnz = static_cast<int>(valB_.size());
+  for (int j = 0; j < nnz; ++j) valB_[j] = csrValA[mapBfromA_[j]];
+  return lu_.Refactor(valB_.data());
+}
+
+int CsrRefactorHost::ZeroPivot(double tol, int* position) const {
+  if (!ready_) return 1;
+  return lu_.ZeroPivot(tol, position);
+}
+
+int CsrRefactorHost::Solve(const double* b, double* x) {
+  if (!ready_) return 1;
+  /* B*(Q*x) = Q*b */
+  for (int j = 0; j < n_; ++j) bhat_[j] = b[Q_[j]];
+  if (lu_.Solve(bhat_.data(), xhat_.data())) return 1;
+  for (int j = 0; j < n_; ++j) x[Q_[j]] = xhat_[j];
+  return 0;
+}
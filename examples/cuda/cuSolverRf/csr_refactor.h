@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+#include "examples/cuda/cuSolverRf/csr_lu.h"
+
+/*
+ * Host refactorization for a sequence of matrices A sharing one sparsity
+ * pattern, the CPU counterpart of steps 2-13 of cuSolverRf.cpp. Setup()
+ * does the expensive part once:
+ *
+ *   B = Q*A*Q^T and h_mapBfromA     (csr_perm_host)
+ *   analysis of B                   (CsrLuHost::Analyze)
+ *   P*B*Qlu^T = L*U with pivoting   (CsrLuHost::Factor)
+ *
+ * and Refactor() then only gathers the new values of A through mapBfromA
+ * and redoes the numeric phase on the fixed pivot sequence and L/U pattern
+ * (CsrLuHost::Refactor), which is what cusolverRfRefactor() does on the
+ * device.
+ *
+ * All methods return 0 on success and 1 on invalid arguments or use out of
+ * order.
+ */
+class CsrRefactorHost {
+ public:
+  /*
+   * A is n x n with sorted rows in base baseA. Q (n entries, 0-based) is a
+   * fill-reducing ordering of A such as csr_symamd_host() returns; NULL
+   * keeps the natural order. csrValA gives the values the pivot sequence is
+   * chosen for, see CsrLuHost::Factor for pivot_threshold.
+   */
+  int Setup(int n, int nnzA, int baseA, const int* csrRowPtrA,
+            const int* csrColIndA, const int* Q, const double* csrValA,
+            double pivot_threshold);
+
+  /* New values of A, in the order of the csrColIndA given to Setup(). */
+  int Refactor(const double* csrValA);
+
+  /* See CsrLuHost::ZeroPivot; positions refer to B = Q*A*Q^T. */
+  int ZeroPivot(double tol, int* position) const;
+
+  /* Solves A*x = b with the last factorization. x and b may not alias. */
+  int Solve(const double* b, double* x);
+
+  /* The factorization of B, e.g. for CsrLuHost::Extract. */
+  const CsrLuHost& lu() const { return lu_; }
+
+ private:
+  int n_ = 0;
+  bool ready_ = false;
+  std::vector<int> Q_;
+  std::vector<int> mapBfromA_;
+  std::vector<double> valB_;
+  std::vector<double> bhat_;
+  std::vector<double> xhat_;
+  CsrLuHost lu_;
+};
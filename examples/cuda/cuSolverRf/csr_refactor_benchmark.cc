@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "examples/cuda/cuSolverRf/csr_refactor.h"
+#include "examples/cuda/cuSolverRf/csr_reorder.h"
+#include "examples/cuda/cuSolverRf/mmio_csr.h"
+
+// How to run:
+// bazel run -c opt //examples/cuda/cuSolverRf:csr_refactor_benchmark
+namespace {
+
+constexpr int kValueSets = 8;
+
+struct Problem {
+  int n = 0, nnz = 0;
+  std::vector<int> ptr, ind, Q;
+  // kValueSets perturbations of the values of A on the same pattern.
+  std::vector<std::vector<double>> vals;
+};
+
+Problem Load(const char* path) {
+  Problem a;
+  int m = 0;
+  double* val = nullptr;
+  int *ptr = nullptr, *ind = nullptr;
+  MM_typecode matcode;
+  if (loadMMSparseMatrixHost(const_cast<char*>(path), true, &m, &a.n, &a.nnz,
+                             &val, &ptr, &ind, true, &matcode)) {
+    std::abort();
+  }
+  a.ptr.assign(ptr, ptr + a.n + 1);
+  a.ind.assign(ind, ind + a.nnz);
+  a.Q.resize(a.n);
+  if (csr_symamd_host(a.n, a.nnz, ptr[0], ptr, ind, a.Q.data())) std::abort();
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> scale(0.9, 1.1);
+  for (int s = 0; s < kValueSets; ++s) {
+    a.vals.emplace_back(val, val + a.nnz);
+    for (double& v : a.vals.back()) v *= scale(rng);
+  }
+  free(val);
+  free(ptr);
+  free(ind);
+  return a;
+}
+
+const Problem& GetProblem(int index) {
+  static const auto* problems = new std::vector<Problem>{
+      Load("examples/cuda/cuSolverRf/data/lap2D_5pt_n100.mtx"),
+      Load("examples/cuda/cuSolverRf/data/lap3D_7pt_n20.mtx"),
+  };
+  return (*problems)[index];
+}
+
+void ReportPercentiles(benchmark::State& state, std::vector<double>* usec) {
+  if (usec->empty()) return;
+  std::sort(usec->begin(), usec->end());
+  auto at = [usec](double q) {
+    return (*usec)[static_cast<size_t>(q * (usec->size() - 1))];
+  };
+  state.counters["p50_us"] = at(0.50);
+  state.counters["p90_us"] = at(0.90);
+  state.counters["p99_us"] = at(0.99);
+  state.counters["max_us"] = usec->back();
+}
+
+// Times one iteration of body() and records its latency.
+template <typename Fn>
+void RunTimed(benchmark::State& state, Fn body) {
+  std::vector<double> usec;
+  int s = 0;
+  for (auto _ : state) {
+    const auto start = std::chrono::steady_clock::now();
+    if (body(s)) {
+      state.SkipWithError("factorization failed");
+      return;
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    usec.push_back(std::chrono::duration<double, std::micro>(stop - start)
+                       .count());
+    s = (s + 1) % kValueSets;
+  }
+  ReportPercentiles(state, &usec);
+}
+
+// New values of A, then refactor on the cached pattern and solve.
+void BM_RefactorSolve(benchmark::State& state) {
+  const Problem& a = GetProblem(static_cast<int>(state.range(0)));
+  CsrRefactorHost rf;
+  if (rf.Setup(a.n, a.nnz, a.ptr[0], a.ptr.data(), a.ind.data(), a.Q.data(),
+               a.vals[0].data(), 1.0)) {
+    state.SkipWithError("setup failed");
+    return;
+  }
+  const std::vector<double> b(a.n, 1.0);
+  std::vector<double> x(a.n);
+  RunTimed(state, [&](int s) {
+    return rf.Refactor(a.vals[s].data()) || rf.Solve(b.data(), x.data());
+  });
+}
+BENCHMARK(BM_RefactorSolve)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// What the host path of cuSolverRf.cpp does per matrix: B = Q*A*Q^T,
+// analysis, factorization with pivoting and solve.
+void BM_FullFactorSolve(benchmark::State& state) {
+  const Problem& a = GetProblem(static_cast<int>(state.range(0)));
+  const std::vector<double> b(a.n, 1.0);
+  std::vector<double> x(a.n);
+  RunTimed(state, [&](int s) {
+    CsrRefactorHost rf;
+    return rf.Setup(a.n, a.nnz, a.ptr[0], a.ptr.data(), a.ind.data(),
+                    a.Q.data(), a.vals[s].data(), 1.0) ||
+           rf.Solve(b.data(), x.data());
+  });
+}
+BENCHMARK(BM_FullFactorSolve)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
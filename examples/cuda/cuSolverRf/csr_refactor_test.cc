@@ -0,0 +1,118 @@
+#include "examples/cuda/cuSolverRf/csr_refactor.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "examples/cuda/cuSolverRf/csr_reorder.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+struct Csr {
+  int n = 0;
+  std::vector<int> ptr, ind;
+  std::vector<double> val;
+};
+
+// Convection-diffusion on a k x k grid: unsymmetric values, symmetric
+// pattern, 1-based like the matrices read from .mtx files.
+Csr ConvectionDiffusion(int k, double wind) {
+  Csr a;
+  a.n = k * k;
+  a.ptr.push_back(1);
+  for (int v = 0; v < a.n; ++v) {
+    const int x = v % k, y = v / k;
+    const struct {
+      bool inside;
+      int col;
+      double val;
+    } entries[] = {{y > 0, v - k, -1.0},
+                   {x > 0, v - 1, -1.0 - wind},
+                   {true, v, 4.0},
+                   {x + 1 < k, v + 1, -1.0 + wind},
+                   {y + 1 < k, v + k, -1.0}};
+    for (const auto& e : entries) {
+      if (!e.inside) continue;
+      a.ind.push_back(e.col + 1);
+      a.val.push_back(e.val);
+    }
+    a.ptr.push_back(static_cast<int>(a.ind.size()) + 1);
+  }
+  return a;
+}
+
+double RelativeResidual(const Csr& a, const std::vector<double>& x,
+                        const std::vector<double>& b) {
+  double r = 0.0, xn = 0.0, an = 0.0;
+  for (int i = 0; i < a.n; ++i) {
+    double ax = 0.0, row = 0.0;
+    for (int p = a.ptr[i] - 1; p < a.ptr[i + 1] - 1; ++p) {
+      ax += a.val[p] * x[a.ind[p] - 1];
+      row += fabs(a.val[p]);
+    }
+    r = std::max(r, fabs(b[i] - ax));
+    xn = std::max(xn, fabs(x[i]));
+    an = std::max(an, row);
+  }
+  return r / (an * xn);
+}
+
+TEST(CsrRefactorHostTest, SolvesSequenceWithFixedPattern) {
+  Csr a = ConvectionDiffusion(20, 0.5);
+  const int nnz = static_cast<int>(a.ind.size());
+  std::vector<int> Q(a.n);
+  ASSERT_EQ(csr_symamd_host(a.n, nnz, 1, a.ptr.data(), a.ind.data(),
+                            Q.data()),
+            0);
+  CsrRefactorHost rf;
+  ASSERT_EQ(rf.Setup(a.n, nnz, 1, a.ptr.data(), a.ind.data(), Q.data(),
+                     a.val.data(), 1.0),
+            0);
+
+  const std::vector<double> b(a.n, 1.0);
+  std::vector<double> x(a.n);
+  std::mt19937 rng(4);
+  std::uniform_real_distribution<double> scale(0.8, 1.2);
+  const std::vector<double> val0 = a.val;
+  for (int step = 0; step < 5; ++step) {
+    for (int p = 0; p < nnz; ++p) a.val[p] = val0[p] * scale(rng);
+    ASSERT_EQ(rf.Refactor(a.val.data()), 0);
+    int singularity = 0;
+    ASSERT_EQ(rf.ZeroPivot(1e-14, &singularity), 0);
+    ASSERT_EQ(singularity, -1);
+    ASSERT_EQ(rf.Solve(b.data(), x.data()), 0);
+    EXPECT_LT(RelativeResidual(a, x, b), 1e-13) << "step " << step;
+  }
+}
+
+TEST(CsrRefactorHostTest, NaturalOrder) {
+  const Csr a = ConvectionDiffusion(6, 0.9);
+  CsrRefactorHost rf;
+  ASSERT_EQ(rf.Setup(a.n, static_cast<int>(a.ind.size()), 1, a.ptr.data(),
+                     a.ind.data(), nullptr, a.val.data(), 1.0),
+            0);
+  const std::vector<double> b(a.n, 1.0);
+  std::vector<double> x(a.n);
+  ASSERT_EQ(rf.Solve(b.data(), x.data()), 0);
+  EXPECT_LT(RelativeResidual(a, x, b), 1e-14);
+}
+
+TEST(CsrRefactorHostTest, RejectsUseBeforeSetup) {
+  CsrRefactorHost rf;
+  const std::vector<double> val = {1.0};
+  std::vector<double> x(1);
+  EXPECT_NE(rf.Refactor(val.data()), 0);
+  EXPECT_NE(rf.Solve(val.data(), x.data()), 0);
+
+  const std::vector<int> ptr = {0, 1};
+  const std::vector<int> ind = {1};  // out of range
+  EXPECT_NE(rf.Setup(1, 1, 0, ptr.data(), ind.data(), nullptr, val.data(),
+                     1.0),
+            0);
+  EXPECT_NE(rf.Refactor(val.data()), 0);
+}
+
+}  // namespace
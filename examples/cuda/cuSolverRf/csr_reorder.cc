@@ -0,0 +1,713 @@
+#include "examples/cuda/cuSolverRf/csr_reorder.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "examples/cuda/common/parallel_helper.h"
+
+namespace {
+
+constexpr int kMinNodesPerThread = 1 << 14;
+
+/* BFS levels smaller than this are expanded by the calling thread alone. */
+constexpr int kMinLevelForTeam = 256;
+
+int NumThreads(int n, int num_threads) {
+  return std::min(ParallelThreads(n, num_threads, kMinNodesPerThread),
+                  std::max(n, 1));
+}
+
+/* Sense-free barrier for a fixed team; spins briefly, then yields. */
+class SpinBarrier {
+ public:
+  explicit SpinBarrier(int count) : count_(count) {}
+
+  void Wait() {
+    const int generation = generation_.load(std::memory_order_acquire);
+    if (arrived_.fetch_add(1, std::memory_order_acq_rel) + 1 == count_) {
+      arrived_.store(0, std::memory_order_relaxed);
+      generation_.store(generation + 1, std::memory_order_release);
+      return;
+    }
+    for (int spin = 0;
+         generation_.load(std::memory_order_acquire) == generation; ++spin) {
+      if (spin >= 64) std::this_thread::yield();
+    }
+  }
+
+ private:
+  const int count_;
+  std::atomic<int> arrived_{0};
+  std::atomic<int> generation_{0};
+};
+
+/* Adjacency of A + A^T without the diagonal, deduplicated. */
+struct Graph {
+  std::vector<int> xadj;
+  std::vector<int> adj;
+
+  int n() const { return static_cast<int>(xadj.size()) - 1; }
+  int degree(int v) const { return xadj[v + 1] - xadj[v]; }
+};
+
+bool BuildSymmetricGraph(int n, int nnz, int base, const int* rowPtr,
+                         const int* colInd, int num_threads, Graph* g) {
+  if (n < 0 || nnz < 0 || rowPtr[0] != base || rowPtr[n] - base != nnz) {
+    return false;
+  }
+  std::vector<int> count(n + 1, 0);
+  for (int i = 0; i < n; ++i) {
+    const int start = rowPtr[i] - base;
+    const int end = rowPtr[i + 1] - base;
+    if (start > end) return false;
+    for (int p = start; p < end; ++p) {
+      const int j = colInd[p] - base;
+      if (static_cast<unsigned>(j) >= static_cast<unsigned>(n)) return false;
+      if (i != j) {
+        ++count[i + 1];
+        ++count[j + 1];
+      }
+    }
+  }
+  for (int i = 0; i < n; ++i) count[i + 1] += count[i];
+
+  std::vector<int> adj(count[n]);
+  std::vector<int> next(count.begin(), count.end() - 1);
+  for (int i = 0; i < n; ++i) {
+    for (int p = rowPtr[i] - base; p < rowPtr[i + 1] - base; ++p) {
+      const int j = colInd[p] - base;
+      if (i != j) {
+        adj[next[i]++] = j;
+        adj[next[j]++] = i;
+      }
+    }
+  }
+
+  /* Sort and deduplicate every list, then compact into g->adj. */
+  g->xadj.assign(n + 1, 0);
+  ParallelFor(num_threads, [&](int t) {
+    const int end = BlockBegin(n, t + 1, num_threads);
+    for (int i = BlockBegin(n, t, num_threads); i < end; ++i) {
+      int* first = adj.data() + count[i];
+      int* last = adj.data() + count[i + 1];
+      std::sort(first, last);
+      g->xadj[i + 1] = static_cast<int>(std::unique(first, last) - first);
+    }
+  });
+  for (int i = 0; i < n; ++i) g->xadj[i + 1] += g->xadj[i];
+  g->adj.resize(g->xadj[n]);
+  ParallelFor(num_threads, [&](int t) {
+    const int end = BlockBegin(n, t + 1, num_threads);
+    for (int i = BlockBegin(n, t, num_threads); i < end; ++i) {
+      std::copy(adj.begin() + count[i], adj.begin() + count[i] + g->degree(i),
+                g->adj.begin() + g->xadj[i]);
+    }
+  });
+  return true;
+}
+
+/*
+ * Cuthill-McKee breadth-first search: every level lists the unvisited
+ * neighbours of the previous level grouped by the first node that reaches
+ * them, each group by increasing (degree, id). Large levels are expanded by
+ * a team of threads: each node of the next level is assigned the smallest
+ * position of its neighbours in the current level, and thread 0 then buckets
+ * the level by that position, which reproduces the serial order exactly.
+ */
+class CuthillMcKeeSearch {
+ public:
+  CuthillMcKeeSearch(const Graph& g, int num_threads)
+      : g_(g),
+        num_threads_(num_threads),
+        stamp_(g.n(), 0),
+        parent_(num_threads > 1 ? g.n() : 0),
+        local_(num_threads) {
+    for (auto& p : parent_) p.store(INT_MAX, std::memory_order_relaxed);
+  }
+
+  /*
+   * Orders the component of root into *out and returns its number of levels;
+   * last_level_begin is the offset of the deepest level in *out.
+   */
+  int Run(int root, std::vector<int>* out, int* last_level_begin) {
+    ++tag_;
+    out->clear();
+    out->reserve(g_.n());
+    out->push_back(root);
+    stamp_[root] = tag_;
+    int levels = 0;
+    int level_begin = 0;
+    while (level_begin < static_cast<int>(out->size())) {
+      const int level_end = static_cast<int>(out->size());
+      if (num_threads_ > 1 && level_end - level_begin >= kMinLevelForTeam) {
+        return levels + RunParallel(level_begin, out, last_level_begin);
+      }
+      *last_level_begin = level_begin;
+      for (int q = level_begin; q < level_end; ++q) {
+        const int u = (*out)[q];
+        const size_t first = out->size();
+        for (int p = g_.xadj[u]; p < g_.xadj[u + 1]; ++p) {
+          const int v = g_.adj[p];
+          if (stamp_[v] != tag_) {
+            stamp_[v] = tag_;
+            out->push_back(v);
+          }
+        }
+        std::sort(out->begin() + first, out->end(), ByDegree{g_});
+      }
+      level_begin = level_end;
+      ++levels;
+    }
+    return levels;
+  }
+
+ private:
+  struct ByDegree {
+    const Graph& g;
+    bool operator()(int a, int b) const {
+      const int da = g.degree(a), db = g.degree(b);
+      return da != db ? da < db : a < b;
+    }
+  };
+
+  /* Continues Run() from the level starting at level_begin. */
+  int RunParallel(int level_begin, std::vector<int>* out,
+                  int* last_level_begin) {
+    int level_end = static_cast<int>(out->size());
+    int levels = 0;
+    bool done = false;
+    SpinBarrier barrier(num_threads_);
+    ParallelFor(num_threads_, [&](int t) {
+      std::vector<int>& found = local_[t];
+      while (!done) {
+        found.clear();
+        const int width = level_end - level_begin;
+        const int end = level_begin + BlockBegin(width, t + 1, num_threads_);
+        for (int q = level_begin + BlockBegin(width, t, num_threads_);
+             q < end; ++q) {
+          const int u = (*out)[q];
+          for (int p = g_.xadj[u]; p < g_.xadj[u + 1]; ++p) {
+            const int v = g_.adj[p];
+            if (stamp_[v] == tag_) continue;
+            int cur = parent_[v].load(std::memory_order_relaxed);
+            while (q < cur) {
+              if (parent_[v].compare_exchange_weak(cur, q,
+                                                   std::memory_order_relaxed)) {
+                if (cur == INT_MAX) found.push_back(v);
+                break;
+              }
+            }
+          }
+        }
+        barrier.Wait();
+        if (t == 0) {
+          *last_level_begin = level_begin;
+          ++levels;
+          AppendNextLevel(level_begin, level_end, out);
+          level_begin = level_end;
+          level_end = static_cast<int>(out->size());
+          done = level_begin == level_end;
+        }
+        barrier.Wait();
+      }
+    });
+    return levels;
+  }
+
+  /* Buckets the nodes found by the team by parent position, in order. */
+  void AppendNextLevel(int level_begin, int level_end, std::vector<int>* out) {
+    const int width = level_end - level_begin;
+    start_.assign(width + 1, 0);
+    int total = 0;
+    for (const auto& found : local_) {
+      for (int v : found) {
+        ++start_[parent_[v].load(std::memory_order_relaxed) - level_begin + 1];
+      }
+      total += static_cast<int>(found.size());
+    }
+    if (total == 0) return;
+    for (int b = 0; b < width; ++b) start_[b + 1] += start_[b];
+    const size_t base = out->size();
+    out->resize(base + total);
+    int* next = out->data() + base;
+    for (const auto& found : local_) {
+      for (int v : found) {
+        const int b =
+            parent_[v].load(std::memory_order_relaxed) - level_begin;
+        next[start_[b]++] = v;
+        stamp_[v] = tag_;
+        parent_[v].store(INT_MAX, std::memory_order_relaxed);
+      }
+    }
+    /* start_[b] now ends bucket b. */
+    int first = 0;
+    for (int b = 0; b < width; ++b) {
+      std::sort(next + first, next + start_[b], ByDegree{g_});
+      first = start_[b];
+    }
+  }
+
+  const Graph& g_;
+  const int num_threads_;
+  int tag_ = 0;
+  std::vector<int> stamp_;
+  std::vector<std::atomic<int>> parent_;
+  std::vector<std::vector<int>> local_;
+  std::vector<int> start_;
+};
+
+/* George-Liu pseudo-peripheral roots, one Cuthill-McKee order per component. */
+void RcmOrder(const Graph& g, int num_threads, int* Q) {
+  const int n = g.n();
+
+  /* Nodes by increasing degree, to seed each component cheaply. */
+  int max_degree = 0;
+  for (int v = 0; v < n; ++v) max_degree = std::max(max_degree, g.degree(v));
+  std::vector<int> by_degree(n);
+  {
+    std::vector<int> start(max_degree + 2, 0);
+    for (int v = 0; v < n; ++v) ++start[g.degree(v) + 1];
+    for (int d = 0; d <= max_degree; ++d) start[d + 1] += start[d];
+    for (int v = 0; v < n; ++v) by_degree[start[g.degree(v)]++] = v;
+  }
+
+  CuthillMcKeeSearch search(g, num_threads);
+  std::vector<char> visited(n, 0);
+  std::vector<int> order, best, trial;
+  order.reserve(n);
+  for (int seed : by_degree) {
+    if (visited[seed]) continue;
+    int last_level_begin = 0;
+    int levels = search.Run(seed, &best, &last_level_begin);
+    for (;;) {
+      int candidate = best[last_level_begin];
+      for (size_t q = last_level_begin; q < best.size(); ++q) {
+        if (g.degree(best[q]) < g.degree(candidate)) candidate = best[q];
+      }
+      int trial_last_level_begin = 0;
+      const int trial_levels =
+          search.Run(candidate, &trial, &trial_last_level_begin);
+      if (trial_levels <= levels) break;
+      levels = trial_levels;
+      last_level_begin = trial_last_level_begin;
+      best.swap(trial);
+    }
+    for (int v : best) visited[v] = 1;
+    order.insert(order.end(), best.begin(), best.end());
+  }
+
+  for (int i = 0; i < n; ++i) Q[i] = order[n - 1 - i];
+}
+
+/* Variables bucketed by degree in doubly linked lists. */
+class DegreeLists {
+ public:
+  explicit DegreeLists(int n) : head_(n + 1, -1), links_(n) {}
+
+  void Insert(int v, int d) {
+    Link& link = links_[v];
+    link = {-1, head_[d], d};
+    if (link.next != -1) links_[link.next].prev = v;
+    head_[d] = v;
+    min_ = std::min(min_, d);
+  }
+
+  void Remove(int v) {
+    const Link& link = links_[v];
+    if (link.prev != -1) {
+      links_[link.prev].next = link.next;
+    } else {
+      head_[link.degree] = link.next;
+    }
+    if (link.next != -1) links_[link.next].prev = link.prev;
+  }
+
+  /* Removes and returns a variable of least degree; the lists must not be
+   * empty. */
+  int PopMin() {
+    while (head_[min_] == -1) ++min_;
+    const int v = head_[min_];
+    Remove(v);
+    return v;
+  }
+
+  int degree(int v) const { return links_[v].degree; }
+
+ private:
+  struct Link {
+    int prev, next, degree;
+  };
+  std::vector<int> head_;
+  std::vector<Link> links_;
+  int min_ = 0;
+};
+
+/*
+ * Approximate minimum degree ordering, following Amestoy, Davis and Duff,
+ * "An approximate minimum degree ordering algorithm", SIAM J. Matrix Anal.
+ * Appl. 17(4), 1996. Eliminated pivots become elements of a quotient graph;
+ * every variable keeps the elements and the variables it is adjacent to,
+ * pruned as elements are absorbed. Degrees are the paper's upper bound on
+ * the external degree. Indistinguishable variables are merged into
+ * supervariables and ordered together.
+ */
+class MinimumDegree {
+ public:
+  explicit MinimumDegree(const Graph& g)
+      : n_(g.n()),
+        nodes_(n_),
+        elems_(n_),
+        vars_(n_),
+        merged_(n_),
+        degrees_(n_) {
+    for (int v = 0; v < n_; ++v) {
+      vars_[v].assign(g.adj.begin() + g.xadj[v], g.adj.begin() + g.xadj[v + 1]);
+    }
+  }
+
+  /* Q[k] is the k-th variable to eliminate. */
+  void Order(int* Q) {
+    order_.reserve(n_);
+    /* Rows denser than this are left out of the graph and ordered last. */
+    const double dense = 10.0 * sqrt(static_cast<double>(n_));
+    std::vector<int> dense_rows;
+    for (int v = 0; v < n_; ++v) {
+      if (vars_[v].size() > dense) {
+        nodes_[v].state = kDead;
+        dense_rows.push_back(v);
+      }
+    }
+    remaining_ = n_ - static_cast<int>(dense_rows.size());
+    for (int v = 0; v < n_; ++v) {
+      if (nodes_[v].state != kVariable) continue;
+      Prune(&vars_[v], [&](int u) { return nodes_[u].state == kVariable; });
+      if (vars_[v].empty()) {
+        nodes_[v].state = kDead;
+        --remaining_;
+        Emit(v);
+      } else {
+        degrees_.Insert(v, static_cast<int>(vars_[v].size()));
+      }
+    }
+    while (remaining_ > 0) Eliminate(degrees_.PopMin());
+    for (int v : dense_rows) order_.push_back(v);
+    std::copy(order_.begin(), order_.end(), Q);
+  }
+
+ private:
+  enum State : char {
+    kVariable,  // principal variable, not yet eliminated
+    kMerged,    // merged into another supervariable
+    kElement,   // eliminated, and not yet absorbed
+    kDead,      // absorbed element, or eliminated with a pivot
+  };
+
+  /*
+   * A variable, or the element its elimination created. Its lists are kept
+   * apart in elems_ and vars_, so that the nodes scanned for every list
+   * entry stay small.
+   */
+  struct Node {
+    int weight = 1;  // variable: size of the supervariable;
+                     // element: |Le| counting those sizes
+    int ext = 0;     // scratch for Eliminate()
+    int stamp = 0;
+    State state = kVariable;
+  };
+
+  template <typename Keep>
+  static void Prune(std::vector<int>* list, Keep keep) {
+    list->erase(std::remove_if(list->begin(), list->end(),
+                               [&](int v) { return !keep(v); }),
+                list->end());
+  }
+
+  int NewStamp() {
+    if (tag_ == INT_MAX) {
+      for (Node& node : nodes_) node.stamp = 0;
+      tag_ = 0;
+    }
+    return ++tag_;
+  }
+
+  /* Appends v and the variables merged into it to the order. */
+  void Emit(int v) {
+    const size_t first = order_.size();
+    order_.push_back(v);
+    for (size_t q = first; q < order_.size(); ++q) {
+      const std::vector<int>& children = merged_[order_[q]];
+      order_.insert(order_.end(), children.begin(), children.end());
+    }
+  }
+
+  /* Frees the members of e. The lists of variables are only cleared when
+   * done with, as they never outgrow those of A, but Le can. */
+  void Absorb(int e) {
+    nodes_[e].state = kDead;
+    std::vector<int>().swap(vars_[e]);
+  }
+
+  /* Adds v to Lp and takes its weight off the elements it is adjacent to,
+   * so that once Lp is complete, ext = |Le \ Lp| for each of them. */
+  void AddToLp(int v, int in_lp, std::vector<int>* lp) {
+    Node& node = nodes_[v];
+    node.stamp = in_lp;
+    lp->push_back(v);
+    degrees_.Remove(v);
+    for (int e : elems_[v]) {
+      Node& element = nodes_[e];
+      if (element.state != kElement) continue;
+      if (element.stamp != in_lp) {
+        element.stamp = in_lp;
+        element.ext = element.weight;
+      }
+      element.ext -= node.weight;
+    }
+  }
+
+  /* Eliminates the supervariable p, which becomes element p. */
+  void Eliminate(int p) {
+    Node& pivot = nodes_[p];
+    remaining_ -= pivot.weight;
+
+    /* Lp: the variables adjacent to p, directly or through its elements,
+     * which are absorbed into the new element p. */
+    const int in_lp = NewStamp();
+    pivot.stamp = in_lp;
+    std::vector<int>& lp = lp_;
+    lp.clear();
+    for (int e : elems_[p]) {
+      if (nodes_[e].state != kElement) continue;
+      for (int v : vars_[e]) {
+        if (nodes_[v].state == kVariable && nodes_[v].stamp != in_lp) {
+          AddToLp(v, in_lp, &lp);
+        }
+      }
+      Absorb(e);
+    }
+    for (int v : vars_[p]) {
+      if (nodes_[v].state == kVariable && nodes_[v].stamp != in_lp) {
+        AddToLp(v, in_lp, &lp);
+      }
+    }
+    elems_[p].clear();
+    pivot.state = kElement;
+    Emit(p);
+
+    /* Prune the lists of Lp: elements inside Lp are absorbed into p, and
+     * edges to Lp are covered by p. Variables left adjacent to p alone are
+     * eliminated with it. The others are keyed by a hash of their lists to
+     * find supervariables. */
+    keyed_.clear();
+    for (int v : lp) {
+      Node& node = nodes_[v];
+      int d = 0;
+      unsigned h = 0;
+      Prune(&elems_[v], [&](int e) {
+        Node& element = nodes_[e];
+        if (element.state != kElement) return false;
+        if (element.ext == 0) {
+          Absorb(e);
+          return false;
+        }
+        d += element.ext;
+        h += static_cast<unsigned>(e);
+        return true;
+      });
+      Prune(&vars_[v], [&](int u) {
+        const Node& other = nodes_[u];
+        if (other.state != kVariable || other.stamp == in_lp) return false;
+        d += other.weight;
+        h += static_cast<unsigned>(u);
+        return true;
+      });
+      if (elems_[v].empty() && vars_[v].empty()) {
+        node.state = kDead;
+        remaining_ -= node.weight;
+        Emit(v);
+      } else {
+        elems_[v].push_back(p);
+        node.ext = std::min(degrees_.degree(v), d);
+        keyed_.emplace_back(h, v);
+      }
+    }
+    MergeIndistinguishable();
+
+    lp.clear();
+    int lp_weight = 0;
+    for (const auto& key : keyed_) {
+      if (nodes_[key.second].state != kVariable) continue;
+      lp.push_back(key.second);
+      lp_weight += nodes_[key.second].weight;
+    }
+    for (int v : lp) {
+      const Node& node = nodes_[v];
+      degrees_.Insert(v, std::min(node.ext + lp_weight - node.weight,
+                                  remaining_ - node.weight));
+    }
+    vars_[p].assign(lp.begin(), lp.end());
+    pivot.weight = lp_weight;
+    if (vars_[p].empty()) Absorb(p);
+  }
+
+  /* Merges the variables in keyed_ which have the same lists. */
+  void MergeIndistinguishable() {
+    std::sort(keyed_.begin(), keyed_.end());
+    for (size_t a = 0; a < keyed_.size();) {
+      size_t b = a + 1;
+      while (b < keyed_.size() && keyed_[b].first == keyed_[a].first) ++b;
+      for (size_t s = a; s + 1 < b; ++s) {
+        const int v = keyed_[s].second;
+        if (nodes_[v].state != kVariable) continue;
+        const int tag = NewStamp();
+        for (int e : elems_[v]) nodes_[e].stamp = tag;
+        for (int u : vars_[v]) nodes_[u].stamp = tag;
+        for (size_t t = s + 1; t < b; ++t) {
+          const int u = keyed_[t].second;
+          if (nodes_[u].state == kVariable && SameLists(v, u, tag)) {
+            Merge(u, v);
+          }
+        }
+      }
+      a = b;
+    }
+  }
+
+  /* Whether u has the lists of v, whose entries are stamped with tag. */
+  bool SameLists(int v, int u, int tag) const {
+    if (elems_[u].size() != elems_[v].size() ||
+        vars_[u].size() != vars_[v].size()) {
+      return false;
+    }
+    for (int e : elems_[u]) {
+      if (nodes_[e].stamp != tag) return false;
+    }
+    for (int w : vars_[u]) {
+      if (nodes_[w].stamp != tag) return false;
+    }
+    return true;
+  }
+
+  void Merge(int u, int into) {
+    Node& node = nodes_[u];
+    Node& target = nodes_[into];
+    target.weight += node.weight;
+    target.ext = std::min(target.ext, node.ext);
+    node.weight = 0;
+    node.state = kMerged;
+    merged_[into].push_back(u);
+    elems_[u].clear();
+    vars_[u].clear();
+  }
+
+  const int n_;
+  std::vector<Node> nodes_;
+  std::vector<std::vector<int>> elems_;   // of a variable: its elements
+  std::vector<std::vector<int>> vars_;    // of a variable: its variables;
+                                          // of an element: Le
+  std::vector<std::vector<int>> merged_;  // variables merged into each one
+  DegreeLists degrees_;
+  int tag_ = 0;
+  int remaining_ = 0;  // variables not yet ordered, dense rows aside
+  std::vector<int> order_;
+  /* Scratch space of Eliminate(). */
+  std::vector<int> lp_;
+  std::vector<std::pair<unsigned, int>> keyed_;
+};
+
+}  // namespace
+
+int csr_symrcm_host(int n, int nnzA, int baseA, const int* csrRowPtrA,
+                    const int* csrColIndA, int* Q) {
+  return csr_symrcm_host_n(n, nnzA, baseA, csrRowPtrA, csrColIndA, Q, 0);
+}
+
+int csr_symamd_host(int n, int nnzA, int baseA, const int* csrRowPtrA,
+                    const int* csrColIndA, int* Q) {
+  return csr_symamd_host_n(n, nnzA, baseA, csrRowPtrA, csrColIndA, Q, 0);
+}
+
+int csr_symrcm_host_n(int n, int nnzA, int baseA, const int* csrRowPtrA,
+                      const int* csrColIndA, int* Q, int num_threads) {
+  num_threads = NumThreads(n, num_threads);
+  Graph g;
+  if (!BuildSymmetricGraph(n, nnzA, baseA, csrRowPtrA, csrColIndA,
+                           num_threads, &g)) {
+    return 1;
+  }
+  RcmOrder(g, num_threads, Q);
+  return 0;
+}
+
+int csr_symamd_host_n(int n, int nnzA, int baseA, const int* csrRowPtrA,
+                      const int* csrColIndA, int* Q, int num_threads) {
+  num_threads = NumThreads(n, num_threads);
+  Graph g;
+  if (!BuildSymmetricGraph(n, nnzA, baseA, csrRowPtrA, csrColIndA,
+                           num_threads, &g)) {
+    return 1;
+  }
+  MinimumDegree(g).Order(Q);
+  return 0;
+}
+
+int csr_perm_host(int m, int n, int nnzA, int baseA, int* csrRowPtrA,
+                  int* csrColIndA, const int* P, const int* Q, int* map) {
+  if (m < 0 || n < 0 || csrRowPtrA[0] != baseA ||
+      csrRowPtrA[m] - baseA != nnzA) {
+    return 1;
+  }
+  std::vector<int> pinv(m, -1);
+  for (int i = 0; i < m; ++i) {
+    if (static_cast<unsigned>(P[i]) >= static_cast<unsigned>(m) ||
+        pinv[P[i]] >= 0) {
+      return 1;
+    }
+    pinv[P[i]] = i;
+  }
+  std::vector<int> qinv(n, -1);
+  for (int j = 0; j < n; ++j) {
+    if (static_cast<unsigned>(Q[j]) >= static_cast<unsigned>(n) ||
+        qinv[Q[j]] >= 0) {
+      return 1;
+    }
+    qinv[Q[j]] = j;
+  }
+  for (int i = 0; i < m; ++i) {
+    if (csrRowPtrA[i] > csrRowPtrA[i + 1]) return 1;
+  }
+  for (int p = 0; p < nnzA; ++p) {
+    const int j = csrColIndA[p] - baseA;
+    if (static_cast<unsigned>(j) >= static_cast<unsigned>(n)) return 1;
+  }
+
+  const std::vector<int> rowPtr(csrRowPtrA, csrRowPtrA + m + 1);
+  const std::vector<int> colInd(csrColIndA, csrColIndA + nnzA);
+  const std::vector<int> oldMap(map, map + nnzA);
+  std::vector<std::pair<int, int>> row;
+
+  csrRowPtrA[0] = baseA;
+  for (int i = 0; i < m; ++i) {
+    const int start = rowPtr[P[i]] - baseA;
+    const int end = rowPtr[P[i] + 1] - baseA;
+    row.clear();
+    for (int p = start; p < end; ++p) {
+      row.emplace_back(qinv[colInd[p] - baseA], oldMap[p]);
+    }
+    std::sort(row.begin(), row.end());
+    int out = csrRowPtrA[i] - baseA;
+    for (const auto& entry : row) {
+      csrColIndA[out] = entry.first + baseA;
+      map[out] = entry.second;
+      ++out;
+    }
+    csrRowPtrA[i + 1] = out + baseA;
+  }
+  return 0;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+/*
+ * Host fill-reducing orderings and symmetric permutation of CSR matrices,
+ * standing in for cusolverSpXcsrsymrcmHost(), cusolverSpXcsrsymamdHost()
+ * and cusolverSpXcsrpermHost().
+ *
+ * Permutations follow cusolverSp: B = P*A*Q^T means B(i, j) = A(P[i], Q[j]),
+ * with 0-based P and Q whatever the index base of A is. The orderings work
+ * on the pattern of A + A^T, so A need not be symmetric.
+ */
+
+/*
+ * Q = symrcm(A): reverse Cuthill-McKee ordering, which reduces the
+ * bandwidth of Q*A*Q^T. Each connected component starts from a
+ * pseudo-peripheral node. Returns 0 on success, 1 on a bad pattern.
+ */
+int csr_symrcm_host(int n, int nnzA, int baseA, const int* csrRowPtrA,
+                    const int* csrColIndA, int* Q);
+
+/*
+ * Q = symamd(A): approximate minimum degree ordering on the quotient graph
+ * (element absorption, supervariables, approximate external degrees and
+ * aggressive absorption), which reduces fill-in of the factors of Q*A*Q^T.
+ * Rows denser than 10*sqrt(n) are ordered last. Returns 0 on success, 1 on
+ * a bad pattern.
+ */
+int csr_symamd_host(int n, int nnzA, int baseA, const int* csrRowPtrA,
+                    const int* csrColIndA, int* Q);
+
+/*
+ * Same as above with an explicit thread count; num_threads <= 0 picks one
+ * thread per hardware core, capped so that small graphs run serially. RCM
+ * runs its breadth-first searches level-synchronously across threads, AMD
+ * only builds the graph in parallel. The result does not depend on the
+ * thread count.
+ */
+int csr_symrcm_host_n(int n, int nnzA, int baseA, const int* csrRowPtrA,
+                      const int* csrColIndA, int* Q, int num_threads);
+int csr_symamd_host_n(int n, int nnzA, int baseA, const int* csrRowPtrA,
+                      const int* csrColIndA, int* Q, int num_threads);
+
+/*
+ * B = P*A*Q^T, overwriting the pattern of A with that of B. Column indices
+ * of every row of B are sorted. map[] (nnzA entries) is permuted with the
+ * entries, so starting from the identity, csrValB[j] = csrValA[map[j]].
+ * Returns 0 on success, 1 on a bad pattern or permutation.
+ */
+int csr_perm_host(int m, int n, int nnzA, int baseA, int* csrRowPtrA,
+                  int* csrColIndA, const int* P, const int* Q, int* map);
@@ -0,0 +1,135 @@
+#include <cstdlib>
+#include <map>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "examples/cuda/cuSolverRf/csr_lu.h"
+#include "examples/cuda/cuSolverRf/csr_reorder.h"
+#include "examples/cuda/cuSolverRf/mmio_csr.h"
+
+// How to run:
+// bazel run -c opt //examples/cuda/cuSolverRf:csr_reorder_benchmark
+namespace {
+
+struct Matrix {
+  int n = 0;
+  std::vector<int> ptr, ind;
+  std::vector<double> val;
+};
+
+Matrix Load(const char* path) {
+  Matrix a;
+  int m = 0, n = 0, nnz = 0;
+  double* val = nullptr;
+  int *ptr = nullptr, *ind = nullptr;
+  MM_typecode matcode;
+  if (loadMMSparseMatrixHost(const_cast<char*>(path), true, &m, &n, &nnz,
+                             &val, &ptr, &ind, true, &matcode)) {
+    std::abort();
+  }
+  a.n = n;
+  for (int i = 0; i <= n; ++i) a.ptr.push_back(ptr[i] - ptr[0]);
+  for (int p = 0; p < nnz; ++p) a.ind.push_back(ind[p] - ptr[0]);
+  a.val.assign(val, val + nnz);
+  free(val);
+  free(ptr);
+  free(ind);
+  return a;
+}
+
+// 7-point Laplacian of a k^3 grid, too large to factor in a benchmark.
+Matrix Laplacian3D(int k) {
+  Matrix a;
+  a.n = k * k * k;
+  a.ptr.push_back(0);
+  for (int v = 0; v < a.n; ++v) {
+    const int x = v % k, y = (v / k) % k, z = v / (k * k);
+    const std::pair<bool, int> nbrs[] = {
+        {z > 0, v - k * k}, {y > 0, v - k},     {x > 0, v - 1},
+        {true, v},          {x + 1 < k, v + 1}, {y + 1 < k, v + k},
+        {z + 1 < k, v + k * k}};
+    for (const auto& nbr : nbrs) {
+      if (!nbr.first) continue;
+      a.ind.push_back(nbr.second);
+      a.val.push_back(nbr.second == v ? 6.0 : -1.0);
+    }
+    a.ptr.push_back(static_cast<int>(a.ind.size()));
+  }
+  return a;
+}
+
+const Matrix& GetMatrix(int index) {
+  static const auto* matrices = new std::vector<Matrix>{
+      Load("examples/cuda/cuSolverRf/data/lap2D_5pt_n100.mtx"),
+      Load("examples/cuda/cuSolverRf/data/lap3D_7pt_n20.mtx"),
+      Laplacian3D(80),
+  };
+  return (*matrices)[index];
+}
+
+int Reorder(const Matrix& a, bool amd, int threads, int* Q) {
+  const int nnz = static_cast<int>(a.ind.size());
+  return amd ? csr_symamd_host_n(a.n, nnz, 0, a.ptr.data(), a.ind.data(), Q,
+                                 threads)
+             : csr_symrcm_host_n(a.n, nnz, 0, a.ptr.data(), a.ind.data(), Q,
+                                 threads);
+}
+
+// nnz(L+U) of Q*A*Q^T, computed once per (matrix, ordering).
+int FactorNnz(int index, bool amd) {
+  static auto* cache = new std::map<std::pair<int, bool>, int>;
+  const auto key = std::make_pair(index, amd);
+  auto it = cache->find(key);
+  if (it != cache->end()) return it->second;
+
+  Matrix b = GetMatrix(index);
+  const int nnz = static_cast<int>(b.ind.size());
+  std::vector<int> Q(b.n), map(nnz);
+  std::iota(map.begin(), map.end(), 0);
+  int nnzL = 0, nnzU = 0;
+  CsrLuHost lu;
+  if (Reorder(b, amd, 1, Q.data()) ||
+      csr_perm_host(b.n, b.n, nnz, 0, b.ptr.data(), b.ind.data(), Q.data(),
+                    Q.data(), map.data())) {
+    std::abort();
+  }
+  std::vector<double> val(nnz);
+  for (int p = 0; p < nnz; ++p) val[p] = b.val[map[p]];
+  if (lu.Analyze(b.n, nnz, 0, b.ptr.data(), b.ind.data()) ||
+      lu.Factor(val.data(), 1.0) || lu.Nnz(&nnzL, &nnzU)) {
+    std::abort();
+  }
+  return (*cache)[key] = nnzL + nnzU;
+}
+
+// Arguments: matrix index, 0 = symrcm / 1 = symamd, threads.
+void BM_Reorder(benchmark::State& state) {
+  const int index = static_cast<int>(state.range(0));
+  const bool amd = state.range(1) != 0;
+  const int threads = static_cast<int>(state.range(2));
+  const Matrix& a = GetMatrix(index);
+  std::vector<int> Q(a.n);
+  for (auto _ : state) {
+    if (Reorder(a, amd, threads, Q.data())) {
+      state.SkipWithError("reordering failed");
+      return;
+    }
+    benchmark::DoNotOptimize(Q.data());
+  }
+  state.SetLabel(amd ? "symamd" : "symrcm");
+  state.counters["n"] = a.n;
+  state.counters["nnzA"] = static_cast<double>(a.ind.size());
+  if (index < 2) {
+    const int nnzLU = FactorNnz(index, amd);
+    state.counters["nnzLU"] = nnzLU;
+    state.counters["fill"] = static_cast<double>(nnzLU) / a.ind.size();
+  }
+}
+BENCHMARK(BM_Reorder)
+    ->ArgsProduct({{0, 1, 2}, {0, 1}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,307 @@
+#include "examples/cuda/cuSolverRf/csr_reorder.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "examples/cuda/cuSolverRf/csr_lu.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+struct Csr {
+  int n = 0;
+  std::vector<int> ptr, ind;
+};
+
+Csr FromEntries(int n, const std::set<std::pair<int, int>>& entries) {
+  Csr a;
+  a.n = n;
+  a.ptr.assign(n + 1, 0);
+  for (const auto& e : entries) {
+    ++a.ptr[e.first + 1];
+    a.ind.push_back(e.second);
+  }
+  for (int i = 0; i < n; ++i) a.ptr[i + 1] += a.ptr[i];
+  return a;
+}
+
+// 5-point Laplacian pattern of a k x k grid with its nodes shuffled.
+Csr ShuffledGrid(int k, uint32_t seed) {
+  const int n = k * k;
+  std::vector<int> label(n);
+  std::iota(label.begin(), label.end(), 0);
+  std::shuffle(label.begin(), label.end(), std::mt19937(seed));
+  std::set<std::pair<int, int>> entries;
+  for (int y = 0; y < k; ++y) {
+    for (int x = 0; x < k; ++x) {
+      const int v = label[y * k + x];
+      entries.emplace(v, v);
+      if (x + 1 < k) {
+        entries.emplace(v, label[y * k + x + 1]);
+        entries.emplace(label[y * k + x + 1], v);
+      }
+      if (y + 1 < k) {
+        entries.emplace(v, label[(y + 1) * k + x]);
+        entries.emplace(label[(y + 1) * k + x], v);
+      }
+    }
+  }
+  return FromEntries(n, entries);
+}
+
+// 7-point Laplacian pattern of a k x k x k grid, naturally ordered.
+Csr Grid3D(int k) {
+  const int n = k * k * k;
+  std::set<std::pair<int, int>> entries;
+  for (int v = 0; v < n; ++v) {
+    entries.emplace(v, v);
+    const int x = v % k, y = (v / k) % k, z = v / (k * k);
+    for (int step : {1, k, k * k}) {
+      const bool inside = (step == 1 && x + 1 < k) ||
+                          (step == k && y + 1 < k) ||
+                          (step == k * k && z + 1 < k);
+      if (inside) {
+        entries.emplace(v, v + step);
+        entries.emplace(v + step, v);
+      }
+    }
+  }
+  return FromEntries(n, entries);
+}
+
+int Bandwidth(const Csr& a) {
+  int bw = 0;
+  for (int i = 0; i < a.n; ++i) {
+    for (int p = a.ptr[i]; p < a.ptr[i + 1]; ++p) {
+      bw = std::max(bw, std::abs(i - a.ind[p]));
+    }
+  }
+  return bw;
+}
+
+bool IsPermutation(std::vector<int> q) {
+  std::sort(q.begin(), q.end());
+  for (int i = 0; i < static_cast<int>(q.size()); ++i) {
+    if (q[i] != i) return false;
+  }
+  return true;
+}
+
+// nnz(L+U) of Q*A*Q^T for a diagonally dominant A with the pattern of a.
+int FactorNnz(Csr a, const std::vector<int>& Q) {
+  const int nnz = static_cast<int>(a.ind.size());
+  std::vector<int> map(nnz);
+  std::iota(map.begin(), map.end(), 0);
+  if (csr_perm_host(a.n, a.n, nnz, 0, a.ptr.data(), a.ind.data(), Q.data(),
+                    Q.data(), map.data())) {
+    return -1;
+  }
+  std::vector<double> val(nnz);
+  for (int i = 0; i < a.n; ++i) {
+    for (int p = a.ptr[i]; p < a.ptr[i + 1]; ++p) {
+      val[p] = (a.ind[p] == i) ? 8.0 : -1.0;
+    }
+  }
+  CsrLuHost lu;
+  int nnzL = 0, nnzU = 0;
+  if (lu.Analyze(a.n, nnz, 0, a.ptr.data(), a.ind.data()) ||
+      lu.Factor(val.data(), 1.0) || lu.Nnz(&nnzL, &nnzU)) {
+    return -1;
+  }
+  return nnzL + nnzU;
+}
+
+TEST(CsrSymrcmHostTest, ReducesBandwidth) {
+  Csr a = ShuffledGrid(30, 7);
+  const int nnz = static_cast<int>(a.ind.size());
+  std::vector<int> Q(a.n);
+  ASSERT_EQ(csr_symrcm_host(a.n, nnz, 0, a.ptr.data(), a.ind.data(), Q.data()),
+            0);
+  ASSERT_TRUE(IsPermutation(Q));
+
+  std::vector<int> map(nnz);
+  std::iota(map.begin(), map.end(), 0);
+  const int before = Bandwidth(a);
+  ASSERT_EQ(csr_perm_host(a.n, a.n, nnz, 0, a.ptr.data(), a.ind.data(),
+                          Q.data(), Q.data(), map.data()),
+            0);
+  // A k x k grid has an optimal bandwidth of k.
+  EXPECT_LE(Bandwidth(a), 31);
+  EXPECT_GT(before, 300);
+}
+
+TEST(CsrSymrcmHostTest, DisconnectedAndUnsymmetric) {
+  // Two components plus an isolated node; only one triangle is stored.
+  const Csr a = FromEntries(6, {{0, 0}, {1, 0}, {2, 1}, {4, 3}, {5, 5}});
+  std::vector<int> Q(a.n);
+  ASSERT_EQ(csr_symrcm_host(a.n, static_cast<int>(a.ind.size()), 0,
+                            a.ptr.data(), a.ind.data(), Q.data()),
+            0);
+  EXPECT_TRUE(IsPermutation(Q));
+}
+
+TEST(CsrSymrcmHostTest, RejectsBadPattern) {
+  const std::vector<int> ptr = {0, 1, 2};
+  const std::vector<int> ind = {0, 2};
+  std::vector<int> Q(2);
+  EXPECT_NE(csr_symrcm_host(2, 2, 0, ptr.data(), ind.data(), Q.data()), 0);
+}
+
+TEST(CsrSymrcmHostTest, SameOrderForAnyThreadCount) {
+  // Middle levels of a 24^3 grid are wide enough to use the thread team.
+  const Csr a = Grid3D(24);
+  const int nnz = static_cast<int>(a.ind.size());
+  std::vector<int> serial(a.n);
+  ASSERT_EQ(csr_symrcm_host_n(a.n, nnz, 0, a.ptr.data(), a.ind.data(),
+                              serial.data(), 1),
+            0);
+  ASSERT_TRUE(IsPermutation(serial));
+  for (int threads : {2, 3, 4}) {
+    std::vector<int> Q(a.n);
+    ASSERT_EQ(csr_symrcm_host_n(a.n, nnz, 0, a.ptr.data(), a.ind.data(),
+                                Q.data(), threads),
+              0);
+    EXPECT_EQ(Q, serial) << threads << " threads";
+  }
+}
+
+TEST(CsrSymamdHostTest, LessFillThanRcm) {
+  const Csr a = ShuffledGrid(40, 11);
+  const int nnz = static_cast<int>(a.ind.size());
+  std::vector<int> rcm(a.n), amd(a.n);
+  ASSERT_EQ(csr_symrcm_host(a.n, nnz, 0, a.ptr.data(), a.ind.data(),
+                            rcm.data()),
+            0);
+  ASSERT_EQ(csr_symamd_host(a.n, nnz, 0, a.ptr.data(), a.ind.data(),
+                            amd.data()),
+            0);
+  ASSERT_TRUE(IsPermutation(amd));
+
+  const int fill_rcm = FactorNnz(a, rcm);
+  const int fill_amd = FactorNnz(a, amd);
+  ASSERT_GT(fill_rcm, 0);
+  ASSERT_GT(fill_amd, 0);
+  EXPECT_LT(fill_amd, fill_rcm);
+}
+
+TEST(CsrSymamdHostTest, SameOrderForAnyThreadCount) {
+  const Csr a = ShuffledGrid(30, 5);
+  const int nnz = static_cast<int>(a.ind.size());
+  std::vector<int> serial(a.n), threaded(a.n);
+  ASSERT_EQ(csr_symamd_host_n(a.n, nnz, 0, a.ptr.data(), a.ind.data(),
+                              serial.data(), 1),
+            0);
+  ASSERT_EQ(csr_symamd_host_n(a.n, nnz, 0, a.ptr.data(), a.ind.data(),
+                              threaded.data(), 4),
+            0);
+  EXPECT_EQ(threaded, serial);
+}
+
+TEST(CsrSymamdHostTest, DenseRowAndIsolatedNodes) {
+  // Arrow matrix: row 0 couples to everything, nodes 398 and 399 are
+  // isolated and there is a chain 1-2-...-397 below the arrow. 1-based.
+  const int n = 400;
+  std::set<std::pair<int, int>> entries;
+  for (int i = 0; i < 398; ++i) {
+    entries.emplace(0, i);
+    entries.emplace(i, i);
+    if (i > 1) entries.emplace(i, i - 1);
+  }
+  Csr a = FromEntries(n, entries);
+  for (int& p : a.ptr) ++p;
+  for (int& j : a.ind) ++j;
+  std::vector<int> Q(n);
+  ASSERT_EQ(csr_symamd_host(n, static_cast<int>(a.ind.size()), 1,
+                            a.ptr.data(), a.ind.data(), Q.data()),
+            0);
+  ASSERT_TRUE(IsPermutation(Q));
+  EXPECT_EQ(Q[n - 1], 0);
+}
+
+TEST(CsrSymamdHostTest, RandomPatternsArePermutations) {
+  for (int n : {1, 2, 3, 50, 700}) {
+    for (uint32_t seed = 1; seed <= 3; ++seed) {
+      // Unsymmetric rows of up to 6 entries, and two dense rows.
+      std::mt19937 rng(seed);
+      std::set<std::pair<int, int>> entries;
+      for (int i = 0; i < n; ++i) {
+        entries.emplace(i, i);
+        for (int k = static_cast<int>(rng() % 7); k > 0; --k) {
+          entries.emplace(i, static_cast<int>(rng() % n));
+        }
+      }
+      for (int j = 0; j < n; j += 2) entries.emplace(n / 2, j);
+      for (int i = 0; i < n; i += 3) entries.emplace(i, n - 1);
+      const Csr a = FromEntries(n, entries);
+      std::vector<int> Q(n, -1);
+      ASSERT_EQ(csr_symamd_host(n, static_cast<int>(a.ind.size()), 0,
+                                a.ptr.data(), a.ind.data(), Q.data()),
+                0);
+      EXPECT_TRUE(IsPermutation(Q)) << "n " << n << " seed " << seed;
+      EXPECT_GT(FactorNnz(a, Q), 0);
+    }
+  }
+}
+
+TEST(CsrSymamdHostTest, RejectsBadPattern) {
+  const std::vector<int> ptr = {0, 2, 1};
+  const std::vector<int> ind = {0, 1};
+  std::vector<int> Q(2);
+  EXPECT_NE(csr_symamd_host(2, 1, 0, ptr.data(), ind.data(), Q.data()), 0);
+}
+
+TEST(CsrPermHostTest, MatchesDefinition) {
+  // A(i, j) = 10 * i + j on a random pattern, 1-based.
+  std::mt19937 rng(3);
+  std::set<std::pair<int, int>> entries;
+  for (int e = 0; e < 40; ++e) entries.emplace(rng() % 9, rng() % 7);
+  Csr a = FromEntries(9, entries);
+  const int nnz = static_cast<int>(a.ind.size());
+  std::vector<double> val(nnz);
+  for (int i = 0; i < a.n; ++i) {
+    for (int p = a.ptr[i]; p < a.ptr[i + 1]; ++p) val[p] = 10 * i + a.ind[p];
+  }
+  for (int& p : a.ptr) ++p;
+  for (int& j : a.ind) ++j;
+
+  std::vector<int> P(9), Q(7);
+  std::iota(P.begin(), P.end(), 0);
+  std::iota(Q.begin(), Q.end(), 0);
+  std::shuffle(P.begin(), P.end(), rng);
+  std::shuffle(Q.begin(), Q.end(), rng);
+  std::vector<int> map(nnz);
+  std::iota(map.begin(), map.end(), 0);
+  ASSERT_EQ(csr_perm_host(9, 7, nnz, 1, a.ptr.data(), a.ind.data(), P.data(),
+                          Q.data(), map.data()),
+            0);
+
+  EXPECT_EQ(a.ptr[0], 1);
+  EXPECT_EQ(a.ptr[9], nnz + 1);
+  for (int i = 0; i < 9; ++i) {
+    for (int p = a.ptr[i] - 1; p < a.ptr[i + 1] - 1; ++p) {
+      const int j = a.ind[p] - 1;
+      EXPECT_EQ(val[map[p]], 10 * P[i] + Q[j]);
+      if (p > a.ptr[i] - 1) {
+        EXPECT_LT(a.ind[p - 1], a.ind[p]);
+      }
+    }
+  }
+}
+
+TEST(CsrPermHostTest, RejectsNonPermutation) {
+  std::vector<int> ptr = {0, 1, 2};
+  std::vector<int> ind = {0, 1};
+  std::vector<int> map = {0, 1};
+  const std::vector<int> P = {0, 0};
+  const std::vector<int> Q = {0, 1};
+  EXPECT_NE(csr_perm_host(2, 2, 2, 0, ptr.data(), ind.data(), P.data(),
+                          Q.data(), map.data()),
+            0);
+  EXPECT_EQ(ind, (std::vector<int>{0, 1}));
+}
+
+}  // namespace
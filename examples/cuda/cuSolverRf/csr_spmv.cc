@@ -0,0 +1,246 @@
+#include "examples/cuda/cuSolverRf/csr_spmv.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "examples/cuda/common/parallel_helper.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CSR_SPMV_X86 1
+#endif
+
+namespace {
+
+constexpr int kMinEntriesPerThread = 1 << 16;
+
+struct CsrView {
+  int base;
+  const double* val;
+  const int* rowPtr;
+  const int* colInd;
+};
+
+/* y[i] = alpha * dot + beta * y[i] */
+struct AxpbyRow {
+  double alpha, beta;
+  double* y;
+  void operator()(int i, double dot) {
+    y[i] = (beta == 0.0) ? alpha * dot : alpha * dot + beta * y[i];
+  }
+};
+
+/* max(m, a), but NaN if either is NaN, where fmax would drop it */
+inline double MaxKeepNan(double m, double a) {
+  return (a > m || a != a) ? a : m;
+}
+
+/* r[i] = b[i] - dot, tracking max |r[i]| */
+struct ResidualRow {
+  const double* b;
+  double* r;
+  double amax = 0.0;
+  void operator()(int i, double dot) {
+    const double ri = b[i] - dot;
+    if (r != nullptr) r[i] = ri;
+    amax = MaxKeepNan(amax, fabs(ri));
+  }
+};
+
+template <typename Op>
+void RowsScalar(const CsrView& a, int begin, int end, const double* x,
+                Op& op) {
+  for (int i = begin; i < end; ++i) {
+    double dot = 0.0;
+    for (int p = a.rowPtr[i] - a.base; p < a.rowPtr[i + 1] - a.base; ++p) {
+      dot += a.val[p] * x[a.colInd[p] - a.base];
+    }
+    op(i, dot);
+  }
+}
+
+#ifdef CSR_SPMV_X86
+
+template <typename Op>
+__attribute__((target("avx2,fma"))) void RowsAvx2(const CsrView& a,
+                                                   int begin, int end,
+                                                   const double* x, Op& op) {
+  const __m128i base = _mm_set1_epi32(a.base);
+  for (int i = begin; i < end; ++i) {
+    int p = a.rowPtr[i] - a.base;
+    const int q = a.rowPtr[i + 1] - a.base;
+    __m256d acc = _mm256_setzero_pd();
+    for (; p + 4 <= q; p += 4) {
+      const __m128i col = _mm_sub_epi32(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(a.colInd + p)),
+          base);
+      acc = _mm256_fmadd_pd(_mm256_loadu_pd(a.val + p),
+                            _mm256_i32gather_pd(x, col, 8), acc);
+    }
+    __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(acc),
+                             _mm256_extractf128_pd(acc, 1));
+    double dot = _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+    for (; p < q; ++p) dot += a.val[p] * x[a.colInd[p] - a.base];
+    op(i, dot);
+  }
+}
+
+template <typename Op>
+__attribute__((target("avx512f"))) void RowsAvx512(const CsrView& a,
+                                                   int begin, int end,
+                                                   const double* x, Op& op) {
+  const __m256i base = _mm256_set1_epi32(a.base);
+  for (int i = begin; i < end; ++i) {
+    int p = a.rowPtr[i] - a.base;
+    const int q = a.rowPtr[i + 1] - a.base;
+    __m512d acc = _mm512_setzero_pd();
+    for (; p + 8 <= q; p += 8) {
+      const __m256i col = _mm256_sub_epi32(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a.colInd + p)),
+          base);
+      acc = _mm512_fmadd_pd(_mm512_loadu_pd(a.val + p),
+                            _mm512_i32gather_pd(col, x, 8), acc);
+    }
+    if (p < q) {
+      /* Masked lanes are neither loaded nor gathered. */
+      const __mmask8 mask = static_cast<__mmask8>((1u << (q - p)) - 1);
+      const __m256i col = _mm256_sub_epi32(
+          _mm512_castsi512_si256(_mm512_maskz_loadu_epi32(mask, a.colInd + p)),
+          base);
+      const __m512d xv =
+          _mm512_mask_i32gather_pd(_mm512_setzero_pd(), mask, col, x, 8);
+      acc = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, a.val + p), xv, acc);
+    }
+    op(i, _mm512_reduce_add_pd(acc));
+  }
+}
+
+#endif  // CSR_SPMV_X86
+
+CsrSpmvKernel Resolve(CsrSpmvKernel kernel) {
+  if (kernel != kCsrSpmvAuto) return kernel;
+  if (csr_spmv_kernel_supported(kCsrSpmvAvx512)) return kCsrSpmvAvx512;
+  if (csr_spmv_kernel_supported(kCsrSpmvAvx2)) return kCsrSpmvAvx2;
+  return kCsrSpmvScalar;
+}
+
+template <typename Op>
+void Rows(CsrSpmvKernel kernel, const CsrView& a, int begin, int end,
+          const double* x, Op& op) {
+  switch (kernel) {
+#ifdef CSR_SPMV_X86
+    case kCsrSpmvAvx512:
+      RowsAvx512(a, begin, end, x, op);
+      return;
+    case kCsrSpmvAvx2:
+      RowsAvx2(a, begin, end, x, op);
+      return;
+#endif
+    default:
+      RowsScalar(a, begin, end, x, op);
+      return;
+  }
+}
+
+bool CheckRowPtr(int m, int nnz, int base, const int* rowPtr) {
+  return m >= 0 && nnz >= 0 && (m == 0 || rowPtr[0] == base) &&
+         (m == 0 || rowPtr[m] - base == nnz);
+}
+
+/* First row of thread t's share: rows are split at nnz * t / T. */
+int RowSplit(int m, int nnz, int base, const int* rowPtr, int t,
+             int num_threads) {
+  if (t == 0) return 0;
+  if (t == num_threads) return m;
+  const int target =
+      base + static_cast<int>(static_cast<long long>(nnz) * t / num_threads);
+  return static_cast<int>(std::lower_bound(rowPtr, rowPtr + m, target) -
+                          rowPtr);
+}
+
+/* Runs a fresh Op per thread over its rows; returns the ops. */
+template <typename Op>
+std::vector<Op> RunRows(int m, int nnz, const CsrView& a, const double* x,
+                        const Op& proto, int num_threads,
+                        CsrSpmvKernel kernel) {
+  num_threads = csr_spmv_num_threads(nnz, num_threads);
+  std::vector<Op> ops(num_threads, proto);
+  ParallelFor(num_threads, [&](int t) {
+    const int begin = RowSplit(m, nnz, a.base, a.rowPtr, t, num_threads);
+    const int end = RowSplit(m, nnz, a.base, a.rowPtr, t + 1, num_threads);
+    Op op = proto;  // thread-local, so the per-row updates do not share lines
+    Rows(kernel, a, begin, end, x, op);
+    ops[t] = op;
+  });
+  return ops;
+}
+
+}  // namespace
+
+bool csr_spmv_kernel_supported(CsrSpmvKernel kernel) {
+  switch (kernel) {
+    case kCsrSpmvAuto:
+    case kCsrSpmvScalar:
+      return true;
+#ifdef CSR_SPMV_X86
+    case kCsrSpmvAvx2:
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case kCsrSpmvAvx512:
+      return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+      return false;
+  }
+}
+
+const char* csr_spmv_kernel_name(CsrSpmvKernel kernel) {
+  switch (Resolve(kernel)) {
+    case kCsrSpmvAvx2:
+      return "avx2";
+    case kCsrSpmvAvx512:
+      return "avx512";
+    default:
+      return "scalar";
+  }
+}
+
+int csr_spmv_num_threads(int nnzA, int num_threads) {
+  return ParallelThreads(nnzA, num_threads, kMinEntriesPerThread);
+}
+
+int csr_spmv_host(int m, int nnzA, int baseA, const double* csrValA,
+                  const int* csrRowPtrA, const int* csrColIndA, double alpha,
+                  const double* x, double beta, double* y, int num_threads,
+                  CsrSpmvKernel kernel) {
+  if (!CheckRowPtr(m, nnzA, baseA, csrRowPtrA) ||
+      !csr_spmv_kernel_supported(kernel)) {
+    return 1;
+  }
+  const CsrView a = {baseA, csrValA, csrRowPtrA, csrColIndA};
+  RunRows(m, nnzA, a, x, AxpbyRow{alpha, beta, y}, num_threads,
+          Resolve(kernel));
+  return 0;
+}
+
+int csr_residual_norminf_host(int m, int nnzA, int baseA,
+                              const double* csrValA, const int* csrRowPtrA,
+                              const int* csrColIndA, const double* x,
+                              const double* b, double* r, double* r_inf,
+                              int num_threads, CsrSpmvKernel kernel) {
+  if (!CheckRowPtr(m, nnzA, baseA, csrRowPtrA) ||
+      !csr_spmv_kernel_supported(kernel)) {
+    return 1;
+  }
+  const CsrView a = {baseA, csrValA, csrRowPtrA, csrColIndA};
+  ResidualRow proto;
+  proto.b = b;
+  proto.r = r;
+  *r_inf = 0.0;
+  for (const auto& op : RunRows(m, nnzA, a, x, proto, num_threads,
+                                Resolve(kernel))) {
+    *r_inf = MaxKeepNan(*r_inf, op.amax);
+  }
+  return 0;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+/*
+ * Host CSR sparse matrix-vector products, used in place of cusparseSpMV()
+ * where cuSolverRf.cpp only needs a residual on the CPU.
+ *
+ * Rows are split into one contiguous range per thread with about the same
+ * number of nonzeros each. Within a row the products are accumulated in
+ * SIMD lanes, with x gathered by column index (AVX2: 4 doubles, AVX-512: 8
+ * with masked tails); the summation order therefore depends on the kernel,
+ * but not on the thread count.
+ *
+ * All functions return 0 on success and 1 on inconsistent row pointers or
+ * a kernel the CPU does not support.
+ */
+
+enum CsrSpmvKernel {
+  kCsrSpmvAuto = 0,  // widest kernel the CPU supports
+  kCsrSpmvScalar,
+  kCsrSpmvAvx2,
+  kCsrSpmvAvx512,
+};
+
+/* Whether the kernel can run on this CPU; kCsrSpmvAuto always can. */
+bool csr_spmv_kernel_supported(CsrSpmvKernel kernel);
+
+/* Name of the kernel kCsrSpmvAuto resolves to, or of kernel itself. */
+const char* csr_spmv_kernel_name(CsrSpmvKernel kernel);
+
+/* Returns the number of threads the functions below actually use. */
+int csr_spmv_num_threads(int nnzA, int num_threads);
+
+/*
+ * y = alpha*A*x + beta*y for the m-row matrix A in CSR format with index
+ * base baseA. y is not read when beta == 0. num_threads <= 0 picks one
+ * thread per hardware core, capped so that small products run serially.
+ */
+int csr_spmv_host(int m, int nnzA, int baseA, const double* csrValA,
+                  const int* csrRowPtrA, const int* csrColIndA, double alpha,
+                  const double* x, double beta, double* y,
+                  int num_threads = 0, CsrSpmvKernel kernel = kCsrSpmvAuto);
+
+/*
+ * r = b - A*x and *r_inf = |r|_inf in one pass over A. r may be NULL when
+ * only the norm is needed. *r_inf is NaN if any r[i] is, so that a diverged
+ * solve never reports a small residual.
+ */
+int csr_residual_norminf_host(int m, int nnzA, int baseA,
+                              const double* csrValA, const int* csrRowPtrA,
+                              const int* csrColIndA, const double* x,
+                              const double* b, double* r, double* r_inf,
+                              int num_threads = 0,
+                              CsrSpmvKernel kernel = kCsrSpmvAuto);
@@ -0,0 +1,131 @@
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "examples/cuda/cuSolverRf/csr_spmv.h"
+#include "examples/cuda/cuSolverRf/mmio_csr.h"
+
+// How to run:
+// bazel run -c opt //examples/cuda/cuSolverRf:csr_spmv_benchmark
+namespace {
+
+struct Matrix {
+  int m = 0, n = 0, base = 0;
+  std::vector<int> ptr, ind;
+  std::vector<double> val;
+};
+
+Matrix Load(const char* path) {
+  Matrix a;
+  int nnz = 0;
+  double* val = nullptr;
+  int *ptr = nullptr, *ind = nullptr;
+  MM_typecode matcode;
+  if (loadMMSparseMatrixHost(const_cast<char*>(path), true, &a.m, &a.n, &nnz,
+                             &val, &ptr, &ind, true, &matcode)) {
+    std::abort();
+  }
+  a.base = ptr[0];
+  a.ptr.assign(ptr, ptr + a.m + 1);
+  a.ind.assign(ind, ind + nnz);
+  a.val.assign(val, val + nnz);
+  free(val);
+  free(ptr);
+  free(ind);
+  return a;
+}
+
+// 7-point Laplacian of a k^3 grid, larger than the last-level cache.
+Matrix Laplacian3D(int k) {
+  Matrix a;
+  a.m = a.n = k * k * k;
+  a.ptr.push_back(0);
+  for (int v = 0; v < a.m; ++v) {
+    const int x = v % k, y = (v / k) % k, z = v / (k * k);
+    const std::pair<bool, int> nbrs[] = {
+        {z > 0, v - k * k}, {y > 0, v - k},     {x > 0, v - 1},
+        {true, v},          {x + 1 < k, v + 1}, {y + 1 < k, v + k},
+        {z + 1 < k, v + k * k}};
+    for (const auto& nbr : nbrs) {
+      if (!nbr.first) continue;
+      a.ind.push_back(nbr.second);
+      a.val.push_back(nbr.second == v ? 6.0 : -1.0);
+    }
+    a.ptr.push_back(static_cast<int>(a.ind.size()));
+  }
+  return a;
+}
+
+const Matrix& GetMatrix(int index) {
+  static const auto* matrices = new std::vector<Matrix>{
+      Load("examples/cuda/cuSolverRf/data/lap2D_5pt_n100.mtx"),
+      Load("examples/cuda/cuSolverRf/data/lap3D_7pt_n20.mtx"),
+      Laplacian3D(160),
+  };
+  return (*matrices)[index];
+}
+
+// Minimum traffic of one pass: A once, x once, and bytes_per_row per row.
+void SetRates(benchmark::State& state, const Matrix& a, int bytes_per_row) {
+  const double nnz = static_cast<double>(a.ind.size());
+  const double bytes = nnz * (sizeof(double) + sizeof(int)) +
+                       (a.m + 1.0) * sizeof(int) + a.n * sizeof(double) +
+                       static_cast<double>(a.m) * bytes_per_row;
+  state.counters["GFLOP/s"] = benchmark::Counter(
+      2.0 * nnz * 1e-9, benchmark::Counter::kIsIterationInvariantRate);
+  state.counters["GB/s"] = benchmark::Counter(
+      bytes * 1e-9, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// Arguments: matrix index, CsrSpmvKernel, threads.
+void BM_Spmv(benchmark::State& state) {
+  const Matrix& a = GetMatrix(static_cast<int>(state.range(0)));
+  const auto kernel = static_cast<CsrSpmvKernel>(state.range(1));
+  const int threads = static_cast<int>(state.range(2));
+  if (!csr_spmv_kernel_supported(kernel)) {
+    state.SkipWithError("kernel not supported on this CPU");
+    return;
+  }
+  const int nnz = static_cast<int>(a.ind.size());
+  std::vector<double> x(a.n, 1.0), y(a.m);
+  for (auto _ : state) {
+    csr_spmv_host(a.m, nnz, a.base, a.val.data(), a.ptr.data(), a.ind.data(),
+                  1.0, x.data(), 0.0, y.data(), threads, kernel);
+    benchmark::DoNotOptimize(y.data());
+  }
+  state.SetLabel(csr_spmv_kernel_name(kernel));
+  SetRates(state, a, sizeof(double));
+}
+
+// r = b - A*x and |r|_inf in one pass.
+void BM_Residual(benchmark::State& state) {
+  const Matrix& a = GetMatrix(static_cast<int>(state.range(0)));
+  const auto kernel = static_cast<CsrSpmvKernel>(state.range(1));
+  const int threads = static_cast<int>(state.range(2));
+  if (!csr_spmv_kernel_supported(kernel)) {
+    state.SkipWithError("kernel not supported on this CPU");
+    return;
+  }
+  const int nnz = static_cast<int>(a.ind.size());
+  std::vector<double> x(a.n, 1.0), b(a.m, 1.0), r(a.m);
+  double r_inf = 0.0;
+  for (auto _ : state) {
+    csr_residual_norminf_host(a.m, nnz, a.base, a.val.data(), a.ptr.data(),
+                              a.ind.data(), x.data(), b.data(), r.data(),
+                              &r_inf, threads, kernel);
+    benchmark::DoNotOptimize(r_inf);
+  }
+  state.SetLabel(csr_spmv_kernel_name(kernel));
+  SetRates(state, a, 2 * sizeof(double));
+}
+
+const std::vector<std::vector<int64_t>> kArgs = {
+    {0, 1, 2},
+    {kCsrSpmvScalar, kCsrSpmvAvx2, kCsrSpmvAvx512},
+    {1, 2, 4, 8}};
+
+BENCHMARK(BM_Spmv)->ArgsProduct(kArgs)->UseRealTime();
+BENCHMARK(BM_Residual)->ArgsProduct(kArgs)->UseRealTime();
+
+}  // namespace
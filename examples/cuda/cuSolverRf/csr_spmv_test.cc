@@ -0,0 +1,182 @@
+#include "examples/cuda/cuSolverRf/csr_spmv.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct Csr {
+  int m = 0, n = 0, base = 0;
+  std::vector<int> ptr, ind;
+  std::vector<double> val;
+};
+
+// Random rows of 0-40 entries, so every SIMD tail length shows up.
+Csr RandomCsr(int m, int n, int base, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> value(-1.0, 1.0);
+  Csr a;
+  a.m = m;
+  a.n = n;
+  a.base = base;
+  a.ptr.push_back(base);
+  for (int i = 0; i < m; ++i) {
+    std::set<int> cols;
+    const int len = static_cast<int>(rng() % 41);
+    while (static_cast<int>(cols.size()) < std::min(len, n)) {
+      cols.insert(static_cast<int>(rng() % n));
+    }
+    for (int j : cols) {
+      a.ind.push_back(j + base);
+      a.val.push_back(value(rng));
+    }
+    a.ptr.push_back(static_cast<int>(a.ind.size()) + base);
+  }
+  return a;
+}
+
+std::vector<double> Reference(const Csr& a, const std::vector<double>& x) {
+  std::vector<double> y(a.m, 0.0);
+  for (int i = 0; i < a.m; ++i) {
+    for (int p = a.ptr[i] - a.base; p < a.ptr[i + 1] - a.base; ++p) {
+      y[i] += a.val[p] * x[a.ind[p] - a.base];
+    }
+  }
+  return y;
+}
+
+std::vector<CsrSpmvKernel> Kernels() {
+  std::vector<CsrSpmvKernel> kernels;
+  for (CsrSpmvKernel k : {kCsrSpmvAuto, kCsrSpmvScalar, kCsrSpmvAvx2,
+                          kCsrSpmvAvx512}) {
+    if (csr_spmv_kernel_supported(k)) kernels.push_back(k);
+  }
+  return kernels;
+}
+
+TEST(CsrSpmvHostTest, MatchesReference) {
+  for (int base : {0, 1}) {
+    const Csr a = RandomCsr(300, 250, base, 5 + base);
+    const int nnz = static_cast<int>(a.ind.size());
+    std::vector<double> x(a.n);
+    for (int j = 0; j < a.n; ++j) x[j] = 1.0 + 0.01 * j;
+    const std::vector<double> ax = Reference(a, x);
+
+    for (CsrSpmvKernel kernel : Kernels()) {
+      for (int threads : {1, 3, 8}) {
+        std::vector<double> y(a.m, 2.0);
+        ASSERT_EQ(csr_spmv_host(a.m, nnz, base, a.val.data(), a.ptr.data(),
+                                a.ind.data(), -1.5, x.data(), 0.5, y.data(),
+                                threads, kernel),
+                  0);
+        for (int i = 0; i < a.m; ++i) {
+          EXPECT_NEAR(y[i], -1.5 * ax[i] + 1.0, 1e-12)
+              << csr_spmv_kernel_name(kernel) << " row " << i;
+        }
+
+        // beta == 0 must not read y.
+        std::vector<double> z(a.m, NAN);
+        ASSERT_EQ(csr_spmv_host(a.m, nnz, base, a.val.data(), a.ptr.data(),
+                                a.ind.data(), 1.0, x.data(), 0.0, z.data(),
+                                threads, kernel),
+                  0);
+        for (int i = 0; i < a.m; ++i) EXPECT_NEAR(z[i], ax[i], 1e-12);
+      }
+    }
+  }
+}
+
+TEST(CsrSpmvHostTest, ResidualNorm) {
+  const Csr a = RandomCsr(500, 500, 1, 17);
+  const int nnz = static_cast<int>(a.ind.size());
+  std::vector<double> x(a.n), b(a.m);
+  for (int j = 0; j < a.n; ++j) x[j] = cos(j);
+  for (int i = 0; i < a.m; ++i) b[i] = sin(i);
+  const std::vector<double> ax = Reference(a, x);
+  double expected = 0.0;
+  for (int i = 0; i < a.m; ++i) expected = fmax(expected, fabs(b[i] - ax[i]));
+
+  for (CsrSpmvKernel kernel : Kernels()) {
+    for (int threads : {1, 4}) {
+      std::vector<double> r(a.m);
+      double r_inf = -1.0;
+      ASSERT_EQ(csr_residual_norminf_host(a.m, nnz, 1, a.val.data(),
+                                          a.ptr.data(), a.ind.data(),
+                                          x.data(), b.data(), r.data(),
+                                          &r_inf, threads, kernel),
+                0);
+      EXPECT_NEAR(r_inf, expected, 1e-12);
+      for (int i = 0; i < a.m; ++i) EXPECT_NEAR(r[i], b[i] - ax[i], 1e-12);
+
+      double norm_only = -1.0;
+      ASSERT_EQ(csr_residual_norminf_host(a.m, nnz, 1, a.val.data(),
+                                          a.ptr.data(), a.ind.data(),
+                                          x.data(), b.data(), nullptr,
+                                          &norm_only, threads, kernel),
+                0);
+      EXPECT_EQ(norm_only, r_inf);
+    }
+  }
+}
+
+TEST(CsrSpmvHostTest, ResidualNormKeepsNan) {
+  const Csr a = RandomCsr(400, 400, 0, 11);
+  const int nnz = static_cast<int>(a.ind.size());
+  const std::vector<double> b(a.m, 1.0);
+  std::vector<double> all_nan(a.n, NAN), one_nan(a.n, 0.5);
+  // Read only by the last stored entry, so only the last thread sees it.
+  one_nan[a.ind[a.ptr[a.m] - 1]] = NAN;
+
+  for (CsrSpmvKernel kernel : Kernels()) {
+    for (int threads : {1, 4}) {
+      for (const std::vector<double>* x : {&all_nan, &one_nan}) {
+        double r_inf = 0.0;
+        ASSERT_EQ(csr_residual_norminf_host(a.m, nnz, 0, a.val.data(),
+                                            a.ptr.data(), a.ind.data(),
+                                            x->data(), b.data(), nullptr,
+                                            &r_inf, threads, kernel),
+                  0);
+        EXPECT_TRUE(isnan(r_inf))
+            << csr_spmv_kernel_name(kernel) << " threads " << threads
+            << (x == &all_nan ? " all NaN" : " one NaN");
+      }
+    }
+  }
+}
+
+TEST(CsrSpmvHostTest, SameResultForAnyThreadCount) {
+  const Csr a = RandomCsr(1000, 1000, 0, 3);
+  const int nnz = static_cast<int>(a.ind.size());
+  std::vector<double> x(a.n, 0.1), serial(a.m), threaded(a.m);
+  ASSERT_EQ(csr_spmv_host(a.m, nnz, 0, a.val.data(), a.ptr.data(),
+                          a.ind.data(), 1.0, x.data(), 0.0, serial.data(), 1),
+            0);
+  ASSERT_EQ(csr_spmv_host(a.m, nnz, 0, a.val.data(), a.ptr.data(),
+                          a.ind.data(), 1.0, x.data(), 0.0, threaded.data(),
+                          7),
+            0);
+  EXPECT_EQ(serial, threaded);
+}
+
+TEST(CsrSpmvHostTest, RejectsBadRowPointers) {
+  const std::vector<int> ptr = {1, 2, 3};
+  const std::vector<int> ind = {1, 2};
+  const std::vector<double> val = {1.0, 1.0}, x = {1.0, 1.0};
+  std::vector<double> y(2);
+  EXPECT_NE(csr_spmv_host(2, 2, 0, val.data(), ptr.data(), ind.data(), 1.0,
+                          x.data(), 0.0, y.data()),
+            0);
+  double r_inf;
+  EXPECT_NE(csr_residual_norminf_host(2, 3, 1, val.data(), ptr.data(),
+                                      ind.data(), x.data(), x.data(),
+                                      y.data(), &r_inf),
+            0);
+}
+
+}  // namespace
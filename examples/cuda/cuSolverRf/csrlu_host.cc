@@ -0,0 +1,298 @@
+/*
+ *  Steps 1-5 of cuSolverRf.cpp on the host only, with the in-tree
+ *  reordering and sparse LU in place of the cusolverSp *Host() routines:
+ *
+ *  step 1: read A and set b = ones(n,1)
+ *  step 2: Q = symrcm(A) or Q = symamd(A)
+ *  step 3: B = Q*A*Q^T
+ *  step 4: solve A*x = b by Plu*B*Qlu^T = L*U
+ *  step 5: extract L and U
+ *  step 6: refactor with the values of A on the pattern of L and U
+ *  step 7: solve A*x = b with the refactored L and U
+ *
+ *  How to use
+ *     ./csrlu_host -P=symrcm -file=<file>
+ *     ./csrlu_host -P=symamd -file=<file>
+ *
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+
+#include "examples/cuda/common/norm_helper.h"
+#include "examples/cuda/common/string_helper.h"
+#include "examples/cuda/cuSolverRf/csr_lu.h"
+#include "examples/cuda/cuSolverRf/csr_refactor.h"
+#include "examples/cuda/cuSolverRf/csr_reorder.h"
+#include "examples/cuda/cuSolverRf/csr_spmv.h"
+#include "examples/cuda/cuSolverRf/mmio_csr.h"
+
+namespace {
+
+constexpr char kDefaultSparseMatPath[] =
+    "examples/cuda/cuSolverRf/data/lap2D_5pt_n100.mtx";
+
+double second() {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void Usage() {
+  printf("<options>\n");
+  printf("-h          : display this help\n");
+  printf("-P=<name>    : choose a reordering\n");
+  printf("              symrcm (Reverse Cuthill-McKee)\n");
+  printf("              symamd (Approximate Minimum Degree)\n");
+  printf("-file=<filename> : filename containing a matrix in MM format\n");
+  exit(0);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const char* reorder = "symrcm";
+  char* filename = const_cast<char*>(kDefaultSparseMatPath);
+
+  if (checkCmdLineFlag(argc, (const char**)argv, "h")) {
+    Usage();
+  }
+  if (checkCmdLineFlag(argc, (const char**)argv, "P")) {
+    char* reorderType = NULL;
+    getCmdLineArgumentString(argc, (const char**)argv, "P", &reorderType);
+    if (!reorderType || (STRCASECMP(reorderType, "symrcm") != 0 &&
+                         STRCASECMP(reorderType, "symamd") != 0)) {
+      printf("\nIncorrect argument passed to -P option\n");
+      Usage();
+    }
+    reorder = reorderType;
+  }
+  if (checkCmdLineFlag(argc, (const char**)argv, "file")) {
+    char* fileName = NULL;
+    getCmdLineArgumentString(argc, (const char**)argv, "file", &fileName);
+    if (!fileName) {
+      printf("\nIncorrect filename passed to -file \n ");
+      Usage();
+    }
+    filename = fileName;
+  }
+
+  // the constants used in cusolverSp
+  const double tol = 1.e-14;
+  const double pivot_threshold = 1.0;
+
+  double start, stop;
+  double time_reorder;
+  double time_perm;
+  double time_sp_analysis;
+  double time_sp_factor;
+  double time_sp_solve;
+  double time_sp_extract;
+  double time_rf_setup;
+  double time_rf_refactor;
+  double time_rf_solve;
+
+  printf("step 1.1: read matrix market format\n");
+  printf("Using input file [%s]\n", filename);
+  int rowsA = 0, colsA = 0, nnzA = 0;
+  double* h_csrValA = NULL;
+  int *h_csrRowPtrA = NULL, *h_csrColIndA = NULL;
+  MM_typecode matcode;
+  if (loadMMSparseMatrixHost(filename, true, &rowsA, &colsA, &nnzA, &h_csrValA,
+                             &h_csrRowPtrA, &h_csrColIndA, true, &matcode)) {
+    return 1;
+  }
+  if (mm_is_complex(matcode)) {
+    fprintf(stderr, "Error: only support real matrix\n");
+    return 1;
+  }
+  if (rowsA != colsA) {
+    fprintf(stderr, "Error: only support square matrix\n");
+    return 1;
+  }
+  const int n = rowsA;
+  const int baseA = h_csrRowPtrA[0];
+  if (baseA) {
+    for (int i = 0; i <= n; i++) h_csrRowPtrA[i]--;
+    for (int i = 0; i < nnzA; i++) h_csrColIndA[i]--;
+  }
+  printf("sparse matrix A is %d x %d with %d nonzeros, base=0\n", rowsA, colsA,
+         nnzA);
+
+  printf("step 1.2: set right hand side vector (b) to 1\n");
+  std::vector<double> h_b(n, 1.0), h_x(n), h_r(n), h_bhat(n), h_xhat(n);
+
+  printf("step 2: reorder the matrix to reduce zero fill-in\n");
+  printf("        Q = %s(A) \n", reorder);
+  std::vector<int> h_Qreorder(n);
+  start = second();
+  const bool amd = STRCASECMP(reorder, "symamd") == 0;
+  if ((amd ? csr_symamd_host : csr_symrcm_host)(
+          n, nnzA, 0, h_csrRowPtrA, h_csrColIndA, h_Qreorder.data())) {
+    fprintf(stderr, "Error: %s failed\n", reorder);
+    return 1;
+  }
+  stop = second();
+  time_reorder = stop - start;
+
+  printf("step 3: B = Q*A*Q^T\n");
+  std::vector<int> h_csrRowPtrB(h_csrRowPtrA, h_csrRowPtrA + n + 1);
+  std::vector<int> h_csrColIndB(h_csrColIndA, h_csrColIndA + nnzA);
+  std::vector<double> h_csrValB(nnzA);
+  std::vector<int> h_mapBfromA(nnzA);
+  start = second();
+  // h_mapBfromA = Identity
+  for (int j = 0; j < nnzA; j++) {
+    h_mapBfromA[j] = j;
+  }
+  if (csr_perm_host(n, n, nnzA, 0, h_csrRowPtrB.data(), h_csrColIndB.data(),
+                    h_Qreorder.data(), h_Qreorder.data(),
+                    h_mapBfromA.data())) {
+    fprintf(stderr, "Error: B = Q*A*Q^T failed\n");
+    return 1;
+  }
+  // B = A( mapBfromA )
+  for (int j = 0; j < nnzA; j++) {
+    h_csrValB[j] = h_csrValA[h_mapBfromA[j]];
+  }
+  stop = second();
+  time_perm = stop - start;
+
+  printf("step 4: solve A*x = b by LU(B)\n");
+  CsrLuHost lu;
+  printf("step 4.2: analyze LU(B)\n");
+  start = second();
+  if (lu.Analyze(n, nnzA, 0, h_csrRowPtrB.data(), h_csrColIndB.data())) {
+    fprintf(stderr, "Error: LU analysis failed\n");
+    return 1;
+  }
+  stop = second();
+  time_sp_analysis = stop - start;
+
+  printf("step 4.4: compute Ppivot*B = L*U \n");
+  start = second();
+  lu.Factor(h_csrValB.data(), pivot_threshold);
+  stop = second();
+  time_sp_factor = stop - start;
+
+  printf("step 4.5: check if the matrix is singular \n");
+  int singularity = 0;
+  lu.ZeroPivot(tol, &singularity);
+  if (0 <= singularity) {
+    fprintf(stderr, "Error: A is not invertible, singularity=%d\n",
+            singularity);
+    return 1;
+  }
+
+  printf("step 4.6: solve A*x = b \n");
+  printf("    i.e.  solve B*(Qx) = Q*b \n");
+  start = second();
+  // b_hat = Q*b
+  for (int j = 0; j < n; j++) {
+    h_bhat[j] = h_b[h_Qreorder[j]];
+  }
+  // B*x_hat = b_hat
+  lu.Solve(h_bhat.data(), h_xhat.data());
+  // x = Q^T * x_hat
+  for (int j = 0; j < n; j++) {
+    h_x[h_Qreorder[j]] = h_xhat[j];
+  }
+  stop = second();
+  time_sp_solve = stop - start;
+
+  printf("step 4.7: evaluate residual r = b - A*x (result on CPU)\n");
+  double r_inf = 0.0;
+  csr_residual_norminf_host(n, nnzA, 0, h_csrValA, h_csrRowPtrA, h_csrColIndA,
+                            h_x.data(), h_b.data(), h_r.data(), &r_inf);
+  const double x_inf = vec_norminf_simd(n, h_x.data());
+  const double A_inf =
+      csr_mat_norminf_simd(n, nnzA, 0, h_csrValA, h_csrRowPtrA);
+  printf("(CPU) |b - A*x| = %E \n", r_inf);
+  printf("(CPU) |A| = %E \n", A_inf);
+  printf("(CPU) |x| = %E \n", x_inf);
+  printf("(CPU) |b - A*x|/(|A|*|x|) = %E \n", r_inf / (A_inf * x_inf));
+
+  printf("step 5: extract P, Q, L and U from P*B*Q^T = L*U \n");
+  printf("        L has implicit unit diagonal\n");
+  start = second();
+  int nnzL = 0, nnzU = 0;
+  lu.Nnz(&nnzL, &nnzU);
+  std::vector<int> h_Plu(n), h_Qlu(n);
+  std::vector<int> h_csrRowPtrL(n + 1), h_csrColIndL(nnzL);
+  std::vector<int> h_csrRowPtrU(n + 1), h_csrColIndU(nnzU);
+  std::vector<double> h_csrValL(nnzL), h_csrValU(nnzU);
+  lu.Extract(h_Plu.data(), h_Qlu.data(), h_csrValL.data(),
+             h_csrRowPtrL.data(), h_csrColIndL.data(), h_csrValU.data(),
+             h_csrRowPtrU.data(), h_csrColIndU.data());
+  stop = second();
+  time_sp_extract = stop - start;
+  printf("nnzL = %d, nnzU = %d\n", nnzL, nnzU);
+
+  printf("step 6: cache Q, mapBfromA and the L/U pattern, then refactor\n");
+  CsrRefactorHost rf;
+  start = second();
+  if (rf.Setup(n, nnzA, 0, h_csrRowPtrA, h_csrColIndA, h_Qreorder.data(),
+               h_csrValA, pivot_threshold)) {
+    fprintf(stderr, "Error: refactorization setup failed\n");
+    return 1;
+  }
+  stop = second();
+  time_rf_setup = stop - start;
+
+  start = second();
+  if (rf.Refactor(h_csrValA)) {
+    fprintf(stderr, "Error: refactorization failed\n");
+    return 1;
+  }
+  stop = second();
+  time_rf_refactor = stop - start;
+
+  printf("step 6.5: check if the refactored matrix is singular \n");
+  rf.ZeroPivot(tol, &singularity);
+  if (0 <= singularity) {
+    fprintf(stderr, "Error: refactored A is not invertible, singularity=%d\n",
+            singularity);
+    return 1;
+  }
+
+  printf("step 7: solve A*x = b with the refactored L and U\n");
+  start = second();
+  if (rf.Solve(h_b.data(), h_x.data())) {
+    fprintf(stderr, "Error: refactored solve failed\n");
+    return 1;
+  }
+  stop = second();
+  time_rf_solve = stop - start;
+  csr_residual_norminf_host(n, nnzA, 0, h_csrValA, h_csrRowPtrA, h_csrColIndA,
+                            h_x.data(), h_b.data(), nullptr, &r_inf);
+  printf("(CPU) |b - A*x|/(|A|*|x| + |b|) = %E \n",
+         r_inf / (A_inf * vec_norminf_simd(n, h_x.data()) +
+                  vec_norminf_simd(n, h_b.data())));
+
+  printf("===== statistics \n");
+  printf(" nnz(A) = %d, nnz(L+U) = %d, zero fill-in ratio = %f\n", nnzA,
+         nnzL + nnzU, ((double)(nnzL + nnzU)) / (double)nnzA);
+  printf("\n");
+  printf("===== timing profile \n");
+  printf(" reorder A   : %f sec\n", time_reorder);
+  printf(" B = Q*A*Q^T : %f sec\n", time_perm);
+  printf("\n");
+  printf(" host LU analysis: %f sec\n", time_sp_analysis);
+  printf(" host LU factor  : %f sec\n", time_sp_factor);
+  printf(" host LU solve   : %f sec\n", time_sp_solve);
+  printf(" host LU extract : %f sec\n", time_sp_extract);
+  printf("\n");
+  printf(" host refactor setup   : %f sec\n", time_rf_setup);
+  printf(" host refactor         : %f sec\n", time_rf_refactor);
+  printf(" host refactor solve   : %f sec\n", time_rf_solve);
+
+  free(h_csrValA);
+  free(h_csrRowPtrA);
+  free(h_csrColIndA);
+  return 0;
+}
@@ -23,6 +23,7 @@
  *  How to use
  *     ./cuSolverRf -P=symrcm -file <file>
  *     ./cuSolverRf -P=symamd -file <file>
+ *     ./cuSolverRf -cache -file <file>
  *
  */
 
@@ -41,6 +42,8 @@
 #include "examples/cuda/common/cusolver_helper.h"
 #include "examples/cuda/common/cusparse_helper.h"
 #include "examples/cuda/common/string_helper.h"
+#include "examples/cuda/cuSolverRf/csr_reorder.h"
+#include "examples/cuda/cuSolverRf/csr_spmv.h"
 #include "examples/cuda/cuSolverRf/mmio_wrapper.h"
 
 namespace {
@@ -48,6 +51,9 @@ namespace {
 constexpr char kDefaultSparseMatPath[] =
     "examples/cuda/cuSolverRf/data/lap2D_5pt_n100.mtx";
 
+// Load through the <file>.csrcache sidecar (see csr_cache.h).
+bool use_csr_cache = false;
+
 }  // namespace
 
 template <typename T_ELEM>
@@ -55,6 +61,12 @@ int loadMMSparseMatrix(char* filename, char elem_type, bool csrFormat, int* m,
                        int* n, int* nnz, T_ELEM** aVal, int** aRowInd,
                        int** aColInd, int extendSymMatrix);
 
+template <typename T_ELEM>
+int loadMMSparseMatrixCached(char* filename, char elem_type, bool csrFormat,
+                             int* m, int* n, int* nnz, T_ELEM** aVal,
+                             int** aRowInd, int** aColInd,
+                             int extendSymMatrix);
+
 void UsageRF(void) {
   printf("<options>\n");
   printf("-h          : display this help\n");
@@ -63,6 +75,7 @@ void UsageRF(void) {
   printf("              symamd (Approximate Minimum Degree)\n");
   printf("-file=<filename> : filename containing a matrix in MM format\n");
   printf("-device=<device_id> : <device_id> if want to run on specific GPU\n");
+  printf("-cache      : reuse/write a binary <filename>.csrcache sidecar\n");
 
   exit(0);
 }
@@ -105,6 +118,8 @@ void parseCommandLineArguments(int argc, char* argv[],
       UsageRF();
     }
   }
+
+  use_csr_cache = checkCmdLineFlag(argc, (const char**)argv, "cache");
 }
 
 int main(int argc, char* argv[]) {
@@ -244,11 +259,21 @@ int main(int argc, char* argv[]) {
   }
 
   if (opts.sparse_mat_filename) {
-    if (loadMMSparseMatrix<double>(opts.sparse_mat_filename, 'd', true, &rowsA,
-                                   &colsA, &nnzA, &h_csrValA, &h_csrRowPtrA,
-                                   &h_csrColIndA, true)) {
+    start = second();
+    const int error =
+        use_csr_cache
+            ? loadMMSparseMatrixCached<double>(
+                  opts.sparse_mat_filename, 'd', true, &rowsA, &colsA, &nnzA,
+                  &h_csrValA, &h_csrRowPtrA, &h_csrColIndA, true)
+            : loadMMSparseMatrix<double>(opts.sparse_mat_filename, 'd', true,
+                                         &rowsA, &colsA, &nnzA, &h_csrValA,
+                                         &h_csrRowPtrA, &h_csrColIndA, true);
+    if (error) {
       return 1;
     }
+    stop = second();
+    printf("(CPU) load matrix%s: %f sec\n", use_csr_cache ? " (cached)" : "",
+           stop - start);
     baseA = h_csrRowPtrA[0];  // baseA = {0,1}
   }
 
@@ -333,14 +358,19 @@ int main(int argc, char* argv[]) {
   start = second();
   start = second();
 
+  // multithreaded host orderings, see csr_reorder.h
   if (0 == strcmp(opts.reorder, "symrcm")) {
-    checkCudaErrors(cusolverSpXcsrsymrcmHost(cusolverSpH, rowsA, nnzA, descrA,
-                                             h_csrRowPtrA, h_csrColIndA,
-                                             h_Qreorder));
+    if (csr_symrcm_host(rowsA, nnzA, baseA, h_csrRowPtrA, h_csrColIndA,
+                        h_Qreorder)) {
+      fprintf(stderr, "Error: symrcm failed\n");
+      return 1;
+    }
   } else if (0 == strcmp(opts.reorder, "symamd")) {
-    checkCudaErrors(cusolverSpXcsrsymamdHost(cusolverSpH, rowsA, nnzA, descrA,
-                                             h_csrRowPtrA, h_csrColIndA,
-                                             h_Qreorder));
+    if (csr_symamd_host(rowsA, nnzA, baseA, h_csrRowPtrA, h_csrColIndA,
+                        h_Qreorder)) {
+      fprintf(stderr, "Error: symamd failed\n");
+      return 1;
+    }
   } else {
     fprintf(stderr, "Error: %s is unknow reordering\n", opts.reorder);
     return 1;
@@ -454,56 +484,14 @@ int main(int argc, char* argv[]) {
   time_sp_solve = stop - start;
 
   printf("step 4.7: evaluate residual r = b - A*x (result on CPU)\n");
-  // use GPU gemv to compute r = b - A*x
-  checkCudaErrors(cudaMemcpy(d_csrRowPtrA, h_csrRowPtrA,
-                             sizeof(int) * (rowsA + 1),
-                             cudaMemcpyHostToDevice));
-  checkCudaErrors(cudaMemcpy(d_csrColIndA, h_csrColIndA, sizeof(int) * nnzA,
-                             cudaMemcpyHostToDevice));
-  checkCudaErrors(cudaMemcpy(d_csrValA, h_csrValA, sizeof(double) * nnzA,
-                             cudaMemcpyHostToDevice));
-
-  checkCudaErrors(
-      cudaMemcpy(d_r, h_b, sizeof(double) * rowsA, cudaMemcpyHostToDevice));
-  checkCudaErrors(
-      cudaMemcpy(d_x, h_x, sizeof(double) * colsA, cudaMemcpyHostToDevice));
-
-  /* Wrap raw data into cuSPARSE generic API objects */
-  cusparseSpMatDescr_t matA = NULL;
-  if (baseA) {
-    checkCudaErrors(cusparseCreateCsr(&matA, rowsA, colsA, nnzA, d_csrRowPtrA,
-                                      d_csrColIndA, d_csrValA,
-                                      CUSPARSE_INDEX_32I, CUSPARSE_INDEX_32I,
-                                      CUSPARSE_INDEX_BASE_ONE, CUDA_R_64F));
-  } else {
-    checkCudaErrors(cusparseCreateCsr(&matA, rowsA, colsA, nnzA, d_csrRowPtrA,
-                                      d_csrColIndA, d_csrValA,
-                                      CUSPARSE_INDEX_32I, CUSPARSE_INDEX_32I,
-                                      CUSPARSE_INDEX_BASE_ZERO, CUDA_R_64F));
+  // r = b - A*x and |r| in one pass on the host, see csr_spmv.h
+  if (csr_residual_norminf_host(rowsA, nnzA, baseA, h_csrValA, h_csrRowPtrA,
+                                h_csrColIndA, h_x, h_b, h_r, &r_inf)) {
+    fprintf(stderr, "Error: residual evaluation failed\n");
+    return 1;
   }
 
-  cusparseDnVecDescr_t vecx = NULL;
-  checkCudaErrors(cusparseCreateDnVec(&vecx, colsA, d_x, CUDA_R_64F));
-  cusparseDnVecDescr_t vecAx = NULL;
-  checkCudaErrors(cusparseCreateDnVec(&vecAx, rowsA, d_r, CUDA_R_64F));
-
-  /* Allocate workspace for cuSPARSE */
-  size_t bufferSize = 0;
-  checkCudaErrors(cusparseSpMV_bufferSize(
-      cusparseH, CUSPARSE_OPERATION_NON_TRANSPOSE, &minus_one, matA, vecx, &one,
-      vecAx, CUDA_R_64F, CUSPARSE_SPMV_ALG_DEFAULT, &bufferSize));
-  void* buffer = NULL;
-  checkCudaErrors(cudaMalloc(&buffer, bufferSize));
-
-  checkCudaErrors(cusparseSpMV(cusparseH, CUSPARSE_OPERATION_NON_TRANSPOSE,
-                               &minus_one, matA, vecx, &one, vecAx, CUDA_R_64F,
-                               CUSPARSE_SPMV_ALG_DEFAULT, buffer));
-
-  checkCudaErrors(
-      cudaMemcpy(h_r, d_r, sizeof(double) * rowsA, cudaMemcpyDeviceToHost));
-
   x_inf = vec_norminf(colsA, h_x);
-  r_inf = vec_norminf(rowsA, h_r);
   A_inf = csr_mat_norminf(rowsA, colsA, nnzA, descrA, h_csrValA, h_csrRowPtrA,
                           h_csrColIndA);
 
@@ -511,6 +499,8 @@ int main(int argc, char* argv[]) {
   printf("(CPU) |A| = %E \n", A_inf);
   printf("(CPU) |x| = %E \n", x_inf);
   printf("(CPU) |b - A*x|/(|A|*|x|) = %E \n", r_inf / (A_inf * x_inf));
+  printf("(CPU) |b - A*x|/(|A|*|x| + |b|) = %E \n",
+         r_inf / (A_inf * x_inf + vec_norminf(rowsA, h_b)));
 
   printf("step 5: extract P, Q, L and U from P*B*Q^T = L*U \n");
   printf("        L has implicit unit diagonal\n");
@@ -665,6 +655,33 @@ int main(int argc, char* argv[]) {
   checkCudaErrors(
       cudaMemcpy(d_r, h_b, sizeof(double) * rowsA, cudaMemcpyHostToDevice));
 
+  /* Wrap raw data into cuSPARSE generic API objects */
+  cusparseSpMatDescr_t matA = NULL;
+  if (baseA) {
+    checkCudaErrors(cusparseCreateCsr(&matA, rowsA, colsA, nnzA, d_csrRowPtrA,
+                                      d_csrColIndA, d_csrValA,
+                                      CUSPARSE_INDEX_32I, CUSPARSE_INDEX_32I,
+                                      CUSPARSE_INDEX_BASE_ONE, CUDA_R_64F));
+  } else {
+    checkCudaErrors(cusparseCreateCsr(&matA, rowsA, colsA, nnzA, d_csrRowPtrA,
+                                      d_csrColIndA, d_csrValA,
+                                      CUSPARSE_INDEX_32I, CUSPARSE_INDEX_32I,
+                                      CUSPARSE_INDEX_BASE_ZERO, CUDA_R_64F));
+  }
+
+  cusparseDnVecDescr_t vecx = NULL;
+  checkCudaErrors(cusparseCreateDnVec(&vecx, colsA, d_x, CUDA_R_64F));
+  cusparseDnVecDescr_t vecAx = NULL;
+  checkCudaErrors(cusparseCreateDnVec(&vecAx, rowsA, d_r, CUDA_R_64F));
+
+  /* Allocate workspace for cuSPARSE */
+  size_t bufferSize = 0;
+  checkCudaErrors(cusparseSpMV_bufferSize(
+      cusparseH, CUSPARSE_OPERATION_NON_TRANSPOSE, &minus_one, matA, vecx, &one,
+      vecAx, CUDA_R_64F, CUSPARSE_SPMV_ALG_DEFAULT, &bufferSize));
+  void* buffer = NULL;
+  checkCudaErrors(cudaMalloc(&buffer, bufferSize));
+
   checkCudaErrors(cusparseSpMV(cusparseH, CUSPARSE_OPERATION_NON_TRANSPOSE,
                                &minus_one, matA, vecx, &one, vecAx, CUDA_R_64F,
                                CUSPARSE_SPMV_ALG_DEFAULT, buffer));
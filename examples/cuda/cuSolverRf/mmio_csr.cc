@@ -0,0 +1,237 @@
+#include "examples/cuda/cuSolverRf/mmio_csr.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "examples/cuda/cuSolverRf/coo_convert.h"
+#include "examples/cuda/cuSolverRf/mmio_parallel.h"
+
+int verify_pattern(int m, int nnz, const int* csrRowPtr,
+                   const int* csrColInd) {
+  int i, col, start, end, base_index;
+  int error_found = 0;
+
+  if (nnz != (csrRowPtr[m] - csrRowPtr[0])) {
+    fprintf(stderr,
+            "Error (nnz check failed): (csrRowPtr[%d]=%d - csrRowPtr[%d]=%d) "
+            "!= (nnz=%d)\n",
+            0, csrRowPtr[0], m, csrRowPtr[m], nnz);
+    error_found = 1;
+  }
+
+  base_index = csrRowPtr[0];
+  if ((0 != base_index) && (1 != base_index)) {
+    fprintf(stderr, "Error (base index check failed): base index = %d\n",
+            base_index);
+    error_found = 1;
+  }
+
+  for (i = 0; (!error_found) && (i < m); i++) {
+    start = csrRowPtr[i] - base_index;
+    end = csrRowPtr[i + 1] - base_index;
+    if (start > end) {
+      fprintf(
+          stderr,
+          "Error (corrupted row): csrRowPtr[%d] (=%d) > csrRowPtr[%d] (=%d)\n",
+          i, start + base_index, i + 1, end + base_index);
+      error_found = 1;
+    }
+    for (col = start; col < end; col++) {
+      if (csrColInd[col] < base_index) {
+        fprintf(
+            stderr,
+            "Error (column vs. base index check failed): csrColInd[%d] < %d\n",
+            col, base_index);
+        error_found = 1;
+      }
+      if ((col < (end - 1)) && (csrColInd[col] >= csrColInd[col + 1])) {
+        fprintf(stderr,
+                "Error (sorting of the column indecis check failed): "
+                "(csrColInd[%d]=%d) >= (csrColInd[%d]=%d)\n",
+                col, csrColInd[col], col + 1, csrColInd[col + 1]);
+        error_found = 1;
+      }
+    }
+  }
+  return error_found;
+}
+
+int loadMMSparseMatrixHost(char* filename, bool csrFormat, int* m, int* n,
+                           int* nnz, double** aVal, int** aRowInd,
+                           int** aColInd, int extendSymMatrix,
+                           MM_typecode* matcode) {
+  double* tempVal;
+  int *tempRowInd, *tempColInd;
+  double* tval;
+  int *trow, *tcol;
+  int *csrRowPtr, *cscColPtr;
+  int i, j, error, base, count, values_per_entry;
+  int* perm;
+
+  /* read the matrix */
+  error = mm_read_mtx_crd_parallel(filename, m, n, nnz, &trow, &tcol, &tval,
+                                   matcode);
+  if (error) {
+    fprintf(stderr, "!!!! can not open file: '%s'\n", filename);
+    return 1;
+  }
+
+  /* start error checking */
+  if (mm_is_dense(*matcode) || mm_is_array(*matcode) ||
+      mm_is_pattern(*matcode) /*|| mm_is_integer(*matcode)*/) {
+    fprintf(
+        stderr,
+        "!!!! dense, array, pattern and integer matrices are not supported\n");
+    return 1;
+  }
+  values_per_entry = mm_is_complex(*matcode) ? 2 : 1;
+
+  /* if necessary symmetrize the pattern (transform from triangular to full) */
+  if ((extendSymMatrix) &&
+      (mm_is_symmetric(*matcode) || mm_is_hermitian(*matcode) ||
+       mm_is_skew(*matcode))) {
+    // count number of non-diagonal elements
+    count = 0;
+    for (i = 0; i < (*nnz); i++) {
+      if (trow[i] != tcol[i]) {
+        count++;
+      }
+    }
+    // allocate space for the symmetrized matrix
+    tempRowInd = (int*)malloc((*nnz + count) * sizeof(int));
+    tempColInd = (int*)malloc((*nnz + count) * sizeof(int));
+    tempVal = (double*)malloc(values_per_entry * (*nnz + count) *
+                              sizeof(double));
+    // copy the elements regular and transposed locations
+    for (j = 0, i = 0; i < (*nnz); i++) {
+      tempRowInd[j] = trow[i];
+      tempColInd[j] = tcol[i];
+      if (values_per_entry == 1) {
+        tempVal[j] = tval[i];
+      } else {
+        tempVal[2 * j] = tval[2 * i];
+        tempVal[2 * j + 1] = tval[2 * i + 1];
+      }
+      j++;
+      if (trow[i] != tcol[i]) {
+        tempRowInd[j] = tcol[i];
+        tempColInd[j] = trow[i];
+        if (values_per_entry == 1) {
+          if (mm_is_skew(*matcode)) {
+            tempVal[j] = -tval[i];
+          } else {
+            tempVal[j] = tval[i];
+          }
+        } else {
+          if (mm_is_hermitian(*matcode)) {
+            tempVal[2 * j] = tval[2 * i];
+            tempVal[2 * j + 1] = -tval[2 * i + 1];
+          } else {
+            tempVal[2 * j] = tval[2 * i];
+            tempVal[2 * j + 1] = tval[2 * i + 1];
+          }
+        }
+        j++;
+      }
+    }
+    (*nnz) += count;
+    // free temporary storage
+    free(trow);
+    free(tcol);
+    free(tval);
+  } else {
+    tempRowInd = trow;
+    tempColInd = tcol;
+    tempVal = tval;
+  }
+  // life time of (trow, tcol, tval) is over.
+  // please use COO format (tempRowInd, tempColInd, tempVal)
+
+  // setup base
+  // check if there is any row/col 0, if so base-0
+  // check if there is any row/col equal to matrix dimension m/n, if so base-1
+  int base0 = 0;
+  int base1 = 0;
+  for (i = 0; i < (*nnz); i++) {
+    const int row = tempRowInd[i];
+    const int col = tempColInd[i];
+    if ((0 == row) || (0 == col)) {
+      base0 = 1;
+    }
+    if ((*m == row) || (*n == col)) {
+      base1 = 1;
+    }
+  }
+  if (base0 && base1) {
+    printf("Error: input matrix is base-0 and base-1 \n");
+    return 1;
+  }
+
+  base = 0;
+  if (base1) {
+    base = 1;
+  }
+
+  /* sort by counting sort and compress the appropriate indices; perm[i] is
+   * the COO entry that ends up at position i */
+  perm = (int*)malloc((*nnz) * sizeof(int));
+  if (NULL == perm) {
+    fprintf(stderr, "!!!! allocation error, malloc failed\n");
+    return 1;
+  }
+  if (csrFormat) {
+    /* CSR format (sorted by row and within each row by column) */
+    csrRowPtr = (int*)malloc(((*m) + 1) * sizeof(csrRowPtr[0]));
+    if (!csrRowPtr) return 1;
+    *aRowInd = csrRowPtr;
+    *aColInd = (int*)malloc((*nnz) * sizeof(int));
+    error = coo_to_csr_csc(*m, *n, *nnz, tempRowInd, tempColInd, base,
+                           csrRowPtr, *aColInd, perm, NULL, NULL, NULL, 0);
+  } else {
+    /* CSC format (sorted by column and within each column by row) */
+    cscColPtr = (int*)malloc(((*n) + 1) * sizeof(cscColPtr[0]));
+    if (!cscColPtr) return 1;
+    *aColInd = cscColPtr;
+    *aRowInd = (int*)malloc((*nnz) * sizeof(int));
+    error = coo_to_csr_csc(*m, *n, *nnz, tempRowInd, tempColInd, base, NULL,
+                           NULL, NULL, cscColPtr, *aRowInd, perm, 0);
+  }
+  if (error) {
+    fprintf(stderr, "!!!! row or column index out of range\n");
+    return 1;
+  }
+
+  /* gather the values into compressed order */
+  *aVal = (double*)malloc((*nnz) * values_per_entry * sizeof(double));
+  if (NULL == *aVal) {
+    fprintf(stderr, "!!!! allocation error, malloc failed\n");
+    return 1;
+  }
+  for (i = 0; i < (*nnz); i++) {
+    for (j = 0; j < values_per_entry; j++) {
+      (*aVal)[values_per_entry * i + j] =
+          tempVal[values_per_entry * perm[i] + j];
+    }
+  }
+
+  /* check for corruption */
+  int error_found;
+  if (csrFormat) {
+    error_found = verify_pattern(*m, *nnz, *aRowInd, *aColInd);
+  } else {
+    error_found = verify_pattern(*n, *nnz, *aColInd, *aRowInd);
+  }
+  if (error_found) {
+    fprintf(stderr, "!!!! verify_pattern failed\n");
+    return 1;
+  }
+
+  /* cleanup and exit */
+  free(perm);
+  free(tempVal);
+  free(tempColInd);
+  free(tempRowInd);
+
+  return 0;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "examples/cuda/cuSolverRf/mmio.h"
+
+/*
+ * The CUDA-free part of loadMMSparseMatrix(): reads a MatrixMarket file,
+ * optionally expands symmetric/hermitian/skew storage to the full pattern,
+ * and compresses it to CSR (csrFormat) or CSC with sorted indices. Values
+ * stay doubles, two per entry for complex matrices, in compressed order.
+ *
+ * For CSR, *aRowInd receives the m+1 row pointers and *aColInd the column
+ * indices; for CSC, *aColInd the n+1 column pointers and *aRowInd the row
+ * indices. The index base (0 or 1) is the one used by the file. All outputs
+ * are malloc()ed. Returns 0 on success.
+ */
+int loadMMSparseMatrixHost(char* filename, bool csrFormat, int* m, int* n,
+                           int* nnz, double** aVal, int** aRowInd,
+                           int** aColInd, int extendSymMatrix,
+                           MM_typecode* matcode);
+
+/* Checks that a compressed pattern is consistent and sorted; returns
+ * nonzero and prints the first problem otherwise. */
+int verify_pattern(int m, int nnz, const int* csrRowPtr, const int* csrColInd);
@@ -0,0 +1,303 @@
+#include "examples/cuda/cuSolverRf/mmio_parallel.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "examples/cuda/common/parallel_helper.h"
+
+namespace {
+
+constexpr size_t kMinChunkBytes = 1 << 20;
+
+/* Exact powers of ten representable as double (Clinger's fast path). */
+constexpr double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                             1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                             1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+inline bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+inline bool IsDigit(char c) { return static_cast<unsigned>(c - '0') < 10; }
+
+inline const char* SkipBlanks(const char* p, const char* end) {
+  while (p < end && IsBlank(*p)) ++p;
+  return p;
+}
+
+/* Returns the position after the parsed integer, or nullptr. */
+inline const char* ParseInt(const char* p, const char* end, int* out) {
+  p = SkipBlanks(p, end);
+  bool neg = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    neg = *p == '-';
+    ++p;
+  }
+  if (p == end || !IsDigit(*p)) return nullptr;
+  int64_t v = 0;
+  while (p < end && IsDigit(*p)) {
+    v = v * 10 + (*p - '0');
+    if (v > INT32_MAX) return nullptr;
+    ++p;
+  }
+  *out = static_cast<int>(neg ? -v : v);
+  return p;
+}
+
+/*
+ * Returns the position after the parsed double, or nullptr. Mantissas of at
+ * most 19 significant digits with a small decimal exponent are converted
+ * exactly by one multiplication or division; anything else goes through
+ * std::from_chars, so results always match a correctly rounded strtod().
+ */
+inline const char* ParseDouble(const char* p, const char* end, double* out) {
+  p = SkipBlanks(p, end);
+  const char* start = p;
+  bool neg = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    neg = *p == '-';
+    ++p;
+  }
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exp10 = 0;
+  bool any = false;
+  while (p < end && IsDigit(*p)) {
+    if (digits < 19) {
+      mantissa = mantissa * 10 + (*p - '0');
+      if (mantissa != 0) ++digits;
+    } else {
+      ++exp10;
+      ++digits;
+    }
+    any = true;
+    ++p;
+  }
+  if (p < end && *p == '.') {
+    ++p;
+    while (p < end && IsDigit(*p)) {
+      if (digits < 19) {
+        mantissa = mantissa * 10 + (*p - '0');
+        if (mantissa != 0) ++digits;
+        --exp10;
+      } else {
+        ++digits;
+      }
+      any = true;
+      ++p;
+    }
+  }
+  if (!any) {
+    /* inf, nan and friends, which fscanf("%lg") accepts as well. */
+    while (p < end && !IsBlank(*p) && *p != '\n') ++p;
+    if (start < p && *start == '+') ++start;
+    const auto res = std::from_chars(start, p, *out);
+    return res.ec == std::errc() && res.ptr == p ? p : nullptr;
+  }
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    int e = 0;
+    /* ParseInt() skips blanks, which an exponent must not contain. */
+    if (p + 1 == end || IsBlank(p[1])) return nullptr;
+    const char* q = ParseInt(p + 1, end, &e);
+    if (q == nullptr) return nullptr;
+    exp10 += e;
+    p = q;
+  }
+  if (p < end && !IsBlank(*p) && *p != '\n') return nullptr;
+
+  if (digits <= 19 && mantissa < (uint64_t{1} << 53) && exp10 >= -22 &&
+      exp10 <= 22) {
+    double v = static_cast<double>(mantissa);
+    v = exp10 < 0 ? v / kPow10[-exp10] : v * kPow10[exp10];
+    *out = neg ? -v : v;
+    return p;
+  }
+  if (*start == '+') ++start;
+  const auto res = std::from_chars(start, p, *out);
+  return res.ec == std::errc() ? p : nullptr;
+}
+
+/* Moves p to the first character of the next line. */
+inline const char* NextLine(const char* p, const char* end) {
+  const void* nl = std::memchr(p, '\n', end - p);
+  return nl ? static_cast<const char*>(nl) + 1 : end;
+}
+
+struct Chunk {
+  const char* begin;
+  const char* end;
+  std::vector<int> I;
+  std::vector<int> J;
+  std::vector<double> val;
+  int error = 0;
+};
+
+void ParseChunk(Chunk* c, int values_per_entry) {
+  const size_t estimate = (c->end - c->begin) / 16 + 1;
+  c->I.reserve(estimate);
+  c->J.reserve(estimate);
+  c->val.reserve(estimate * values_per_entry);
+  const char* p = c->begin;
+  while (p < c->end) {
+    const char* q = SkipBlanks(p, c->end);
+    if (q == c->end) break;
+    if (*q == '\n') {
+      p = q + 1;
+      continue;
+    }
+    int i, j;
+    double v[2];
+    q = ParseInt(q, c->end, &i);
+    if (q) q = ParseInt(q, c->end, &j);
+    for (int k = 0; q && k < values_per_entry; ++k) {
+      q = ParseDouble(q, c->end, &v[k]);
+    }
+    if (q == nullptr) {
+      c->error = MM_PREMATURE_EOF;
+      return;
+    }
+    c->I.push_back(i);
+    c->J.push_back(j);
+    for (int k = 0; k < values_per_entry; ++k) c->val.push_back(v[k]);
+    p = NextLine(q, c->end);
+  }
+}
+
+int ValuesPerEntry(const MM_typecode matcode) {
+  if (mm_is_complex(matcode)) return 2;
+  if (mm_is_real(matcode) || mm_is_integer(matcode)) return 1;
+  if (mm_is_pattern(matcode)) return 0;
+  return -1;
+}
+
+}  // namespace
+
+int mm_parse_mtx_crd_data(const char* begin, const char* end, int nz, int I[],
+                          int J[], double val[], MM_typecode matcode,
+                          int num_threads) {
+  const int values_per_entry = ValuesPerEntry(matcode);
+  if (values_per_entry < 0) return MM_UNSUPPORTED_TYPE;
+
+  const size_t bytes = end - begin;
+  num_threads = static_cast<int>(
+      std::min<size_t>(ParallelThreads(bytes, num_threads, kMinChunkBytes),
+                       std::max<size_t>(bytes, 1)));
+
+  /* Split at newline boundaries so no entry straddles two chunks. */
+  std::vector<Chunk> chunks(num_threads);
+  const char* p = begin;
+  for (int t = 0; t < num_threads; ++t) {
+    chunks[t].begin = p;
+    const char* split = begin + bytes * (t + 1) / num_threads;
+    p = t + 1 == num_threads ? end : NextLine(std::max(p, split), end);
+    chunks[t].end = p;
+  }
+
+  ParallelFor(num_threads,
+              [&](int t) { ParseChunk(&chunks[t], values_per_entry); });
+
+  /* Entries past nz are ignored, like the fscanf() loop does. */
+  std::vector<size_t> offsets(num_threads + 1, 0);
+  for (int t = 0; t < num_threads; ++t) {
+    offsets[t + 1] = offsets[t] + chunks[t].I.size();
+  }
+  for (int t = 0; t < num_threads; ++t) {
+    if (chunks[t].error && offsets[t] < static_cast<size_t>(nz)) {
+      return chunks[t].error;
+    }
+  }
+  if (offsets[num_threads] < static_cast<size_t>(nz)) return MM_PREMATURE_EOF;
+
+  ParallelFor(num_threads, [&](int t) {
+    if (offsets[t] >= static_cast<size_t>(nz)) return;
+    const size_t n = std::min<size_t>(chunks[t].I.size(), nz - offsets[t]);
+    std::copy_n(chunks[t].I.data(), n, I + offsets[t]);
+    std::copy_n(chunks[t].J.data(), n, J + offsets[t]);
+    if (values_per_entry > 0) {
+      std::copy_n(chunks[t].val.data(), n * values_per_entry,
+                  val + offsets[t] * values_per_entry);
+    }
+  });
+  return 0;
+}
+
+int mm_read_mtx_crd_parallel_n(const char* fname, int* M, int* N, int* nz,
+                               int** I, int** J, double** val,
+                               MM_typecode* matcode, int num_threads) {
+  FILE* f = fopen(fname, "r");
+  if (f == NULL) return MM_COULD_NOT_READ_FILE;
+
+  int ret_code;
+  if ((ret_code = mm_read_banner(f, matcode)) != 0) {
+    fclose(f);
+    return ret_code;
+  }
+  if (!(mm_is_valid(*matcode) && mm_is_sparse(*matcode) &&
+        mm_is_matrix(*matcode))) {
+    fclose(f);
+    return MM_UNSUPPORTED_TYPE;
+  }
+  if ((ret_code = mm_read_mtx_crd_size(f, M, N, nz)) != 0) {
+    fclose(f);
+    return ret_code;
+  }
+  const long body = ftell(f);
+  const int fd = dup(fileno(f));
+  fclose(f);
+  if (body < 0 || fd < 0) {
+    if (fd >= 0) close(fd);
+    return MM_COULD_NOT_READ_FILE;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return MM_COULD_NOT_READ_FILE;
+  }
+  const size_t size = static_cast<size_t>(st.st_size);
+  void* base = nullptr;
+  if (size > 0) {
+    base = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (base == MAP_FAILED) return MM_COULD_NOT_READ_FILE;
+  if (base != nullptr) madvise(base, size, MADV_SEQUENTIAL);
+
+  const int values_per_entry = ValuesPerEntry(*matcode);
+  *I = (int*)malloc(*nz * sizeof(int));
+  *J = (int*)malloc(*nz * sizeof(int));
+  *val = NULL;
+  if (values_per_entry > 0) {
+    *val = (double*)malloc(*nz * values_per_entry * sizeof(double));
+  }
+
+  const char* bytes = static_cast<const char*>(base);
+  ret_code = mm_parse_mtx_crd_data(bytes + std::min<size_t>(body, size),
+                                   bytes + size, *nz, *I, *J, *val, *matcode,
+                                   num_threads);
+  if (base != nullptr) munmap(base, size);
+  if (ret_code != 0) {
+    free(*I);
+    free(*J);
+    free(*val);
+    *I = *J = NULL;
+    *val = NULL;
+  }
+  return ret_code;
+}
+
+int mm_read_mtx_crd_parallel(char* fname, int* M, int* N, int* nz, int** I,
+                             int** J, double** val, MM_typecode* matcode) {
+  if (strcmp(fname, "stdin") == 0) {
+    return mm_read_mtx_crd(fname, M, N, nz, I, J, val, matcode);
+  }
+  return mm_read_mtx_crd_parallel_n(fname, M, N, nz, I, J, val, matcode, 0);
+}
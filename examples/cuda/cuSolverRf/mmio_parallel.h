@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+
+#include "examples/cuda/cuSolverRf/mmio.h"
+
+/*
+ * Multithreaded Matrix Market coordinate reader.
+ *
+ * The header is read with mm_read_banner()/mm_read_mtx_crd_size(), after
+ * which the body is memory-mapped, split at newline boundaries into one
+ * chunk per thread and scanned without stdio or the C locale. Results are
+ * identical to mm_read_mtx_crd(): 1-based indices exactly as in the file,
+ * and 2*nz values for complex matrices.
+ */
+
+/* Drop-in replacement for mm_read_mtx_crd(). "stdin" falls back to it. */
+int mm_read_mtx_crd_parallel(char* fname, int* M, int* N, int* nz, int** I,
+                             int** J, double** val, MM_typecode* matcode);
+
+/* Same as above with an explicit thread count; num_threads <= 0 picks one
+ * thread per hardware core, capped so that no chunk is tiny. */
+int mm_read_mtx_crd_parallel_n(const char* fname, int* M, int* N, int* nz,
+                               int** I, int** J, double** val,
+                               MM_typecode* matcode, int num_threads);
+
+/* Parses exactly nz entries from the body text [begin, end) into
+ * caller-allocated I/J/val (val may be NULL for pattern matrices). */
+int mm_parse_mtx_crd_data(const char* begin, const char* end, int nz, int I[],
+                          int J[], double val[], MM_typecode matcode,
+                          int num_threads);
@@ -0,0 +1,114 @@
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "examples/cuda/cuSolverRf/mmio_parallel.h"
+
+// How to run:
+// bazel run -c opt //examples/cuda/cuSolverRf:mmio_parallel_benchmark
+namespace {
+
+// Writes the 7-point Laplacian of an n^3 grid (lower triangle, symmetric),
+// the same family as the bundled lap3D_7pt_n20.mtx.
+std::string MakeLaplacian3D(int n) {
+  const auto path = std::filesystem::temp_directory_path() /
+                    ("lap3D_7pt_n" + std::to_string(n) + ".mtx");
+  if (std::filesystem::exists(path)) {
+    return path.string();
+  }
+  FILE* f = fopen(path.c_str(), "w");
+  if (f == nullptr) std::abort();
+  const int rows = n * n * n;
+  const long nz = rows + 3L * (n - 1) * n * n;
+  fprintf(f, "%%%%MatrixMarket matrix coordinate real symmetric\n");
+  fprintf(f, "%d %d %ld\n", rows, rows, nz);
+  for (int z = 0; z < n; ++z) {
+    for (int y = 0; y < n; ++y) {
+      for (int x = 0; x < n; ++x) {
+        const int row = (z * n + y) * n + x + 1;
+        fprintf(f, "%d %d  6\n", row, row);
+        if (x + 1 < n) fprintf(f, "%d %d -1\n", row + 1, row);
+        if (y + 1 < n) fprintf(f, "%d %d -1\n", row + n, row);
+        if (z + 1 < n) fprintf(f, "%d %d -1\n", row + n * n, row);
+      }
+    }
+  }
+  fclose(f);
+  return path.string();
+}
+
+const std::string& MatrixPath(int index) {
+  static const auto* paths = new std::vector<std::string>{
+      "examples/cuda/cuSolverRf/data/lap2D_5pt_n100.mtx",
+      "examples/cuda/cuSolverRf/data/lap3D_7pt_n20.mtx",
+      MakeLaplacian3D(100),
+      MakeLaplacian3D(200),
+  };
+  return (*paths)[index];
+}
+
+void Finish(benchmark::State& state, const std::string& path, int* I, int* J,
+            double* val) {
+  free(I);
+  free(J);
+  free(val);
+  state.SetLabel(std::filesystem::path(path).filename().string());
+  state.SetBytesProcessed(state.iterations() *
+                          std::filesystem::file_size(path));
+}
+
+void BM_Fscanf(benchmark::State& state) {
+  const std::string& path = MatrixPath(state.range(0));
+  int M, N, nz;
+  int *I = nullptr, *J = nullptr;
+  double* val = nullptr;
+  MM_typecode matcode;
+  for (auto _ : state) {
+    free(I);
+    free(J);
+    free(val);
+    if (mm_read_mtx_crd(const_cast<char*>(path.c_str()), &M, &N, &nz, &I, &J,
+                        &val, &matcode) != 0) {
+      state.SkipWithError("mm_read_mtx_crd failed");
+      break;
+    }
+  }
+  Finish(state, path, I, J, val);
+}
+
+void BM_Parallel(benchmark::State& state) {
+  const std::string& path = MatrixPath(state.range(0));
+  const int threads = static_cast<int>(state.range(1));
+  int M, N, nz;
+  int *I = nullptr, *J = nullptr;
+  double* val = nullptr;
+  MM_typecode matcode;
+  for (auto _ : state) {
+    free(I);
+    free(J);
+    free(val);
+    if (mm_read_mtx_crd_parallel_n(path.c_str(), &M, &N, &nz, &I, &J, &val,
+                                   &matcode, threads) != 0) {
+      state.SkipWithError("mm_read_mtx_crd_parallel_n failed");
+      break;
+    }
+  }
+  Finish(state, path, I, J, val);
+}
+
+// Matrices: 0, 1 are bundled; 2 (~50 MB) and 3 (~400 MB) are synthetic.
+BENCHMARK(BM_Fscanf)
+    ->ArgName("matrix")
+    ->DenseRange(0, 3)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_Parallel)
+    ->ArgNames({"matrix", "threads"})
+    ->ArgsProduct({{0, 1, 2, 3}, {1, 2, 4, 8, 16}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,151 @@
+#include "examples/cuda/cuSolverRf/mmio_parallel.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct CooMatrix {
+  int M = 0, N = 0, nz = 0;
+  int* I = nullptr;
+  int* J = nullptr;
+  double* val = nullptr;
+  MM_typecode matcode;
+
+  ~CooMatrix() {
+    free(I);
+    free(J);
+    free(val);
+  }
+};
+
+void ExpectSameMatrix(const CooMatrix& a, const CooMatrix& b) {
+  ASSERT_EQ(a.M, b.M);
+  ASSERT_EQ(a.N, b.N);
+  ASSERT_EQ(a.nz, b.nz);
+  ASSERT_EQ(std::memcmp(a.matcode, b.matcode, sizeof(MM_typecode)), 0);
+  const int values = mm_is_complex(a.matcode) ? 2 : 1;
+  for (int k = 0; k < a.nz; ++k) {
+    ASSERT_EQ(a.I[k], b.I[k]) << "entry " << k;
+    ASSERT_EQ(a.J[k], b.J[k]) << "entry " << k;
+    if (!mm_is_pattern(a.matcode)) {
+      for (int v = 0; v < values; ++v) {
+        // Bitwise equality: the scanner must round exactly like strtod().
+        ASSERT_EQ(a.val[values * k + v], b.val[values * k + v])
+            << "entry " << k;
+      }
+    }
+  }
+}
+
+void CompareWithFscanf(const std::string& path, int num_threads) {
+  CooMatrix expected, actual;
+  ASSERT_EQ(mm_read_mtx_crd(const_cast<char*>(path.c_str()), &expected.M,
+                            &expected.N, &expected.nz, &expected.I,
+                            &expected.J, &expected.val, &expected.matcode),
+            0);
+  ASSERT_EQ(mm_read_mtx_crd_parallel_n(path.c_str(), &actual.M, &actual.N,
+                                       &actual.nz, &actual.I, &actual.J,
+                                       &actual.val, &actual.matcode,
+                                       num_threads),
+            0);
+  ExpectSameMatrix(expected, actual);
+}
+
+std::string WriteTemp(const std::string& name, const std::string& text) {
+  const std::string path = ::testing::TempDir() + name;
+  std::ofstream(path, std::ios::binary) << text;
+  return path;
+}
+
+TEST(MmioParallelTest, BundledMatrices) {
+  for (const char* path : {"examples/cuda/cuSolverRf/data/lap2D_5pt_n100.mtx",
+                           "examples/cuda/cuSolverRf/data/lap3D_7pt_n20.mtx"}) {
+    for (int threads : {1, 3, 8}) {
+      SCOPED_TRACE(path);
+      CompareWithFscanf(path, threads);
+    }
+  }
+}
+
+TEST(MmioParallelTest, NumberFormats) {
+  const std::string path = WriteTemp(
+      "formats.mtx",
+      "%%MatrixMarket matrix coordinate real general\n"
+      "% comment\n"
+      "4 4 9\n"
+      "1 1 4\n"
+      "2\t1\t-1.5\r\n"
+      "  3 2 +2.5e-3\n"
+      "\n"
+      "4 3 1E+10\n"
+      "1 2 0.1\n"
+      "2 2 123456789012345678901234567890\n"
+      "3 3 -0.000000000000000000000000123\n"
+      "4 4 .5\n"
+      "3 4 1.7976931348623157e308\n");
+  for (int threads : {1, 2, 5}) {
+    CompareWithFscanf(path, threads);
+  }
+}
+
+TEST(MmioParallelTest, RandomValues) {
+  std::mt19937_64 rng(7);
+  std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+  std::uniform_int_distribution<int> exponent(-40, 40);
+  const char* formats[] = {"%d %d %.17g\n", "%d %d %g\n", "%d %d %.6e\n",
+                           "%d %d %20.16g\n", "%d %d %.3f\n"};
+  const int nz = 20000;
+  std::string text = "%%MatrixMarket matrix coordinate real general\n";
+  text += std::to_string(nz) + " " + std::to_string(nz) + " " +
+          std::to_string(nz) + "\n";
+  char line[128];
+  for (int k = 0; k < nz; ++k) {
+    const double v = std::ldexp(mantissa(rng), exponent(rng));
+    std::snprintf(line, sizeof(line), formats[k % 5], k + 1, nz - k, v);
+    text += line;
+  }
+  const std::string path = WriteTemp("random.mtx", text);
+  for (int threads : {1, 4}) {
+    CompareWithFscanf(path, threads);
+  }
+}
+
+TEST(MmioParallelTest, ComplexAndPattern) {
+  CompareWithFscanf(WriteTemp("complex.mtx",
+                              "%%MatrixMarket matrix coordinate complex "
+                              "hermitian\n3 3 3\n1 1 1 0\n2 1 0.5 -0.25\n"
+                              "3 3 2 0\n"),
+                    2);
+  CompareWithFscanf(WriteTemp("pattern.mtx",
+                              "%%MatrixMarket matrix coordinate pattern "
+                              "general\n3 3 3\n1 1\n2 1\n3 3\n"),
+                    2);
+}
+
+TEST(MmioParallelTest, PrematureEof) {
+  CooMatrix m;
+  const std::string path = WriteTemp(
+      "short.mtx",
+      "%%MatrixMarket matrix coordinate real general\n3 3 3\n1 1 1\n2 2 2\n");
+  EXPECT_EQ(mm_read_mtx_crd_parallel_n(path.c_str(), &m.M, &m.N, &m.nz, &m.I,
+                                       &m.J, &m.val, &m.matcode, 2),
+            MM_PREMATURE_EOF);
+
+  const std::string bad = WriteTemp(
+      "bad.mtx",
+      "%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 x\n2 2 2\n");
+  EXPECT_EQ(mm_read_mtx_crd_parallel_n(bad.c_str(), &m.M, &m.N, &m.nz, &m.I,
+                                       &m.J, &m.val, &m.matcode, 1),
+            MM_PREMATURE_EOF);
+  EXPECT_EQ(m.I, nullptr);
+}
+
+}  // namespace
@@ -29,17 +29,43 @@
 
 #include "examples/cuda/randomFog/rng.h"
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 #include <stdexcept>
 
 const unsigned int RNG::s_maxQrngDimensions = 20000;
 
+static bool useDevice(RNG::Backend backend) {
+  if (backend != RNG::Auto) {
+    return backend == RNG::Device;
+  }
+
+  int deviceCount = 0;
+  return cudaGetDeviceCount(&deviceCount) == cudaSuccess && deviceCount > 0;
+}
+
 RNG::RNG(unsigned long prngSeed, unsigned int qrngDimensions,
-         unsigned int nSamples)
-    : m_prngSeed(prngSeed),
+         unsigned int nSamples, Backend backend)
+    : m_onDevice(useDevice(backend)),
+      m_type(Pseudo),
+      m_pCurrent(&m_prng),
+      m_prng(NULL),
+      m_qrng(NULL),
+      m_sqrng(NULL),
+      m_hqrng(false),
+      m_hsqrng(true),
+      m_prngSeed(prngSeed),
       m_qrngDimensions(qrngDimensions),
       m_nSamplesBatchTarget(nSamples),
-      m_nSamplesRemaining(0) {
+      m_nSamplesRemaining(0),
+      m_h_samples(NULL),
+      m_d_samples(NULL),
+      m_doubleBuffered(false),
+      m_h_next(NULL),
+      m_hqrngSaved(false),
+      m_offsetSaved(0),
+      m_offsets() {
   using std::invalid_argument;
   using std::runtime_error;
   using std::string;
@@ -71,6 +97,13 @@ RNG::RNG(unsigned long prngSeed, unsigned int qrngDimensions,
     throw runtime_error("Could not allocate host memory for RNG::m_h_samples");
   }
 
+  if (!m_onDevice) {
+    resetSeed();
+    updateDimensions();
+    setBatchSize();
+    return;
+  }
+
   // Allocate sample array in device mem
   cudaResult =
       cudaMalloc((void**)&m_d_samples, m_nSamplesBatchTarget * sizeof(float));
@@ -111,15 +144,19 @@ RNG::RNG(unsigned long prngSeed, unsigned int qrngDimensions,
   resetSeed();
   updateDimensions();
   setBatchSize();
-
-  // Set default RNG to be pseudo-random (XORWOW)
-  m_pCurrent = &m_prng;
 }
 
 RNG::~RNG() {
-  curandDestroyGenerator(m_prng);
-  curandDestroyGenerator(m_qrng);
-  curandDestroyGenerator(m_sqrng);
+  // Only wait for the producer; there is nothing left to rewind
+  if (m_prefetch.valid()) {
+    m_prefetch.wait();
+  }
+
+  if (m_onDevice) {
+    curandDestroyGenerator(m_prng);
+    curandDestroyGenerator(m_qrng);
+    curandDestroyGenerator(m_sqrng);
+  }
 
   if (m_d_samples) {
     cudaFree(m_d_samples);
@@ -128,12 +165,36 @@ RNG::~RNG() {
   if (m_h_samples) {
     free(m_h_samples);
   }
+
+  if (m_h_next) {
+    free(m_h_next);
+  }
 }
 
-void RNG::generateBatch(void) {
+void RNG::generateBatch(float* h_samples) {
   using std::runtime_error;
   using std::string;
 
+  if (!m_onDevice) {
+    // The host generators write straight into h_samples, in parallel
+    switch (m_type) {
+      case Quasi:
+        m_hqrng.GenerateUniform(h_samples, m_nSamplesBatchActual);
+        break;
+
+      case ScrambledQuasi:
+        m_hsqrng.GenerateUniform(h_samples, m_nSamplesBatchActual);
+        break;
+
+      case Pseudo:
+      default:
+        m_hprng.GenerateUniform(h_samples, m_nSamplesBatchActual);
+        break;
+    }
+
+    return;
+  }
+
   cudaError_t cudaResult;
   curandStatus_t curandResult;
 
@@ -147,9 +208,14 @@ void RNG::generateBatch(void) {
     throw runtime_error(msg);
   }
 
+  // cuRAND counts the offset of a quasi-random generator in points
+  m_offsets[m_type] += (m_type == Pseudo)
+                           ? m_nSamplesBatchActual
+                           : m_nSamplesBatchActual / m_qrngDimensions;
+
   // Copy random numbers to host
   cudaResult =
-      cudaMemcpy(m_h_samples, m_d_samples,
+      cudaMemcpy(h_samples, m_d_samples,
                  m_nSamplesBatchActual * sizeof(float), cudaMemcpyDeviceToHost);
 
   if (cudaResult != cudaSuccess) {
@@ -159,13 +225,112 @@ void RNG::generateBatch(void) {
   }
 }
 
+void RNG::refill(void) {
+  if (!m_doubleBuffered) {
+    generateBatch(m_h_samples);
+  } else {
+    // Take the prefetched batch if there is one, then start the next
+    if (m_prefetch.valid()) {
+      m_prefetch.get();
+      std::swap(m_h_samples, m_h_next);
+    } else {
+      generateBatch(m_h_samples);
+    }
+
+    saveGenerator();
+    m_prefetch =
+        std::async(std::launch::async, &RNG::generateBatch, this, m_h_next);
+  }
+
+  m_nSamplesRemaining = m_nSamplesBatchActual;
+}
+
+void RNG::cancelPrefetch(void) {
+  // Wait for the producer before the generators change under it; its
+  // batch, or its error, is dropped and the generator rewound to where a
+  // single-buffered RNG would have left it
+  if (m_prefetch.valid()) {
+    m_prefetch.wait();
+    m_prefetch = std::future<void>();
+    restoreGenerator();
+  }
+}
+
+void RNG::saveGenerator(void) {
+  if (m_onDevice) {
+    m_offsetSaved = m_offsets[m_type];
+    return;
+  }
+
+  switch (m_type) {
+    case Quasi:
+      m_hqrngSaved = m_hqrng;
+      break;
+
+    case ScrambledQuasi:
+      m_hqrngSaved = m_hsqrng;
+      break;
+
+    case Pseudo:
+    default:
+      m_hprngSaved = m_hprng;
+      break;
+  }
+}
+
+void RNG::restoreGenerator(void) {
+  if (!m_onDevice) {
+    switch (m_type) {
+      case Quasi:
+        m_hqrng = m_hqrngSaved;
+        break;
+
+      case ScrambledQuasi:
+        m_hsqrng = m_hqrngSaved;
+        break;
+
+      case Pseudo:
+      default:
+        m_hprng = m_hprngSaved;
+        break;
+    }
+
+    return;
+  }
+
+  m_offsets[m_type] = m_offsetSaved;
+  curandStatus_t curandResult =
+      curandSetGeneratorOffset(*m_pCurrent, m_offsetSaved);
+
+  if (curandResult != CURAND_STATUS_SUCCESS) {
+    std::string msg("Could not rewind random number generator: ");
+    msg += curandResult;
+    throw std::runtime_error(msg);
+  }
+}
+
+void RNG::setDoubleBuffered(bool enabled) {
+  cancelPrefetch();
+
+  if (enabled && m_h_next == NULL) {
+    m_h_next = (float*)malloc(m_nSamplesBatchTarget * sizeof(float));
+
+    if (m_h_next == NULL) {
+      throw std::runtime_error(
+          "Could not allocate host memory for RNG::m_h_next");
+    }
+  }
+
+  m_doubleBuffered = enabled;
+  setBatchSize();
+}
+
 float RNG::getNextU01(void) {
   if (m_nSamplesRemaining == 0) {
-    generateBatch();
-    m_nSamplesRemaining = m_nSamplesBatchActual;
+    refill();
   }
 
-  if (m_pCurrent == &m_prng) {
+  if (m_type == Pseudo) {
     return m_h_samples[m_nSamplesBatchActual - m_nSamplesRemaining--];
   } else {
     unsigned int index = m_nSamplesBatchActual - m_nSamplesRemaining--;
@@ -176,36 +341,87 @@ float RNG::getNextU01(void) {
   }
 }
 
+void RNG::getNextU01(float* out, size_t n) {
+  while (n > 0) {
+    if (m_nSamplesRemaining == 0) {
+      refill();
+    }
+
+    unsigned int count =
+        (unsigned int)std::min<size_t>(n, m_nSamplesRemaining);
+    unsigned int index = m_nSamplesBatchActual - m_nSamplesRemaining;
+
+    if (m_type == Pseudo) {
+      memcpy(out, m_h_samples + index, count * sizeof(float));
+    } else {
+      // Gather point by point from the dimension-major batch
+      unsigned int samplesPerDim = m_nSamplesBatchActual / m_qrngDimensions;
+      unsigned int dim = index % m_qrngDimensions;
+      unsigned int draw = index / m_qrngDimensions;
+
+      for (unsigned int i = 0; i < count; ++i) {
+        out[i] = m_h_samples[dim * samplesPerDim + draw];
+
+        if (++dim == m_qrngDimensions) {
+          dim = 0;
+          ++draw;
+        }
+      }
+    }
+
+    m_nSamplesRemaining -= count;
+    out += count;
+    n -= count;
+  }
+}
+
 void RNG::getInfoString(std::string& msg) {
   using std::stringstream;
 
   stringstream ss;
 
-  if (m_pCurrent == &m_prng) {
-    ss << "XORWOW (seed=" << m_prngSeed << ")";
-  } else if (m_pCurrent == &m_qrng) {
-    ss << "Sobol (dimensions=" << m_qrngDimensions << ")";
-  } else if (m_pCurrent == &m_sqrng) {
-    ss << "Scrambled Sobol (dimensions=" << m_qrngDimensions << ")";
-  } else {
-    ss << "Invalid RNG";
+  switch (m_type) {
+    case Pseudo:
+      ss << "XORWOW (seed=" << m_prngSeed << ")";
+      break;
+
+    case Quasi:
+      ss << "Sobol (dimensions=" << m_qrngDimensions << ")";
+      break;
+
+    case ScrambledQuasi:
+      ss << "Scrambled Sobol (dimensions=" << m_qrngDimensions << ")";
+      break;
+
+    default:
+      ss << "Invalid RNG";
+      break;
+  }
+
+  if (!m_onDevice) {
+    ss << " [host]";
   }
 
   msg.assign(ss.str());
 }
 
 void RNG::selectRng(RNG::RngType type) {
+  cancelPrefetch();
+
   switch (type) {
     case Quasi:
+      m_type = Quasi;
       m_pCurrent = &m_qrng;
       break;
 
     case ScrambledQuasi:
+      m_type = ScrambledQuasi;
       m_pCurrent = &m_sqrng;
       break;
 
     case Pseudo:
     default:
+      m_type = Pseudo;
       m_pCurrent = &m_prng;
       break;
   }
@@ -216,6 +432,14 @@ void RNG::selectRng(RNG::RngType type) {
 void RNG::resetSeed(void) {
   using std::runtime_error;
 
+  cancelPrefetch();
+
+  if (!m_onDevice) {
+    m_hprng.SetSeed(m_prngSeed);
+    setBatchSize();
+    return;
+  }
+
   curandStatus_t curandResult;
   curandResult = curandSetPseudoRandomGeneratorSeed(m_prng, m_prngSeed);
 
@@ -233,16 +457,22 @@ void RNG::resetSeed(void) {
     throw runtime_error(msg);
   }
 
+  m_offsets[Pseudo] = 0;
+
   setBatchSize();
 }
 
 void RNG::resetDimensions(void) {
+  cancelPrefetch();
+
   m_qrngDimensions = 1;
   updateDimensions();
   setBatchSize();
 }
 
 void RNG::incrementDimensions(void) {
+  cancelPrefetch();
+
   if (++m_qrngDimensions > s_maxQrngDimensions) {
     m_qrngDimensions = 1;
   }
@@ -254,6 +484,12 @@ void RNG::incrementDimensions(void) {
 void RNG::updateDimensions(void) {
   using std::runtime_error;
 
+  if (!m_onDevice) {
+    m_hqrng.SetDimensions(m_qrngDimensions);
+    m_hsqrng.SetDimensions(m_qrngDimensions);
+    return;
+  }
+
   curandStatus_t curandResult;
   curandResult =
       curandSetQuasiRandomGeneratorDimensions(m_qrng, m_qrngDimensions);
@@ -290,10 +526,13 @@ void RNG::updateDimensions(void) {
     msg += curandResult;
     throw runtime_error(msg);
   }
+
+  m_offsets[Quasi] = 0;
+  m_offsets[ScrambledQuasi] = 0;
 }
 
 void RNG::setBatchSize(void) {
-  if (m_pCurrent == &m_prng) {
+  if (m_type == Pseudo) {
     m_nSamplesBatchActual = m_nSamplesBatchTarget;
   } else {
     m_nSamplesBatchActual =
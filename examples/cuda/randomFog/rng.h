@@ -26,31 +26,51 @@
  */
 #pragma once
 
+#include <stddef.h>
+
+#include <future>
 #include <string>
 
 #include "cuda/include/curand.h"
+#include "examples/cuda/randomFog/rng_host.h"
 
 // RNGs
 class RNG {
  public:
   enum RngType { Pseudo, Quasi, ScrambledQuasi };
+  // Where batches are generated. Auto uses the GPU when one is present and
+  // the host generators in rng_host.h otherwise.
+  enum Backend { Auto, Device, Host };
   RNG(unsigned long prngSeed, unsigned int qrngDimensions,
-      unsigned int nSamples);
+      unsigned int nSamples, Backend backend = Auto);
   virtual ~RNG();
 
   float getNextU01(void);
+  // Copies the next n samples to out, in the order getNextU01() returns them
+  void getNextU01(float* out, size_t n);
   void getInfoString(std::string& msg);
   void selectRng(RngType type);
   void resetSeed(void);
   void resetDimensions(void);
   void incrementDimensions(void);
+  bool onDevice(void) const { return m_onDevice; }
+  // When enabled, the next batch is generated in the background while the
+  // current one is consumed. The samples returned are the same either way:
+  // changing the generator or its parameters drops the prefetched batch and
+  // rewinds the generator that made it.
+  void setDoubleBuffered(bool enabled);
 
  private:
   // Generators
+  const bool m_onDevice;
+  RngType m_type;
   curandGenerator_t* m_pCurrent;
   curandGenerator_t m_prng;
   curandGenerator_t m_qrng;
   curandGenerator_t m_sqrng;
+  XorwowHost m_hprng;
+  Sobol32Host m_hqrng;
+  Sobol32Host m_hsqrng;
 
   // Parameters
   unsigned long m_prngSeed;
@@ -60,7 +80,11 @@ class RNG {
   const unsigned int m_nSamplesBatchTarget;
   unsigned int m_nSamplesBatchActual;
   unsigned int m_nSamplesRemaining;
-  void generateBatch(void);
+  void generateBatch(float* h_samples);
+  void refill(void);
+  void cancelPrefetch(void);
+  void saveGenerator(void);
+  void restoreGenerator(void);
 
   // Helpers
   void updateDimensions(void);
@@ -70,5 +94,18 @@ class RNG {
   float* m_h_samples;
   float* m_d_samples;
 
+  // Double buffering: m_prefetch fills m_h_next while m_h_samples is read
+  bool m_doubleBuffered;
+  float* m_h_next;
+  std::future<void> m_prefetch;
+
+  // State of the current generator from before the prefetched batch
+  XorwowHost m_hprngSaved;
+  Sobol32Host m_hqrngSaved;
+  unsigned long long m_offsetSaved;
+
+  // Offsets of the device generators, by RngType; cuRAND has no getter
+  unsigned long long m_offsets[3];
+
   static const unsigned int s_maxQrngDimensions;
 };
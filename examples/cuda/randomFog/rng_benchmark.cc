@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "examples/cuda/randomFog/rng.h"
+
+// How to run:
+// bazel run -c opt //examples/cuda/randomFog:rng_benchmark
+namespace {
+
+constexpr unsigned int kBatch = 1 << 18;
+
+// Arguments: RngType, double buffered.
+void SetUp(RNG* rng, benchmark::State& state) {
+  rng->selectRng(static_cast<RNG::RngType>(state.range(0)));
+  rng->setDoubleBuffered(state.range(1) != 0);
+  state.SetLabel(state.range(1) != 0 ? "double buffered" : "sync");
+}
+
+// Sustained rate of one getNextU01() per sample.
+void BM_Single(benchmark::State& state) {
+  RNG rng(1, 3, kBatch);
+  SetUp(&rng, state);
+  for (auto _ : state) {
+    for (int i = 0; i < 1024; ++i) benchmark::DoNotOptimize(rng.getNextU01());
+  }
+  state.SetItemsProcessed(state.iterations() * 1024);
+}
+
+// Sustained rate of getNextU01(out, n).
+void BM_Span(benchmark::State& state) {
+  RNG rng(1, 3, kBatch);
+  SetUp(&rng, state);
+  std::vector<float> out(state.range(2));
+  for (auto _ : state) {
+    rng.getNextU01(out.data(), out.size());
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * out.size());
+}
+
+// Latency of single calls, including those that refill; with some work
+// between calls the producer can run ahead of the consumer.
+void BM_SingleLatency(benchmark::State& state) {
+  using Clock = std::chrono::steady_clock;
+  RNG rng(1, 3, kBatch);
+  SetUp(&rng, state);
+  const int work = static_cast<int>(state.range(2));
+  std::vector<double> ns;
+  ns.reserve(1 << 22);
+  float sum = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < 1024; ++i) {
+      const Clock::time_point t0 = Clock::now();
+      const float x = rng.getNextU01();
+      const Clock::time_point t1 = Clock::now();
+      if (ns.size() < ns.capacity()) {
+        ns.push_back(
+            std::chrono::duration<double, std::nano>(t1 - t0).count());
+      }
+      for (int w = 0; w < work; ++w) sum += x * w;
+      benchmark::DoNotOptimize(sum);
+    }
+  }
+  std::sort(ns.begin(), ns.end());
+  auto percentile = [&](double p) {
+    if (ns.empty()) return 0.0;
+    return ns[std::min(ns.size() - 1, static_cast<size_t>(p * ns.size()))];
+  };
+  state.counters["p50_ns"] = percentile(0.5);
+  state.counters["p99_ns"] = percentile(0.99);
+  state.counters["p99.99_ns"] = percentile(0.9999);
+  state.counters["max_ns"] = ns.empty() ? 0.0 : ns.back();
+  state.SetItemsProcessed(state.iterations() * 1024);
+}
+
+BENCHMARK(BM_Single)
+    ->ArgsProduct({{RNG::Pseudo, RNG::Quasi}, {0, 1}})
+    ->UseRealTime();
+BENCHMARK(BM_Span)
+    ->ArgsProduct({{RNG::Pseudo, RNG::Quasi}, {0, 1}, {64, 1 << 16}})
+    ->UseRealTime();
+BENCHMARK(BM_SingleLatency)
+    ->ArgsProduct({{RNG::Pseudo}, {0, 1}, {0, 200}})
+    ->UseRealTime();
+
+}  // namespace
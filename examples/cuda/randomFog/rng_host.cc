@@ -0,0 +1,317 @@
+#include "examples/cuda/randomFog/rng_host.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "examples/cuda/common/parallel_helper.h"
+
+namespace {
+
+// Below this many outputs per thread, spawning threads costs more than it
+// saves.
+constexpr long long kMinPerThread = 1 << 15;
+
+/* curand_uniform(): (0, 1], and exact because 2^-32 is a power of two. */
+inline float Uniform(unsigned int x) {
+  return static_cast<float>(x) * 0x1p-32f + 0x1p-33f;
+}
+
+int NumThreads(size_t n, int num_threads, int max_threads) {
+  return std::min(ParallelThreads(static_cast<long long>(n), num_threads,
+                                  kMinPerThread),
+                  std::max(max_threads, 1));
+}
+
+uint64_t SplitMix64(uint64_t* x) {
+  uint64_t z = (*x += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+//===========================================================================
+// XORWOW
+//===========================================================================
+
+constexpr int kXorwowBits = 160;
+
+// Enough powers of the step matrix for skipahead_sequence(n < 2^64).
+constexpr int kXorwowPowers = 67 + 64;
+
+/*
+ * The xorshift part of XORWOW as a 160x160 matrix over GF(2): column b is
+ * the image of the state with only bit b % 32 of word b / 32 set.
+ */
+struct XorwowMatrix {
+  uint32_t col[kXorwowBits][5];
+
+  void Apply(uint32_t v[5]) const {
+    uint32_t r[5] = {0, 0, 0, 0, 0};
+    for (int w = 0; w < 5; ++w) {
+      for (uint32_t bits = v[w]; bits != 0; bits &= bits - 1) {
+        const uint32_t* c = col[w * 32 + __builtin_ctz(bits)];
+        for (int i = 0; i < 5; ++i) r[i] ^= c[i];
+      }
+    }
+    std::copy(r, r + 5, v);
+  }
+};
+
+/* powers[i] is the step matrix to the power 2^i. */
+const std::vector<XorwowMatrix>& XorwowPowers() {
+  static const std::vector<XorwowMatrix>* powers = [] {
+    auto* p = new std::vector<XorwowMatrix>(kXorwowPowers);
+    XorwowMatrix& step = (*p)[0];
+    for (int b = 0; b < kXorwowBits; ++b) {
+      uint32_t v[5] = {0, 0, 0, 0, 0};
+      v[b / 32] = 1u << (b % 32);
+      const uint32_t t = v[0] ^ (v[0] >> 2);
+      step.col[b][0] = v[1];
+      step.col[b][1] = v[2];
+      step.col[b][2] = v[3];
+      step.col[b][3] = v[4];
+      step.col[b][4] = (v[4] ^ (v[4] << 4)) ^ (t ^ (t << 1));
+    }
+    for (int i = 1; i < kXorwowPowers; ++i) {
+      (*p)[i] = (*p)[i - 1];
+      for (int b = 0; b < kXorwowBits; ++b) {
+        (*p)[i - 1].Apply((*p)[i].col[b]);
+      }
+    }
+    return p;
+  }();
+  return *powers;
+}
+
+}  // namespace
+
+XorwowState::XorwowState(unsigned long long seed,
+                         unsigned long long subsequence,
+                         unsigned long long offset) {
+  // Break up seed, apply salt, mix up bits; constants as in curand_init().
+  const unsigned int s0 = static_cast<unsigned int>(seed) ^ 0xaad26b49u;
+  const unsigned int s1 = static_cast<unsigned int>(seed >> 32) ^ 0xf7dcefddu;
+  const unsigned int t0 = 1099087573u * s0;
+  const unsigned int t1 = 2591861531u * s1;
+  d_ = 6615241u + t1 + t0;
+  v_[0] = 123456789u + t0;
+  v_[1] = 362436069u ^ t0;
+  v_[2] = 521288629u + t1;
+  v_[3] = 88675123u ^ t1;
+  v_[4] = 5783321u + t0;
+  SkipaheadSequence(subsequence);
+  Skipahead(offset);
+}
+
+void XorwowState::Skipahead(unsigned long long n) {
+  d_ += static_cast<unsigned int>(n) * 362437u;
+  const std::vector<XorwowMatrix>& powers = XorwowPowers();
+  for (int i = 0; n != 0; ++i, n >>= 1) {
+    if (n & 1) powers[i].Apply(v_);
+  }
+}
+
+void XorwowState::SkipaheadSequence(unsigned long long n) {
+  // 2^67 * 362437 is a multiple of 2^32, so d does not move.
+  const std::vector<XorwowMatrix>& powers = XorwowPowers();
+  for (int i = 67; n != 0; ++i, n >>= 1) {
+    if (n & 1) powers[i].Apply(v_);
+  }
+}
+
+bool XorwowState::operator==(const XorwowState& other) const {
+  return d_ == other.d_ && std::equal(v_, v_ + 5, other.v_);
+}
+
+XorwowHost::XorwowHost(unsigned long long seed) { SetSeed(seed); }
+
+void XorwowHost::SetSeed(unsigned long long seed) {
+  m_states.assign(1, XorwowState(seed, 0, 0));
+  m_states.reserve(kSubsequences);
+  for (int s = 1; s < kSubsequences; ++s) {
+    m_states.push_back(m_states.back());
+    m_states.back().SkipaheadSequence(1);
+  }
+  m_offset = 0;
+}
+
+void XorwowHost::GenerateUniform(float* out, size_t n, int num_threads) {
+  if (m_states.empty()) {
+    throw std::logic_error("XorwowHost::GenerateUniform: no seed set");
+  }
+  if (n == 0) return;
+  const unsigned long long begin = m_offset, end = m_offset + n;
+  const unsigned long long K = kSubsequences;
+  num_threads = NumThreads(n, num_threads, kSubsequences);
+
+  // Thread t owns subsequences [s0, s1) and walks the output row by row,
+  // so each thread writes contiguous runs and each state moves in order.
+  ParallelFor(num_threads, [&](int t) {
+    const unsigned long long s0 = K * t / num_threads;
+    const unsigned long long s1 = K * (t + 1) / num_threads;
+    for (unsigned long long row = begin / K; row * K < end; ++row) {
+      const unsigned long long lo = std::max(row * K + s0, begin);
+      const unsigned long long hi = std::min(row * K + s1, end);
+      for (unsigned long long i = lo; i < hi; ++i) {
+        out[i - begin] = Uniform(m_states[i - row * K].Next());
+      }
+    }
+  });
+  m_offset = end;
+}
+
+//===========================================================================
+// Sobol32
+//===========================================================================
+
+namespace {
+
+constexpr int kSobolBits = 32;
+
+/* a * b mod p over GF(2), for p of degree deg <= 31. */
+uint64_t MulMod(uint64_t a, uint64_t b, uint64_t p, int deg) {
+  uint64_t r = 0;
+  for (; b != 0; b &= b - 1) r ^= a << __builtin_ctzll(b);
+  for (int i = 2 * deg; i >= deg; --i) {
+    if (r >> i & 1) r ^= p << (i - deg);
+  }
+  return r;
+}
+
+uint64_t PowMod(uint64_t e, uint64_t p, int deg) {
+  uint64_t r = 1, x = 2;
+  for (; e != 0; e >>= 1) {
+    if (e & 1) r = MulMod(r, x, p, deg);
+    x = MulMod(x, x, p, deg);
+  }
+  return r;
+}
+
+/*
+ * Whether x has order 2^deg - 1 modulo p, i.e. p is primitive. primes are
+ * the prime factors of 2^deg - 1.
+ */
+bool IsPrimitive(uint64_t p, int deg, const std::vector<uint64_t>& primes) {
+  const uint64_t x = MulMod(2, 1, p, deg);
+  uint64_t y = x;
+  for (int i = 0; i < deg; ++i) y = MulMod(y, y, p, deg);
+  if (y != x) return false;  // x^(2^deg) != x
+  const uint64_t order = (1ull << deg) - 1;
+  for (uint64_t q : primes) {
+    if (PowMod(order / q, p, deg) == 1) return false;
+  }
+  return true;
+}
+
+std::vector<uint64_t> PrimeFactors(uint64_t n) {
+  std::vector<uint64_t> primes;
+  for (uint64_t q = 2; q * q <= n; ++q) {
+    if (n % q != 0) continue;
+    primes.push_back(q);
+    while (n % q == 0) n /= q;
+  }
+  if (n > 1) primes.push_back(n);
+  return primes;
+}
+
+struct SobolTables {
+  std::vector<uint32_t> v;         // kSobolBits direction numbers per dim
+  std::vector<uint32_t> scramble;  // one constant per dimension
+};
+
+const SobolTables& GetSobolTables() {
+  static const SobolTables* tables = [] {
+    const unsigned int dims = Sobol32Host::kMaxDimensions;
+    auto* t = new SobolTables;
+    t->v.resize(static_cast<size_t>(dims) * kSobolBits);
+    t->scramble.resize(dims);
+
+    // Dimension 1: van der Corput.
+    for (int k = 0; k < kSobolBits; ++k) t->v[k] = 1u << (31 - k);
+
+    // Primitive polynomials x^s + a_1 x^(s-1) + ... + a_(s-1) x + 1 in
+    // increasing order, a = a_1...a_(s-1) in binary.
+    unsigned int d = 1;
+    for (int s = 1; d < dims; ++s) {
+      const std::vector<uint64_t> primes = PrimeFactors((1ull << s) - 1);
+      for (uint64_t a = 0; a < (1ull << (s - 1)) && d < dims; ++a) {
+        const uint64_t p = (1ull << s) | (a << 1) | 1;
+        // An even number of terms means x + 1 divides p.
+        if (s > 1 && __builtin_popcountll(p) % 2 == 0) continue;
+        if (!IsPrimitive(p, s, primes)) continue;
+
+        uint32_t* v = &t->v[static_cast<size_t>(d) * kSobolBits];
+        uint64_t state = d;
+        for (int k = 1; k <= s; ++k) {
+          // Odd m_k < 2^k.
+          const uint32_t m = static_cast<uint32_t>(
+              (SplitMix64(&state) % (1ull << (k - 1))) * 2 + 1);
+          v[k - 1] = m << (32 - k);
+        }
+        for (int k = s; k < kSobolBits; ++k) {
+          v[k] = v[k - s] ^ (v[k - s] >> s);
+          for (int j = 1; j < s; ++j) {
+            if (a >> (s - 1 - j) & 1) v[k] ^= v[k - j];
+          }
+        }
+        ++d;
+      }
+    }
+
+    uint64_t state = 0x5c4a3b1ed6f9e027ull;
+    for (unsigned int i = 0; i < dims; ++i) {
+      t->scramble[i] = static_cast<uint32_t>(SplitMix64(&state) >> 32);
+    }
+    return t;
+  }();
+  return *tables;
+}
+
+}  // namespace
+
+Sobol32Host::Sobol32Host(bool scrambled)
+    : m_scrambled(scrambled), m_dimensions(1), m_offset(0) {}
+
+void Sobol32Host::SetDimensions(unsigned int dimensions) {
+  if (dimensions == 0 || dimensions > kMaxDimensions) {
+    throw std::invalid_argument("Sobol32Host dimensions out of range");
+  }
+  m_dimensions = dimensions;
+  m_offset = 0;
+}
+
+void Sobol32Host::GenerateUniform(float* out, size_t n, int num_threads) {
+  if (n % m_dimensions != 0) {
+    throw std::invalid_argument(
+        "Sobol32Host::GenerateUniform: n must be a multiple of dimensions");
+  }
+  if (n == 0) return;
+  const SobolTables& tables = GetSobolTables();
+  const size_t points = n / m_dimensions;
+  num_threads = NumThreads(n, num_threads, 1 << 16);
+
+  // Thread t owns out[n * t / num_threads, n * (t + 1) / num_threads) and
+  // starts each dimension it touches from the Gray code of its first point.
+  ParallelFor(num_threads, [&](int t) {
+    const size_t lo = n * t / num_threads, hi = n * (t + 1) / num_threads;
+    for (size_t pos = lo; pos < hi;) {
+      const size_t d = pos / points;
+      const size_t end = std::min(hi, (d + 1) * points);
+      const uint32_t* v = &tables.v[d * kSobolBits];
+      // Sobol32 has 2^32 points; the index wraps like curand's.
+      unsigned int i = static_cast<unsigned int>(m_offset + pos % points);
+      uint32_t x = m_scrambled ? tables.scramble[d] : 0;
+      for (uint32_t g = i ^ (i >> 1); g != 0; g &= g - 1) {
+        x ^= v[__builtin_ctz(g)];
+      }
+      for (; pos < end; ++pos, ++i) {
+        out[pos] = Uniform(x);
+        x ^= v[__builtin_ctz(~i | 0x80000000u)];
+      }
+    }
+  });
+  m_offset += points;
+}
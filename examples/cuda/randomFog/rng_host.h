@@ -0,0 +1,111 @@
+#pragma once
+
+/*
+ * Host counterparts of the cuRAND generators used by RNG, for machines
+ * without a GPU.
+ *
+ * XorwowState reproduces curand_init() and curand() for
+ * curandStateXORWOW_t bit for bit, including skipahead() and
+ * skipahead_sequence(). XorwowHost interleaves kSubsequences such states
+ * the way a GPU grid does: offset n of its output is draw
+ * n / kSubsequences of subsequence n % kSubsequences.
+ *
+ * Sobol32Host generates Sobol32 and scrambled Sobol32 points with
+ * Gray-code updates (x ^= v[ctz(~i)], as curand() does for
+ * curandStateSobol32_t). Dimension 1 is the van der Corput sequence.
+ * Higher dimensions take the primitive polynomials in the order of the
+ * Joe-Kuo tables (by degree, then by coefficients), but their initial
+ * direction numbers and the scramble constants come from SplitMix64, so
+ * those dimensions differ from the GPU sequence.
+ *
+ * Every generator converts a 32-bit draw x to a float in (0, 1] as
+ * curand_uniform() does: x * 2^-32 + 2^-33. Batches are generated by
+ * several threads; the output does not depend on the thread count.
+ */
+
+#include <stddef.h>
+
+#include <vector>
+
+/* curandStateXORWOW_t on the host. */
+class XorwowState {
+ public:
+  /* curand_init(seed, subsequence, offset, &state) */
+  XorwowState(unsigned long long seed, unsigned long long subsequence,
+              unsigned long long offset);
+
+  /* curand(&state) */
+  unsigned int Next() {
+    const unsigned int t = v_[0] ^ (v_[0] >> 2);
+    v_[0] = v_[1];
+    v_[1] = v_[2];
+    v_[2] = v_[3];
+    v_[3] = v_[4];
+    v_[4] = (v_[4] ^ (v_[4] << 4)) ^ (t ^ (t << 1));
+    d_ += 362437;
+    return v_[4] + d_;
+  }
+
+  /* skipahead(n, &state): n draws in O(log n). */
+  void Skipahead(unsigned long long n);
+
+  /* skipahead_sequence(n, &state): n subsequences of 2^67 draws. */
+  void SkipaheadSequence(unsigned long long n);
+
+  bool operator==(const XorwowState& other) const;
+
+ private:
+  unsigned int d_;
+  unsigned int v_[5];
+};
+
+/* CURAND_RNG_PSEUDO_XORWOW on the host. */
+class XorwowHost {
+ public:
+  static const int kSubsequences = 4096;
+
+  /* Unseeded; call SetSeed() before generating. */
+  XorwowHost() : m_offset(0) {}
+  explicit XorwowHost(unsigned long long seed);
+
+  /* Restarts the output at offset 0 of the sequence of seed. */
+  void SetSeed(unsigned long long seed);
+
+  /*
+   * Writes the next n uniform floats. Throws std::logic_error if no seed
+   * has been set.
+   */
+  void GenerateUniform(float* out, size_t n, int num_threads = 0);
+
+ private:
+  std::vector<XorwowState> m_states;  // one per subsequence
+  unsigned long long m_offset;        // outputs generated so far
+};
+
+/* CURAND_RNG_QUASI_SOBOL32 and CURAND_RNG_QUASI_SCRAMBLED_SOBOL32. */
+class Sobol32Host {
+ public:
+  static const unsigned int kMaxDimensions = 20000;
+
+  explicit Sobol32Host(bool scrambled);
+
+  /*
+   * Restarts every dimension at point 0. Throws std::invalid_argument
+   * unless 1 <= dimensions <= kMaxDimensions.
+   */
+  void SetDimensions(unsigned int dimensions);
+  unsigned int dimensions() const { return m_dimensions; }
+
+  /*
+   * Writes the next n / dimensions points dimension by dimension, as
+   * curandGenerateUniform() does: out[d * (n / dimensions) + i] is
+   * coordinate d of point i. Throws std::invalid_argument unless n is a
+   * multiple of the dimension count.
+   */
+  void GenerateUniform(float* out, size_t n, int num_threads = 0);
+
+ private:
+  bool m_scrambled;
+  unsigned int m_dimensions;
+  unsigned long long m_offset;  // points generated so far
+};
@@ -0,0 +1,64 @@
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "examples/cuda/randomFog/rng_host.h"
+
+// How to run:
+// bazel run -c opt //examples/cuda/randomFog:rng_host_benchmark
+namespace {
+
+// One curand() per call through a single state.
+void BM_XorwowStateLoop(benchmark::State& state) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  std::vector<float> x(n);
+  XorwowState rng(1, 0, 0);
+  for (auto _ : state) {
+    for (size_t i = 0; i < n; ++i) {
+      x[i] = static_cast<float>(rng.Next()) * 0x1p-32f + 0x1p-33f;
+    }
+    benchmark::DoNotOptimize(x.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Arguments: values, threads.
+void BM_XorwowHost(benchmark::State& state) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  std::vector<float> x(n);
+  XorwowHost rng(1);
+  for (auto _ : state) {
+    rng.GenerateUniform(x.data(), n, static_cast<int>(state.range(1)));
+    benchmark::DoNotOptimize(x.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Arguments: values, dimensions, threads, scrambled.
+void BM_Sobol32Host(benchmark::State& state) {
+  const unsigned int dims = static_cast<unsigned int>(state.range(1));
+  const size_t n = state.range(0) / dims * dims;
+  std::vector<float> x(n);
+  Sobol32Host rng(state.range(3) != 0);
+  rng.SetDimensions(dims);
+  for (auto _ : state) {
+    rng.GenerateUniform(x.data(), n, static_cast<int>(state.range(2)));
+    benchmark::DoNotOptimize(x.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+void BM_XorwowSeed(benchmark::State& state) {
+  XorwowHost rng;
+  for (auto _ : state) rng.SetSeed(state.iterations());
+}
+
+BENCHMARK(BM_XorwowStateLoop)->Arg(1 << 20);
+BENCHMARK(BM_XorwowHost)
+    ->ArgsProduct({{40000, 1 << 20}, {1, 4}})
+    ->UseRealTime();
+BENCHMARK(BM_Sobol32Host)
+    ->ArgsProduct({{40000, 1 << 20}, {1, 3, 20000}, {1, 4}, {0, 1}})
+    ->UseRealTime();
+BENCHMARK(BM_XorwowSeed);
+
+}  // namespace
@@ -0,0 +1,235 @@
+#include "examples/cuda/randomFog/rng_host.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+// curand_init(seed, 0, 0) and curand() as written in curand_kernel.h.
+struct ReferenceXorwow {
+  unsigned int d, v[5];
+  explicit ReferenceXorwow(unsigned long long seed) {
+    unsigned int s0 = ((unsigned int)seed) ^ 0xaad26b49UL;
+    unsigned int s1 = (unsigned int)(seed >> 32) ^ 0xf7dcefddUL;
+    unsigned int t0 = 1099087573UL * s0;
+    unsigned int t1 = 2591861531UL * s1;
+    d = 6615241 + t1 + t0;
+    v[0] = 123456789UL + t0;
+    v[1] = 362436069UL ^ t0;
+    v[2] = 521288629UL + t1;
+    v[3] = 88675123UL ^ t1;
+    v[4] = 5783321UL + t0;
+  }
+  unsigned int operator()() {
+    unsigned int t;
+    t = (v[0] ^ (v[0] >> 2));
+    v[0] = v[1];
+    v[1] = v[2];
+    v[2] = v[3];
+    v[3] = v[4];
+    v[4] = (v[4] ^ (v[4] << 4)) ^ (t ^ (t << 1));
+    d += 362437;
+    return v[4] + d;
+  }
+};
+
+float Uniform(unsigned int x) {
+  return x * 2.3283064e-10f + (2.3283064e-10f / 2.0f);
+}
+
+unsigned int ReverseBits(unsigned int x) {
+  unsigned int r = 0;
+  for (int i = 0; i < 32; ++i, x >>= 1) r = (r << 1) | (x & 1);
+  return r;
+}
+
+TEST(XorwowStateTest, MatchesCurand) {
+  for (unsigned long long seed : {0ull, 1ull, 12345ull, 0xdeadbeefcafeull}) {
+    ReferenceXorwow reference(seed);
+    XorwowState state(seed, 0, 0);
+    for (int i = 0; i < 10000; ++i) ASSERT_EQ(state.Next(), reference()) << i;
+  }
+}
+
+TEST(XorwowStateTest, SkipaheadMatchesStepping) {
+  for (unsigned long long n : {0ull, 1ull, 5ull, 160ull, 4097ull, 100003ull}) {
+    XorwowState stepped(7, 0, 0), jumped(7, 0, 0);
+    for (unsigned long long i = 0; i < n; ++i) stepped.Next();
+    jumped.Skipahead(n);
+    EXPECT_TRUE(jumped == stepped) << n;
+    EXPECT_TRUE(XorwowState(7, 0, n) == stepped) << n;
+  }
+}
+
+TEST(XorwowStateTest, SubsequencesAre2Pow67Apart) {
+  // 2^67 draws as sixteen skips of 2^63.
+  XorwowState skipped(9, 0, 0);
+  for (int i = 0; i < 16; ++i) skipped.Skipahead(1ull << 63);
+  EXPECT_TRUE(skipped == XorwowState(9, 1, 0));
+
+  XorwowState sequence(9, 2, 0);
+  sequence.SkipaheadSequence(3);
+  EXPECT_TRUE(sequence == XorwowState(9, 5, 0));
+  EXPECT_FALSE(sequence == XorwowState(9, 4, 0));
+}
+
+TEST(XorwowHostTest, InterleavesSubsequences) {
+  const int K = XorwowHost::kSubsequences;
+  const size_t n = 3 * K + 123;
+  XorwowHost host(42);
+  std::vector<float> x(n);
+  host.GenerateUniform(x.data(), n, 1);
+  for (int s : {0, 1, 17, K - 1}) {
+    XorwowState state(42, s, 0);
+    for (size_t i = s; i < n; i += K) {
+      ASSERT_EQ(x[i], Uniform(state.Next())) << "subsequence " << s;
+    }
+  }
+  for (float u : x) {
+    ASSERT_GT(u, 0.0f);
+    ASSERT_LE(u, 1.0f);
+  }
+}
+
+TEST(XorwowHostTest, BatchesContinueOneSequence) {
+  const size_t n = 100000;
+  std::vector<float> whole(n);
+  XorwowHost(3).GenerateUniform(whole.data(), n, 1);
+
+  for (int threads : {1, 2, 5, 64}) {
+    XorwowHost host(3);
+    std::vector<float> x(n);
+    size_t done = 0;
+    for (size_t batch : {1, 4095, 4097, 50000}) {
+      host.GenerateUniform(x.data() + done, batch, threads);
+      done += batch;
+    }
+    host.GenerateUniform(x.data() + done, n - done, threads);
+    EXPECT_EQ(x, whole) << threads << " threads";
+
+    host.SetSeed(3);
+    host.GenerateUniform(x.data(), n, threads);
+    EXPECT_EQ(x, whole) << threads << " threads after SetSeed";
+  }
+}
+
+TEST(XorwowHostTest, RequiresSeed) {
+  XorwowHost host;
+  float x;
+  EXPECT_THROW(host.GenerateUniform(&x, 1), std::logic_error);
+}
+
+TEST(Sobol32HostTest, FirstDimensionIsVanDerCorput) {
+  const size_t n = 1 << 12;
+  Sobol32Host sobol(false);
+  std::vector<float> x(n);
+  sobol.GenerateUniform(x.data(), n, 1);
+  for (unsigned int i = 0; i < n; ++i) {
+    ASSERT_EQ(x[i], Uniform(ReverseBits(i ^ (i >> 1)))) << i;
+  }
+}
+
+TEST(Sobol32HostTest, SecondDimensionUsesXPlusOne) {
+  Sobol32Host sobol(false);
+  sobol.SetDimensions(2);
+  std::vector<float> x(8);
+  sobol.GenerateUniform(x.data(), x.size(), 1);
+  const float expect[] = {0.0f, 0.5f, 0.25f, 0.75f};
+  for (int i = 0; i < 4; ++i) EXPECT_EQ(x[4 + i], Uniform(expect[i] * 0x1p32f));
+}
+
+TEST(Sobol32HostTest, EveryDimensionIsStratified) {
+  // The first 2^m points of any Sobol dimension hit each of the 2^m
+  // intervals [k / 2^m, (k + 1) / 2^m) exactly once.
+  const unsigned int dims = Sobol32Host::kMaxDimensions;
+  const size_t points = 1 << 8;
+  Sobol32Host sobol(false);
+  sobol.SetDimensions(dims);
+  std::vector<float> x(points * dims);
+  sobol.GenerateUniform(x.data(), x.size());
+  for (unsigned int d = 0; d < dims; ++d) {
+    std::vector<int> hits(points);
+    for (size_t i = 0; i < points; ++i) {
+      ++hits[static_cast<size_t>(x[d * points + i] * points)];
+    }
+    for (size_t k = 0; k < points; ++k) {
+      ASSERT_EQ(hits[k], 1) << "dimension " << d << " interval " << k;
+    }
+  }
+}
+
+TEST(Sobol32HostTest, ScrambledDiffersButStaysInRange) {
+  const unsigned int dims = 16;
+  const size_t n = dims * 1000;
+  Sobol32Host plain(false), scrambled(true);
+  plain.SetDimensions(dims);
+  scrambled.SetDimensions(dims);
+  std::vector<float> x(n), y(n);
+  plain.GenerateUniform(x.data(), n);
+  scrambled.GenerateUniform(y.data(), n);
+  EXPECT_NE(x, y);
+  for (float u : y) {
+    ASSERT_GT(u, 0.0f);
+    ASSERT_LE(u, 1.0f);
+  }
+}
+
+class Sobol32HostLayoutTest : public ::testing::TestWithParam<bool> {};
+
+TEST_P(Sobol32HostLayoutTest, BatchesAndThreadsDoNotChangePoints) {
+  const unsigned int dims = 7;
+  const size_t points = 30001;
+  Sobol32Host sobol(GetParam());
+  sobol.SetDimensions(dims);
+  std::vector<float> whole(dims * points);
+  sobol.GenerateUniform(whole.data(), whole.size(), 1);
+
+  for (int threads : {1, 3, 8}) {
+    // Two batches: points [0, 10000) then [10000, points).
+    Sobol32Host again(GetParam());
+    again.SetDimensions(dims);
+    std::vector<float> a(dims * 10000), b(dims * (points - 10000));
+    again.GenerateUniform(a.data(), a.size(), threads);
+    again.GenerateUniform(b.data(), b.size(), threads);
+    for (unsigned int d = 0; d < dims; ++d) {
+      for (size_t i = 0; i < points; ++i) {
+        const float got = i < 10000 ? a[d * 10000 + i]
+                                    : b[d * (points - 10000) + i - 10000];
+        ASSERT_EQ(got, whole[d * points + i])
+            << threads << " threads, dimension " << d << " point " << i;
+      }
+    }
+  }
+}
+
+TEST_P(Sobol32HostLayoutTest, DimensionsDoNotDependOnCount) {
+  const size_t points = 1000;
+  Sobol32Host few(GetParam()), many(GetParam());
+  few.SetDimensions(3);
+  many.SetDimensions(50);
+  std::vector<float> x(3 * points), y(50 * points);
+  few.GenerateUniform(x.data(), x.size());
+  many.GenerateUniform(y.data(), y.size());
+  EXPECT_TRUE(std::equal(x.begin(), x.end(), y.begin()));
+}
+
+TEST_P(Sobol32HostLayoutTest, RejectsBadArguments) {
+  Sobol32Host sobol(GetParam());
+  EXPECT_THROW(sobol.SetDimensions(0), std::invalid_argument);
+  EXPECT_THROW(sobol.SetDimensions(Sobol32Host::kMaxDimensions + 1),
+               std::invalid_argument);
+  sobol.SetDimensions(3);
+  std::vector<float> x(10);
+  EXPECT_THROW(sobol.GenerateUniform(x.data(), x.size()),
+               std::invalid_argument);
+}
+
+INSTANTIATE_TEST_SUITE_P(Scrambling, Sobol32HostLayoutTest, ::testing::Bool(),
+                         [](const ::testing::TestParamInfo<bool>& info) {
+                           return info.param ? "scrambled" : "plain";
+                         });
+
+}  // namespace
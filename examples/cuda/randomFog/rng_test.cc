@@ -1,6 +1,8 @@
 #include "examples/cuda/randomFog/rng.h"
 
 #include <cstdio>
+#include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -19,3 +21,107 @@ TEST(RngTest, TestRng) {
   printf("Msg: %s\n", msg.c_str());
   EXPECT_FALSE(msg.empty()) << "Non-empty msg: " << msg;
 }
+
+TEST(RngTest, HostPseudoMatchesXorwowHost) {
+  RNG rng(12345, 1, 40000, RNG::Host);
+  EXPECT_FALSE(rng.onDevice());
+
+  std::vector<float> expect(100000);
+  XorwowHost(12345).GenerateUniform(expect.data(), expect.size());
+  for (size_t i = 0; i < expect.size(); ++i) {
+    ASSERT_EQ(rng.getNextU01(), expect[i]) << i;
+  }
+
+  rng.resetSeed();
+  EXPECT_EQ(rng.getNextU01(), expect[0]);
+}
+
+TEST(RngTest, HostQuasiReturnsPointsInOrder) {
+  const unsigned int dims = 3;
+  RNG rng(12345, 1, 40000, RNG::Host);
+  rng.selectRng(RNG::ScrambledQuasi);
+  rng.incrementDimensions();
+  rng.incrementDimensions();
+
+  // One batch of 40000 / 3 points, returned point by point.
+  const size_t points = 40000 / dims;
+  std::vector<float> batch(points * dims);
+  Sobol32Host sobol(true);
+  sobol.SetDimensions(dims);
+  sobol.GenerateUniform(batch.data(), batch.size());
+  for (size_t i = 0; i < points; ++i) {
+    for (unsigned int d = 0; d < dims; ++d) {
+      ASSERT_EQ(rng.getNextU01(), batch[d * points + i]) << i << ", " << d;
+    }
+  }
+
+  std::string msg;
+  rng.getInfoString(msg);
+  EXPECT_EQ(msg, "Scrambled Sobol (dimensions=3) [host]");
+}
+
+TEST(RngTest, SpanMatchesSingleSamples) {
+  for (RNG::RngType type : {RNG::Pseudo, RNG::Quasi}) {
+    RNG single(7, 5, 40000, RNG::Host), span(7, 5, 40000, RNG::Host);
+    single.selectRng(type);
+    span.selectRng(type);
+
+    // Runs that start and end inside batches and cross their boundaries.
+    std::vector<float> got(100000);
+    size_t done = 0;
+    for (size_t n : {1, 39998, 3, 40001, 19997}) {
+      span.getNextU01(got.data() + done, n);
+      done += n;
+    }
+    for (size_t i = 0; i < done; ++i) {
+      ASSERT_EQ(got[i], single.getNextU01()) << type << ", " << i;
+    }
+  }
+}
+
+TEST(RngTest, DoubleBufferedReturnsSameSamples) {
+  RNG sync(99, 4, 40000, RNG::Host), async(99, 4, 40000, RNG::Host);
+  async.setDoubleBuffered(true);
+
+  std::vector<float> a(200000), b(200000);
+  for (RNG::RngType type : {RNG::Pseudo, RNG::ScrambledQuasi}) {
+    sync.selectRng(type);
+    async.selectRng(type);
+    sync.getNextU01(a.data(), a.size());
+    for (float& x : b) x = async.getNextU01();
+    EXPECT_EQ(a, b) << type;
+  }
+
+  // Reseeding drops the prefetched batch and starts over.
+  sync.selectRng(RNG::Pseudo);
+  async.selectRng(RNG::Pseudo);
+  sync.resetSeed();
+  async.resetSeed();
+  sync.getNextU01(a.data(), a.size());
+  async.getNextU01(b.data(), b.size());
+  EXPECT_EQ(a, b);
+
+  // Dropping the prefetched batch rewinds the generator past it.
+  async.setDoubleBuffered(false);
+  sync.getNextU01(a.data(), a.size());
+  async.getNextU01(b.data(), b.size());
+  EXPECT_EQ(a, b);
+}
+
+TEST(RngTest, DoubleBufferedSurvivesSwitchingGenerators) {
+  RNG sync(12345, 1, 40000, RNG::Host), async(12345, 1, 40000, RNG::Host);
+  async.setDoubleBuffered(true);
+
+  // Each switch drops a prefetched batch of the generator switched away
+  // from, without a resetSeed() to hide it.
+  std::vector<float> a(100000), b(100000);
+  for (RNG::RngType type : {RNG::Quasi, RNG::Pseudo, RNG::ScrambledQuasi,
+                            RNG::Quasi, RNG::Pseudo}) {
+    sync.selectRng(type);
+    async.selectRng(type);
+    EXPECT_EQ(sync.getNextU01(), async.getNextU01()) << type;
+    sync.getNextU01(a.data(), a.size());
+    async.getNextU01(b.data(), b.size());
+    EXPECT_EQ(a, b) << type;
+  }
+}
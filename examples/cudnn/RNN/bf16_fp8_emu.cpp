@@ -0,0 +1,386 @@
+#include "examples/cudnn/RNN/bf16_fp8_emu.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "examples/cuda/common/parallel_helper.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BF16_FP8_EMU_X86 1
+#endif
+
+namespace {
+
+const size_t kMinPerThread = 1 << 18;
+
+// A binary format narrower than float, by its float-relative parameters.
+struct Format {
+  int mant_bits;
+  int bias;
+  int sign_shift;     // 15 for 16-bit formats, 7 for 8-bit ones
+  uint32_t max_code;  // largest finite magnitude
+  uint32_t inf_code;  // 0 if the format has no infinity
+  uint32_t nan_code;
+};
+
+const Format kBf16 = {7, 127, 15, 0x7f7f, 0x7f80, 0x7fff};
+const Format kE4m3 = {3, 7, 7, 0x7e, 0, 0x7f};
+const Format kE5m2 = {2, 15, 7, 0x7b, 0x7c, 0x7f};
+
+uint32_t FloatBits(float f) {
+  uint32_t x;
+  memcpy(&x, &f, sizeof(x));
+  return x;
+}
+
+float BitsFloat(uint32_t x) {
+  float f;
+  memcpy(&f, &x, sizeof(f));
+  return f;
+}
+
+// Rounds m / 2^shift to nearest even, for 1 <= shift <= 25 and m small
+// enough that m + 2^shift does not overflow.
+inline uint32_t RoundShift(uint32_t m, uint32_t shift) {
+  return (m + (1u << (shift - 1)) - 1 + ((m >> shift) & 1)) >> shift;
+}
+
+uint32_t Encode(float f, const Format& fmt, LowpSaturation sat) {
+  const uint32_t x = FloatBits(f);
+  const uint32_t u = x & 0x7fffffff;
+  if (u > 0x7f800000) return fmt.nan_code;
+
+  // Fields of f; a float subnormal has exponent field 0 and no implicit
+  // bit but the scale of field 1.
+  const int field = (int)(u >> 23);
+  const int emin = 1 - fmt.bias;  // of the narrow format
+  uint32_t r;
+  if (std::max(field, 1) - 127 >= emin) {
+    // Normal in the narrow format: round the low bits of u and rebias.
+    r = RoundShift(u, 23 - fmt.mant_bits) -
+        ((uint32_t)(127 - fmt.bias) << fmt.mant_bits);
+  } else {
+    // Subnormal: shift the full mantissa into place.
+    const uint32_t m = (u & 0x7fffff) | (field ? 0x800000 : 0);
+    const int shift = 23 - fmt.mant_bits + emin - (std::max(field, 1) - 127);
+    r = RoundShift(m, (uint32_t)std::min(shift, 25));
+  }
+
+  if (r > fmt.max_code) {
+    if (sat == kLowpSatFinite) {
+      r = fmt.max_code;
+    } else if (fmt.inf_code) {
+      r = fmt.inf_code;
+    } else {
+      return fmt.nan_code;
+    }
+  }
+  return r | ((x >> 31) << fmt.sign_shift);
+}
+
+// Exact for every code of an 8-bit format; NaNs become 0x7fffffff as in
+// cpu_half2float().
+float DecodeFp8(uint32_t v, const Format& fmt) {
+  const uint32_t exp_mask = 0x7f >> fmt.mant_bits;
+  const uint32_t e = (v >> fmt.mant_bits) & exp_mask;
+  const uint32_t m = v & ((1u << fmt.mant_bits) - 1);
+  if ((v & 0x7f) > (fmt.inf_code ? fmt.inf_code : fmt.max_code)) {
+    return BitsFloat(0x7fffffff);
+  }
+  float r;
+  if ((v & 0x7f) == fmt.inf_code && fmt.inf_code) {
+    r = INFINITY;
+  } else if (e == 0) {
+    r = ldexpf((float)m, 1 - fmt.bias - fmt.mant_bits);
+  } else {
+    r = ldexpf((float)(m | (1u << fmt.mant_bits)),
+               (int)e - fmt.bias - fmt.mant_bits);
+  }
+  return (v & 0x80) ? -r : r;
+}
+
+// Every 8-bit code decoded, for table lookups.
+struct Fp8Table {
+  float e4m3[256];
+  float e5m2[256];
+  Fp8Table() {
+    for (uint32_t v = 0; v < 256; ++v) {
+      e4m3[v] = DecodeFp8(v, kE4m3);
+      e5m2[v] = DecodeFp8(v, kE5m2);
+    }
+  }
+};
+
+const Fp8Table& GetFp8Table() {
+  static const Fp8Table table;
+  return table;
+}
+
+template <typename Out>
+void EncodeScalar(const float* f, Out* out, size_t n, const Format& fmt,
+                  LowpSaturation sat) {
+  for (size_t i = 0; i < n; ++i) out[i] = (Out)Encode(f[i], fmt, sat);
+}
+
+void DecodeFp8Scalar(const uint8_t* v, float* f, size_t n,
+                     const float* table) {
+  for (size_t i = 0; i < n; ++i) f[i] = table[v[i]];
+}
+
+void DecodeBf16Scalar(const uint16_t* b, float* f, size_t n) {
+  for (size_t i = 0; i < n; ++i) f[i] = BitsFloat((uint32_t)b[i] << 16);
+}
+
+#ifdef BF16_FP8_EMU_X86
+
+// Eight lanes of Encode(), as 32-bit integers.
+__attribute__((target("avx2"))) inline __m256i Encode8(__m256i x,
+                                                      const Format& fmt,
+                                                      LowpSaturation sat) {
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i u = _mm256_and_si256(x, _mm256_set1_epi32(0x7fffffff));
+  const __m256i field = _mm256_max_epi32(_mm256_srli_epi32(u, 23), one);
+  const int emin = 1 - fmt.bias;
+
+  // Normal: round the low bits of u and rebias.
+  const int nshift = 23 - fmt.mant_bits;
+  __m256i normal = _mm256_add_epi32(
+      u, _mm256_add_epi32(
+             _mm256_set1_epi32((1 << (nshift - 1)) - 1),
+             _mm256_and_si256(_mm256_srli_epi32(u, nshift), one)));
+  normal = _mm256_sub_epi32(
+      _mm256_srli_epi32(normal, nshift),
+      _mm256_set1_epi32((127 - fmt.bias) << fmt.mant_bits));
+
+  // Subnormal: shift the full mantissa right by a per-lane amount, at
+  // most 25 so that the rounding constant stays in range.
+  const __m256i implicit = _mm256_and_si256(
+      _mm256_cmpgt_epi32(_mm256_srli_epi32(u, 23), _mm256_setzero_si256()),
+      _mm256_set1_epi32(0x800000));
+  const __m256i m = _mm256_or_si256(
+      _mm256_and_si256(u, _mm256_set1_epi32(0x7fffff)), implicit);
+  const __m256i shift = _mm256_min_epi32(
+      _mm256_sub_epi32(_mm256_set1_epi32(23 - fmt.mant_bits + emin + 127),
+                       field),
+      _mm256_set1_epi32(25));
+  const __m256i half_m1 = _mm256_sub_epi32(
+      _mm256_sllv_epi32(one, _mm256_sub_epi32(shift, one)), one);
+  const __m256i odd = _mm256_and_si256(_mm256_srlv_epi32(m, shift), one);
+  const __m256i subnormal = _mm256_srlv_epi32(
+      _mm256_add_epi32(m, _mm256_add_epi32(half_m1, odd)), shift);
+
+  __m256i r = _mm256_blendv_epi8(
+      subnormal, normal,
+      _mm256_cmpgt_epi32(field, _mm256_set1_epi32(emin + 126)));
+
+  const __m256i overflow =
+      _mm256_cmpgt_epi32(r, _mm256_set1_epi32((int)fmt.max_code));
+  const bool to_nan = sat != kLowpSatFinite && fmt.inf_code == 0;
+  const uint32_t clamp = sat == kLowpSatFinite ? fmt.max_code : fmt.inf_code;
+  r = _mm256_blendv_epi8(r, _mm256_set1_epi32((int)clamp), overflow);
+  r = _mm256_or_si256(r, _mm256_slli_epi32(_mm256_srli_epi32(x, 31),
+                                           fmt.sign_shift));
+  const __m256i nan_code = _mm256_set1_epi32((int)fmt.nan_code);
+  if (to_nan) r = _mm256_blendv_epi8(r, nan_code, overflow);
+  return _mm256_blendv_epi8(
+      r, nan_code, _mm256_cmpgt_epi32(u, _mm256_set1_epi32(0x7f800000)));
+}
+
+__attribute__((target("avx2"))) void EncodeBf16Avx2(const float* f,
+                                                    uint16_t* b, size_t n,
+                                                    LowpSaturation sat) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i r =
+        Encode8(_mm256_loadu_si256((const __m256i*)(f + i)), kBf16, sat);
+    _mm_storeu_si128((__m128i*)(b + i),
+                     _mm_packus_epi32(_mm256_castsi256_si128(r),
+                                      _mm256_extracti128_si256(r, 1)));
+  }
+  EncodeScalar(f + i, b + i, n - i, kBf16, sat);
+}
+
+__attribute__((target("avx2"))) void EncodeFp8Avx2(const float* f,
+                                                   uint8_t* v, size_t n,
+                                                   const Format& fmt,
+                                                   LowpSaturation sat) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i r =
+        Encode8(_mm256_loadu_si256((const __m256i*)(f + i)), fmt, sat);
+    const __m128i r16 = _mm_packus_epi32(_mm256_castsi256_si128(r),
+                                         _mm256_extracti128_si256(r, 1));
+    _mm_storel_epi64((__m128i*)(v + i), _mm_packus_epi16(r16, r16));
+  }
+  EncodeScalar(f + i, v + i, n - i, fmt, sat);
+}
+
+__attribute__((target("avx2"))) void DecodeBf16Avx2(const uint16_t* b,
+                                                    float* f, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i x =
+        _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(b + i)));
+    _mm256_storeu_si256((__m256i*)(f + i), _mm256_slli_epi32(x, 16));
+  }
+  DecodeBf16Scalar(b + i, f + i, n - i);
+}
+
+__attribute__((target("avx2"))) void DecodeFp8Avx2(const uint8_t* v,
+                                                   float* f, size_t n,
+                                                   const float* table) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i idx =
+        _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(v + i)));
+    _mm256_storeu_ps(f + i, _mm256_i32gather_ps(table, idx, 4));
+  }
+  DecodeFp8Scalar(v + i, f + i, n - i, table);
+}
+
+#endif  // BF16_FP8_EMU_X86
+
+LowpKernel Resolve(LowpKernel kernel) {
+  if (kernel != kLowpKernelAuto) return kernel;
+  if (lowp_kernel_supported(kLowpKernelAvx2)) return kLowpKernelAvx2;
+  return kLowpKernelScalar;
+}
+
+template <typename Out>
+int EncodeBulk(const float* f, Out* out, size_t n, const Format& fmt,
+               LowpSaturation sat, int num_threads, LowpKernel kernel) {
+  if (!lowp_kernel_supported(kernel)) return 1;
+  const bool simd = Resolve(kernel) == kLowpKernelAvx2;
+  ParallelChunks(n, num_threads, kMinPerThread, [&](size_t begin, size_t end) {
+#ifdef BF16_FP8_EMU_X86
+    if (simd && sizeof(Out) == 2) {
+      EncodeBf16Avx2(f + begin, (uint16_t*)out + begin, end - begin, sat);
+      return;
+    }
+    if (simd) {
+      EncodeFp8Avx2(f + begin, (uint8_t*)out + begin, end - begin, fmt, sat);
+      return;
+    }
+#endif
+    (void)simd;
+    EncodeScalar(f + begin, out + begin, end - begin, fmt, sat);
+  });
+  return 0;
+}
+
+int DecodeFp8Bulk(const uint8_t* v, float* f, size_t n, const float* table,
+                  int num_threads, LowpKernel kernel) {
+  if (!lowp_kernel_supported(kernel)) return 1;
+  const bool simd = Resolve(kernel) == kLowpKernelAvx2;
+  ParallelChunks(n, num_threads, kMinPerThread, [&](size_t begin, size_t end) {
+#ifdef BF16_FP8_EMU_X86
+    if (simd) {
+      DecodeFp8Avx2(v + begin, f + begin, end - begin, table);
+      return;
+    }
+#endif
+    (void)simd;
+    DecodeFp8Scalar(v + begin, f + begin, end - begin, table);
+  });
+  return 0;
+}
+
+}  // namespace
+
+bfloat16 cpu_float2bfloat16_rn(float f, LowpSaturation sat) {
+  bfloat16 b = {(unsigned short)Encode(f, kBf16, sat)};
+  return b;
+}
+
+float cpu_bfloat162float(bfloat16 b) { return BitsFloat((uint32_t)b.x << 16); }
+
+fp8_e4m3 cpu_float2fp8_e4m3_rn(float f, LowpSaturation sat) {
+  fp8_e4m3 v = {(unsigned char)Encode(f, kE4m3, sat)};
+  return v;
+}
+
+float cpu_fp8_e4m32float(fp8_e4m3 v) { return DecodeFp8(v.x, kE4m3); }
+
+fp8_e5m2 cpu_float2fp8_e5m2_rn(float f, LowpSaturation sat) {
+  fp8_e5m2 v = {(unsigned char)Encode(f, kE5m2, sat)};
+  return v;
+}
+
+float cpu_fp8_e5m22float(fp8_e5m2 v) { return DecodeFp8(v.x, kE5m2); }
+
+bool lowp_kernel_supported(LowpKernel kernel) {
+  switch (kernel) {
+    case kLowpKernelAuto:
+    case kLowpKernelScalar:
+      return true;
+#ifdef BF16_FP8_EMU_X86
+    case kLowpKernelAvx2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+const char* lowp_kernel_name(LowpKernel kernel) {
+  switch (Resolve(kernel)) {
+    case kLowpKernelScalar:
+      return "scalar";
+    case kLowpKernelAvx2:
+      return "avx2";
+    default:
+      return "unknown";
+  }
+}
+
+int cpu_float2bfloat16_rn(const float* f, bfloat16* b, size_t n,
+                          LowpSaturation sat, int num_threads,
+                          LowpKernel kernel) {
+  return EncodeBulk(f, (uint16_t*)b, n, kBf16, sat, num_threads, kernel);
+}
+
+int cpu_bfloat162float(const bfloat16* b, float* f, size_t n,
+                       int num_threads, LowpKernel kernel) {
+  if (!lowp_kernel_supported(kernel)) return 1;
+  const bool simd = Resolve(kernel) == kLowpKernelAvx2;
+  const uint16_t* x = (const uint16_t*)b;
+  ParallelChunks(n, num_threads, kMinPerThread, [&](size_t begin, size_t end) {
+#ifdef BF16_FP8_EMU_X86
+    if (simd) {
+      DecodeBf16Avx2(x + begin, f + begin, end - begin);
+      return;
+    }
+#endif
+    (void)simd;
+    DecodeBf16Scalar(x + begin, f + begin, end - begin);
+  });
+  return 0;
+}
+
+int cpu_float2fp8_e4m3_rn(const float* f, fp8_e4m3* v, size_t n,
+                          LowpSaturation sat, int num_threads,
+                          LowpKernel kernel) {
+  return EncodeBulk(f, (uint8_t*)v, n, kE4m3, sat, num_threads, kernel);
+}
+
+int cpu_fp8_e4m32float(const fp8_e4m3* v, float* f, size_t n,
+                       int num_threads, LowpKernel kernel) {
+  return DecodeFp8Bulk((const uint8_t*)v, f, n, GetFp8Table().e4m3,
+                       num_threads, kernel);
+}
+
+int cpu_float2fp8_e5m2_rn(const float* f, fp8_e5m2* v, size_t n,
+                          LowpSaturation sat, int num_threads,
+                          LowpKernel kernel) {
+  return EncodeBulk(f, (uint8_t*)v, n, kE5m2, sat, num_threads, kernel);
+}
+
+int cpu_fp8_e5m22float(const fp8_e5m2* v, float* f, size_t n,
+                       int num_threads, LowpKernel kernel) {
+  return DecodeFp8Bulk((const uint8_t*)v, f, n, GetFp8Table().e5m2,
+                       num_threads, kernel);
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+// Conversion from/to bfloat16 and 8-bit floating point (E4M3, E5M2), the
+// host-side companions of fp16_emu.h for weights stored in those formats.
+//
+// bfloat16 is the top half of an IEEE float. E5M2 has the exponent range
+// of FP16 with two mantissa bits, infinities and NaNs. E4M3 has no
+// infinities; its only NaN encodings are S.1111.111 and its largest value
+// is 448.
+//
+// Conversions from float round to nearest even. Out-of-range values follow
+// the saturation mode: kLowpSatNone gives +/-Inf (bfloat16, E5M2) or NaN
+// (E4M3), kLowpSatFinite clamps them, infinities included, to +/-max. NaN
+// inputs always give the positive NaN with all mantissa bits set, as
+// cpu_float2half_rn() does. Conversions to float are exact.
+
+#include <stddef.h>
+
+struct bfloat16 {
+  unsigned short x;
+};
+
+struct fp8_e4m3 {
+  unsigned char x;
+};
+
+struct fp8_e5m2 {
+  unsigned char x;
+};
+
+#define BF16_EPSILON 7.812500E-03
+#define BF16_MIN 1.175494E-38
+#define BF16_MAX 3.389531E+38
+#define FP8_E4M3_EPSILON 1.250000E-01
+#define FP8_E4M3_MIN 1.562500E-02
+#define FP8_E4M3_MAX 4.480000E+02
+#define FP8_E5M2_EPSILON 2.500000E-01
+#define FP8_E5M2_MIN 6.103516E-05
+#define FP8_E5M2_MAX 5.734400E+04
+
+enum LowpSaturation {
+  kLowpSatNone = 0,
+  kLowpSatFinite,
+};
+
+bfloat16 cpu_float2bfloat16_rn(float f, LowpSaturation sat = kLowpSatNone);
+float cpu_bfloat162float(bfloat16 b);
+
+fp8_e4m3 cpu_float2fp8_e4m3_rn(float f, LowpSaturation sat = kLowpSatNone);
+float cpu_fp8_e4m32float(fp8_e4m3 v);
+
+fp8_e5m2 cpu_float2fp8_e5m2_rn(float f, LowpSaturation sat = kLowpSatNone);
+float cpu_fp8_e5m22float(fp8_e5m2 v);
+
+// Bulk conversions of n values, bit for bit the same as the scalar
+// functions above. Large arrays are split across threads; num_threads <= 0
+// picks one per core. All return 0 on success and 1 if the kernel cannot
+// run on this CPU.
+enum LowpKernel {
+  kLowpKernelAuto = 0,  // widest kernel the CPU supports
+  kLowpKernelScalar,
+  kLowpKernelAvx2,
+};
+
+bool lowp_kernel_supported(LowpKernel kernel);
+const char* lowp_kernel_name(LowpKernel kernel);
+
+int cpu_float2bfloat16_rn(const float* f, bfloat16* b, size_t n,
+                          LowpSaturation sat = kLowpSatNone,
+                          int num_threads = 0,
+                          LowpKernel kernel = kLowpKernelAuto);
+int cpu_bfloat162float(const bfloat16* b, float* f, size_t n,
+                       int num_threads = 0,
+                       LowpKernel kernel = kLowpKernelAuto);
+
+int cpu_float2fp8_e4m3_rn(const float* f, fp8_e4m3* v, size_t n,
+                          LowpSaturation sat = kLowpSatNone,
+                          int num_threads = 0,
+                          LowpKernel kernel = kLowpKernelAuto);
+int cpu_fp8_e4m32float(const fp8_e4m3* v, float* f, size_t n,
+                       int num_threads = 0,
+                       LowpKernel kernel = kLowpKernelAuto);
+
+int cpu_float2fp8_e5m2_rn(const float* f, fp8_e5m2* v, size_t n,
+                          LowpSaturation sat = kLowpSatNone,
+                          int num_threads = 0,
+                          LowpKernel kernel = kLowpKernelAuto);
+int cpu_fp8_e5m22float(const fp8_e5m2* v, float* f, size_t n,
+                       int num_threads = 0,
+                       LowpKernel kernel = kLowpKernelAuto);
+
+// Scalar helpers, as habs(), hneg(), ishnan(), ... in fp16_emu.h.
+
+static inline bfloat16 babs(bfloat16 b) {
+  b.x &= 0x7fffU;
+  return b;
+}
+
+static inline bfloat16 bneg(bfloat16 b) {
+  b.x ^= 0x8000U;
+  return b;
+}
+
+static inline int isbnan(bfloat16 b) {
+  return (b.x & 0x7f80U) == 0x7f80U && (b.x & 0x007fU) != 0;
+}
+
+static inline int isbinf(bfloat16 b) { return (b.x & 0x7fffU) == 0x7f80U; }
+
+// Largest positive bfloat16 value, corresponds to 3.3895e+38
+static inline bfloat16 bmax() {
+  bfloat16 b = {0x7f7fU};
+  return b;
+}
+
+// Smallest positive (normalized) bfloat16 value, corresponds to 1.1755e-38
+static inline bfloat16 bmin() {
+  bfloat16 b = {0x0080U};
+  return b;
+}
+
+static inline bfloat16 bone() {
+  bfloat16 b = {0x3f80U};
+  return b;
+}
+
+static inline fp8_e4m3 fp8abs(fp8_e4m3 v) {
+  v.x &= 0x7fU;
+  return v;
+}
+
+static inline fp8_e5m2 fp8abs(fp8_e5m2 v) {
+  v.x &= 0x7fU;
+  return v;
+}
+
+static inline fp8_e4m3 fp8neg(fp8_e4m3 v) {
+  v.x ^= 0x80U;
+  return v;
+}
+
+static inline fp8_e5m2 fp8neg(fp8_e5m2 v) {
+  v.x ^= 0x80U;
+  return v;
+}
+
+static inline int isfp8nan(fp8_e4m3 v) { return (v.x & 0x7fU) == 0x7fU; }
+
+static inline int isfp8nan(fp8_e5m2 v) { return (v.x & 0x7fU) > 0x7cU; }
+
+static inline int isfp8inf(fp8_e4m3) { return 0; }
+
+static inline int isfp8inf(fp8_e5m2 v) { return (v.x & 0x7fU) == 0x7cU; }
+
+// Largest positive values, 448 and 57344
+static inline fp8_e4m3 fp8_e4m3_max() {
+  fp8_e4m3 v = {0x7eU};
+  return v;
+}
+
+static inline fp8_e5m2 fp8_e5m2_max() {
+  fp8_e5m2 v = {0x7bU};
+  return v;
+}
@@ -0,0 +1,106 @@
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "examples/cudnn/RNN/bf16_fp8_emu.h"
+#include "examples/cudnn/RNN/fp16_emu.h"
+
+// How to run:
+// bazel run -c opt //examples/cudnn/RNN:bf16_fp8_emu_benchmark
+namespace {
+
+enum Format { kFp16, kBf16, kE4m3, kE5m2 };
+
+const char* const kFormatNames[] = {"fp16", "bf16", "e4m3", "e5m2"};
+const size_t kFormatBytes[] = {2, 2, 1, 1};
+
+std::vector<float> Values(size_t n) {
+  std::vector<float> f(n);
+  for (size_t i = 0; i < n; ++i) f[i] = (float)i * 0.37f - 1000.0f;
+  return f;
+}
+
+// The narrow copy of n values, as raw bytes of the format.
+void Encode(Format format, const float* f, void* out, size_t n,
+            int num_threads) {
+  switch (format) {
+    case kFp16:
+      cpu_float2half_rn(f, (half1*)out, n, num_threads);
+      break;
+    case kBf16:
+      cpu_float2bfloat16_rn(f, (bfloat16*)out, n, kLowpSatFinite,
+                            num_threads);
+      break;
+    case kE4m3:
+      cpu_float2fp8_e4m3_rn(f, (fp8_e4m3*)out, n, kLowpSatFinite,
+                            num_threads);
+      break;
+    case kE5m2:
+      cpu_float2fp8_e5m2_rn(f, (fp8_e5m2*)out, n, kLowpSatFinite,
+                            num_threads);
+      break;
+  }
+}
+
+void Decode(Format format, const void* in, float* f, size_t n,
+            int num_threads) {
+  switch (format) {
+    case kFp16:
+      cpu_half2float((const half1*)in, f, n, num_threads);
+      break;
+    case kBf16:
+      cpu_bfloat162float((const bfloat16*)in, f, n, num_threads);
+      break;
+    case kE4m3:
+      cpu_fp8_e4m32float((const fp8_e4m3*)in, f, n, num_threads);
+      break;
+    case kE5m2:
+      cpu_fp8_e5m22float((const fp8_e5m2*)in, f, n, num_threads);
+      break;
+  }
+}
+
+// Size of the narrow tensor and the bytes moved per value converted.
+void SetCounters(benchmark::State& state, Format format, size_t n) {
+  state.SetLabel(kFormatNames[format]);
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetBytesProcessed(state.iterations() * n *
+                          (sizeof(float) + kFormatBytes[format]));
+  state.counters["bytes_per_value"] = (double)kFormatBytes[format];
+  state.counters["footprint_MB"] = n * kFormatBytes[format] / 1e6;
+}
+
+// Arguments: Format, values, threads.
+void BM_Encode(benchmark::State& state) {
+  const auto format = static_cast<Format>(state.range(0));
+  const size_t n = static_cast<size_t>(state.range(1));
+  const std::vector<float> f = Values(n);
+  std::vector<unsigned char> out(n * kFormatBytes[format]);
+  for (auto _ : state) {
+    Encode(format, f.data(), out.data(), n, (int)state.range(2));
+    benchmark::DoNotOptimize(out.data());
+  }
+  SetCounters(state, format, n);
+}
+
+// Arguments: Format, values, threads.
+void BM_Decode(benchmark::State& state) {
+  const auto format = static_cast<Format>(state.range(0));
+  const size_t n = static_cast<size_t>(state.range(1));
+  const std::vector<float> values = Values(n);
+  std::vector<unsigned char> in(n * kFormatBytes[format]);
+  Encode(format, values.data(), in.data(), n, 0);
+  std::vector<float> f(n);
+  for (auto _ : state) {
+    Decode(format, in.data(), f.data(), n, (int)state.range(2));
+    benchmark::DoNotOptimize(f.data());
+  }
+  SetCounters(state, format, n);
+}
+
+const std::vector<std::vector<int64_t>> kArgs = {
+    {kFp16, kBf16, kE4m3, kE5m2}, {1 << 12, 1 << 24}, {1, 0}};
+
+BENCHMARK(BM_Encode)->ArgsProduct(kArgs)->UseRealTime();
+BENCHMARK(BM_Decode)->ArgsProduct(kArgs)->UseRealTime();
+
+}  // namespace
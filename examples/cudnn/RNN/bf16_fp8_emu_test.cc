@@ -0,0 +1,277 @@
+#include "examples/cudnn/RNN/bf16_fp8_emu.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+uint32_t Bits(float f) {
+  uint32_t x;
+  memcpy(&x, &f, sizeof(x));
+  return x;
+}
+
+float Float(uint32_t x) {
+  float f;
+  memcpy(&f, &x, sizeof(f));
+  return f;
+}
+
+std::vector<LowpKernel> SupportedKernels() {
+  std::vector<LowpKernel> kernels;
+  for (LowpKernel kernel : {kLowpKernelScalar, kLowpKernelAvx2}) {
+    if (lowp_kernel_supported(kernel)) kernels.push_back(kernel);
+  }
+  return kernels;
+}
+
+// Float bit patterns covering every sign, exponent and top mantissa bits,
+// with low bits at and around the rounding points of all three formats.
+std::vector<float> SampleFloats() {
+  std::vector<float> f;
+  for (uint32_t hi = 0; hi < (1u << 20); ++hi) {
+    for (uint32_t lo : {0x000u, 0x001u, 0x7ffu, 0x800u, 0x801u, 0xfffu}) {
+      f.push_back(Float(hi << 12 | lo));
+    }
+  }
+  return f;
+}
+
+// Independent reference for the 8-bit formats: the nearest finite code by
+// exhaustive search over the decoded values, ties to the even code.
+template <typename T, typename Decode>
+unsigned int NearestFp8(float f, LowpSaturation sat, Decode decode,
+                        unsigned int max_code, bool has_inf) {
+  if (isnan(f)) return 0x7f;
+  const double a = fabs(static_cast<double>(f));
+  const unsigned int sign = signbit(f) ? 0x80 : 0;
+  // Halfway above the largest value is where rounding overflows.
+  T max = {static_cast<unsigned char>(max_code)};
+  T below = {static_cast<unsigned char>(max_code - 1)};
+  const double limit = decode(max) + (decode(max) - decode(below)) / 2;
+  if (a >= limit && !(a == limit && (max_code & 1) == 0)) {
+    if (sat == kLowpSatFinite) return max_code | sign;
+    return has_inf ? (max_code + 1) | sign : 0x7f;
+  }
+  unsigned int best = 0;
+  double best_err = INFINITY;
+  for (unsigned int c = 0; c <= max_code; ++c) {
+    T v = {static_cast<unsigned char>(c)};
+    const double err = fabs(decode(v) - a);
+    if (err < best_err || (err == best_err && (c & 1) == 0)) {
+      best = c;
+      best_err = err;
+    }
+  }
+  return best | sign;
+}
+
+// The same for bfloat16, between the two codes that bracket f.
+unsigned int NearestBf16(float f, LowpSaturation sat) {
+  if (isnan(f)) return 0x7fff;
+  const uint32_t u = Bits(f) & 0x7fffffff;
+  const unsigned int sign = signbit(f) ? 0x8000 : 0;
+  if (u == 0x7f800000) return (sat == kLowpSatFinite ? 0x7f7f : 0x7f80) | sign;
+  const unsigned int lo = u >> 16;
+  const double a = Float(u);
+  const double dlo = Float(lo << 16);
+  const double dhi = lo == 0x7f7f ? ldexp(1.0, 128) : Float((lo + 1) << 16);
+  unsigned int r = lo;
+  if (a - dlo > dhi - a || (a - dlo == dhi - a && (lo & 1))) r = lo + 1;
+  if (r > 0x7f7f) r = sat == kLowpSatFinite ? 0x7f7f : 0x7f80;
+  return r | sign;
+}
+
+double DecodeE4m3(fp8_e4m3 v) { return cpu_fp8_e4m32float(v); }
+double DecodeE5m2(fp8_e5m2 v) { return cpu_fp8_e5m22float(v); }
+
+TEST(Bf16Fp8EmuTest, SpotValues) {
+  EXPECT_EQ(cpu_float2bfloat16_rn(1.0f).x, 0x3f80);
+  EXPECT_EQ(cpu_float2bfloat16_rn(-2.0f).x, 0xc000);
+  EXPECT_EQ(cpu_float2bfloat16_rn(Float(0x3f808000)).x, 0x3f80);
+  EXPECT_EQ(cpu_float2bfloat16_rn(Float(0x3f818000)).x, 0x3f82);
+  EXPECT_EQ(cpu_float2bfloat16_rn(Float(0x7f7fffff)).x, 0x7f80);
+  EXPECT_EQ(cpu_float2bfloat16_rn(Float(0x7f7fffff), kLowpSatFinite).x,
+            0x7f7f);
+  EXPECT_EQ(cpu_float2bfloat16_rn(-INFINITY, kLowpSatFinite).x, 0xff7f);
+  EXPECT_EQ(cpu_float2bfloat16_rn(Float(0xffc00001)).x, 0x7fff);
+
+  EXPECT_EQ(cpu_float2fp8_e4m3_rn(1.0f).x, 0x38);
+  EXPECT_EQ(cpu_float2fp8_e4m3_rn(448.0f).x, 0x7e);
+  EXPECT_EQ(cpu_float2fp8_e4m3_rn(464.0f).x, 0x7e);
+  EXPECT_EQ(cpu_float2fp8_e4m3_rn(480.0f).x, 0x7f);
+  EXPECT_EQ(cpu_float2fp8_e4m3_rn(-480.0f, kLowpSatFinite).x, 0xfe);
+  EXPECT_EQ(cpu_float2fp8_e4m3_rn(INFINITY).x, 0x7f);
+  EXPECT_EQ(cpu_float2fp8_e4m3_rn(0x1p-9f).x, 0x01);
+  EXPECT_EQ(cpu_float2fp8_e4m3_rn(0x1p-10f).x, 0x00);
+  EXPECT_EQ(cpu_float2fp8_e4m3_rn(0x1.8p-10f).x, 0x01);
+
+  EXPECT_EQ(cpu_float2fp8_e5m2_rn(1.0f).x, 0x3c);
+  EXPECT_EQ(cpu_float2fp8_e5m2_rn(57344.0f).x, 0x7b);
+  EXPECT_EQ(cpu_float2fp8_e5m2_rn(61440.0f).x, 0x7c);
+  EXPECT_EQ(cpu_float2fp8_e5m2_rn(61440.0f, kLowpSatFinite).x, 0x7b);
+  EXPECT_EQ(cpu_float2fp8_e5m2_rn(-INFINITY).x, 0xfc);
+  EXPECT_EQ(cpu_float2fp8_e5m2_rn(NAN).x, 0x7f);
+  EXPECT_EQ(cpu_float2fp8_e5m2_rn(0x1p-16f).x, 0x01);
+
+  EXPECT_EQ(cpu_fp8_e4m32float(fp8_e4m3_max()), FP8_E4M3_MAX);
+  EXPECT_EQ(cpu_fp8_e5m22float(fp8_e5m2_max()), FP8_E5M2_MAX);
+  EXPECT_EQ(cpu_bfloat162float(bmin()), 0x1p-126f);
+  EXPECT_EQ(Bits(cpu_fp8_e4m32float(fp8_e4m3{0xff})), 0x7fffffffu);
+  EXPECT_EQ(Bits(cpu_fp8_e5m22float(fp8_e5m2{0xfc})), 0xff800000u);
+  EXPECT_EQ(Bits(cpu_fp8_e5m22float(fp8_e5m2{0x7d})), 0x7fffffffu);
+}
+
+TEST(Bf16Fp8EmuTest, Helpers) {
+  EXPECT_EQ(babs(bneg(bone())).x, bone().x);
+  EXPECT_TRUE(isbinf(cpu_float2bfloat16_rn(-INFINITY)));
+  EXPECT_TRUE(isbnan(cpu_float2bfloat16_rn(NAN)));
+  EXPECT_FALSE(isbnan(bmax()));
+  EXPECT_TRUE(isfp8nan(cpu_float2fp8_e4m3_rn(1e6f)));
+  EXPECT_FALSE(isfp8inf(cpu_float2fp8_e4m3_rn(1e6f)));
+  EXPECT_TRUE(isfp8inf(cpu_float2fp8_e5m2_rn(1e6f)));
+  EXPECT_FALSE(isfp8nan(fp8_e5m2_max()));
+  EXPECT_EQ(fp8abs(fp8neg(fp8_e4m3_max())).x, fp8_e4m3_max().x);
+  EXPECT_EQ(fp8neg(fp8_e5m2_max()).x, 0xfb);
+}
+
+TEST(Bf16Fp8EmuTest, ScalarMatchesNearestValue) {
+  const std::vector<float> f = SampleFloats();
+  for (LowpSaturation sat : {kLowpSatNone, kLowpSatFinite}) {
+    for (float x : f) {
+      ASSERT_EQ(cpu_float2bfloat16_rn(x, sat).x, NearestBf16(x, sat))
+          << std::hex << Bits(x) << " " << sat;
+    }
+  }
+  // The 8-bit references search all codes, so sample more sparsely.
+  for (LowpSaturation sat : {kLowpSatNone, kLowpSatFinite}) {
+    for (size_t i = 0; i < f.size(); i += 7) {
+      ASSERT_EQ(cpu_float2fp8_e4m3_rn(f[i], sat).x,
+                (NearestFp8<fp8_e4m3>(f[i], sat, DecodeE4m3, 0x7e, false)))
+          << std::hex << Bits(f[i]) << " " << sat;
+      ASSERT_EQ(cpu_float2fp8_e5m2_rn(f[i], sat).x,
+                (NearestFp8<fp8_e5m2>(f[i], sat, DecodeE5m2, 0x7b, true)))
+          << std::hex << Bits(f[i]) << " " << sat;
+    }
+  }
+}
+
+TEST(Bf16Fp8EmuTest, DecodeRoundTrips) {
+  for (unsigned int c = 0; c < 256; ++c) {
+    fp8_e4m3 a = {static_cast<unsigned char>(c)};
+    fp8_e5m2 b = {static_cast<unsigned char>(c)};
+    if (!isfp8nan(a)) {
+      EXPECT_EQ(cpu_float2fp8_e4m3_rn(cpu_fp8_e4m32float(a)).x, c);
+    }
+    if (!isfp8nan(b)) {
+      EXPECT_EQ(cpu_float2fp8_e5m2_rn(cpu_fp8_e5m22float(b)).x, c);
+    }
+  }
+  for (unsigned int c = 0; c < 0x10000; ++c) {
+    bfloat16 b = {static_cast<unsigned short>(c)};
+    if (!isbnan(b)) {
+      ASSERT_EQ(cpu_float2bfloat16_rn(cpu_bfloat162float(b)).x, c);
+    }
+  }
+}
+
+class Bf16Fp8BulkTest : public ::testing::TestWithParam<LowpKernel> {};
+
+TEST_P(Bf16Fp8BulkTest, MatchesScalar) {
+  const std::vector<float> f = SampleFloats();
+  const size_t n = f.size();
+  std::vector<bfloat16> b(n);
+  std::vector<fp8_e4m3> e4(n);
+  std::vector<fp8_e5m2> e5(n);
+  for (LowpSaturation sat : {kLowpSatNone, kLowpSatFinite}) {
+    ASSERT_EQ(cpu_float2bfloat16_rn(f.data(), b.data(), n, sat, 1, GetParam()),
+              0);
+    ASSERT_EQ(cpu_float2fp8_e4m3_rn(f.data(), e4.data(), n, sat, 1,
+                                    GetParam()),
+              0);
+    ASSERT_EQ(cpu_float2fp8_e5m2_rn(f.data(), e5.data(), n, sat, 1,
+                                    GetParam()),
+              0);
+    for (size_t i = 0; i < n; ++i) {
+      ASSERT_EQ(b[i].x, cpu_float2bfloat16_rn(f[i], sat).x)
+          << std::hex << Bits(f[i]) << " " << sat;
+      ASSERT_EQ(e4[i].x, cpu_float2fp8_e4m3_rn(f[i], sat).x)
+          << std::hex << Bits(f[i]) << " " << sat;
+      ASSERT_EQ(e5[i].x, cpu_float2fp8_e5m2_rn(f[i], sat).x)
+          << std::hex << Bits(f[i]) << " " << sat;
+    }
+  }
+}
+
+TEST_P(Bf16Fp8BulkTest, DecodeAllCodes) {
+  const size_t n = 1 << 16;
+  std::vector<bfloat16> b(n);
+  std::vector<fp8_e4m3> e4(n);
+  std::vector<fp8_e5m2> e5(n);
+  for (size_t i = 0; i < n; ++i) {
+    b[i].x = static_cast<unsigned short>(i);
+    e4[i].x = e5[i].x = static_cast<unsigned char>(i);
+  }
+  std::vector<float> f(n);
+  ASSERT_EQ(cpu_bfloat162float(b.data(), f.data(), n, 1, GetParam()), 0);
+  for (size_t i = 0; i < n; ++i) {
+    ASSERT_EQ(Bits(f[i]), Bits(cpu_bfloat162float(b[i]))) << i;
+  }
+  ASSERT_EQ(cpu_fp8_e4m32float(e4.data(), f.data(), n, 1, GetParam()), 0);
+  for (size_t i = 0; i < n; ++i) {
+    ASSERT_EQ(Bits(f[i]), Bits(cpu_fp8_e4m32float(e4[i]))) << i;
+  }
+  ASSERT_EQ(cpu_fp8_e5m22float(e5.data(), f.data(), n, 1, GetParam()), 0);
+  for (size_t i = 0; i < n; ++i) {
+    ASSERT_EQ(Bits(f[i]), Bits(cpu_fp8_e5m22float(e5[i]))) << i;
+  }
+}
+
+TEST_P(Bf16Fp8BulkTest, ThreadsAndTailsDoNotChangeResults) {
+  const size_t n = (1 << 20) + 13;
+  std::vector<float> f(n);
+  uint32_t x = 12345;
+  for (size_t i = 0; i < n; ++i) {
+    x = x * 1664525u + 1013904223u;
+    f[i] = Float(x);
+  }
+  std::vector<fp8_e4m3> expect(n), v(n);
+  std::vector<float> back_expect(n), back(n);
+  ASSERT_EQ(cpu_float2fp8_e4m3_rn(f.data(), expect.data(), n, kLowpSatFinite,
+                                  1, kLowpKernelScalar),
+            0);
+  ASSERT_EQ(cpu_fp8_e4m32float(expect.data(), back_expect.data(), n, 1,
+                               kLowpKernelScalar),
+            0);
+  for (int threads : {1, 2, 3, 8}) {
+    for (size_t len : {n, size_t(7), size_t(9), size_t(0)}) {
+      ASSERT_EQ(cpu_float2fp8_e4m3_rn(f.data(), v.data(), len, kLowpSatFinite,
+                                      threads, GetParam()),
+                0);
+      ASSERT_EQ(cpu_fp8_e4m32float(expect.data(), back.data(), len, threads,
+                                   GetParam()),
+                0);
+      for (size_t i = 0; i < len; ++i) {
+        ASSERT_EQ(v[i].x, expect[i].x) << threads << ", " << i;
+        ASSERT_EQ(Bits(back[i]), Bits(back_expect[i]))
+            << threads << ", " << i;
+      }
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Kernels, Bf16Fp8BulkTest,
+                         ::testing::ValuesIn(SupportedKernels()),
+                         [](const ::testing::TestParamInfo<LowpKernel>&
+                                info) {
+                           return std::string(lowp_kernel_name(info.param));
+                         });
+
+}  // namespace
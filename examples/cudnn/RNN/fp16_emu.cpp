@@ -49,6 +49,17 @@
 
 #include "examples/cudnn/RNN/fp16_emu.h"
 
+#include <stdint.h>
+
+#include <algorithm>
+
+#include "examples/cuda/common/parallel_helper.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FP16_EMU_X86 1
+#endif
+
 // Host functions for converting between FP32 and FP16 formats
 // Paulius Micikevicius (pauliusm@nvidia.com)
 
@@ -137,3 +148,246 @@ float cpu_half2float(half1 h) {
 
   return reinterpret_cast<float&>(temp);
 }
+
+// Bulk conversions
+
+namespace {
+
+const size_t kMinPerThread = 1 << 18;
+
+typedef void (*Float2HalfFn)(const float* f, uint16_t* h, size_t n);
+typedef void (*Half2FloatFn)(const uint16_t* h, float* f, size_t n);
+
+void Float2HalfScalar(const float* f, uint16_t* h, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    half1 r = cpu_float2half_rn(f[i]);
+    h[i] = reinterpret_cast<__half_raw&>(r).x;
+  }
+}
+
+void Half2FloatScalar(const uint16_t* h, float* f, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    __half_raw hr;
+    hr.x = h[i];
+    f[i] = cpu_half2float(reinterpret_cast<half1&>(hr));
+  }
+}
+
+#ifdef FP16_EMU_X86
+
+// Eight lanes of cpu_float2half_rn(), as 32-bit integers.
+__attribute__((target("avx2"))) inline __m128i Float2Half8(__m256i x) {
+  const __m256i u = _mm256_and_si256(x, _mm256_set1_epi32(0x7fffffff));
+  const __m256i sign =
+      _mm256_and_si256(_mm256_srli_epi32(x, 16), _mm256_set1_epi32(0x8000));
+  const __m256i one = _mm256_set1_epi32(1);
+
+  // Normal results: rebias the exponent, round the low 13 bits to nearest
+  // even; a carry out of the mantissa bumps the exponent.
+  __m256i normal = _mm256_add_epi32(
+      u, _mm256_add_epi32(_mm256_set1_epi32(0xfff),
+                          _mm256_and_si256(_mm256_srli_epi32(u, 13), one)));
+  normal = _mm256_sub_epi32(_mm256_srli_epi32(normal, 13),
+                            _mm256_set1_epi32(0x70 << 10));
+
+  // Subnormal results: shift the mantissa, implicit bit included, right by
+  // 0x7e - exponent and round the same way.
+  const __m256i shift = _mm256_sub_epi32(_mm256_set1_epi32(0x7e),
+                                         _mm256_srli_epi32(u, 23));
+  const __m256i m = _mm256_or_si256(
+      _mm256_and_si256(u, _mm256_set1_epi32(0x7fffff)),
+      _mm256_set1_epi32(0x800000));
+  const __m256i half_lsb_m1 = _mm256_sub_epi32(
+      _mm256_sllv_epi32(one, _mm256_sub_epi32(shift, one)), one);
+  const __m256i odd = _mm256_and_si256(_mm256_srlv_epi32(m, shift), one);
+  const __m256i subnormal = _mm256_srlv_epi32(
+      _mm256_add_epi32(m, _mm256_add_epi32(half_lsb_m1, odd)), shift);
+
+  __m256i r = _mm256_blendv_epi8(
+      subnormal, normal,
+      _mm256_cmpgt_epi32(u, _mm256_set1_epi32(0x387fffff)));
+  r = _mm256_andnot_si256(
+      _mm256_cmpgt_epi32(_mm256_set1_epi32(0x33000001), u), r);
+  r = _mm256_blendv_epi8(
+      r, _mm256_set1_epi32(0x7c00),
+      _mm256_cmpgt_epi32(u, _mm256_set1_epi32(0x477fefff)));
+  r = _mm256_or_si256(r, sign);
+  r = _mm256_blendv_epi8(
+      r, _mm256_set1_epi32(0x7fff),
+      _mm256_cmpgt_epi32(u, _mm256_set1_epi32(0x7f800000)));
+  return _mm_packus_epi32(_mm256_castsi256_si128(r),
+                          _mm256_extracti128_si256(r, 1));
+}
+
+// Eight lanes of cpu_half2float(), from zero-extended halves.
+__attribute__((target("avx2"))) inline __m256i Half2Float8(__m256i h) {
+  const __m256i sign =
+      _mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(0x8000)), 16);
+  const __m256i habs = _mm256_and_si256(h, _mm256_set1_epi32(0x7fff));
+
+  // Normal: rebias the exponent. Zero and subnormal: the mantissa times
+  // 2^-24, which is exact.
+  const __m256i normal = _mm256_add_epi32(_mm256_slli_epi32(habs, 13),
+                                          _mm256_set1_epi32(0x70 << 23));
+  const __m256i subnormal = _mm256_castps_si256(_mm256_mul_ps(
+      _mm256_cvtepi32_ps(habs), _mm256_set1_ps(5.9604644775390625e-08f)));
+
+  __m256i r = _mm256_blendv_epi8(
+      subnormal, normal, _mm256_cmpgt_epi32(habs, _mm256_set1_epi32(0x3ff)));
+  r = _mm256_blendv_epi8(
+      r, _mm256_set1_epi32(0x7f800000),
+      _mm256_cmpgt_epi32(habs, _mm256_set1_epi32(0x7bff)));
+  r = _mm256_or_si256(r, sign);
+  return _mm256_blendv_epi8(
+      r, _mm256_set1_epi32(0x7fffffff),
+      _mm256_cmpgt_epi32(habs, _mm256_set1_epi32(0x7c00)));
+}
+
+__attribute__((target("avx2"))) void Float2HalfAvx2(const float* f,
+                                                    uint16_t* h, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i x = _mm256_loadu_si256((const __m256i*)(f + i));
+    _mm_storeu_si128((__m128i*)(h + i), Float2Half8(x));
+  }
+  Float2HalfScalar(f + i, h + i, n - i);
+}
+
+__attribute__((target("avx2"))) void Half2FloatAvx2(const uint16_t* h,
+                                                    float* f, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i x =
+        _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(h + i)));
+    _mm256_storeu_si256((__m256i*)(f + i), Half2Float8(x));
+  }
+  Half2FloatScalar(h + i, f + i, n - i);
+}
+
+// The hardware converts NaNs to quiet NaNs that keep sign and payload,
+// where the scalar code returns one fixed NaN; patch those lanes.
+__attribute__((target("avx2,f16c"))) void Float2HalfF16c(const float* f,
+                                                         uint16_t* h,
+                                                         size_t n) {
+  const __m256i abs_mask = _mm256_set1_epi32(0x7fffffff);
+  const __m256i inf = _mm256_set1_epi32(0x7f800000);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256 x = _mm256_loadu_ps(f + i);
+    const __m128i r = _mm256_cvtps_ph(x, _MM_FROUND_TO_NEAREST_INT);
+    const __m256i nan = _mm256_cmpgt_epi32(
+        _mm256_and_si256(_mm256_castps_si256(x), abs_mask), inf);
+    const __m128i nan16 = _mm_packs_epi32(_mm256_castsi256_si128(nan),
+                                          _mm256_extracti128_si256(nan, 1));
+    _mm_storeu_si128((__m128i*)(h + i),
+                     _mm_blendv_epi8(r, _mm_set1_epi16(0x7fff), nan16));
+  }
+  Float2HalfScalar(f + i, h + i, n - i);
+}
+
+__attribute__((target("avx2,f16c"))) void Half2FloatF16c(const uint16_t* h,
+                                                         float* f,
+                                                         size_t n) {
+  const __m256i abs_mask = _mm256_set1_epi32(0x7fff);
+  const __m256i inf = _mm256_set1_epi32(0x7c00);
+  const __m256 nan = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m128i x = _mm_loadu_si128((const __m128i*)(h + i));
+    const __m256i is_nan = _mm256_cmpgt_epi32(
+        _mm256_and_si256(_mm256_cvtepu16_epi32(x), abs_mask), inf);
+    _mm256_storeu_ps(f + i, _mm256_blendv_ps(_mm256_cvtph_ps(x), nan,
+                                             _mm256_castsi256_ps(is_nan)));
+  }
+  Half2FloatScalar(h + i, f + i, n - i);
+}
+
+#endif  // FP16_EMU_X86
+
+Fp16Kernel Resolve(Fp16Kernel kernel) {
+  if (kernel != kFp16KernelAuto) return kernel;
+  if (fp16_kernel_supported(kFp16KernelF16c)) return kFp16KernelF16c;
+  if (fp16_kernel_supported(kFp16KernelAvx2)) return kFp16KernelAvx2;
+  return kFp16KernelScalar;
+}
+
+template <typename In, typename Out>
+void Convert(void (*fn)(const In*, Out*, size_t), const In* in, Out* out,
+             size_t n, int num_threads) {
+  ParallelChunks(n, num_threads, kMinPerThread, [&](size_t begin, size_t end) {
+    fn(in + begin, out + begin, end - begin);
+  });
+}
+
+}  // namespace
+
+bool fp16_kernel_supported(Fp16Kernel kernel) {
+  switch (kernel) {
+    case kFp16KernelAuto:
+    case kFp16KernelScalar:
+      return true;
+#ifdef FP16_EMU_X86
+    case kFp16KernelAvx2:
+      return __builtin_cpu_supports("avx2");
+    case kFp16KernelF16c:
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+#endif
+    default:
+      return false;
+  }
+}
+
+const char* fp16_kernel_name(Fp16Kernel kernel) {
+  switch (Resolve(kernel)) {
+    case kFp16KernelScalar:
+      return "scalar";
+    case kFp16KernelAvx2:
+      return "avx2";
+    case kFp16KernelF16c:
+      return "f16c";
+    default:
+      return "unknown";
+  }
+}
+
+int cpu_float2half_rn(const float* f, half1* h, size_t n, int num_threads,
+                      Fp16Kernel kernel) {
+  if (!fp16_kernel_supported(kernel)) return 1;
+
+  Float2HalfFn fn = Float2HalfScalar;
+#ifdef FP16_EMU_X86
+  switch (Resolve(kernel)) {
+    case kFp16KernelAvx2:
+      fn = Float2HalfAvx2;
+      break;
+    case kFp16KernelF16c:
+      fn = Float2HalfF16c;
+      break;
+    default:
+      break;
+  }
+#endif
+  Convert(fn, f, reinterpret_cast<uint16_t*>(h), n, num_threads);
+  return 0;
+}
+
+int cpu_half2float(const half1* h, float* f, size_t n, int num_threads,
+                   Fp16Kernel kernel) {
+  if (!fp16_kernel_supported(kernel)) return 1;
+
+  Half2FloatFn fn = Half2FloatScalar;
+#ifdef FP16_EMU_X86
+  switch (Resolve(kernel)) {
+    case kFp16KernelAvx2:
+      fn = Half2FloatAvx2;
+      break;
+    case kFp16KernelF16c:
+      fn = Half2FloatF16c;
+      break;
+    default:
+      break;
+  }
+#endif
+  Convert(fn, reinterpret_cast<const uint16_t*>(h), f, n, num_threads);
+  return 0;
+}
@@ -52,6 +52,8 @@
 #if !defined(_FP16_EMU_H_)
 #define _FP16_EMU_H_
 
+#include <stddef.h>
+
 #include "cuda/include/cuda_fp16.h"
 #include "cuda/include/driver_types.h"
 
@@ -76,6 +78,27 @@ half1 cpu_float2half_rn(float f);
 
 float cpu_half2float(half1 h);
 
+// Bulk conversions of n values, bit for bit the same as calling the
+// functions above on each element (NaNs included: every NaN becomes
+// 0x7fff, resp. 0x7fffffff). Arrays of a few hundred thousand values or
+// more are split across threads; num_threads <= 0 picks one per core.
+// Both return 0 on success and 1 if the kernel cannot run on this CPU.
+enum Fp16Kernel {
+  kFp16KernelAuto = 0,  // widest kernel the CPU supports
+  kFp16KernelScalar,
+  kFp16KernelAvx2,  // integer emulation of the scalar code
+  kFp16KernelF16c,  // vcvtps2ph / vcvtph2ps, NaNs patched up
+};
+
+bool fp16_kernel_supported(Fp16Kernel kernel);
+const char* fp16_kernel_name(Fp16Kernel kernel);
+
+int cpu_float2half_rn(const float* f, half1* h, size_t n, int num_threads = 0,
+                      Fp16Kernel kernel = kFp16KernelAuto);
+
+int cpu_half2float(const half1* h, float* f, size_t n, int num_threads = 0,
+                   Fp16Kernel kernel = kFp16KernelAuto);
+
 static __inline__ __device__ __host__ half1 habs(half1 h) {
   __half_raw hr = reinterpret_cast<__half_raw&>(h);
   hr.x &= 0x7fffU;
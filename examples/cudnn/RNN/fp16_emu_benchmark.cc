@@ -0,0 +1,79 @@
+#include <string.h>
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "examples/cudnn/RNN/fp16_emu.h"
+
+// How to run:
+// bazel run -c opt //examples/cudnn/RNN:fp16_emu_benchmark
+namespace {
+
+std::vector<float> Values(size_t n) {
+  std::vector<float> f(n);
+  for (size_t i = 0; i < n; ++i) f[i] = (float)i * 0.37f - 1000.0f;
+  return f;
+}
+
+// One cpu_float2half_rn(float) call per value.
+void BM_Float2HalfLoop(benchmark::State& state) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  const std::vector<float> f = Values(n);
+  std::vector<half1> h(n);
+  for (auto _ : state) {
+    for (size_t i = 0; i < n; ++i) h[i] = cpu_float2half_rn(f[i]);
+    benchmark::DoNotOptimize(h.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Arguments: values, Fp16Kernel, threads.
+void BM_Float2Half(benchmark::State& state) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  const auto kernel = static_cast<Fp16Kernel>(state.range(1));
+  if (!fp16_kernel_supported(kernel)) {
+    state.SkipWithError("kernel not supported on this CPU");
+    return;
+  }
+  const std::vector<float> f = Values(n);
+  std::vector<half1> h(n);
+  for (auto _ : state) {
+    cpu_float2half_rn(f.data(), h.data(), n, (int)state.range(2), kernel);
+    benchmark::DoNotOptimize(h.data());
+  }
+  state.SetLabel(fp16_kernel_name(kernel));
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetBytesProcessed(state.iterations() * n * (sizeof(float) + 2));
+}
+
+// Arguments: values, Fp16Kernel, threads.
+void BM_Half2Float(benchmark::State& state) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  const auto kernel = static_cast<Fp16Kernel>(state.range(1));
+  if (!fp16_kernel_supported(kernel)) {
+    state.SkipWithError("kernel not supported on this CPU");
+    return;
+  }
+  const std::vector<float> values = Values(n);
+  std::vector<half1> h(n);
+  cpu_float2half_rn(values.data(), h.data(), n);
+  std::vector<float> f(n);
+  for (auto _ : state) {
+    cpu_half2float(h.data(), f.data(), n, (int)state.range(2), kernel);
+    benchmark::DoNotOptimize(f.data());
+  }
+  state.SetLabel(fp16_kernel_name(kernel));
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetBytesProcessed(state.iterations() * n * (sizeof(float) + 2));
+}
+
+const std::vector<std::vector<int64_t>> kArgs = {
+    {1 << 12, 1 << 24},
+    {kFp16KernelScalar, kFp16KernelAvx2, kFp16KernelF16c},
+    {1, 0}};
+
+BENCHMARK(BM_Float2HalfLoop)->Arg(1 << 12)->Arg(1 << 24);
+BENCHMARK(BM_Float2Half)->ArgsProduct(kArgs)->UseRealTime();
+BENCHMARK(BM_Half2Float)->ArgsProduct(kArgs)->UseRealTime();
+
+}  // namespace
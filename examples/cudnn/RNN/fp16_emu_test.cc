@@ -0,0 +1,137 @@
+#include "examples/cudnn/RNN/fp16_emu.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+uint16_t Bits(half1 h) {
+  uint16_t x;
+  memcpy(&x, &h, sizeof(x));
+  return x;
+}
+
+half1 Half(uint16_t x) {
+  half1 h;
+  memcpy(&h, &x, sizeof(h));
+  return h;
+}
+
+uint32_t Bits(float f) {
+  uint32_t x;
+  memcpy(&x, &f, sizeof(x));
+  return x;
+}
+
+float Float(uint32_t x) {
+  float f;
+  memcpy(&f, &x, sizeof(f));
+  return f;
+}
+
+std::vector<Fp16Kernel> SupportedKernels() {
+  std::vector<Fp16Kernel> kernels;
+  for (Fp16Kernel kernel :
+       {kFp16KernelScalar, kFp16KernelAvx2, kFp16KernelF16c}) {
+    if (fp16_kernel_supported(kernel)) kernels.push_back(kernel);
+  }
+  return kernels;
+}
+
+TEST(Fp16EmuTest, ScalarSpotValues) {
+  EXPECT_EQ(Bits(cpu_float2half_rn(1.0f)), 0x3c00);
+  EXPECT_EQ(Bits(cpu_float2half_rn(-0.0f)), 0x8000);
+  EXPECT_EQ(Bits(cpu_float2half_rn(65504.0f)), 0x7bff);
+  EXPECT_EQ(Bits(cpu_float2half_rn(65520.0f)), 0x7c00);
+  EXPECT_EQ(Bits(cpu_float2half_rn(0x1p-24f)), 0x0001);
+  EXPECT_EQ(Bits(cpu_float2half_rn(0x1p-25f)), 0x0000);
+  EXPECT_EQ(Bits(cpu_float2half_rn(Float(0xffc00001))), 0x7fff);
+  EXPECT_EQ(Bits(cpu_half2float(Half(0x0001))), Bits(0x1p-24f));
+  EXPECT_EQ(Bits(cpu_half2float(Half(0xfc00))), 0xff800000);
+  EXPECT_EQ(Bits(cpu_half2float(Half(0xfe01))), 0x7fffffff);
+}
+
+TEST(Fp16EmuTest, FloatToHalfExhaustive) {
+  // Every float bit pattern, a chunk at a time. The reference is the
+  // scalar function, run on all cores; each SIMD kernel must match it.
+  const size_t chunk = 1 << 24;
+  std::vector<float> f(chunk);
+  std::vector<half1> expect(chunk), h(chunk);
+  for (uint64_t base = 0; base < (1ull << 32); base += chunk) {
+    for (size_t i = 0; i < chunk; ++i) {
+      f[i] = Float(static_cast<uint32_t>(base + i));
+    }
+    ASSERT_EQ(cpu_float2half_rn(f.data(), expect.data(), chunk, 0,
+                                kFp16KernelScalar),
+              0);
+    for (Fp16Kernel kernel : SupportedKernels()) {
+      if (kernel == kFp16KernelScalar) continue;
+      ASSERT_EQ(cpu_float2half_rn(f.data(), h.data(), chunk, 0, kernel), 0);
+      for (size_t i = 0; i < chunk; ++i) {
+        ASSERT_EQ(Bits(h[i]), Bits(expect[i]))
+            << fp16_kernel_name(kernel) << " " << std::hex << base + i;
+      }
+    }
+  }
+}
+
+class Fp16BulkTest : public ::testing::TestWithParam<Fp16Kernel> {};
+
+TEST_P(Fp16BulkTest, HalfToFloatExhaustive) {
+  const size_t n = 1 << 16;
+  std::vector<half1> h(n);
+  for (size_t i = 0; i < n; ++i) h[i] = Half(static_cast<uint16_t>(i));
+  std::vector<float> f(n);
+  ASSERT_EQ(cpu_half2float(h.data(), f.data(), n, 1, GetParam()), 0);
+  for (size_t i = 0; i < n; ++i) {
+    ASSERT_EQ(Bits(f[i]), Bits(cpu_half2float(h[i]))) << std::hex << i;
+  }
+}
+
+TEST_P(Fp16BulkTest, ThreadsAndTailsDoNotChangeResults) {
+  // Odd sizes and several threads; values cover all classes.
+  const size_t n = (1 << 20) + 13;
+  std::vector<float> f(n);
+  uint32_t x = 12345;
+  for (size_t i = 0; i < n; ++i) {
+    x = x * 1664525u + 1013904223u;
+    f[i] = Float(x);
+  }
+  std::vector<half1> expect(n), h(n);
+  std::vector<float> back_expect(n), back(n);
+  ASSERT_EQ(cpu_float2half_rn(f.data(), expect.data(), n, 1,
+                              kFp16KernelScalar),
+            0);
+  ASSERT_EQ(cpu_half2float(expect.data(), back_expect.data(), n, 1,
+                           kFp16KernelScalar),
+            0);
+  for (int threads : {1, 2, 3, 8}) {
+    for (size_t len : {n, size_t(7), size_t(9), size_t(0)}) {
+      ASSERT_EQ(cpu_float2half_rn(f.data(), h.data(), len, threads,
+                                  GetParam()),
+                0);
+      ASSERT_EQ(cpu_half2float(expect.data(), back.data(), len, threads,
+                               GetParam()),
+                0);
+      for (size_t i = 0; i < len; ++i) {
+        ASSERT_EQ(Bits(h[i]), Bits(expect[i])) << threads << ", " << i;
+        ASSERT_EQ(Bits(back[i]), Bits(back_expect[i]))
+            << threads << ", " << i;
+      }
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Kernels, Fp16BulkTest,
+                         ::testing::ValuesIn(SupportedKernels()),
+                         [](const ::testing::TestParamInfo<Fp16Kernel>&
+                                info) {
+                           return std::string(fp16_kernel_name(info.param));
+                         });
+
+}  // namespace
@@ -0,0 +1,14 @@
+"""Loads the google benchmark library"""
+
+load("@bazel_tools//tools/build_defs/repo:http.bzl", "http_archive")
+
+def repo():
+    version = "1.6.1"
+    http_archive(
+        name = "com_github_google_benchmark",
+        sha256 = "6132883bc8c9b0df5375b16ab520fac1a85dc9e4cf5be59480448ece74b278d4",
+        strip_prefix = "benchmark-{}".format(version),
+        urls = [
+            "https://github.com/google/benchmark/archive/refs/tags/v{}.tar.gz".format(version),
+        ],
+    )
@@ -0,0 +1,15 @@
+load("@bazel_tools//tools/build_defs/repo:http.bzl", "http_archive")
+
+def clean_dep(dep):
+    return str(Label(dep))
+
+def repo():
+    http_archive(
+        name = "lz4",
+        build_file = clean_dep("//third_party/lz4:lz4.BUILD"),
+        sha256 = "0b0e3aa07c8c063ddf40b082bdf7e37a1562bda40a0ff5272957f3e987e0e54b",
+        strip_prefix = "lz4-1.9.4",
+        urls = [
+            "https://github.com/lz4/lz4/archive/refs/tags/v1.9.4.tar.gz",
+        ],
+    )